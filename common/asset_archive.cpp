@@ -0,0 +1,527 @@
+#include "asset_archive.hpp"
+#include "job_system.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <unordered_set>
+
+static_assert(sizeof(AssetArchiveHeader) == 40, "AssetArchiveHeader layout");
+static_assert(sizeof(AssetArchiveEntry) == 40, "AssetArchiveEntry layout");
+
+namespace
+{
+    const uint32_t ARCHIVE_VERSION = 1;
+
+    const size_t LZ4_MIN_MATCH = 4;
+    const size_t LZ4_LAST_LITERALS = 5; // 块的最后 5 个字节总是字面量
+    const size_t LZ4_MATCH_LIMIT = 12;  // 最后一个匹配至少在块结束前 12 字节开始
+    const size_t LZ4_MAX_OFFSET = 65535;
+    const int LZ4_HASH_BITS = 16;
+
+    uint32_t read_u32(const uint8_t *bytes)
+    {
+        uint32_t value;
+        std::memcpy(&value, bytes, sizeof(value));
+        return value;
+    }
+
+    uint32_t lz4_hash(uint32_t sequence)
+    {
+        return (sequence * 2654435761u) >> (32 - LZ4_HASH_BITS);
+    }
+
+    // 长度字段超过 15 的部分：若干个 255 加一个余数
+    void write_length(std::vector<uint8_t> &out, size_t length)
+    {
+        for (; length >= 255; length -= 255)
+            out.push_back(255);
+        out.push_back(static_cast<uint8_t>(length));
+    }
+
+    bool read_length(const uint8_t *source, size_t size, size_t &position, size_t &length)
+    {
+        uint8_t byte;
+        do
+        {
+            if (position >= size)
+                return false;
+            byte = source[position++];
+            length += byte;
+        } while (byte == 255);
+        return true;
+    }
+
+    // match_length 为 0 表示块末尾只有字面量的那一段
+    void emit_sequence(std::vector<uint8_t> &out, const uint8_t *literals, size_t literal_length, size_t offset, size_t match_length)
+    {
+        size_t match_code = match_length ? match_length - LZ4_MIN_MATCH : 0;
+        out.push_back(static_cast<uint8_t>((std::min<size_t>(literal_length, 15) << 4) | std::min<size_t>(match_code, 15)));
+        if (literal_length >= 15)
+            write_length(out, literal_length - 15);
+        out.insert(out.end(), literals, literals + literal_length);
+        if (!match_length)
+            return;
+        out.push_back(static_cast<uint8_t>(offset));
+        out.push_back(static_cast<uint8_t>(offset >> 8));
+        if (match_code >= 15)
+            write_length(out, match_code - 15);
+    }
+
+    bool is_absolute(const std::string &path)
+    {
+        return (!path.empty() && (path[0] == '/' || path[0] == '\\')) || (path.size() > 1 && path[1] == ':');
+    }
+
+    struct PackItem
+    {
+        std::string name;
+        std::string source;
+        uint64_t hash = 0;
+        std::vector<uint8_t> data;
+        size_t size = 0;
+        AssetCompression compression = AssetCompression::NONE;
+        bool ok = false;
+    };
+
+    bool read_file(const std::string &path, std::vector<uint8_t> &data)
+    {
+        std::FILE *file = std::fopen(path.c_str(), "rb");
+        if (!file)
+            return false;
+        bool ok = std::fseek(file, 0, SEEK_END) == 0;
+        long size = ok ? std::ftell(file) : -1;
+        ok = size >= 0 && std::fseek(file, 0, SEEK_SET) == 0;
+        if (ok)
+        {
+            data.resize(static_cast<size_t>(size));
+            ok = std::fread(data.data(), 1, data.size(), file) == data.size();
+        }
+        std::fclose(file);
+        return ok;
+    }
+
+    bool write_padding(std::FILE *file, uint64_t &position, uint64_t alignment)
+    {
+        static const uint8_t zeros[256] = {};
+        uint64_t padding = (alignment - position % alignment) % alignment;
+        position += padding;
+        while (padding > 0)
+        {
+            size_t chunk = static_cast<size_t>(std::min<uint64_t>(padding, sizeof(zeros)));
+            if (std::fwrite(zeros, 1, chunk, file) != chunk)
+                return false;
+            padding -= chunk;
+        }
+        return true;
+    }
+}
+
+std::string normalize_asset_path(const std::string &path)
+{
+    if (is_absolute(path))
+        return path;
+    std::string result;
+    size_t begin = 0;
+    while (begin <= path.size())
+    {
+        size_t end = path.find_first_of("/\\", begin);
+        if (end == std::string::npos)
+            end = path.size();
+        size_t length = end - begin;
+        if (length == 2 && path.compare(begin, 2, "..") == 0)
+        {
+            size_t slash = result.find_last_of('/');
+            size_t last = slash == std::string::npos ? 0 : slash + 1;
+            if (result.empty() || result.compare(last, std::string::npos, "..") == 0)
+                result += result.empty() ? ".." : "/..";
+            else
+                result.erase(slash == std::string::npos ? 0 : slash);
+        }
+        else if (length > 0 && !(length == 1 && path[begin] == '.'))
+        {
+            if (!result.empty())
+                result += '/';
+            result.append(path, begin, length);
+        }
+        begin = end + 1;
+    }
+    return result;
+}
+
+uint64_t asset_path_hash(const std::string &normalized)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : normalized)
+    {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+bool asset_exists(const std::string &path)
+{
+    return AssetArchive::instance().contains(path) || std::ifstream(path).good();
+}
+
+std::vector<std::string> default_asset_excludes()
+{
+    return {".blend"};
+}
+
+bool is_asset_excluded(const std::string &path, const std::vector<std::string> &excludes)
+{
+    for (const std::string &suffix : excludes)
+        if (path.size() >= suffix.size() && path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0)
+            return true;
+    return false;
+}
+
+size_t lz4_compress(const uint8_t *source, size_t size, std::vector<uint8_t> &compressed)
+{
+    compressed.clear();
+    compressed.reserve(size + size / 255 + 16);
+    size_t anchor = 0;
+    if (size > LZ4_MATCH_LIMIT && size < UINT32_MAX)
+    {
+        // 每个哈希槽只记最近一次出现的位置，贪心地取第一个匹配
+        std::vector<uint32_t> table(size_t(1) << LZ4_HASH_BITS, UINT32_MAX);
+        size_t limit = size - LZ4_MATCH_LIMIT;
+        size_t position = 0;
+        size_t misses = 0;
+        while (position < limit)
+        {
+            uint32_t sequence = read_u32(source + position);
+            uint32_t &slot = table[lz4_hash(sequence)];
+            size_t candidate = slot;
+            slot = static_cast<uint32_t>(position);
+            if (candidate == UINT32_MAX || position - candidate > LZ4_MAX_OFFSET || read_u32(source + candidate) != sequence)
+            {
+                // 连续找不到匹配（多半是已经压缩过的数据）时逐渐加大步长
+                position += 1 + (misses++ >> 6);
+                continue;
+            }
+            misses = 0;
+            size_t length = LZ4_MIN_MATCH;
+            size_t max_length = size - LZ4_LAST_LITERALS - position;
+            while (length < max_length && source[position + length] == source[candidate + length])
+                length++;
+            while (position > anchor && candidate > 0 && source[position - 1] == source[candidate - 1])
+            {
+                position--;
+                candidate--;
+                length++;
+            }
+            emit_sequence(compressed, source + anchor, position - anchor, position - candidate, length);
+            position += length;
+            anchor = position;
+        }
+    }
+    emit_sequence(compressed, source + anchor, size - anchor, 0, 0);
+    return compressed.size();
+}
+
+bool lz4_decompress(const uint8_t *source, size_t size, uint8_t *destination, size_t destination_size)
+{
+    // 输入输出后面都还有 16 字节余量时按固定 16 字节复制（可以多写，后面的数据会覆盖），否则按精确长度复制
+    const size_t WILD_COPY = 16;
+    size_t in = 0, out = 0;
+    while (in < size)
+    {
+        uint8_t token = source[in++];
+        size_t literal_length = token >> 4;
+        if (literal_length == 15 && !read_length(source, size, in, literal_length))
+            return false;
+        if (literal_length > size - in || literal_length > destination_size - out)
+            return false;
+        if (literal_length <= WILD_COPY && size - in >= WILD_COPY && destination_size - out >= WILD_COPY)
+            std::memcpy(destination + out, source + in, WILD_COPY);
+        else if (literal_length > 0)
+            std::memcpy(destination + out, source + in, literal_length);
+        in += literal_length;
+        out += literal_length;
+        if (in == size)
+            break; // 最后一段没有匹配
+
+        if (size - in < 2)
+            return false;
+        size_t offset = source[in] | (size_t(source[in + 1]) << 8);
+        in += 2;
+        size_t match_length = token & 15;
+        if (match_length == 15 && !read_length(source, size, in, match_length))
+            return false;
+        match_length += LZ4_MIN_MATCH;
+        if (offset == 0 || offset > out || match_length > destination_size - out)
+            return false;
+        const uint8_t *match = destination + out - offset;
+        if (offset >= WILD_COPY && destination_size - out - match_length >= WILD_COPY)
+        {
+            // 每次读的 16 字节都在已写出的范围内
+            for (size_t copied = 0; copied < match_length; copied += WILD_COPY)
+                std::memcpy(destination + out + copied, match + copied, WILD_COPY);
+        }
+        else if (offset >= match_length)
+            std::memcpy(destination + out, match, match_length);
+        else
+        {
+            // 重叠的匹配（如连续重复的字节）必须逐字节复制
+            for (size_t i = 0; i < match_length; i++)
+                destination[out + i] = match[i];
+        }
+        out += match_length;
+    }
+    return out == destination_size;
+}
+
+AssetArchive &AssetArchive::instance()
+{
+    static AssetArchive archive;
+    return archive;
+}
+
+bool AssetArchive::mount(const std::string &path)
+{
+    Archive archive;
+    archive.path = path;
+    if (!archive.file.open_file(path))
+    {
+        printf("ERROR::ASSET_ARCHIVE:: cannot open %s\n", path.c_str());
+        return false;
+    }
+    const uint8_t *bytes = archive.file.data();
+    uint64_t size = archive.file.size();
+    archive.header = reinterpret_cast<const AssetArchiveHeader *>(bytes);
+    const AssetArchiveHeader &header = *archive.header;
+    bool valid = size >= sizeof(AssetArchiveHeader) && std::memcmp(header.magic, "APAK", 4) == 0 && header.version == ARCHIVE_VERSION &&
+                 header.index_offset % alignof(AssetArchiveEntry) == 0 && header.index_offset <= size &&
+                 header.entry_count <= (size - header.index_offset) / sizeof(AssetArchiveEntry) &&
+                 header.names_offset <= size && header.names_size <= size - header.names_offset;
+    if (valid)
+    {
+        archive.entries = reinterpret_cast<const AssetArchiveEntry *>(bytes + header.index_offset);
+        archive.names = reinterpret_cast<const char *>(bytes + header.names_offset);
+        for (uint32_t i = 0; valid && i < header.entry_count; i++)
+        {
+            const AssetArchiveEntry &entry = archive.entries[i];
+            valid = entry.offset <= size && entry.stored_size <= size - entry.offset && uint64_t(entry.name_offset) + entry.name_length <= header.names_size &&
+                    (entry.compression == AssetCompression::LZ4 || (entry.compression == AssetCompression::NONE && entry.stored_size == entry.size));
+        }
+    }
+    if (!valid)
+    {
+        printf("ERROR::ASSET_ARCHIVE:: %s is not a valid asset archive\n", path.c_str());
+        return false;
+    }
+    printf("Asset archive mounted: %s, %u files, %.1f MB\n", path.c_str(), header.entry_count, size / (1024.0 * 1024.0));
+    archives.push_back(std::move(archive));
+    return true;
+}
+
+void AssetArchive::unmount_all()
+{
+    archives.clear();
+}
+
+const AssetArchiveEntry *AssetArchive::find(const std::string &path, const Archive *&archive) const
+{
+    if (archives.empty())
+        return nullptr;
+    std::string name = normalize_asset_path(path);
+    uint64_t hash = asset_path_hash(name);
+    for (auto it = archives.rbegin(); it != archives.rend(); ++it)
+    {
+        const AssetArchiveEntry *begin = it->entries;
+        const AssetArchiveEntry *end = begin + it->header->entry_count;
+        const AssetArchiveEntry *entry = std::lower_bound(begin, end, hash, [](const AssetArchiveEntry &entry, uint64_t hash)
+                                                          { return entry.hash < hash; });
+        for (; entry != end && entry->hash == hash; ++entry)
+        {
+            if (entry->name_length == name.size() && name.compare(0, name.size(), it->names + entry->name_offset, entry->name_length) == 0)
+            {
+                archive = &*it;
+                return entry;
+            }
+        }
+    }
+    return nullptr;
+}
+
+bool AssetArchive::contains(const std::string &path) const
+{
+    const Archive *archive = nullptr;
+    return find(path, archive) != nullptr;
+}
+
+bool AssetArchive::read(const std::string &path, const uint8_t *&data, size_t &size, std::vector<uint8_t> &storage) const
+{
+    const Archive *archive = nullptr;
+    const AssetArchiveEntry *entry = find(path, archive);
+    if (!entry)
+        return false;
+    const uint8_t *stored = archive->file.data() + entry->offset;
+    if (entry->compression == AssetCompression::NONE)
+    {
+        data = stored;
+        size = static_cast<size_t>(entry->size);
+        return true;
+    }
+    storage.resize(static_cast<size_t>(entry->size));
+    if (!lz4_decompress(stored, static_cast<size_t>(entry->stored_size), storage.data(), storage.size()))
+    {
+        printf("ERROR::ASSET_ARCHIVE:: corrupt entry %s in %s\n", path.c_str(), archive->path.c_str());
+        storage.clear();
+        return false;
+    }
+    data = storage.data();
+    size = storage.size();
+    return true;
+}
+
+std::vector<std::string> AssetArchive::list() const
+{
+    std::vector<std::string> names;
+    for (const Archive &archive : archives)
+        for (uint32_t i = 0; i < archive.header->entry_count; i++)
+            names.emplace_back(archive.names + archive.entries[i].name_offset, archive.entries[i].name_length);
+    return names;
+}
+
+void AssetArchive::parse_command_line(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strncmp(argv[i], "--archive=", 10) == 0)
+            mount(argv[i] + 10);
+    }
+}
+
+bool write_asset_archive(const std::string &output, const std::vector<std::pair<std::string, std::string>> &files,
+                         const AssetPackOptions &options, AssetPackStats *stats)
+{
+    uint64_t alignment = std::max<uint32_t>(options.alignment, 8);
+    if ((alignment & (alignment - 1)) != 0)
+    {
+        printf("ERROR::ASSET_PACK:: alignment %llu is not a power of two\n", (unsigned long long)alignment);
+        return false;
+    }
+
+    std::vector<PackItem> items;
+    std::unordered_set<std::string> seen;
+    for (const auto &file : files)
+    {
+        PackItem item;
+        item.name = normalize_asset_path(file.first);
+        if (item.name.empty() || item.name.size() > UINT16_MAX || !seen.insert(item.name).second)
+            continue;
+        item.source = file.second;
+        item.hash = asset_path_hash(item.name);
+        items.push_back(std::move(item));
+    }
+
+    // 读取和压缩互不相关，可以并行；写出按输入顺序，同一目录的文件在包里相邻
+    auto process = [&](size_t begin, size_t end)
+    {
+        std::vector<uint8_t> compressed;
+        for (size_t i = begin; i < end; i++)
+        {
+            PackItem &item = items[i];
+            item.ok = read_file(item.source, item.data);
+            item.size = item.data.size();
+            if (!item.ok || !options.compress || item.size < 64)
+                continue;
+            if (lz4_compress(item.data.data(), item.size, compressed) <= item.size * options.max_ratio)
+            {
+                item.data.swap(compressed);
+                item.compression = AssetCompression::LZ4;
+            }
+        }
+    };
+    if (options.jobs)
+        options.jobs->parallel_for(items.size(), 1, process);
+    else
+        process(0, items.size());
+    for (const PackItem &item : items)
+    {
+        if (!item.ok)
+        {
+            printf("ERROR::ASSET_PACK:: cannot read %s\n", item.source.c_str());
+            return false;
+        }
+    }
+
+    // 先写到临时文件再改名，正在运行、映射着旧包的程序不受影响
+    std::string temporary = output + ".tmp";
+    std::FILE *file = std::fopen(temporary.c_str(), "wb");
+    if (!file)
+    {
+        printf("ERROR::ASSET_PACK:: cannot write %s\n", temporary.c_str());
+        return false;
+    }
+    AssetArchiveHeader header = {};
+    std::memcpy(header.magic, "APAK", 4);
+    header.version = ARCHIVE_VERSION;
+    header.entry_count = static_cast<uint32_t>(items.size());
+    header.alignment = static_cast<uint32_t>(alignment);
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    uint64_t position = sizeof(header);
+
+    std::vector<AssetArchiveEntry> entries(items.size());
+    std::string names;
+    AssetPackStats result;
+    for (size_t i = 0; ok && i < items.size(); i++)
+    {
+        const PackItem &item = items[i];
+        ok = write_padding(file, position, alignment) && std::fwrite(item.data.data(), 1, item.data.size(), file) == item.data.size();
+        AssetArchiveEntry &entry = entries[i];
+        entry = {};
+        entry.hash = item.hash;
+        entry.offset = position;
+        entry.stored_size = item.data.size();
+        entry.size = item.size;
+        entry.name_offset = static_cast<uint32_t>(names.size());
+        entry.name_length = static_cast<uint16_t>(item.name.size());
+        entry.compression = item.compression;
+        names += item.name;
+        position += item.data.size();
+
+        result.files++;
+        result.compressed_files += item.compression != AssetCompression::NONE;
+        result.raw_bytes += item.size;
+        result.stored_bytes += item.data.size();
+    }
+
+    // 查找按 (hash, 路径) 二分
+    std::sort(entries.begin(), entries.end(), [&names](const AssetArchiveEntry &a, const AssetArchiveEntry &b)
+              {
+                  if (a.hash != b.hash)
+                      return a.hash < b.hash;
+                  return names.compare(a.name_offset, a.name_length, names, b.name_offset, b.name_length) < 0; });
+    ok = ok && write_padding(file, position, alignof(AssetArchiveEntry));
+    header.index_offset = position;
+    ok = ok && std::fwrite(entries.data(), sizeof(AssetArchiveEntry), entries.size(), file) == entries.size();
+    position += entries.size() * sizeof(AssetArchiveEntry);
+    header.names_offset = position;
+    header.names_size = names.size();
+    ok = ok && std::fwrite(names.data(), 1, names.size(), file) == names.size();
+    position += names.size();
+    ok = ok && std::fseek(file, 0, SEEK_SET) == 0 && std::fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = std::fclose(file) == 0 && ok;
+
+    if (ok && std::rename(temporary.c_str(), output.c_str()) != 0)
+    {
+        // Windows 上目标存在时 rename 失败
+        std::remove(output.c_str());
+        ok = std::rename(temporary.c_str(), output.c_str()) == 0;
+    }
+    if (!ok)
+    {
+        printf("ERROR::ASSET_PACK:: cannot write %s\n", output.c_str());
+        std::remove(temporary.c_str());
+        return false;
+    }
+    result.archive_bytes = static_cast<size_t>(position);
+    if (stats)
+        *stats = result;
+    return true;
+}
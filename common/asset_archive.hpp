@@ -0,0 +1,132 @@
+#ifndef ASSET_ARCHIVE_HPP
+#define ASSET_ARCHIVE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "mapped_file.hpp"
+
+class JobSystem;
+
+// 资源包文件格式（小端）：
+//   AssetArchiveHeader
+//   数据块，每个按 header.alignment 对齐
+//   AssetArchiveEntry[entry_count]，按 (hash, 路径) 排序
+//   路径字符串表（规范化后的相对路径，不带结尾的 0）
+struct AssetArchiveHeader
+{
+    char magic[4];           // "APAK"
+    uint32_t version;        // 1
+    uint32_t entry_count;
+    uint32_t alignment;      // 数据块对齐
+    uint64_t index_offset;   // 条目表
+    uint64_t names_offset;   // 路径字符串表
+    uint64_t names_size;
+};
+
+enum class AssetCompression : uint8_t
+{
+    NONE, // 原样存放，读取时直接指向映射的包
+    LZ4,  // LZ4 块格式，读取时解压
+};
+
+struct AssetArchiveEntry
+{
+    uint64_t hash;        // asset_path_hash(路径)
+    uint64_t offset;      // 数据块在包内的位置
+    uint64_t stored_size; // 包内字节数
+    uint64_t size;        // 原文件字节数
+    uint32_t name_offset; // 在路径字符串表中的位置
+    uint16_t name_length;
+    AssetCompression compression;
+    uint8_t reserved;
+};
+
+/**
+ * @brief 只读资源包。启动时把 asset_pack 打出的一个或多个包 mmap 进来，之后 MappedFile::open 按路径先查包，
+ *        查到就直接引用包内数据（压缩的条目解压到 MappedFile 自己的缓冲），查不到才访问磁盘上的散文件，
+ *        所以纹理、着色器和模型加载代码不需要知道资源来自哪里。
+ *        查找是对排序的 64 位哈希做二分，不产生任何文件系统调用。
+ *        mount / unmount_all 要在开始加载资源之前、单线程调用；之后的查找和读取可以在任意线程并发进行。
+ */
+class AssetArchive
+{
+public:
+    static AssetArchive &instance();
+
+    // 挂载一个资源包，后挂载的优先；文件不存在或格式不对时打印错误并返回 false
+    bool mount(const std::string &path);
+    void unmount_all();
+    bool is_mounted() const { return !archives.empty(); }
+
+    // 包里是否有这个路径
+    bool contains(const std::string &path) const;
+    // 找到时返回 true：未压缩的条目 data 指向映射的包，压缩的条目解压到 storage 后指向它
+    bool read(const std::string &path, const uint8_t *&data, size_t &size, std::vector<uint8_t> &storage) const;
+
+    // 已挂载的包里的所有路径（按包的挂载顺序、包内按哈希排序）
+    std::vector<std::string> list() const;
+
+    // 解析 --archive=<文件>（可以出现多次），依次挂载
+    void parse_command_line(int argc, char **argv);
+
+private:
+    AssetArchive() = default;
+
+    struct Archive
+    {
+        std::string path;
+        MappedFile file;
+        const AssetArchiveHeader *header = nullptr;
+        const AssetArchiveEntry *entries = nullptr;
+        const char *names = nullptr;
+    };
+
+    const AssetArchiveEntry *find(const std::string &path, const Archive *&archive) const;
+
+    std::vector<Archive> archives;
+};
+
+// 包内路径：'\' 换成 '/'，去掉 "." 和空段，"a/../b" 化简为 "b"，用于打包和查找
+std::string normalize_asset_path(const std::string &path);
+// 规范化路径的 FNV-1a 64 位哈希
+uint64_t asset_path_hash(const std::string &normalized);
+
+// 资源包里或磁盘上有这个文件
+bool asset_exists(const std::string &path);
+
+// asset_pack 默认不打包的后缀（只有建模软件用的源文件）；asset_bench 列散文件时用同一份，两边读的是同一批文件
+std::vector<std::string> default_asset_excludes();
+// path 以 excludes 中任一后缀结尾
+bool is_asset_excluded(const std::string &path, const std::vector<std::string> &excludes);
+
+// LZ4 块格式压缩（不带帧头），返回压缩后的字节数
+size_t lz4_compress(const uint8_t *source, size_t size, std::vector<uint8_t> &compressed);
+// 解压到 destination，数据损坏或解压后的长度不等于 destination_size 时返回 false
+bool lz4_decompress(const uint8_t *source, size_t size, uint8_t *destination, size_t destination_size);
+
+struct AssetPackOptions
+{
+    bool compress = true;      // 压缩后不大于原大小的 max_ratio 时才存压缩数据（png / jpg / ktx2 通常原样存放）
+    float max_ratio = 0.9f;
+    uint32_t alignment = 64;   // 数据块对齐，2 的幂
+    JobSystem *jobs = nullptr; // 不为空时并行读取和压缩
+};
+
+struct AssetPackStats
+{
+    size_t files = 0;
+    size_t compressed_files = 0;
+    size_t raw_bytes = 0;    // 原文件合计
+    size_t stored_bytes = 0; // 包内数据块合计（不含对齐和索引）
+    size_t archive_bytes = 0;
+};
+
+// 把 files（包内路径, 磁盘路径）打成一个资源包；包内路径会被规范化，重复的只保留第一个。
+// 读取磁盘文件时不经过已挂载的包。失败时打印错误并返回 false
+bool write_asset_archive(const std::string &output, const std::vector<std::pair<std::string, std::string>> &files,
+                         const AssetPackOptions &options, AssetPackStats *stats = nullptr);
+
+#endif // ASSET_ARCHIVE_HPP
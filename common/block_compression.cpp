@@ -0,0 +1,880 @@
+#include "block_compression.hpp"
+#include "job_system.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+    const float PI = 3.14159265358979f;
+
+    int round_clamp(float value, int low, int high)
+    {
+        return std::min(high, std::max(low, static_cast<int>(std::floor(value + 0.5f))));
+    }
+
+    // 块内像素的主轴（协方差矩阵幂迭代），channels 之外的分量不参与
+    void principal_axis(const float points[16][4], int channels, float mean[4], float axis[4])
+    {
+        float low[4], high[4];
+        for (int c = 0; c < 4; c++)
+        {
+            mean[c] = 0.0f;
+            low[c] = std::numeric_limits<float>::max();
+            high[c] = -std::numeric_limits<float>::max();
+        }
+        for (int i = 0; i < 16; i++)
+            for (int c = 0; c < channels; c++)
+            {
+                mean[c] += points[i][c] / 16.0f;
+                low[c] = std::min(low[c], points[i][c]);
+                high[c] = std::max(high[c], points[i][c]);
+            }
+
+        float covariance[4][4] = {};
+        for (int i = 0; i < 16; i++)
+            for (int a = 0; a < channels; a++)
+                for (int b = 0; b < channels; b++)
+                    covariance[a][b] += (points[i][a] - mean[a]) * (points[i][b] - mean[b]);
+
+        // 从包围盒对角线出发迭代，收敛很快
+        float vector[4] = {};
+        float length = 0.0f;
+        for (int c = 0; c < channels; c++)
+        {
+            vector[c] = high[c] - low[c];
+            length += vector[c] * vector[c];
+        }
+        if (length == 0.0f)
+            for (int c = 0; c < channels; c++)
+                vector[c] = 1.0f;
+        for (int iteration = 0; iteration < 8; iteration++)
+        {
+            float next[4] = {};
+            for (int a = 0; a < channels; a++)
+                for (int b = 0; b < channels; b++)
+                    next[a] += covariance[a][b] * vector[b];
+            float norm = 0.0f;
+            for (int c = 0; c < channels; c++)
+                norm += next[c] * next[c];
+            if (norm < 1e-12f)
+                break;
+            norm = std::sqrt(norm);
+            for (int c = 0; c < channels; c++)
+                vector[c] = next[c] / norm;
+        }
+        length = 0.0f;
+        for (int c = 0; c < channels; c++)
+            length += vector[c] * vector[c];
+        length = std::sqrt(length);
+        for (int c = 0; c < 4; c++)
+            axis[c] = c < channels ? vector[c] / length : 0.0f;
+    }
+
+    // 沿主轴投影取两端作为初始端点
+    void axis_endpoints(const float points[16][4], int channels, float start[4], float end[4])
+    {
+        float mean[4], axis[4];
+        principal_axis(points, channels, mean, axis);
+        float low = std::numeric_limits<float>::max(), high = -std::numeric_limits<float>::max();
+        for (int i = 0; i < 16; i++)
+        {
+            float t = 0.0f;
+            for (int c = 0; c < channels; c++)
+                t += (points[i][c] - mean[c]) * axis[c];
+            low = std::min(low, t);
+            high = std::max(high, t);
+        }
+        for (int c = 0; c < 4; c++)
+        {
+            start[c] = mean[c] + axis[c] * high;
+            end[c] = mean[c] + axis[c] * low;
+        }
+    }
+
+    // 每个像素选最近的调色板项，返回平方误差之和
+    float assign_indices(const float points[16][4], const float palette[][4], int palette_size, int channels, uint8_t indices[16])
+    {
+        float total = 0.0f;
+        for (int i = 0; i < 16; i++)
+        {
+            float best = std::numeric_limits<float>::max();
+            for (int p = 0; p < palette_size; p++)
+            {
+                float error = 0.0f;
+                for (int c = 0; c < channels; c++)
+                {
+                    float d = points[i][c] - palette[p][c];
+                    error += d * d;
+                }
+                if (error < best)
+                {
+                    best = error;
+                    indices[i] = static_cast<uint8_t>(p);
+                }
+            }
+            total += best;
+        }
+        return total;
+    }
+
+    // 固定索引求最优端点：最小化 Σ|w_i * e0 + (1 - w_i) * e1 - p_i|²，w 为索引对应的 e0 权重
+    bool least_squares_endpoints(const float points[16][4], const uint8_t indices[16], const float *weights, int channels, float e0[4], float e1[4])
+    {
+        float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+        float ax[4] = {}, bx[4] = {};
+        for (int i = 0; i < 16; i++)
+        {
+            float a = weights[indices[i]], b = 1.0f - a;
+            aa += a * a;
+            bb += b * b;
+            ab += a * b;
+            for (int c = 0; c < channels; c++)
+            {
+                ax[c] += a * points[i][c];
+                bx[c] += b * points[i][c];
+            }
+        }
+        float determinant = aa * bb - ab * ab;
+        if (std::fabs(determinant) < 1e-6f)
+            return false;
+        for (int c = 0; c < channels; c++)
+        {
+            e0[c] = (ax[c] * bb - bx[c] * ab) / determinant;
+            e1[c] = (bx[c] * aa - ax[c] * ab) / determinant;
+        }
+        return true;
+    }
+
+    void load_points(const uint8_t *rgba, float points[16][4])
+    {
+        for (int i = 0; i < 16; i++)
+            for (int c = 0; c < 4; c++)
+                points[i][c] = rgba[i * 4 + c];
+    }
+
+    // ---------------- BC1 ----------------
+
+    uint16_t pack_565(const float color[4])
+    {
+        int r = round_clamp(color[0] * 31.0f / 255.0f, 0, 31);
+        int g = round_clamp(color[1] * 63.0f / 255.0f, 0, 63);
+        int b = round_clamp(color[2] * 31.0f / 255.0f, 0, 31);
+        return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    void unpack_565(uint16_t value, float color[4])
+    {
+        int r = (value >> 11) & 31, g = (value >> 5) & 63, b = value & 31;
+        color[0] = static_cast<float>((r << 3) | (r >> 2));
+        color[1] = static_cast<float>((g << 2) | (g >> 4));
+        color[2] = static_cast<float>((b << 3) | (b >> 2));
+        color[3] = 255.0f;
+    }
+
+    // four_color 为 false 时按 c0 <= c1 的三色 + 透明模式解释（只有单独的 BC1 才有这种模式）
+    void bc1_palette(uint16_t c0, uint16_t c1, bool four_color, float palette[4][4])
+    {
+        unpack_565(c0, palette[0]);
+        unpack_565(c1, palette[1]);
+        for (int c = 0; c < 3; c++)
+        {
+            int p0 = static_cast<int>(palette[0][c]), p1 = static_cast<int>(palette[1][c]);
+            if (four_color)
+            {
+                palette[2][c] = static_cast<float>((2 * p0 + p1) / 3);
+                palette[3][c] = static_cast<float>((p0 + 2 * p1) / 3);
+            }
+            else
+            {
+                palette[2][c] = static_cast<float>((p0 + p1) / 2);
+                palette[3][c] = 0.0f;
+            }
+        }
+        palette[2][3] = 255.0f;
+        palette[3][3] = four_color ? 255.0f : 0.0f;
+    }
+
+    // 总是输出四色模式（c0 > c1），BC3 的颜色块也可以直接使用
+    void encode_bc1_color(const uint8_t *rgba, uint8_t *output)
+    {
+        float points[16][4];
+        load_points(rgba, points);
+        float start[4], end[4];
+        axis_endpoints(points, 3, start, end);
+        // 两端各往内收 1/16，抵消量化后调色板两端被“拉出”的误差
+        for (int c = 0; c < 3; c++)
+        {
+            float inset = (start[c] - end[c]) / 16.0f;
+            start[c] -= inset;
+            end[c] += inset;
+        }
+
+        uint16_t c0 = pack_565(start), c1 = pack_565(end);
+        float palette[4][4];
+        uint8_t indices[16];
+        bc1_palette(c0, c1, true, palette);
+        float error = assign_indices(points, palette, 4, 3, indices);
+
+        const float weights[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+        for (int iteration = 0; iteration < 2 && error > 0.0f; iteration++)
+        {
+            float e0[4] = {}, e1[4] = {};
+            if (!least_squares_endpoints(points, indices, weights, 3, e0, e1))
+                break;
+            uint16_t n0 = pack_565(e0), n1 = pack_565(e1);
+            float candidate_palette[4][4];
+            uint8_t candidate[16];
+            bc1_palette(n0, n1, true, candidate_palette);
+            float candidate_error = assign_indices(points, candidate_palette, 4, 3, candidate);
+            if (candidate_error >= error)
+                break;
+            c0 = n0;
+            c1 = n1;
+            error = candidate_error;
+            std::memcpy(indices, candidate, 16);
+        }
+
+        // 四色模式要求 c0 > c1：交换端点后索引 0<->1、2<->3
+        if (c0 < c1)
+        {
+            std::swap(c0, c1);
+            for (int i = 0; i < 16; i++)
+                indices[i] ^= 1;
+        }
+        else if (c0 == c1)
+            std::memset(indices, 0, 16);
+
+        uint32_t bits = 0;
+        for (int i = 0; i < 16; i++)
+            bits |= uint32_t(indices[i]) << (2 * i);
+        output[0] = c0 & 0xff;
+        output[1] = c0 >> 8;
+        output[2] = c1 & 0xff;
+        output[3] = c1 >> 8;
+        for (int i = 0; i < 4; i++)
+            output[4 + i] = (bits >> (8 * i)) & 0xff;
+    }
+
+    void decode_bc1_color(const uint8_t *block, uint8_t *rgba, bool force_four_color)
+    {
+        uint16_t c0 = static_cast<uint16_t>(block[0] | (block[1] << 8));
+        uint16_t c1 = static_cast<uint16_t>(block[2] | (block[3] << 8));
+        float palette[4][4];
+        bc1_palette(c0, c1, force_four_color || c0 > c1, palette);
+        uint32_t bits = block[4] | (block[5] << 8) | (block[6] << 16) | (uint32_t(block[7]) << 24);
+        for (int i = 0; i < 16; i++)
+        {
+            const float *color = palette[(bits >> (2 * i)) & 3];
+            for (int c = 0; c < 3; c++)
+                rgba[i * 4 + c] = static_cast<uint8_t>(color[c]);
+            rgba[i * 4 + 3] = static_cast<uint8_t>(color[3]);
+        }
+    }
+
+    // ---------------- BC4 ----------------
+
+    void bc4_palette(int e0, int e1, int palette[8])
+    {
+        palette[0] = e0;
+        palette[1] = e1;
+        if (e0 > e1)
+        {
+            for (int k = 2; k < 8; k++)
+                palette[k] = ((8 - k) * e0 + (k - 1) * e1 + 3) / 7;
+        }
+        else
+        {
+            for (int k = 2; k < 6; k++)
+                palette[k] = ((6 - k) * e0 + (k - 1) * e1 + 2) / 5;
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+    }
+
+    int bc4_assign(const int values[16], const int palette[8], uint8_t indices[16])
+    {
+        int total = 0;
+        for (int i = 0; i < 16; i++)
+        {
+            int best = std::numeric_limits<int>::max();
+            for (int p = 0; p < 8; p++)
+            {
+                int d = values[i] - palette[p];
+                if (d * d < best)
+                {
+                    best = d * d;
+                    indices[i] = static_cast<uint8_t>(p);
+                }
+            }
+            total += best;
+        }
+        return total;
+    }
+
+    void encode_bc4_channel(const uint8_t *rgba, int channel, uint8_t *output)
+    {
+        int values[16];
+        int low = 255, high = 0;
+        // 六值模式的端点不需要覆盖 0 和 255，它们由固定的调色板项表示
+        int inner_low = 255, inner_high = 0;
+        for (int i = 0; i < 16; i++)
+        {
+            values[i] = rgba[i * 4 + channel];
+            low = std::min(low, values[i]);
+            high = std::max(high, values[i]);
+            if (values[i] != 0 && values[i] != 255)
+            {
+                inner_low = std::min(inner_low, values[i]);
+                inner_high = std::max(inner_high, values[i]);
+            }
+        }
+
+        int e0 = high, e1 = low;
+        uint8_t indices[16] = {};
+        if (high != low)
+        {
+            int palette[8];
+            bc4_palette(high, low, palette);
+            int error = bc4_assign(values, palette, indices);
+
+            // 噪声大的块两端往往只有一两个像素，按最小二乘收紧端点能让中间的调色板项更密
+            const float weights[8] = {1.0f, 0.0f, 6 / 7.0f, 5 / 7.0f, 4 / 7.0f, 3 / 7.0f, 2 / 7.0f, 1 / 7.0f};
+            float points[16][4] = {};
+            for (int i = 0; i < 16; i++)
+                points[i][0] = static_cast<float>(values[i]);
+            for (int iteration = 0; iteration < 2 && error > 0; iteration++)
+            {
+                float f0[4], f1[4];
+                if (!least_squares_endpoints(points, indices, weights, 1, f0, f1))
+                    break;
+                int n0 = round_clamp(f0[0], 0, 255), n1 = round_clamp(f1[0], 0, 255);
+                if (n0 <= n1)
+                    break;
+                uint8_t candidate[16];
+                bc4_palette(n0, n1, palette);
+                int candidate_error = bc4_assign(values, palette, candidate);
+                if (candidate_error >= error)
+                    break;
+                e0 = n0;
+                e1 = n1;
+                error = candidate_error;
+                std::memcpy(indices, candidate, 16);
+            }
+
+            if (inner_low > inner_high)
+                inner_low = inner_high = low;
+            uint8_t six_indices[16];
+            bc4_palette(inner_low, inner_high, palette);
+            if (bc4_assign(values, palette, six_indices) < error)
+            {
+                e0 = inner_low;
+                e1 = inner_high;
+                std::memcpy(indices, six_indices, 16);
+            }
+        }
+
+        uint64_t bits = 0;
+        for (int i = 0; i < 16; i++)
+            bits |= uint64_t(indices[i]) << (3 * i);
+        output[0] = static_cast<uint8_t>(e0);
+        output[1] = static_cast<uint8_t>(e1);
+        for (int i = 0; i < 6; i++)
+            output[2 + i] = (bits >> (8 * i)) & 0xff;
+    }
+
+    void decode_bc4_channel(const uint8_t *block, uint8_t *rgba, int channel)
+    {
+        int palette[8];
+        bc4_palette(block[0], block[1], palette);
+        uint64_t bits = 0;
+        for (int i = 0; i < 6; i++)
+            bits |= uint64_t(block[2 + i]) << (8 * i);
+        for (int i = 0; i < 16; i++)
+            rgba[i * 4 + channel] = static_cast<uint8_t>(palette[(bits >> (3 * i)) & 7]);
+    }
+
+    // ---------------- BC7 mode 6 ----------------
+
+    const int BC7_WEIGHTS[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    struct BitWriter
+    {
+        uint8_t *data;
+        int position = 0;
+
+        void write(uint32_t value, int count)
+        {
+            for (int i = 0; i < count; i++, position++)
+                if ((value >> i) & 1)
+                    data[position >> 3] |= uint8_t(1u << (position & 7));
+        }
+    };
+
+    struct BitReader
+    {
+        const uint8_t *data;
+        int position = 0;
+
+        uint32_t read(int count)
+        {
+            uint32_t value = 0;
+            for (int i = 0; i < count; i++, position++)
+                value |= uint32_t((data[position >> 3] >> (position & 7)) & 1) << i;
+            return value;
+        }
+    };
+
+    // mode 6 端点为 7 位 + 每个端点共享的 1 位 p-bit，还原为 (q << 1) | p
+    struct Bc7Endpoint
+    {
+        int quantized[4];
+        int p;
+        float color[4];
+    };
+
+    Bc7Endpoint quantize_bc7_endpoint(const float color[4])
+    {
+        Bc7Endpoint best = {};
+        float best_error = std::numeric_limits<float>::max();
+        for (int p = 0; p < 2; p++)
+        {
+            Bc7Endpoint candidate = {};
+            candidate.p = p;
+            float error = 0.0f;
+            for (int c = 0; c < 4; c++)
+            {
+                candidate.quantized[c] = round_clamp((color[c] - p) / 2.0f, 0, 127);
+                candidate.color[c] = static_cast<float>((candidate.quantized[c] << 1) | p);
+                float d = candidate.color[c] - color[c];
+                error += d * d;
+            }
+            if (error < best_error)
+            {
+                best_error = error;
+                best = candidate;
+            }
+        }
+        return best;
+    }
+
+    void bc7_palette(const Bc7Endpoint &e0, const Bc7Endpoint &e1, float palette[16][4])
+    {
+        for (int k = 0; k < 16; k++)
+            for (int c = 0; c < 4; c++)
+            {
+                int a = static_cast<int>(e0.color[c]), b = static_cast<int>(e1.color[c]);
+                palette[k][c] = static_cast<float>(((64 - BC7_WEIGHTS[k]) * a + BC7_WEIGHTS[k] * b + 32) >> 6);
+            }
+    }
+
+    void encode_bc7_mode6(const uint8_t *rgba, uint8_t *output)
+    {
+        float points[16][4];
+        load_points(rgba, points);
+        float start[4], end[4];
+        axis_endpoints(points, 4, start, end);
+
+        Bc7Endpoint e0 = quantize_bc7_endpoint(start), e1 = quantize_bc7_endpoint(end);
+        float palette[16][4];
+        uint8_t indices[16];
+        bc7_palette(e0, e1, palette);
+        float error = assign_indices(points, palette, 16, 4, indices);
+
+        float weights[16];
+        for (int k = 0; k < 16; k++)
+            weights[k] = (64 - BC7_WEIGHTS[k]) / 64.0f;
+        for (int iteration = 0; iteration < 2 && error > 0.0f; iteration++)
+        {
+            float f0[4], f1[4];
+            if (!least_squares_endpoints(points, indices, weights, 4, f0, f1))
+                break;
+            Bc7Endpoint n0 = quantize_bc7_endpoint(f0), n1 = quantize_bc7_endpoint(f1);
+            float candidate_palette[16][4];
+            uint8_t candidate[16];
+            bc7_palette(n0, n1, candidate_palette);
+            float candidate_error = assign_indices(points, candidate_palette, 16, 4, candidate);
+            if (candidate_error >= error)
+                break;
+            e0 = n0;
+            e1 = n1;
+            error = candidate_error;
+            std::memcpy(indices, candidate, 16);
+        }
+
+        // 第一个像素的索引（anchor）最高位隐含为 0
+        if (indices[0] & 8)
+        {
+            std::swap(e0, e1);
+            for (int i = 0; i < 16; i++)
+                indices[i] = static_cast<uint8_t>(15 - indices[i]);
+        }
+
+        std::memset(output, 0, 16);
+        BitWriter writer{output};
+        writer.write(1u << 6, 7);
+        for (int c = 0; c < 4; c++)
+        {
+            writer.write(e0.quantized[c], 7);
+            writer.write(e1.quantized[c], 7);
+        }
+        writer.write(e0.p, 1);
+        writer.write(e1.p, 1);
+        writer.write(indices[0], 3);
+        for (int i = 1; i < 16; i++)
+            writer.write(indices[i], 4);
+    }
+
+    // 只解码 mode 6；其他模式输出全 0，用于校验本编码器的结果已经足够
+    void decode_bc7_mode6(const uint8_t *block, uint8_t *rgba)
+    {
+        BitReader reader{block};
+        if (reader.read(7) != (1u << 6))
+        {
+            std::memset(rgba, 0, 64);
+            return;
+        }
+        Bc7Endpoint e0 = {}, e1 = {};
+        for (int c = 0; c < 4; c++)
+        {
+            e0.quantized[c] = static_cast<int>(reader.read(7));
+            e1.quantized[c] = static_cast<int>(reader.read(7));
+        }
+        e0.p = static_cast<int>(reader.read(1));
+        e1.p = static_cast<int>(reader.read(1));
+        for (int c = 0; c < 4; c++)
+        {
+            e0.color[c] = static_cast<float>((e0.quantized[c] << 1) | e0.p);
+            e1.color[c] = static_cast<float>((e1.quantized[c] << 1) | e1.p);
+        }
+        float palette[16][4];
+        bc7_palette(e0, e1, palette);
+        for (int i = 0; i < 16; i++)
+        {
+            uint32_t index = reader.read(i == 0 ? 3 : 4);
+            for (int c = 0; c < 4; c++)
+                rgba[i * 4 + c] = static_cast<uint8_t>(palette[index][c]);
+        }
+    }
+
+    // ---------------- mip 滤波 ----------------
+
+    float srgb_to_linear(float value)
+    {
+        return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+    }
+
+    float linear_to_srgb(float value)
+    {
+        return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+    }
+
+    std::vector<float> to_float(const ImageRGBA &image, TextureUsage usage)
+    {
+        static float srgb_table[256];
+        static bool table_ready = [] {
+            for (int i = 0; i < 256; i++)
+                srgb_table[i] = srgb_to_linear(i / 255.0f);
+            return true;
+        }();
+        (void)table_ready;
+
+        std::vector<float> result(image.pixels.size());
+        for (size_t i = 0; i < image.pixels.size(); i++)
+        {
+            uint8_t value = image.pixels[i];
+            bool alpha = (i & 3) == 3;
+            if (usage == TextureUsage::COLOR && !alpha)
+                result[i] = srgb_table[value];
+            else if (usage == TextureUsage::NORMAL && !alpha)
+                result[i] = value / 127.5f - 1.0f;
+            else
+                result[i] = value / 255.0f;
+        }
+        return result;
+    }
+
+    ImageRGBA from_float(const std::vector<float> &data, int width, int height, TextureUsage usage)
+    {
+        ImageRGBA image;
+        image.width = width;
+        image.height = height;
+        image.pixels.resize(data.size());
+        for (size_t pixel = 0; pixel < data.size() / 4; pixel++)
+        {
+            float color[4] = {data[pixel * 4], data[pixel * 4 + 1], data[pixel * 4 + 2], data[pixel * 4 + 3]};
+            if (usage == TextureUsage::NORMAL)
+            {
+                // 滤波后的法线变短，重新归一化，否则远处的光照会变暗
+                float length = std::sqrt(color[0] * color[0] + color[1] * color[1] + color[2] * color[2]);
+                for (int c = 0; c < 3; c++)
+                    color[c] = length > 1e-6f ? (color[c] / length) * 0.5f + 0.5f : (c == 2 ? 1.0f : 0.5f);
+            }
+            else if (usage == TextureUsage::COLOR)
+                for (int c = 0; c < 3; c++)
+                    color[c] = linear_to_srgb(std::min(1.0f, std::max(0.0f, color[c])));
+            for (int c = 0; c < 4; c++)
+                image.pixels[pixel * 4 + c] = static_cast<uint8_t>(round_clamp(color[c] * 255.0f, 0, 255));
+        }
+        return image;
+    }
+
+    double bessel_i0(double x)
+    {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 32; k++)
+        {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+            if (term < sum * 1e-12)
+                break;
+        }
+        return sum;
+    }
+
+    struct FilterTaps
+    {
+        int first;
+        std::vector<float> weights;
+    };
+
+    // 一维 Kaiser 窗 sinc 的采样权重（半径 3 个目标像素，alpha = 4），t 以目标像素为单位
+    std::vector<FilterTaps> kaiser_taps(int source_size, int target_size)
+    {
+        const float width = 3.0f, alpha = 4.0f;
+        float scale = static_cast<float>(source_size) / target_size;
+        double normalizer = bessel_i0(alpha);
+        std::vector<FilterTaps> taps(target_size);
+        for (int j = 0; j < target_size; j++)
+        {
+            float center = (j + 0.5f) * scale;
+            int first = static_cast<int>(std::floor(center - width * scale));
+            int last = static_cast<int>(std::ceil(center + width * scale));
+            taps[j].first = first;
+            float sum = 0.0f;
+            for (int i = first; i <= last; i++)
+            {
+                float t = (i + 0.5f - center) / scale;
+                float weight = 0.0f;
+                if (std::fabs(t) < width)
+                {
+                    float x = t / width;
+                    float sinc = t == 0.0f ? 1.0f : std::sin(PI * t) / (PI * t);
+                    weight = sinc * static_cast<float>(bessel_i0(alpha * std::sqrt(1.0f - x * x)) / normalizer);
+                }
+                taps[j].weights.push_back(weight);
+                sum += weight;
+            }
+            for (float &weight : taps[j].weights)
+                weight /= sum;
+        }
+        return taps;
+    }
+
+    // 可分离滤波的一个方向：沿 stride 方向把 source_size 个样本缩成 target_size 个
+    void filter_axis(const std::vector<float> &source, std::vector<float> &target, int lines, int source_size, int target_size, bool horizontal)
+    {
+        std::vector<FilterTaps> taps = kaiser_taps(source_size, target_size);
+        for (int line = 0; line < lines; line++)
+            for (int j = 0; j < target_size; j++)
+            {
+                float sum[4] = {};
+                const FilterTaps &tap = taps[j];
+                for (size_t k = 0; k < tap.weights.size(); k++)
+                {
+                    // 边缘按重复最后一个像素处理
+                    int i = std::min(source_size - 1, std::max(0, tap.first + static_cast<int>(k)));
+                    size_t index = horizontal ? (size_t(line) * source_size + i) * 4 : (size_t(i) * lines + line) * 4;
+                    for (int c = 0; c < 4; c++)
+                        sum[c] += source[index + c] * tap.weights[k];
+                }
+                size_t out = horizontal ? (size_t(line) * target_size + j) * 4 : (size_t(j) * lines + line) * 4;
+                for (int c = 0; c < 4; c++)
+                    target[out + c] = sum[c];
+            }
+    }
+}
+
+size_t block_bytes(BlockFormat format)
+{
+    return format == BlockFormat::BC1 || format == BlockFormat::BC4 ? 8 : 16;
+}
+
+const char *block_format_name(BlockFormat format)
+{
+    static const char *names[] = {"BC1", "BC3", "BC4", "BC5", "BC7"};
+    return names[static_cast<int>(format)];
+}
+
+uint32_t block_vk_format(BlockFormat format)
+{
+    switch (format)
+    {
+    case BlockFormat::BC1:
+        return 131; // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+    case BlockFormat::BC3:
+        return 137; // VK_FORMAT_BC3_UNORM_BLOCK
+    case BlockFormat::BC4:
+        return 139; // VK_FORMAT_BC4_UNORM_BLOCK
+    case BlockFormat::BC5:
+        return 141; // VK_FORMAT_BC5_UNORM_BLOCK
+    case BlockFormat::BC7:
+    default:
+        return 145; // VK_FORMAT_BC7_UNORM_BLOCK
+    }
+}
+
+size_t compressed_size(BlockFormat format, int width, int height)
+{
+    return size_t((width + 3) / 4) * ((height + 3) / 4) * block_bytes(format);
+}
+
+void encode_block(BlockFormat format, const uint8_t *rgba, uint8_t *output)
+{
+    switch (format)
+    {
+    case BlockFormat::BC1:
+        encode_bc1_color(rgba, output);
+        break;
+    case BlockFormat::BC3:
+        encode_bc4_channel(rgba, 3, output);
+        encode_bc1_color(rgba, output + 8);
+        break;
+    case BlockFormat::BC4:
+        encode_bc4_channel(rgba, 0, output);
+        break;
+    case BlockFormat::BC5:
+        encode_bc4_channel(rgba, 0, output);
+        encode_bc4_channel(rgba, 1, output + 8);
+        break;
+    case BlockFormat::BC7:
+        encode_bc7_mode6(rgba, output);
+        break;
+    }
+}
+
+void decode_block(BlockFormat format, const uint8_t *block, uint8_t *rgba)
+{
+    switch (format)
+    {
+    case BlockFormat::BC1:
+        decode_bc1_color(block, rgba, false);
+        break;
+    case BlockFormat::BC3:
+        decode_bc1_color(block + 8, rgba, true);
+        decode_bc4_channel(block, rgba, 3);
+        break;
+    case BlockFormat::BC4:
+    case BlockFormat::BC5:
+        // 与 GL 的采样结果一致：缺少的颜色通道为 0，alpha 为 1
+        for (int i = 0; i < 16; i++)
+        {
+            rgba[i * 4 + 1] = rgba[i * 4 + 2] = 0;
+            rgba[i * 4 + 3] = 255;
+        }
+        decode_bc4_channel(block, rgba, 0);
+        if (format == BlockFormat::BC5)
+            decode_bc4_channel(block + 8, rgba, 1);
+        break;
+    case BlockFormat::BC7:
+        decode_bc7_mode6(block, rgba);
+        break;
+    }
+}
+
+std::vector<uint8_t> compress_image(const ImageRGBA &image, BlockFormat format, JobSystem *jobs)
+{
+    int blocks_x = (image.width + 3) / 4, blocks_y = (image.height + 3) / 4;
+    size_t stride = block_bytes(format);
+    std::vector<uint8_t> output(size_t(blocks_x) * blocks_y * stride);
+
+    auto compress_rows = [&](size_t begin, size_t end)
+    {
+        uint8_t block[64];
+        for (size_t by = begin; by < end; by++)
+            for (int bx = 0; bx < blocks_x; bx++)
+            {
+                for (int y = 0; y < 4; y++)
+                    for (int x = 0; x < 4; x++)
+                    {
+                        int sx = std::min(bx * 4 + x, image.width - 1);
+                        int sy = std::min(static_cast<int>(by) * 4 + y, image.height - 1);
+                        std::memcpy(block + (y * 4 + x) * 4, &image.pixels[(size_t(sy) * image.width + sx) * 4], 4);
+                    }
+                encode_block(format, block, &output[(by * blocks_x + bx) * stride]);
+            }
+    };
+    // 每个任务至少几百个块，调度开销可以忽略
+    size_t grain = std::max<size_t>(1, 256 / blocks_x);
+    if (jobs)
+        jobs->parallel_for(blocks_y, grain, compress_rows);
+    else
+        compress_rows(0, blocks_y);
+    return output;
+}
+
+ImageRGBA decompress_image(const uint8_t *data, int width, int height, BlockFormat format)
+{
+    ImageRGBA image;
+    image.width = width;
+    image.height = height;
+    image.pixels.resize(size_t(width) * height * 4);
+    int blocks_x = (width + 3) / 4, blocks_y = (height + 3) / 4;
+    uint8_t block[64];
+    for (int by = 0; by < blocks_y; by++)
+        for (int bx = 0; bx < blocks_x; bx++)
+        {
+            decode_block(format, data + (size_t(by) * blocks_x + bx) * block_bytes(format), block);
+            for (int y = 0; y < 4 && by * 4 + y < height; y++)
+                for (int x = 0; x < 4 && bx * 4 + x < width; x++)
+                    std::memcpy(&image.pixels[(size_t(by * 4 + y) * width + bx * 4 + x) * 4], block + (y * 4 + x) * 4, 4);
+        }
+    return image;
+}
+
+ImageRGBA downsample(const ImageRGBA &image, MipFilter filter, TextureUsage usage)
+{
+    int width = std::max(1, image.width / 2), height = std::max(1, image.height / 2);
+    std::vector<float> source = to_float(image, usage);
+    std::vector<float> result(size_t(width) * height * 4);
+
+    if (filter == MipFilter::BOX)
+    {
+        for (int y = 0; y < height; y++)
+            for (int x = 0; x < width; x++)
+            {
+                int x0 = std::min(x * 2, image.width - 1), x1 = std::min(x * 2 + 1, image.width - 1);
+                int y0 = std::min(y * 2, image.height - 1), y1 = std::min(y * 2 + 1, image.height - 1);
+                for (int c = 0; c < 4; c++)
+                    result[(size_t(y) * width + x) * 4 + c] =
+                        (source[(size_t(y0) * image.width + x0) * 4 + c] + source[(size_t(y0) * image.width + x1) * 4 + c] +
+                         source[(size_t(y1) * image.width + x0) * 4 + c] + source[(size_t(y1) * image.width + x1) * 4 + c]) *
+                        0.25f;
+            }
+    }
+    else
+    {
+        std::vector<float> horizontal(size_t(width) * image.height * 4);
+        filter_axis(source, horizontal, image.height, image.width, width, true);
+        filter_axis(horizontal, result, width, image.height, height, false);
+    }
+    return from_float(result, width, height, usage);
+}
+
+double compute_psnr(const ImageRGBA &reference, const ImageRGBA &test, BlockFormat format)
+{
+    int channels = format == BlockFormat::BC4 ? 1 : format == BlockFormat::BC5 ? 2 : format == BlockFormat::BC1 ? 3 : 4;
+    double sum = 0.0;
+    size_t pixel_count = size_t(reference.width) * reference.height;
+    for (size_t i = 0; i < pixel_count; i++)
+        for (int c = 0; c < channels; c++)
+        {
+            double d = double(reference.pixels[i * 4 + c]) - test.pixels[i * 4 + c];
+            sum += d * d;
+        }
+    double mse = sum / (double(pixel_count) * channels);
+    if (mse == 0.0)
+        return std::numeric_limits<double>::infinity();
+    return 10.0 * std::log10(255.0 * 255.0 / mse);
+}
@@ -0,0 +1,63 @@
+#ifndef BLOCK_COMPRESSION_HPP
+#define BLOCK_COMPRESSION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class JobSystem;
+
+// 块压缩格式：都以 4x4 像素为一块
+enum class BlockFormat
+{
+    BC1, // RGB，8 字节 / 块
+    BC3, // RGBA，BC4 编码的 alpha + BC1 颜色，16 字节 / 块
+    BC4, // 单通道，8 字节 / 块
+    BC5, // 双通道（法线 xy），两个 BC4 块，16 字节 / 块
+    BC7  // RGBA，16 字节 / 块，只输出 mode 6
+};
+
+// RGBA8 图像，自上而下逐行存放
+struct ImageRGBA
+{
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> pixels;
+};
+
+enum class MipFilter
+{
+    BOX,   // 2x2 平均
+    KAISER // Kaiser 窗 sinc，过渡更锐利，远处纹理不会糊成一片
+};
+
+// 决定 mip 的滤波方式
+enum class TextureUsage
+{
+    COLOR,  // sRGB 颜色，先转到线性空间再滤波
+    LINEAR, // 粗糙度 / 金属度 / AO 等数据，直接滤波
+    NORMAL  // 切线空间法线，滤波后重新归一化
+};
+
+size_t block_bytes(BlockFormat format);
+const char *block_format_name(BlockFormat format);
+// 对应 KTX2 头里的 VkFormat
+uint32_t block_vk_format(BlockFormat format);
+// 一层压缩数据的字节数
+size_t compressed_size(BlockFormat format, int width, int height);
+
+// 压缩 / 解压一个 4x4 块，rgba 为 16 个像素，按行排列
+void encode_block(BlockFormat format, const uint8_t *rgba, uint8_t *output);
+void decode_block(BlockFormat format, const uint8_t *block, uint8_t *rgba);
+
+// 整幅图像逐块压缩，宽高不是 4 的倍数时边缘块重复最后一行 / 列；jobs 不为空时按块行并行
+std::vector<uint8_t> compress_image(const ImageRGBA &image, BlockFormat format, JobSystem *jobs = nullptr);
+ImageRGBA decompress_image(const uint8_t *data, int width, int height, BlockFormat format);
+
+// 生成下一级 mip（宽高各减半，最小为 1）
+ImageRGBA downsample(const ImageRGBA &image, MipFilter filter, TextureUsage usage);
+
+// 只比较格式实际保存的通道（BC1 为 RGB，BC4 为 R，BC5 为 RG）
+double compute_psnr(const ImageRGBA &reference, const ImageRGBA &test, BlockFormat format);
+
+#endif // BLOCK_COMPRESSION_HPP
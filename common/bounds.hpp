@@ -0,0 +1,145 @@
+#ifndef BOUNDS_HPP
+#define BOUNDS_HPP
+
+#include <cfloat>
+#include <cmath>
+#include <algorithm>
+#include "glm/glm.hpp"
+
+// 轴对齐包围盒
+struct AABB
+{
+    glm::vec3 min = glm::vec3(FLT_MAX);
+    glm::vec3 max = glm::vec3(-FLT_MAX);
+
+    AABB() = default;
+    AABB(const glm::vec3 &min, const glm::vec3 &max) : min(min), max(max) {}
+
+    bool valid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+
+    void expand(const glm::vec3 &point)
+    {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+
+    void expand(const AABB &other)
+    {
+        min = glm::min(min, other.min);
+        max = glm::max(max, other.max);
+    }
+
+    glm::vec3 center() const { return (min + max) * 0.5f; }
+    glm::vec3 extent() const { return max - min; }
+
+    // SAH 只需要相对大小，省去系数 2
+    float half_area() const
+    {
+        glm::vec3 e = glm::max(max - min, glm::vec3(0.0f));
+        return e.x * e.y + e.y * e.z + e.z * e.x;
+    }
+
+    // 变换后重新求包围盒（Arvo 方法，不需要变换 8 个角点）
+    AABB transformed(const glm::mat4 &m) const
+    {
+        if (!valid())
+            return *this;
+        glm::vec3 new_min(m[3]), new_max(m[3]);
+        for (int col = 0; col < 3; col++)
+        {
+            for (int row = 0; row < 3; row++)
+            {
+                float a = m[col][row] * min[col];
+                float b = m[col][row] * max[col];
+                new_min[row] += std::min(a, b);
+                new_max[row] += std::max(a, b);
+            }
+        }
+        return AABB(new_min, new_max);
+    }
+};
+
+// 射线，inv_direction 预先计算供 slab 测试使用
+struct Ray
+{
+    glm::vec3 origin;
+    glm::vec3 direction;
+    glm::vec3 inv_direction;
+
+    Ray() = default;
+    Ray(const glm::vec3 &origin, const glm::vec3 &direction)
+        : origin(origin), direction(direction), inv_direction(1.0f / direction) {}
+
+    // slab 测试，命中时返回进入距离
+    bool intersects(const AABB &box, float t_max, float &t_enter) const
+    {
+        glm::vec3 t0 = (box.min - origin) * inv_direction;
+        glm::vec3 t1 = (box.max - origin) * inv_direction;
+        glm::vec3 t_small = glm::min(t0, t1);
+        glm::vec3 t_big = glm::max(t0, t1);
+        float t_near = std::max(std::max(t_small.x, t_small.y), std::max(t_small.z, 0.0f));
+        float t_far = std::min(std::min(t_big.x, t_big.y), std::min(t_big.z, t_max));
+        t_enter = t_near;
+        return t_near <= t_far;
+    }
+};
+
+// 视锥体：6 个平面 (nx, ny, nz, d)，法线指向内侧
+struct Frustum
+{
+    enum Result
+    {
+        OUTSIDE,
+        INTERSECT,
+        INSIDE
+    };
+
+    glm::vec4 planes[6];
+
+    Frustum() = default;
+
+    // 从 projection * view 矩阵提取平面 (Gribb-Hartmann)
+    explicit Frustum(const glm::mat4 &view_projection)
+    {
+        glm::vec4 row0(view_projection[0][0], view_projection[1][0], view_projection[2][0], view_projection[3][0]);
+        glm::vec4 row1(view_projection[0][1], view_projection[1][1], view_projection[2][1], view_projection[3][1]);
+        glm::vec4 row2(view_projection[0][2], view_projection[1][2], view_projection[2][2], view_projection[3][2]);
+        glm::vec4 row3(view_projection[0][3], view_projection[1][3], view_projection[2][3], view_projection[3][3]);
+        planes[0] = row3 + row0; // left
+        planes[1] = row3 - row0; // right
+        planes[2] = row3 + row1; // bottom
+        planes[3] = row3 - row1; // top
+        planes[4] = row3 + row2; // near
+        planes[5] = row3 - row2; // far
+        for (auto &plane : planes)
+            plane /= glm::length(glm::vec3(plane));
+    }
+
+    // plane_mask 中为 1 的位表示还需要测试的平面，完全在某平面内侧时清掉对应位，子节点可跳过该平面
+    Result classify(const AABB &box, unsigned int &plane_mask) const
+    {
+        glm::vec3 center = box.center();
+        glm::vec3 half = box.max - center;
+        for (int i = 0; i < 6; i++)
+        {
+            if (!(plane_mask & (1u << i)))
+                continue;
+            const glm::vec4 &p = planes[i];
+            float distance = glm::dot(glm::vec3(p), center) + p.w;
+            float radius = glm::dot(glm::abs(glm::vec3(p)), half);
+            if (distance < -radius)
+                return OUTSIDE;
+            if (distance >= radius)
+                plane_mask &= ~(1u << i);
+        }
+        return plane_mask == 0 ? INSIDE : INTERSECT;
+    }
+
+    bool intersects(const AABB &box) const
+    {
+        unsigned int mask = 0x3f;
+        return classify(box, mask) != OUTSIDE;
+    }
+};
+
+#endif // BOUNDS_HPP
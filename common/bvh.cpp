@@ -0,0 +1,282 @@
+#include "bvh.hpp"
+#include <algorithm>
+#include <numeric>
+
+void BVH::build(const std::vector<AABB> &bounds)
+{
+    nodes.clear();
+    object_bounds = bounds;
+    uint32_t object_num = static_cast<uint32_t>(bounds.size());
+    object_indices.resize(object_num);
+    std::iota(object_indices.begin(), object_indices.end(), 0u);
+    object_leaf.assign(object_num, 0);
+    parents.clear();
+    if (object_num == 0)
+        return;
+
+    std::vector<glm::vec3> centroids(object_num);
+    for (uint32_t i = 0; i < object_num; i++)
+        centroids[i] = bounds[i].center();
+
+    nodes.reserve(2 * object_num);
+    parents.reserve(2 * object_num);
+    nodes.push_back(Node{glm::vec3(0.0f), 0, glm::vec3(0.0f), object_num});
+    parents.push_back(0);
+    update_node_bounds(0);
+
+    // 用显式栈代替递归，避免 10 万物体时栈过深
+    std::vector<std::pair<uint32_t, int>> stack;
+    stack.push_back({0, 0});
+    while (!stack.empty())
+    {
+        uint32_t node_index = stack.back().first;
+        int depth = stack.back().second;
+        stack.pop_back();
+        Node node = nodes[node_index];
+
+        if (node.count <= 1)
+            continue;
+
+        int axis;
+        float split_pos, split_cost;
+        // 过深时改用中位数划分，保证遍历用的定长栈不会溢出
+        bool found = depth < MAX_SAH_DEPTH && find_split(node, centroids, axis, split_pos, split_cost);
+        float leaf_cost = node.count * AABB(node.bounds_min, node.bounds_max).half_area();
+        if (node.count <= MAX_LEAF_SIZE && (!found || split_cost >= leaf_cost))
+            continue;
+
+        // 按分割面原地划分物体
+        uint32_t *first = object_indices.data() + node.left_first;
+        uint32_t *last = first + node.count;
+        uint32_t *middle = first;
+        if (found)
+            middle = std::partition(first, last, [&](uint32_t i)
+                                    { return centroids[i][axis] < split_pos; });
+        if (middle == first || middle == last)
+        {
+            // 质心重合等退化情况：按最长轴中位数划分
+            glm::vec3 extent = AABB(node.bounds_min, node.bounds_max).extent();
+            axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+            middle = first + node.count / 2;
+            std::nth_element(first, middle, last, [&](uint32_t a, uint32_t b)
+                             { return centroids[a][axis] < centroids[b][axis]; });
+        }
+        uint32_t left_count = static_cast<uint32_t>(middle - first);
+
+        uint32_t left_index = static_cast<uint32_t>(nodes.size());
+        nodes.push_back(Node{glm::vec3(0.0f), node.left_first, glm::vec3(0.0f), left_count});
+        nodes.push_back(Node{glm::vec3(0.0f), node.left_first + left_count, glm::vec3(0.0f), node.count - left_count});
+        parents.push_back(node_index);
+        parents.push_back(node_index);
+        nodes[node_index].left_first = left_index;
+        nodes[node_index].count = 0;
+        update_node_bounds(left_index);
+        update_node_bounds(left_index + 1);
+        stack.push_back({left_index + 1, depth + 1});
+        stack.push_back({left_index, depth + 1});
+    }
+
+    for (uint32_t i = 0; i < nodes.size(); i++)
+    {
+        if (!nodes[i].is_leaf())
+            continue;
+        for (uint32_t j = 0; j < nodes[i].count; j++)
+            object_leaf[object_indices[nodes[i].left_first + j]] = i;
+    }
+}
+
+bool BVH::find_split(const Node &node, const std::vector<glm::vec3> &centroids, int &axis, float &split_pos, float &cost) const
+{
+    AABB centroid_bounds;
+    for (uint32_t i = 0; i < node.count; i++)
+        centroid_bounds.expand(centroids[object_indices[node.left_first + i]]);
+
+    cost = FLT_MAX;
+    for (int a = 0; a < 3; a++)
+    {
+        float bounds_min = centroid_bounds.min[a];
+        float bounds_max = centroid_bounds.max[a];
+        if (bounds_max - bounds_min <= 1e-6f)
+            continue;
+
+        AABB bin_bounds[NUM_BINS];
+        uint32_t bin_count[NUM_BINS] = {0};
+        float scale = NUM_BINS / (bounds_max - bounds_min);
+        for (uint32_t i = 0; i < node.count; i++)
+        {
+            uint32_t object = object_indices[node.left_first + i];
+            int bin = std::min(NUM_BINS - 1, static_cast<int>((centroids[object][a] - bounds_min) * scale));
+            bin_count[bin]++;
+            bin_bounds[bin].expand(object_bounds[object]);
+        }
+
+        // 从两端扫描，得到每个分割面左右两侧的面积和数量
+        float left_area[NUM_BINS - 1], right_area[NUM_BINS - 1];
+        uint32_t left_count[NUM_BINS - 1], right_count[NUM_BINS - 1];
+        AABB left_box, right_box;
+        uint32_t left_sum = 0, right_sum = 0;
+        for (int i = 0; i < NUM_BINS - 1; i++)
+        {
+            left_sum += bin_count[i];
+            left_count[i] = left_sum;
+            left_box.expand(bin_bounds[i]);
+            left_area[i] = left_box.half_area();
+
+            right_sum += bin_count[NUM_BINS - 1 - i];
+            right_count[NUM_BINS - 2 - i] = right_sum;
+            right_box.expand(bin_bounds[NUM_BINS - 1 - i]);
+            right_area[NUM_BINS - 2 - i] = right_box.half_area();
+        }
+
+        float bin_width = (bounds_max - bounds_min) / NUM_BINS;
+        for (int i = 0; i < NUM_BINS - 1; i++)
+        {
+            if (left_count[i] == 0 || right_count[i] == 0)
+                continue;
+            float plane_cost = left_count[i] * left_area[i] + right_count[i] * right_area[i];
+            if (plane_cost < cost)
+            {
+                cost = plane_cost;
+                axis = a;
+                split_pos = bounds_min + bin_width * (i + 1);
+            }
+        }
+    }
+    return cost < FLT_MAX;
+}
+
+void BVH::update_node_bounds(uint32_t node_index)
+{
+    Node &node = nodes[node_index];
+    AABB box;
+    if (node.is_leaf())
+    {
+        for (uint32_t i = 0; i < node.count; i++)
+            box.expand(object_bounds[object_indices[node.left_first + i]]);
+    }
+    else
+    {
+        const Node &left = nodes[node.left_first];
+        const Node &right = nodes[node.left_first + 1];
+        box = AABB(glm::min(left.bounds_min, right.bounds_min), glm::max(left.bounds_max, right.bounds_max));
+    }
+    node.bounds_min = box.min;
+    node.bounds_max = box.max;
+}
+
+void BVH::refit(const std::vector<AABB> &bounds)
+{
+    if (bounds.size() != object_bounds.size())
+    {
+        build(bounds);
+        return;
+    }
+    object_bounds = bounds;
+    // 子节点下标总是大于父节点，逆序遍历即可自底向上
+    for (size_t i = nodes.size(); i-- > 0;)
+        update_node_bounds(static_cast<uint32_t>(i));
+}
+
+void BVH::update(uint32_t object, const AABB &bounds)
+{
+    object_bounds[object] = bounds;
+    uint32_t node_index = object_leaf[object];
+    while (true)
+    {
+        Node &node = nodes[node_index];
+        node.bounds_min = glm::min(node.bounds_min, bounds.min);
+        node.bounds_max = glm::max(node.bounds_max, bounds.max);
+        if (node_index == 0)
+            break;
+        node_index = parents[node_index];
+    }
+}
+
+void BVH::query_frustum(const Frustum &frustum, std::vector<uint32_t> &visible) const
+{
+    if (nodes.empty())
+        return;
+
+    struct Entry
+    {
+        uint32_t node;
+        unsigned int plane_mask;
+    };
+    Entry stack[MAX_STACK_SIZE];
+    int stack_size = 0;
+    stack[stack_size++] = {0, 0x3f};
+    while (stack_size > 0)
+    {
+        Entry entry = stack[--stack_size];
+        const Node &node = nodes[entry.node];
+        unsigned int mask = entry.plane_mask;
+        Frustum::Result result = mask ? frustum.classify(AABB(node.bounds_min, node.bounds_max), mask) : Frustum::INSIDE;
+        if (result == Frustum::OUTSIDE)
+            continue;
+
+        if (node.is_leaf())
+        {
+            for (uint32_t i = 0; i < node.count; i++)
+            {
+                uint32_t object = object_indices[node.left_first + i];
+                // 完全在视锥内的节点不再逐个测试物体
+                if (mask == 0 || frustum.intersects(object_bounds[object]))
+                    visible.push_back(object);
+            }
+            continue;
+        }
+        stack[stack_size++] = {node.left_first + 1, mask};
+        stack[stack_size++] = {node.left_first, mask};
+    }
+}
+
+int BVH::raycast(const Ray &ray, float &t_hit, const RayHitTest &hit_test, float t_max) const
+{
+    int hit_object = -1;
+    t_hit = t_max;
+    float t_enter;
+    if (nodes.empty() || !ray.intersects(AABB(nodes[0].bounds_min, nodes[0].bounds_max), t_hit, t_enter))
+        return -1;
+
+    uint32_t stack[MAX_STACK_SIZE];
+    int stack_size = 0;
+    stack[stack_size++] = 0;
+    while (stack_size > 0)
+    {
+        const Node &node = nodes[stack[--stack_size]];
+        if (node.is_leaf())
+        {
+            for (uint32_t i = 0; i < node.count; i++)
+            {
+                uint32_t object = object_indices[node.left_first + i];
+                float t;
+                if (!ray.intersects(object_bounds[object], t_hit, t))
+                    continue;
+                if (hit_test && !hit_test(object, ray, t))
+                    continue;
+                if (t < t_hit)
+                {
+                    t_hit = t;
+                    hit_object = static_cast<int>(object);
+                }
+            }
+            continue;
+        }
+
+        // 先访问更近的子节点，使 t_hit 尽早收紧
+        uint32_t near_child = node.left_first, far_child = node.left_first + 1;
+        float t_near, t_far;
+        bool hit_near = ray.intersects(AABB(nodes[near_child].bounds_min, nodes[near_child].bounds_max), t_hit, t_near);
+        bool hit_far = ray.intersects(AABB(nodes[far_child].bounds_min, nodes[far_child].bounds_max), t_hit, t_far);
+        if (hit_near && hit_far && t_far < t_near)
+        {
+            std::swap(near_child, far_child);
+            std::swap(hit_near, hit_far);
+        }
+        if (hit_far)
+            stack[stack_size++] = far_child;
+        if (hit_near)
+            stack[stack_size++] = near_child;
+    }
+    return hit_object;
+}
@@ -0,0 +1,67 @@
+#ifndef BVH_HPP
+#define BVH_HPP
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "bounds.hpp"
+
+/**
+ * @brief 场景物体级别的层次包围盒 (BVH)。
+ *        节点以扁平数组存储（前序，左右子节点相邻），每个节点 32 字节，两个节点占一条 cache line。
+ *        构建使用 SAH 分箱；物体移动后可以 refit 只更新包围盒而不重建拓扑。
+ */
+class BVH
+{
+public:
+    struct Node
+    {
+        glm::vec3 bounds_min;
+        uint32_t left_first; // 内部节点：左子节点下标（右子节点为 left_first + 1）；叶子：第一个物体在 object_indices 中的位置
+        glm::vec3 bounds_max;
+        uint32_t count; // 叶子中的物体数量，0 表示内部节点
+
+        bool is_leaf() const { return count > 0; }
+    };
+
+    // narrow phase 回调：对命中包围盒的物体做精确测试，命中时写入距离并返回 true
+    using RayHitTest = std::function<bool(uint32_t object, const Ray &ray, float &t)>;
+
+    static constexpr int NUM_BINS = 12;
+    static constexpr uint32_t MAX_LEAF_SIZE = 4;
+    static constexpr int MAX_SAH_DEPTH = 40;
+    static constexpr int MAX_STACK_SIZE = 64;
+
+    // 根据物体包围盒构建，bounds 的下标即物体编号
+    void build(const std::vector<AABB> &bounds);
+
+    // 物体移动后刷新包围盒，bounds 的数量必须与构建时相同
+    void refit(const std::vector<AABB> &bounds);
+
+    // 更新单个物体的包围盒，并沿父节点链向上扩张（需之后调用 refit 才会收紧）
+    void update(uint32_t object, const AABB &bounds);
+
+    // 视锥剔除，可见物体编号追加到 visible
+    void query_frustum(const Frustum &frustum, std::vector<uint32_t> &visible) const;
+
+    // 返回最近命中的物体编号，未命中返回 -1；不提供 hit_test 时按包围盒求交
+    int raycast(const Ray &ray, float &t_hit, const RayHitTest &hit_test = nullptr, float t_max = FLT_MAX) const;
+
+    bool empty() const { return nodes.empty(); }
+    size_t node_count() const { return nodes.size(); }
+    size_t object_count() const { return object_bounds.size(); }
+    const AABB &get_object_bounds(uint32_t object) const { return object_bounds[object]; }
+    AABB get_bounds() const { return nodes.empty() ? AABB() : AABB(nodes[0].bounds_min, nodes[0].bounds_max); }
+
+private:
+    std::vector<Node> nodes;
+    std::vector<uint32_t> object_indices; // 叶子引用的物体编号，按叶子连续排列
+    std::vector<AABB> object_bounds;
+    std::vector<uint32_t> object_leaf;    // 物体所在的叶子节点
+    std::vector<uint32_t> parents;        // 节点的父节点，根节点为自身
+
+    void update_node_bounds(uint32_t node_index);
+    bool find_split(const Node &node, const std::vector<glm::vec3> &centroids, int &axis, float &split_pos, float &cost) const;
+};
+
+#endif // BVH_HPP
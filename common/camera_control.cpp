@@ -3,7 +3,7 @@
 
 static double scrollYOffset = 0.0;
 
-void scroll_callback(GLFWwindow *window, double xoffset, double yoffset)
+void camera_scroll_callback(GLFWwindow *window, double xoffset, double yoffset)
 {
     // 这里处理滚轮的滚动
     scrollYOffset = yoffset; // 保存yoffset值以供后续使用
@@ -11,22 +11,27 @@ void scroll_callback(GLFWwindow *window, double xoffset, double yoffset)
 
 Camera::Camera(GLFWwindow *window, float initialfov, glm::vec3 position, float horizontal_angle, float vertical_angle,
                float speed, float mouse_speed)
-    : _position(position), _horizontal_angle(horizontal_angle), _vertical_angle(vertical_angle), _speed(speed), _mouse_speed(mouse_speed), _initial_fov(initialfov)
+    : Camera(initialfov, position, horizontal_angle, vertical_angle, speed, mouse_speed)
 {
     // 设置鼠标到窗口中心
     int width, height;
     glfwGetWindowSize(window, &width, &height);
     glfwSetCursorPos(window, width / 2, height / 2);
 
-    glfwSetScrollCallback(window, scroll_callback);
+    glfwSetScrollCallback(window, camera_scroll_callback);
 }
 
-void Camera::compute_matrices_from_inputs(GLFWwindow *window, glm::vec3 center)
+Camera::Camera(float initialfov, glm::vec3 position, float horizontal_angle, float vertical_angle, float speed, float mouse_speed)
+    : _position(position), _horizontal_angle(horizontal_angle), _vertical_angle(vertical_angle), _speed(speed), _mouse_speed(mouse_speed), _initial_fov(initialfov)
+{
+}
+
+bool poll_camera_input(GLFWwindow *window, CameraInput &input)
 {
     // 时间差
     static double lastTime = glfwGetTime();
     double currentTime = glfwGetTime();
-    float deltaTime = float(currentTime - lastTime);
+    input.delta_time = float(currentTime - lastTime);
 
     // 获取鼠标位置并计算偏移量
     double xpos, ypos;
@@ -35,8 +40,10 @@ void Camera::compute_matrices_from_inputs(GLFWwindow *window, glm::vec3 center)
     glfwGetWindowSize(window, &width, &height);
     static double lastXpos = width / 2.0, lastYpos = height / 2.0;
     bool mouse_right = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS;
-    double xoffset = mouse_right ? xpos - lastXpos : 0;
-    double yoffset = mouse_right ? ypos - lastYpos : 0;
+    input.rotate_x = mouse_right ? float(xpos - lastXpos) : 0.0f;
+    input.rotate_y = mouse_right ? float(ypos - lastYpos) : 0.0f;
+    input.width = width;
+    input.height = height;
 
     // 更新时间和位置
     lastTime = currentTime;
@@ -45,7 +52,27 @@ void Camera::compute_matrices_from_inputs(GLFWwindow *window, glm::vec3 center)
 
     // 只识别window内的鼠标移动
     if (xpos < 0 || xpos > width || ypos < 0 || ypos > height)
-        return;
+        return false;
+
+    input.move_right = glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS;
+    input.move_left = glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS;
+    input.move_up = glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS;
+    input.move_down = glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS;
+    input.scroll = float(scrollYOffset);
+    scrollYOffset = 0.0;
+    return true;
+}
+
+void Camera::compute_matrices_from_inputs(GLFWwindow *window, glm::vec3 center)
+{
+    CameraInput input;
+    if (poll_camera_input(window, input))
+        update(input);
+}
+
+void Camera::update(const CameraInput &input)
+{
+    float deltaTime = input.delta_time;
 
     // 计算方向、右向量和上向量
     glm::vec3 direction(
@@ -61,8 +88,8 @@ void Camera::compute_matrices_from_inputs(GLFWwindow *window, glm::vec3 center)
     // 更新角度
     // _horizontal_angle -= _mouse_speed * deltaTime * float(xoffset);
     // _vertical_angle -= _mouse_speed * deltaTime * float(yoffset);           ///???感觉不对不是在世界坐标系下旋转是camera坐标系下旋转
-    glm::mat4 rotation_matrix1 = glm::rotate(glm::mat4(1.0f), _mouse_speed * deltaTime * float(xoffset), up);    // 绕up轴旋转
-    glm::mat4 rotation_matrix2 = glm::rotate(glm::mat4(1.0f), _mouse_speed * deltaTime * float(yoffset), right); // 绕right轴旋转
+    glm::mat4 rotation_matrix1 = glm::rotate(glm::mat4(1.0f), _mouse_speed * deltaTime * input.rotate_x, up);    // 绕up轴旋转
+    glm::mat4 rotation_matrix2 = glm::rotate(glm::mat4(1.0f), _mouse_speed * deltaTime * input.rotate_y, right); // 绕right轴旋转
     direction = glm::vec3(rotation_matrix2 * rotation_matrix1 * glm::vec4(direction, 1.0f));
     _vertical_angle = glm::asin(direction.y);
     _vertical_angle = glm::clamp(_vertical_angle, -glm::radians(89.0f), glm::radians(89.0f)); // 限制垂直角度
@@ -71,25 +98,37 @@ void Camera::compute_matrices_from_inputs(GLFWwindow *window, glm::vec3 center)
     up = glm::cross(right, direction);
 
     // 处理键盘输入
-    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) // 相机右移，物体左移
+    if (input.move_right) // 相机右移，物体左移
         _position += right * deltaTime * _speed;
-    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) // 相机左移，物体右移
+    if (input.move_left) // 相机左移，物体右移
         _position -= right * deltaTime * _speed;
-    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) // 相机上移，物体下移
+    if (input.move_up) // 相机上移，物体下移
         _position += up * deltaTime * _speed;
-    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) // 相机下移，物体上移
+    if (input.move_down) // 相机下移，物体上移
         _position -= up * deltaTime * _speed;
-    if (scrollYOffset >= 1e-6 || scrollYOffset <= -1e-6) // 滚轮滚动，相机前移后移
-        _position += direction * float(scrollYOffset) * _speed * 0.3f;
-    scrollYOffset = 0.0;
+    if (input.scroll >= 1e-6f || input.scroll <= -1e-6f) // 滚轮滚动，相机前移后移
+        _position += direction * input.scroll * _speed * 0.3f;
 
     // 更新投影和观察矩阵
     // ProjectionMatrix = glm::ortho(-10.0f * float(width) / height, 10.0f * float(width) / height, -10.0f, 10.0f, 0.0f, 100.0f);
 
-    projection = glm::perspective(_initial_fov, float(width) / height, 0.5f, 300.0f);
+    projection = glm::perspective(_initial_fov, float(input.width) / input.height, 0.5f, 300.0f);
     view = glm::lookAt(_position, _position + direction, up);
 }
 
+void Camera::look_at(const glm::vec3 &position, const glm::vec3 &target, int width, int height)
+{
+    glm::vec3 direction = glm::normalize(target - position);
+    _position = position;
+    _vertical_angle = glm::clamp(glm::asin(direction.y), -glm::radians(89.0f), glm::radians(89.0f));
+    _horizontal_angle = glm::atan(direction.x, direction.z);
+    // 只改朝向，不带任何移动和旋转输入地更新一次矩阵
+    CameraInput input;
+    input.width = width;
+    input.height = height;
+    update(input);
+}
+
 glm::vec3 Camera::get_pos()
 {
     return _position;
@@ -107,3 +146,15 @@ glm::vec3 Camera::get_direction()
         sin(_vertical_angle),
         cos(_vertical_angle) * cos(_horizontal_angle));
 }
+
+Ray Camera::get_pick_ray(double xpos, double ypos, int width, int height) const
+{
+    float x = float(2.0 * xpos / width - 1.0);
+    float y = float(1.0 - 2.0 * ypos / height);
+    glm::mat4 inverse_view_projection = glm::inverse(projection * view);
+    glm::vec4 near_point = inverse_view_projection * glm::vec4(x, y, -1.0f, 1.0f);
+    glm::vec4 far_point = inverse_view_projection * glm::vec4(x, y, 1.0f, 1.0f);
+    near_point /= near_point.w;
+    far_point /= far_point.w;
+    return Ray(glm::vec3(near_point), glm::normalize(glm::vec3(far_point - near_point)));
+}
@@ -7,6 +7,26 @@
 #include "GLFW/glfw3.h"
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
+#include "bounds.hpp"
+
+// 一帧的相机输入，可以来自 GLFW 轮询，也可以由脚本生成（无窗口渲染、基准测试）
+struct CameraInput
+{
+    float delta_time = 0.0f;
+    float rotate_x = 0.0f; // 右键拖动时光标的位移（像素）
+    float rotate_y = 0.0f;
+    bool move_right = false;
+    bool move_left = false;
+    bool move_up = false;
+    bool move_down = false;
+    float scroll = 0.0f;
+    int width = 1;
+    int height = 1;
+};
+
+// 从窗口轮询相机输入；光标在窗口外时返回 false
+bool poll_camera_input(GLFWwindow *window, CameraInput &input);
+void camera_scroll_callback(GLFWwindow *window, double xoffset, double yoffset);
 
 class Camera
 {
@@ -16,14 +36,27 @@ public:
     Camera(GLFWwindow *window, float initialfov = 45.0f, glm::vec3 position = glm::vec3(0, 0, 20), float horizontal_angle = GLM_PI, float vertical_angle = 0.f,
            float speed = 5.0f, float mouse_speed = 1.0f);
 
+    // 不依赖窗口，输入由 update() 传入
+    Camera(float initialfov, glm::vec3 position, float horizontal_angle = GLM_PI, float vertical_angle = 0.f,
+           float speed = 5.0f, float mouse_speed = 1.0f);
+
     void compute_matrices_from_inputs(GLFWwindow *window, glm::vec3 center = glm::vec3(0, 0, 0));
 
+    // 根据一帧输入更新位置、朝向以及投影和观察矩阵
+    void update(const CameraInput &input);
+
+    // 直接把相机放到 position 并看向 target（脚本化相机路径）
+    void look_at(const glm::vec3 &position, const glm::vec3 &target, int width, int height);
+
     glm::vec3 get_pos();
 
     void set_position(glm::vec3 position);
 
     glm::vec3 get_direction();
 
+    // 由屏幕坐标（窗口像素，左上角为原点）生成世界空间拾取射线，使用最近一次计算的投影和观察矩阵
+    Ray get_pick_ray(double xpos, double ypos, int width, int height) const;
+
     // 投影和观察矩阵
     glm::mat4 projection;
     glm::mat4 view;
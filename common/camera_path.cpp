@@ -0,0 +1,91 @@
+#include "camera_path.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+    glm::vec3 catmull_rom(const glm::vec3 &p0, const glm::vec3 &p1, const glm::vec3 &p2, const glm::vec3 &p3, float t)
+    {
+        float t2 = t * t;
+        float t3 = t2 * t;
+        return 0.5f * ((2.0f * p1) + (p2 - p0) * t + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 + (3.0f * p1 - p0 - 3.0f * p2 + p3) * t3);
+    }
+}
+
+void CameraPath::add_key(float time, const glm::vec3 &position, const glm::vec3 &target)
+{
+    keys.push_back(Key{time, position, target});
+}
+
+bool CameraPath::load(const std::string &path)
+{
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        printf("ERROR::CAMERA_PATH:: failed to open %s\n", path.c_str());
+        return false;
+    }
+    keys.clear();
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.empty() || line[0] == '#')
+            continue;
+        std::istringstream stream(line);
+        Key key;
+        if (stream >> key.time >> key.position.x >> key.position.y >> key.position.z >> key.target.x >> key.target.y >> key.target.z)
+            keys.push_back(key);
+    }
+    std::sort(keys.begin(), keys.end(), [](const Key &a, const Key &b)
+              { return a.time < b.time; });
+    return !keys.empty();
+}
+
+bool CameraPath::save(const std::string &path) const
+{
+    FILE *file = fopen(path.c_str(), "w");
+    if (!file)
+    {
+        printf("ERROR::CAMERA_PATH:: failed to write %s\n", path.c_str());
+        return false;
+    }
+    fprintf(file, "# time px py pz tx ty tz\n");
+    for (const Key &key : keys)
+        fprintf(file, "%.4f %.4f %.4f %.4f %.4f %.4f %.4f\n", key.time, key.position.x, key.position.y, key.position.z,
+                key.target.x, key.target.y, key.target.z);
+    fclose(file);
+    return true;
+}
+
+void CameraPath::evaluate(float time, glm::vec3 &position, glm::vec3 &target) const
+{
+    if (keys.empty())
+        return;
+    if (keys.size() == 1 || time <= keys.front().time)
+    {
+        position = keys.front().position;
+        target = keys.front().target;
+        return;
+    }
+    if (time >= keys.back().time)
+    {
+        position = keys.back().position;
+        target = keys.back().target;
+        return;
+    }
+
+    // 找到 time 所在的区间 [i, i + 1]，首尾缺的控制点用端点代替
+    size_t i = std::upper_bound(keys.begin(), keys.end(), time, [](float value, const Key &key)
+                                { return value < key.time; }) -
+               keys.begin() - 1;
+    const Key &k0 = keys[i == 0 ? 0 : i - 1];
+    const Key &k1 = keys[i];
+    const Key &k2 = keys[i + 1];
+    const Key &k3 = keys[std::min(i + 2, keys.size() - 1)];
+    float span = k2.time - k1.time;
+    float t = span > 0.0f ? (time - k1.time) / span : 0.0f;
+    position = catmull_rom(k0.position, k1.position, k2.position, k3.position, t);
+    target = catmull_rom(k0.target, k1.target, k2.target, k3.target, t);
+}
@@ -0,0 +1,40 @@
+#ifndef CAMERA_PATH_HPP
+#define CAMERA_PATH_HPP
+
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+/**
+ * @brief 相机路径：按时间排列的关键帧（位置 + 注视点），用 Catmull-Rom 样条插值。
+ *        文本格式每行一个关键帧 "time px py pz tx ty tz"，# 开头为注释，可以录制后保存再回放。
+ */
+class CameraPath
+{
+public:
+    struct Key
+    {
+        float time;
+        glm::vec3 position;
+        glm::vec3 target;
+    };
+
+    // 关键帧需要按时间递增添加
+    void add_key(float time, const glm::vec3 &position, const glm::vec3 &target);
+    void clear() { keys.clear(); }
+
+    bool load(const std::string &path);
+    bool save(const std::string &path) const;
+
+    bool empty() const { return keys.empty(); }
+    size_t size() const { return keys.size(); }
+    float get_duration() const { return keys.empty() ? 0.0f : keys.back().time; }
+
+    // 超出时间范围时停在首尾关键帧
+    void evaluate(float time, glm::vec3 &position, glm::vec3 &target) const;
+
+private:
+    std::vector<Key> keys;
+};
+
+#endif // CAMERA_PATH_HPP
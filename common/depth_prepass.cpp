@@ -0,0 +1,70 @@
+#include "depth_prepass.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+DepthPrepass::DepthPrepass(const std::string &vertex_shader, const std::string &fragment_shader)
+    : shader(vertex_shader, fragment_shader)
+{
+}
+
+void DepthPrepass::update_toggle(bool key_down)
+{
+    if (key_down && !key_was_down)
+    {
+        enabled = !enabled;
+        printf("depth prepass: %s\n", enabled ? "on" : "off");
+    }
+    key_was_down = key_down;
+}
+
+void DepthPrepass::parse_command_line(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--depth-prepass") == 0)
+            enabled = true;
+        else if (std::strcmp(argv[i], "--no-depth-prepass") == 0)
+            enabled = false;
+    }
+}
+
+void DepthPrepass::save_state()
+{
+    if (state_saved)
+        return;
+    glGetIntegerv(GL_DEPTH_FUNC, &saved_depth_func);
+    glGetBooleanv(GL_DEPTH_WRITEMASK, &saved_depth_mask);
+    state_saved = true;
+}
+
+Shader &DepthPrepass::begin_depth(const glm::mat4 &projection, const glm::mat4 &view)
+{
+    save_state();
+    // 深度函数不变：场景原来用 GL_LESS 还是 GL_LEQUAL，预通道留下的都是同样的最近深度
+    glDepthMask(GL_TRUE);
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    shader.use();
+    shader.setMat4("projection", projection);
+    shader.setMat4("view", view);
+    return shader;
+}
+
+void DepthPrepass::begin_shading()
+{
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    if (!enabled)
+        return;
+    save_state();
+    glDepthFunc(GL_EQUAL);
+    glDepthMask(GL_FALSE);
+}
+
+void DepthPrepass::end()
+{
+    if (!state_saved)
+        return;
+    glDepthFunc(saved_depth_func);
+    glDepthMask(saved_depth_mask);
+    state_saved = false;
+}
@@ -0,0 +1,61 @@
+#ifndef DEPTH_PREPASS_HPP
+#define DEPTH_PREPASS_HPP
+
+#include <string>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "shader.hpp"
+
+/**
+ * @brief 不透明物体的深度预通道。先用只写深度的着色器把不透明物体画一遍（关闭颜色写入），
+ *        再用 GL_EQUAL 深度测试、关闭深度写入画着色通道，每个像素只执行一次昂贵的片元着色器，与绘制顺序无关。
+ *        两个通道的 gl_Position 必须逐位相同：深度着色器按 pbr.vs 的写法计算
+ *        projection * view * vec4(vec3(model * vec4(aPos, 1.0)), 1.0)，两边都声明 invariant gl_Position。
+ *        顶点属性只读 location 0，可以直接画 render_sphere 的 VAO，模型用 Model::DrawDepth（只读位置流）。
+ *        默认关闭：场景较简单时多一遍顶点处理反而更慢，用 --depth-prepass 或运行中按 P 开启后对比 GPU 耗时。
+ *
+ * 用法：
+ *     if (prepass.is_enabled())
+ *     {
+ *         Shader &depth = prepass.begin_depth(projection, view);
+ *         ...对每个不透明物体 depth.setMat4("model", ...) 后绘制...
+ *     }
+ *     prepass.begin_shading();
+ *     ...照常绘制不透明物体...
+ *     prepass.end();
+ *     ...天空盒、透明物体...
+ */
+class DepthPrepass
+{
+public:
+    explicit DepthPrepass(const std::string &vertex_shader = "source/shader/depth_prepass/depth.vs",
+                          const std::string &fragment_shader = "source/shader/depth_prepass/depth.fs");
+
+    void set_enabled(bool enabled) { this->enabled = enabled; }
+    bool is_enabled() const { return enabled; }
+    // 每帧传入切换键是否按下，按下的那一帧切换并打印当前模式
+    void update_toggle(bool key_down);
+    // 解析 --depth-prepass / --no-depth-prepass，默认关闭
+    void parse_command_line(int argc, char **argv);
+
+    // 深度通道：保存当前深度状态，关闭颜色写入，绑定深度着色器并设置 view / projection
+    Shader &begin_depth(const glm::mat4 &projection, const glm::mat4 &view);
+    // 着色通道：恢复颜色写入；启用时深度测试改为 GL_EQUAL 并关闭深度写入
+    void begin_shading();
+    // 恢复 begin_depth / begin_shading 之前的深度函数和深度写入
+    void end();
+
+    Shader &get_shader() { return shader; }
+
+private:
+    void save_state();
+
+    Shader shader;
+    bool enabled = false;
+    bool key_was_down = false;
+    bool state_saved = false;
+    GLint saved_depth_func = GL_LESS;
+    GLboolean saved_depth_mask = GL_TRUE;
+};
+
+#endif // DEPTH_PREPASS_HPP
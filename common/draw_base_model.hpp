@@ -5,6 +5,8 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include "render_stats.hpp"
+#include "gl_registry.hpp"
 
 // ------------------------------------------------------------
 // render_cube 函数：渲染一个大小为 2x2x2 的立方体
@@ -64,12 +66,16 @@ void render_cube()
             -1.0f, 1.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f   // bottom-left
         };
         // 生成 VAO 和 VBO，并配置 VAO 属性
-        glGenVertexArrays(1, &cube_vao);
-        glGenBuffers(1, &cube_vbo);
+        // 进程内一直复用，不算泄漏
+        cube_vao = GL_CREATE(VERTEX_ARRAY, "render_cube");
+        cube_vbo = GL_CREATE(BUFFER, "render_cube vertices");
+        GLRegistry::instance().set_persistent(GLObjectType::VERTEX_ARRAY, cube_vao);
+        GLRegistry::instance().set_persistent(GLObjectType::BUFFER, cube_vbo);
 
         glBindVertexArray(cube_vao);
         glBindBuffer(GL_ARRAY_BUFFER, cube_vbo);
         glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+        GLRegistry::instance().set_bytes(GLObjectType::BUFFER, cube_vbo, sizeof(vertices));
         // 位置属性
         glEnableVertexAttribArray(0);
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)0);
@@ -88,6 +94,8 @@ void render_cube()
     // 绘制立方体
     glBindVertexArray(cube_vao);
     glDrawArrays(GL_TRIANGLES, 0, 36);
+    count_vertex_array_bind();
+    count_draw(GL_TRIANGLES, 36);
     glBindVertexArray(0);
 }
 
@@ -102,11 +110,12 @@ void render_sphere()
 
     if (sphere_vao == 0)
     {
-        glGenVertexArrays(1, &sphere_vao);
-
-        unsigned int vbo, ebo;
-        glGenBuffers(1, &vbo);
-        glGenBuffers(1, &ebo);
+        sphere_vao = GL_CREATE(VERTEX_ARRAY, "render_sphere");
+        unsigned int vbo = GL_CREATE(BUFFER, "render_sphere vertices");
+        unsigned int ebo = GL_CREATE(BUFFER, "render_sphere indices");
+        GLRegistry::instance().set_persistent(GLObjectType::VERTEX_ARRAY, sphere_vao);
+        GLRegistry::instance().set_persistent(GLObjectType::BUFFER, vbo);
+        GLRegistry::instance().set_persistent(GLObjectType::BUFFER, ebo);
 
         std::vector<glm::vec3> positions;
         std::vector<glm::vec2> uv;
@@ -162,6 +171,8 @@ void render_sphere()
         glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), &data[0], GL_STATIC_DRAW);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+        GLRegistry::instance().set_bytes(GLObjectType::BUFFER, vbo, data.size() * sizeof(float));
+        GLRegistry::instance().set_bytes(GLObjectType::BUFFER, ebo, indices.size() * sizeof(unsigned int));
 
         glEnableVertexAttribArray(0);
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)0);
@@ -177,6 +188,8 @@ void render_sphere()
 
     glBindVertexArray(sphere_vao);
     glDrawElements(GL_TRIANGLE_STRIP, index_count, GL_UNSIGNED_INT, 0);
+    count_vertex_array_bind();
+    count_draw(GL_TRIANGLE_STRIP, index_count);
     glBindVertexArray(0);
 }
 
@@ -0,0 +1,168 @@
+#include "draw_list.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // 键相同时按物体编号排，保证排序结果与线程数、分段方式无关
+    bool key_less(const DrawCommand &a, const DrawCommand &b)
+    {
+        return a.sort_key != b.sort_key ? a.sort_key < b.sort_key : a.object < b.object;
+    }
+
+    // 排序键：材质(16) | LOD(4) | 深度(32) | 保留(12)。物体编号不放进键里，由 key_less 比较，物体数量没有上限
+    uint64_t make_sort_key(uint32_t material, uint32_t lod, float depth01)
+    {
+        uint64_t depth_bits = static_cast<uint64_t>(static_cast<double>(glm::clamp(depth01, 0.0f, 1.0f)) * 4294967295.0);
+        return (static_cast<uint64_t>(material & 0xffff) << 48) |
+               (static_cast<uint64_t>(lod & 0xf) << 44) |
+               (depth_bits << 12);
+    }
+}
+
+DrawListBuilder::DrawListBuilder(JobSystem &jobs) : jobs(jobs)
+{
+    TaskGraph::TaskId transforms = graph.add([this]
+                                             { update_transforms(); });
+    TaskGraph::TaskId cull = graph.add([this]
+                                       { cull_and_generate_keys(); },
+                                       {transforms});
+    graph.add([this]
+              { sort_commands(); },
+              {cull});
+}
+
+void DrawListBuilder::prepare(TransformSystem &transforms, const std::vector<DrawObject> &objects, const FrameView &view)
+{
+    frame_transforms = &transforms;
+    frame_objects = &objects;
+    frame_view = view;
+}
+
+const std::vector<DrawCommand> &DrawListBuilder::build(TransformSystem &transforms, const std::vector<DrawObject> &objects, const FrameView &view)
+{
+    prepare(transforms, objects, view);
+    graph.run(jobs);
+    return commands;
+}
+
+void DrawListBuilder::kick(TransformSystem &transforms, const std::vector<DrawObject> &objects, const FrameView &view)
+{
+    jobs.wait(frame_counter);
+    prepare(transforms, objects, view);
+    jobs.submit([this]
+                { graph.run(jobs); },
+                &frame_counter);
+}
+
+const std::vector<DrawCommand> &DrawListBuilder::acquire()
+{
+    jobs.wait(frame_counter);
+    return commands;
+}
+
+void DrawListBuilder::update_transforms()
+{
+    TransformSystem &transforms = *frame_transforms;
+    if (!transforms.begin_update())
+        return;
+    // 同一层的节点互不依赖，层与层之间顺序执行
+    for (size_t level = 0; level < transforms.get_level_count(); level++)
+    {
+        jobs.parallel_for(transforms.get_level(level).size(), grain, [&transforms, level](size_t begin, size_t end)
+                          { transforms.update_level_range(level, begin, end); });
+    }
+    transforms.end_update();
+}
+
+void DrawListBuilder::cull_and_generate_keys()
+{
+    const std::vector<DrawObject> &objects = *frame_objects;
+    const TransformSystem &transforms = *frame_transforms;
+    size_t chunk_count = objects.empty() ? 0 : (objects.size() - 1) / grain + 1;
+    if (chunk_commands.size() < chunk_count)
+        chunk_commands.resize(chunk_count);
+
+    Frustum frustum(frame_view.projection * frame_view.view);
+    // 投影后的屏幕高度占比 ≈ 半径 * projection[1][1] / 距离
+    float projection_scale = frame_view.projection[1][1];
+    float inv_far = 1.0f / frame_view.far_plane;
+    glm::vec3 camera_pos = frame_view.camera_pos;
+
+    jobs.parallel_for(objects.size(), grain, [&](size_t begin, size_t end)
+                      {
+        std::vector<DrawCommand> &out = chunk_commands[begin / grain];
+        out.clear();
+        for (size_t i = begin; i < end; i++)
+        {
+            const DrawObject &object = objects[i];
+            AABB world_bounds = object.local_bounds.transformed(transforms.get_world(object.transform_node));
+            if (!frustum.intersects(world_bounds))
+                continue;
+
+            float radius = glm::length(world_bounds.extent()) * 0.5f;
+            float distance = glm::length(world_bounds.center() - camera_pos);
+            float screen_size = distance > radius ? radius * projection_scale / distance : 1.0f;
+            uint32_t lod = 0;
+            while (lod + 1 < object.lod_count && lod < lod_screen_sizes.size() && screen_size < lod_screen_sizes[lod])
+                lod++;
+
+            uint32_t index = static_cast<uint32_t>(i);
+            out.push_back(DrawCommand{make_sort_key(object.material, lod, distance * inv_far), index, lod});
+        } });
+
+    // 各块结果拼接到一起
+    size_t total = 0;
+    for (size_t chunk = 0; chunk < chunk_count; chunk++)
+        total += chunk_commands[chunk].size();
+    commands.resize(total);
+    size_t offset = 0;
+    for (size_t chunk = 0; chunk < chunk_count; chunk++)
+    {
+        std::copy(chunk_commands[chunk].begin(), chunk_commands[chunk].end(), commands.begin() + offset);
+        offset += chunk_commands[chunk].size();
+    }
+}
+
+void DrawListBuilder::sort_commands()
+{
+    size_t count = commands.size();
+    size_t segment_count = std::min<size_t>(jobs.get_thread_count(), count == 0 ? 0 : (count - 1) / grain + 1);
+    if (segment_count <= 1)
+    {
+        std::sort(commands.begin(), commands.end(), key_less);
+        return;
+    }
+
+    // 分段并行排序，再两两归并
+    size_t segment_size = (count + segment_count - 1) / segment_count;
+    jobs.parallel_for(segment_count, 1, [&](size_t begin, size_t end)
+                      {
+        for (size_t segment = begin; segment < end; segment++)
+        {
+            size_t first = segment * segment_size;
+            size_t last = std::min(first + segment_size, count);
+            std::sort(commands.begin() + first, commands.begin() + last, key_less);
+        } });
+
+    sort_buffer.resize(count);
+    std::vector<DrawCommand> *source = &commands, *target = &sort_buffer;
+    for (size_t width = segment_size; width < count; width *= 2)
+    {
+        size_t pair_count = (count + 2 * width - 1) / (2 * width);
+        jobs.parallel_for(pair_count, 1, [&](size_t begin, size_t end)
+                          {
+            for (size_t pair = begin; pair < end; pair++)
+            {
+                size_t first = pair * 2 * width;
+                size_t middle = std::min(first + width, count);
+                size_t last = std::min(first + 2 * width, count);
+                std::merge(source->begin() + first, source->begin() + middle,
+                           source->begin() + middle, source->begin() + last,
+                           target->begin() + first, key_less);
+            } });
+        std::swap(source, target);
+    }
+    if (source != &commands)
+        commands.swap(sort_buffer);
+}
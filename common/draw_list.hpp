@@ -0,0 +1,79 @@
+#ifndef DRAW_LIST_HPP
+#define DRAW_LIST_HPP
+
+#include <cstdint>
+#include <vector>
+#include "glm/glm.hpp"
+#include "bounds.hpp"
+#include "job_system.hpp"
+#include "transform_system.hpp"
+
+// 参与构建绘制列表的物体
+struct DrawObject
+{
+    uint32_t transform_node; // TransformSystem 中的节点
+    AABB local_bounds;       // 模型空间包围盒
+    uint32_t material = 0;   // 材质/着色器编号，排序时相同材质排在一起以减少状态切换
+    uint32_t lod_count = 1;
+};
+
+// GL 线程消费的绘制命令
+struct DrawCommand
+{
+    uint64_t sort_key; // 列表按 (sort_key, object) 升序
+    uint32_t object;   // DrawObject 下标
+    uint32_t lod;
+};
+
+struct FrameView
+{
+    glm::mat4 projection;
+    glm::mat4 view;
+    glm::vec3 camera_pos;
+    float far_plane = 300.0f;
+};
+
+/**
+ * @brief 多线程构建每帧的绘制列表：变换更新 -> 剔除 + LOD 选择 + 排序键 -> 排序，按任务图依次执行，每一步内部并行。
+ *        GL 线程只读取完成后的列表。kick/acquire 可以让下一帧的构建与当前帧的 GL 提交重叠。
+ */
+class DrawListBuilder
+{
+public:
+    explicit DrawListBuilder(JobSystem &jobs);
+
+    // 屏幕高度占比低于 lod_screen_sizes[i] 时使用 LOD i+1
+    std::vector<float> lod_screen_sizes = {0.25f, 0.1f, 0.03f};
+    // 每个并行任务处理的物体数
+    size_t grain = 2048;
+
+    // 同步构建并返回结果
+    const std::vector<DrawCommand> &build(TransformSystem &transforms, const std::vector<DrawObject> &objects, const FrameView &view);
+
+    // 异步构建：kick 之后到 acquire 之前不能修改 transforms 和 objects
+    void kick(TransformSystem &transforms, const std::vector<DrawObject> &objects, const FrameView &view);
+    const std::vector<DrawCommand> &acquire();
+
+    const std::vector<DrawCommand> &get_commands() const { return commands; }
+
+private:
+    JobSystem &jobs;
+    TaskGraph graph;
+    JobCounter frame_counter;
+
+    // 当前帧的输入
+    TransformSystem *frame_transforms = nullptr;
+    const std::vector<DrawObject> *frame_objects = nullptr;
+    FrameView frame_view;
+
+    std::vector<std::vector<DrawCommand>> chunk_commands; // 每个任务块各自输出，无需加锁
+    std::vector<DrawCommand> commands;
+    std::vector<DrawCommand> sort_buffer;
+
+    void update_transforms();
+    void cull_and_generate_keys();
+    void sort_commands();
+    void prepare(TransformSystem &transforms, const std::vector<DrawObject> &objects, const FrameView &view);
+};
+
+#endif // DRAW_LIST_HPP
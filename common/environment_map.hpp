@@ -9,6 +9,9 @@
 #include "error.hpp"
 #include "load_texture.hpp"
 #include "draw_base_model.hpp"
+#include "profiler.hpp"
+#include "gl_registry.hpp"
+#include "render_graph.hpp"
 
 // 用于捕获立方体贴图的投影矩阵和视图矩阵
 const glm::mat4 capture_projection = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 10.0f);
@@ -20,6 +23,50 @@ const glm::mat4 capture_views[] = {
     glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, -1.0f, 0.0f)),
     glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, -1.0f, 0.0f))};
 
+/**
+ * @brief 用渲染图把 shader 画到立方体贴图 cubemap 的 6 个面（size x size），输入纹理 input_texture 绑定到 0 号纹理单元（采样器 input_sampler）。
+ *        每个面一个 pass：写入导入的立方体贴图面和一张临时深度缓冲；6 张深度的生命周期互不重叠，渲染图只分配一张。
+ *        结束后恢复调用方的帧缓冲和视口（无窗口模式下输出不是帧缓冲 0）。
+ */
+inline void render_cubemap_faces(const char *name, Shader &shader, const char *input_sampler, GLenum input_target, GLuint input_texture, GLuint cubemap, int size)
+{
+    GLint previous_framebuffer, previous_viewport[4];
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous_framebuffer);
+    glGetIntegerv(GL_VIEWPORT, previous_viewport);
+
+    RenderGraph graph;
+    for (unsigned int i = 0; i < 6; ++i)
+    {
+        RenderGraph::ResourceId face = graph.import_texture(std::string(name) + " face " + std::to_string(i), cubemap, {size, size, GL_RGB16F},
+                                                            GL_TEXTURE_CUBE_MAP_POSITIVE_X + i);
+        graph.mark_output(face);
+        graph.add_pass(std::string(name) + " " + std::to_string(i), [&](RenderGraph::PassBuilder &builder)
+                       { builder.write(face);
+                         builder.create("capture depth", {size, size, GL_DEPTH_COMPONENT24}); },
+                       [&shader, i](RenderGraph::PassContext &)
+                       {
+                           shader.setMat4("view", capture_views[i]);
+                           glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                           render_cube();
+                       });
+    }
+    // compile 创建临时纹理时会改动纹理绑定，输入纹理在它之后绑定
+    if (graph.compile())
+    {
+        shader.use();
+        shader.setInt(input_sampler, 0);
+        shader.setMat4("projection", capture_projection);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(input_target, input_texture);
+        graph.execute();
+    }
+    graph.print_stats();
+
+    glBindFramebuffer(GL_FRAMEBUFFER, previous_framebuffer);
+    glViewport(previous_viewport[0], previous_viewport[1], previous_viewport[2], previous_viewport[3]);
+    // 临时深度和 FBO 随 graph 释放
+}
+
 /**
  * @brief 创建一个环境立方体贴图 (cubemap)。
  *        该函数将 equirectangular 格式的 HDR 贴图转换为立方体贴图，
@@ -33,49 +80,27 @@ const glm::mat4 capture_views[] = {
  */
 GLuint convert_equirectangular_to_cubemap(GLuint hdr_texture, const std::string &vertex_shader_path = "source/shader/cubemap.vs", const std::string &fragment_shader_path = "source/shader/equirectangular_to_cubemap.fs")
 {
+    PROFILE_CPU_SCOPE("convert_equirectangular_to_cubemap");
     // 初始化转换的着色器
     Shader equirectangular_to_cubemap_shader(vertex_shader_path.c_str(), fragment_shader_path.c_str());
 
     // 设置立方体贴图
-    GLuint env_cubemap;
-    glGenTextures(1, &env_cubemap);
+    GLuint env_cubemap = GL_CREATE(TEXTURE, "environment cubemap");
     glBindTexture(GL_TEXTURE_CUBE_MAP, env_cubemap);
     for (unsigned int i = 0; i < 6; ++i)
     {
         glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB16F, 512, 512, 0, GL_RGB, GL_FLOAT, nullptr);
     }
+    GLRegistry::instance().set_bytes(GLObjectType::TEXTURE, env_cubemap, GLRegistry::texture_bytes(GL_RGB16F, 512, 512, 6));
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-    // 创建和配置FBO和RBO
-    GLuint capture_fbo, capture_rbo;
-    glGenFramebuffers(1, &capture_fbo);
-    glGenRenderbuffers(1, &capture_rbo);
-    glBindFramebuffer(GL_FRAMEBUFFER, capture_fbo);
-    glBindRenderbuffer(GL_RENDERBUFFER, capture_rbo);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 512, 512);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, capture_rbo);
-
     // 渲染立方体贴图
-    equirectangular_to_cubemap_shader.use();
-    equirectangular_to_cubemap_shader.setInt("equirectangularMap", 0);
-    equirectangular_to_cubemap_shader.setMat4("projection", capture_projection);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, hdr_texture);
-
-    glViewport(0, 0, 512, 512);
-    glBindFramebuffer(GL_FRAMEBUFFER, capture_fbo);
-    for (unsigned int i = 0; i < 6; ++i)
-    {
-        equirectangular_to_cubemap_shader.setMat4("view", capture_views[i]);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, env_cubemap, 0);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        render_cube();
-    }
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    PROFILE_GPU_SCOPE("equirectangular_to_cubemap");
+    render_cubemap_faces("environment cubemap", equirectangular_to_cubemap_shader, "equirectangularMap", GL_TEXTURE_2D, hdr_texture, env_cubemap, 512);
 
     return env_cubemap;
 }
@@ -92,46 +117,25 @@ GLuint convert_equirectangular_to_cubemap(GLuint hdr_texture, const std::string
  */
 GLuint generate_irradiance_map(GLuint env_cubemap, const std::string &vertex_shader_path = "source/shader/cubemap.vs", const std::string &fragment_shader_path = "source/shader/irradiance_convolution.fs")
 {
+    PROFILE_CPU_SCOPE("generate_irradiance_map");
     Shader irradiance_shader(vertex_shader_path.c_str(), fragment_shader_path.c_str());
 
     // 创建辐照度立方体贴图
-    GLuint irradiance_map;
-    glGenTextures(1, &irradiance_map);
+    GLuint irradiance_map = GL_CREATE(TEXTURE, "irradiance cubemap");
     glBindTexture(GL_TEXTURE_CUBE_MAP, irradiance_map);
     for (unsigned int i = 0; i < 6; ++i)
     {
         glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB16F, 32, 32, 0, GL_RGB, GL_FLOAT, nullptr);
     }
+    GLRegistry::instance().set_bytes(GLObjectType::TEXTURE, irradiance_map, GLRegistry::texture_bytes(GL_RGB16F, 32, 32, 6));
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-    GLuint capture_fbo, capture_rbo;
-    glGenFramebuffers(1, &capture_fbo);
-    glGenRenderbuffers(1, &capture_rbo);
-    glBindFramebuffer(GL_FRAMEBUFFER, capture_fbo);
-    glBindRenderbuffer(GL_RENDERBUFFER, capture_rbo);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 32, 32);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, capture_rbo);
-
-    irradiance_shader.use();
-    irradiance_shader.setInt("environmentMap", 0);
-    irradiance_shader.setMat4("projection", capture_projection);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, env_cubemap);
-
-    glViewport(0, 0, 32, 32);
-    glBindFramebuffer(GL_FRAMEBUFFER, capture_fbo);
-    for (unsigned int i = 0; i < 6; ++i)
-    {
-        irradiance_shader.setMat4("view", capture_views[i]);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, irradiance_map, 0);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        render_cube();
-    }
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    PROFILE_GPU_SCOPE("irradiance_convolution");
+    render_cubemap_faces("irradiance cubemap", irradiance_shader, "environmentMap", GL_TEXTURE_CUBE_MAP, env_cubemap, irradiance_map, 32);
 
     return irradiance_map;
 }
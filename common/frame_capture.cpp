@@ -0,0 +1,163 @@
+#include "frame_capture.hpp"
+#include "gl_registry.hpp"
+#include <cstdio>
+#include <cstring>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+namespace
+{
+    bool has_extension(const std::string &path, const char *extension)
+    {
+        size_t length = std::strlen(extension);
+        return path.size() >= length && path.compare(path.size() - length, length, extension) == 0;
+    }
+}
+
+bool CapturedImage::write(const std::string &path) const
+{
+    int result = 0;
+    if (format == Format::LDR && has_extension(path, ".png"))
+        result = stbi_write_png(path.c_str(), width, height, 4, ldr.data(), width * 4);
+    else if (format == Format::HDR && has_extension(path, ".hdr"))
+        result = stbi_write_hdr(path.c_str(), width, height, 3, hdr.data());
+    else
+    {
+        // stb 没有 EXR 编码器，浮点图像只能写 Radiance .hdr
+        printf("ERROR::FRAME_CAPTURE:: unsupported output %s (LDR -> .png, HDR -> .hdr)\n", path.c_str());
+        return false;
+    }
+    if (!result)
+        printf("ERROR::FRAME_CAPTURE:: failed to write %s\n", path.c_str());
+    return result != 0;
+}
+
+FrameCapture::FrameCapture(JobSystem &jobs, int ring_size) : jobs(jobs), slots(ring_size > 0 ? ring_size : 1)
+{
+    for (Slot &slot : slots)
+        slot.buffer = GL_CREATE(BUFFER, "frame capture readback");
+}
+
+FrameCapture::~FrameCapture()
+{
+    flush();
+    for (Slot &slot : slots)
+        GL_DESTROY(BUFFER, slot.buffer);
+}
+
+void FrameCapture::capture(GLuint framebuffer, int width, int height, const std::string &path)
+{
+    CapturedImage::Format format = has_extension(path, ".hdr") ? CapturedImage::Format::HDR : CapturedImage::Format::LDR;
+    capture(framebuffer, width, height, format, [path](CapturedImage &image)
+            { image.write(path); });
+}
+
+void FrameCapture::capture(GLuint framebuffer, int width, int height, CapturedImage::Format format, Callback callback)
+{
+    if (pending == static_cast<int>(slots.size()))
+        resolve_oldest(true);
+
+    Slot &slot = slots[(oldest + pending) % slots.size()];
+    slot.width = width;
+    slot.height = height;
+    slot.format = format;
+    slot.callback = std::move(callback);
+
+    bool hdr = format == CapturedImage::Format::HDR;
+    size_t size = size_t(width) * height * (hdr ? 3 * sizeof(float) : 4);
+    GLint previous_framebuffer = 0;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previous_framebuffer);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    if (slot.capacity < size)
+    {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+        GLRegistry::instance().set_bytes(GLObjectType::BUFFER, slot.buffer, size);
+        slot.capacity = size;
+    }
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glReadBuffer(framebuffer == 0 ? GL_BACK : GL_COLOR_ATTACHMENT0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    // 绑定了 PIXEL_PACK 缓冲时最后一个参数是缓冲内偏移，调用只是把拷贝排进命令队列
+    glReadPixels(0, 0, width, height, hdr ? GL_RGB : GL_RGBA, hdr ? GL_FLOAT : GL_UNSIGNED_BYTE, nullptr);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, previous_framebuffer);
+    pending++;
+}
+
+void FrameCapture::poll()
+{
+    while (pending > 0)
+    {
+        GLenum status = glClientWaitSync(slots[oldest].fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            break;
+        resolve_oldest(false);
+    }
+}
+
+void FrameCapture::flush()
+{
+    while (pending > 0)
+        resolve_oldest(true);
+    jobs.wait(encode_counter);
+}
+
+void FrameCapture::resolve_oldest(bool wait)
+{
+    Slot &slot = slots[oldest];
+    if (wait)
+    {
+        // 第一次等待要求刷新命令队列，否则 fence 可能永远不会被提交
+        GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+        while (glClientWaitSync(slot.fence, flags, 1000000000) == GL_TIMEOUT_EXPIRED)
+            flags = 0;
+    }
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+
+    std::shared_ptr<CapturedImage> image = std::make_shared<CapturedImage>();
+    image->width = slot.width;
+    image->height = slot.height;
+    image->format = slot.format;
+    bool hdr = slot.format == CapturedImage::Format::HDR;
+    size_t row_size = size_t(slot.width) * (hdr ? 3 * sizeof(float) : 4);
+    unsigned char *destination;
+    if (hdr)
+    {
+        image->hdr.resize(size_t(slot.width) * slot.height * 3);
+        destination = reinterpret_cast<unsigned char *>(image->hdr.data());
+    }
+    else
+    {
+        image->ldr.resize(row_size * slot.height);
+        destination = image->ldr.data();
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    const unsigned char *source = static_cast<const unsigned char *>(
+        glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, row_size * slot.height, GL_MAP_READ_BIT));
+    if (source)
+    {
+        // GL 的原点在左下角，拷贝时顺便翻转成自上而下
+        for (int y = 0; y < slot.height; y++)
+            std::memcpy(destination + row_size * y, source + row_size * (slot.height - 1 - y), row_size);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    else
+        printf("ERROR::FRAME_CAPTURE:: failed to map pixel buffer\n");
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    if (source)
+    {
+        Callback callback = std::move(slot.callback);
+        jobs.submit([image, callback]()
+                    { callback(*image); },
+                    &encode_counter);
+    }
+    slot.callback = nullptr;
+    oldest = (oldest + 1) % slots.size();
+    pending--;
+}
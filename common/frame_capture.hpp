@@ -0,0 +1,78 @@
+#ifndef FRAME_CAPTURE_HPP
+#define FRAME_CAPTURE_HPP
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include "job_system.hpp"
+
+// 读回得到的图像，行顺序已翻转为自上而下（和 PNG 等文件格式一致）
+struct CapturedImage
+{
+    enum class Format
+    {
+        LDR, // RGBA8，对应 PNG
+        HDR  // RGB32F，对应 Radiance .hdr
+    };
+
+    int width = 0, height = 0;
+    Format format = Format::LDR;
+    std::vector<unsigned char> ldr; // width * height * 4
+    std::vector<float> hdr;         // width * height * 3
+
+    // 按扩展名写文件：.png 写 LDR，.hdr 写 HDR
+    bool write(const std::string &path) const;
+};
+
+/**
+ * @brief 异步帧读回。
+ *        glReadPixels 读进环形排列的 PIXEL_PACK 缓冲，随后插入 fence 立即返回；之后的帧里 poll()
+ *        用零超时检查 fence，GPU 写完了才映射缓冲拷出数据，编码 / 回调放到工作线程执行，整个过程不阻塞渲染线程。
+ *        环满时 capture() 才会等待最旧的那一帧。所有 GL 调用必须在持有上下文的线程上进行。
+ */
+class FrameCapture
+{
+public:
+    using Callback = std::function<void(CapturedImage &)>;
+
+    explicit FrameCapture(JobSystem &jobs, int ring_size = 3);
+    ~FrameCapture();
+
+    FrameCapture(const FrameCapture &) = delete;
+    FrameCapture &operator=(const FrameCapture &) = delete;
+
+    // 读回 framebuffer 的颜色附件并在工作线程上写入 path，格式由扩展名决定
+    void capture(GLuint framebuffer, int width, int height, const std::string &path);
+    // 读回后在工作线程上调用 callback
+    void capture(GLuint framebuffer, int width, int height, CapturedImage::Format format, Callback callback);
+
+    // 每帧调用一次，处理 GPU 已经完成的读回，不阻塞
+    void poll();
+    // 等待所有读回和编码完成
+    void flush();
+
+    int get_pending() const { return pending; }
+
+private:
+    struct Slot
+    {
+        GLuint buffer = 0;
+        size_t capacity = 0;
+        GLsync fence = nullptr;
+        int width = 0, height = 0;
+        CapturedImage::Format format = CapturedImage::Format::LDR;
+        Callback callback;
+    };
+
+    JobSystem &jobs;
+    JobCounter encode_counter;
+    std::vector<Slot> slots;
+    int oldest = 0;  // 最早发出、尚未处理的槽
+    int pending = 0; // 正在等待 GPU 的槽数
+
+    void resolve_oldest(bool wait);
+};
+
+#endif // FRAME_CAPTURE_HPP
@@ -0,0 +1,77 @@
+#include "gl_handle.hpp"
+#include <iterator>
+
+GLDeletionQueue &GLDeletionQueue::instance()
+{
+    static GLDeletionQueue queue;
+    return queue;
+}
+
+void GLDeletionQueue::enqueue(GLObjectType type, GLuint name)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    current.objects.push_back({type, name});
+}
+
+void GLDeletionQueue::end_frame()
+{
+    std::vector<Batch> completed;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!current.objects.empty())
+        {
+            // 这一帧之前提交的命令执行完后 fence 才会通过，届时它们不再被引用
+            current.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            in_flight.push_back(std::move(current));
+            current = Batch();
+        }
+        size_t done = 0;
+        while (done < in_flight.size())
+        {
+            GLenum status = glClientWaitSync(in_flight[done].fence, 0, 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+                break;
+            done++;
+        }
+        completed.assign(std::make_move_iterator(in_flight.begin()), std::make_move_iterator(in_flight.begin() + done));
+        in_flight.erase(in_flight.begin(), in_flight.begin() + done);
+    }
+    for (Batch &batch : completed)
+        destroy_batch(batch);
+}
+
+void GLDeletionQueue::flush()
+{
+    std::vector<Batch> batches;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        batches = std::move(in_flight);
+        in_flight.clear();
+        if (!current.objects.empty())
+            batches.push_back(std::move(current));
+        current = Batch();
+    }
+    if (batches.empty())
+        return;
+    glFinish();
+    for (Batch &batch : batches)
+        destroy_batch(batch);
+}
+
+size_t GLDeletionQueue::get_pending() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t count = current.objects.size();
+    for (const Batch &batch : in_flight)
+        count += batch.objects.size();
+    return count;
+}
+
+void GLDeletionQueue::destroy_batch(Batch &batch)
+{
+    if (batch.fence)
+        glDeleteSync(batch.fence);
+    GLRegistry &registry = GLRegistry::instance();
+    for (const auto &object : batch.objects)
+        registry.destroy(object.first, object.second);
+}
@@ -0,0 +1,103 @@
+#ifndef GL_HANDLE_HPP
+#define GL_HANDLE_HPP
+
+#include <mutex>
+#include <utility>
+#include <vector>
+#include <glad/glad.h>
+#include "gl_registry.hpp"
+
+/**
+ * @brief 延迟删除队列。
+ *        句柄析构时不直接 glDelete*，而是把名字放进当前帧的批次；end_frame() 给该批次插入 fence，
+ *        之后的帧里 fence 通过（GPU 已经执行完引用它们的命令）才真正删除，流式加载 / 卸载时不会让管线停顿。
+ *        RenderContext::end_frame 会调用 end_frame()，上下文销毁前调用 flush()。
+ *        enqueue 可以在任意线程调用，end_frame / flush 只能在 GL 线程调用。
+ */
+class GLDeletionQueue
+{
+public:
+    static GLDeletionQueue &instance();
+
+    void enqueue(GLObjectType type, GLuint name);
+    // 封存当前帧的批次，并删除 fence 已通过的批次，不阻塞
+    void end_frame();
+    // 等待 GPU 空闲后删除所有待删对象
+    void flush();
+
+    size_t get_pending() const;
+
+private:
+    struct Batch
+    {
+        GLsync fence = nullptr;
+        std::vector<std::pair<GLObjectType, GLuint>> objects;
+    };
+
+    GLDeletionQueue() = default;
+
+    mutable std::mutex mutex;
+    Batch current;
+    std::vector<Batch> in_flight; // 按帧顺序排列，fence 也按顺序通过
+
+    static void destroy_batch(Batch &batch);
+};
+
+/**
+ * @brief 只能移动的 GL 对象句柄，析构时交给 GLDeletionQueue。
+ *        用 GL_CREATE 的结果构造，对象由登记表记录创建位置：TextureHandle texture(GL_CREATE(TEXTURE, "albedo"));
+ */
+template <GLObjectType TYPE>
+class GLHandle
+{
+public:
+    GLHandle() = default;
+    explicit GLHandle(GLuint name) : name(name) {}
+    ~GLHandle() { reset(); }
+
+    GLHandle(const GLHandle &) = delete;
+    GLHandle &operator=(const GLHandle &) = delete;
+
+    GLHandle(GLHandle &&other) noexcept : name(other.name) { other.name = 0; }
+    GLHandle &operator=(GLHandle &&other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            name = other.name;
+            other.name = 0;
+        }
+        return *this;
+    }
+
+    GLuint get() const { return name; }
+    explicit operator bool() const { return name != 0; }
+
+    // 放弃所有权，返回名字
+    GLuint release()
+    {
+        GLuint released = name;
+        name = 0;
+        return released;
+    }
+
+    // 延迟删除当前对象并接管新的名字
+    void reset(GLuint new_name = 0)
+    {
+        if (name != 0)
+            GLDeletionQueue::instance().enqueue(TYPE, name);
+        name = new_name;
+    }
+
+private:
+    GLuint name = 0;
+};
+
+using BufferHandle = GLHandle<GLObjectType::BUFFER>;
+using TextureHandle = GLHandle<GLObjectType::TEXTURE>;
+using VertexArrayHandle = GLHandle<GLObjectType::VERTEX_ARRAY>;
+using FramebufferHandle = GLHandle<GLObjectType::FRAMEBUFFER>;
+using RenderbufferHandle = GLHandle<GLObjectType::RENDERBUFFER>;
+using ProgramHandle = GLHandle<GLObjectType::PROGRAM>;
+
+#endif // GL_HANDLE_HPP
@@ -0,0 +1,290 @@
+#include "gl_registry.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    GLenum label_identifier(GLObjectType type)
+    {
+        switch (type)
+        {
+        case GLObjectType::BUFFER:
+            return GL_BUFFER;
+        case GLObjectType::TEXTURE:
+            return GL_TEXTURE;
+        case GLObjectType::VERTEX_ARRAY:
+            return GL_VERTEX_ARRAY;
+        case GLObjectType::FRAMEBUFFER:
+            return GL_FRAMEBUFFER;
+        case GLObjectType::RENDERBUFFER:
+            return GL_RENDERBUFFER;
+        case GLObjectType::PROGRAM:
+            return GL_PROGRAM;
+        case GLObjectType::QUERY:
+            return GL_QUERY;
+        default:
+            return GL_NONE;
+        }
+    }
+
+    // glGen* 只分配名字，对象第一次绑定后才存在，所以标签在分配存储或显式 set_label 时才设置
+    void apply_label(GLObjectType type, GLuint name, const std::string &label)
+    {
+        if (glObjectLabel && !label.empty())
+            glObjectLabel(label_identifier(type), name, static_cast<GLsizei>(label.size()), label.c_str());
+    }
+
+    size_t bytes_per_texel(GLenum internal_format)
+    {
+        switch (internal_format)
+        {
+        case GL_RED:
+        case GL_R8:
+            return 1;
+        case GL_RG:
+        case GL_RG8:
+        case GL_R16F:
+        case GL_DEPTH_COMPONENT16:
+            return 2;
+        case GL_RG16F:
+        case GL_R32F:
+        case GL_DEPTH_COMPONENT:
+        case GL_DEPTH_COMPONENT24:
+        case GL_DEPTH_COMPONENT32F:
+        case GL_DEPTH24_STENCIL8:
+        case GL_RGB:
+        case GL_RGB8:
+        case GL_SRGB:
+        case GL_SRGB8:
+        case GL_RGBA:
+        case GL_RGBA8:
+        case GL_SRGB_ALPHA:
+        case GL_SRGB8_ALPHA8:
+        case GL_R11F_G11F_B10F:
+            return 4;
+        case GL_DEPTH32F_STENCIL8:
+        case GL_RG32F:
+        case GL_RGB16F:
+        case GL_RGBA16F:
+            return 8;
+        case GL_RGB32F:
+        case GL_RGBA32F:
+            return 16;
+        default:
+            return 4;
+        }
+    }
+}
+
+GLRegistry &GLRegistry::instance()
+{
+    static GLRegistry registry;
+    return registry;
+}
+
+const char *GLRegistry::type_name(GLObjectType type)
+{
+    static const char *names[] = {"buffer", "texture", "vertex_array", "framebuffer", "renderbuffer", "program", "query"};
+    return type < GLObjectType::COUNT ? names[size_t(type)] : "unknown";
+}
+
+size_t GLRegistry::texture_bytes(GLenum internal_format, int width, int height, int layers, bool mipmaps)
+{
+    size_t texel = bytes_per_texel(internal_format);
+    size_t bytes = 0;
+    while (true)
+    {
+        bytes += size_t(width) * height * texel;
+        if (!mipmaps || (width == 1 && height == 1))
+            break;
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+    return bytes * layers;
+}
+
+GLuint GLRegistry::create(GLObjectType type, const std::string &label, const char *file, int line)
+{
+    GLuint name = 0;
+    switch (type)
+    {
+    case GLObjectType::BUFFER:
+        glGenBuffers(1, &name);
+        break;
+    case GLObjectType::TEXTURE:
+        glGenTextures(1, &name);
+        break;
+    case GLObjectType::VERTEX_ARRAY:
+        glGenVertexArrays(1, &name);
+        break;
+    case GLObjectType::FRAMEBUFFER:
+        glGenFramebuffers(1, &name);
+        break;
+    case GLObjectType::RENDERBUFFER:
+        glGenRenderbuffers(1, &name);
+        break;
+    case GLObjectType::PROGRAM:
+        name = glCreateProgram();
+        apply_label(type, name, label);
+        break;
+    case GLObjectType::QUERY:
+        glGenQueries(1, &name);
+        break;
+    default:
+        break;
+    }
+    if (name)
+        track(type, name, label, file, line);
+    return name;
+}
+
+void GLRegistry::destroy(GLObjectType type, GLuint name)
+{
+    if (name == 0)
+        return;
+    switch (type)
+    {
+    case GLObjectType::BUFFER:
+        glDeleteBuffers(1, &name);
+        break;
+    case GLObjectType::TEXTURE:
+        glDeleteTextures(1, &name);
+        break;
+    case GLObjectType::VERTEX_ARRAY:
+        glDeleteVertexArrays(1, &name);
+        break;
+    case GLObjectType::FRAMEBUFFER:
+        glDeleteFramebuffers(1, &name);
+        break;
+    case GLObjectType::RENDERBUFFER:
+        glDeleteRenderbuffers(1, &name);
+        break;
+    case GLObjectType::PROGRAM:
+        glDeleteProgram(name);
+        break;
+    case GLObjectType::QUERY:
+        glDeleteQueries(1, &name);
+        break;
+    default:
+        break;
+    }
+    untrack(type, name);
+}
+
+void GLRegistry::track(GLObjectType type, GLuint name, const std::string &label, const char *file, int line)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    CategoryStats &category = categories[size_t(type)];
+    auto result = entries.emplace(key(type, name), Entry{label, file, line, 0, false, next_serial++});
+    if (!result.second)
+    {
+        // 名字被重新分配：说明旧对象没有经过登记表删除
+        printf("ERROR::GL_REGISTRY:: %s %u (%s) recreated at %s:%d without being destroyed through the registry\n",
+               type_name(type), name, result.first->second.label.c_str(), file, line);
+        category.bytes -= result.first->second.bytes;
+        result.first->second = Entry{label, file, line, 0, false, next_serial - 1};
+        return;
+    }
+    category.live++;
+    category.created++;
+    category.peak = std::max(category.peak, category.live);
+}
+
+void GLRegistry::untrack(GLObjectType type, GLuint name)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = entries.find(key(type, name));
+    if (found == entries.end())
+        return;
+    CategoryStats &category = categories[size_t(type)];
+    category.live--;
+    category.bytes -= found->second.bytes;
+    entries.erase(found);
+}
+
+void GLRegistry::set_bytes(GLObjectType type, GLuint name, size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = entries.find(key(type, name));
+    if (found == entries.end())
+        return;
+    CategoryStats &category = categories[size_t(type)];
+    category.bytes = category.bytes - found->second.bytes + bytes;
+    category.peak_bytes = std::max(category.peak_bytes, category.bytes);
+    found->second.bytes = bytes;
+    apply_label(type, name, found->second.label);
+}
+
+void GLRegistry::set_label(GLObjectType type, GLuint name, const std::string &label)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = entries.find(key(type, name));
+    if (found == entries.end())
+        return;
+    found->second.label = label;
+    apply_label(type, name, label);
+}
+
+void GLRegistry::set_persistent(GLObjectType type, GLuint name)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = entries.find(key(type, name));
+    if (found != entries.end())
+        found->second.persistent = true;
+}
+
+GLRegistry::CategoryStats GLRegistry::get_stats(GLObjectType type) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return categories[size_t(type)];
+}
+
+size_t GLRegistry::get_total_bytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t total = 0;
+    for (const CategoryStats &category : categories)
+        total += category.bytes;
+    return total;
+}
+
+void GLRegistry::print_report() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    printf("%-14s %8s %8s %8s %12s %12s\n", "GL objects", "live", "peak", "created", "MB", "peak MB");
+    size_t total = 0;
+    for (size_t i = 0; i < size_t(GLObjectType::COUNT); i++)
+    {
+        const CategoryStats &category = categories[i];
+        printf("%-14s %8zu %8zu %8zu %12.2f %12.2f\n", type_name(GLObjectType(i)), category.live, category.peak,
+               category.created, category.bytes / 1048576.0, category.peak_bytes / 1048576.0);
+        total += category.bytes;
+    }
+    printf("%-14s %48.2f\n", "total", total / 1048576.0);
+}
+
+size_t GLRegistry::dump_leaks() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::pair<uint64_t, const Entry *>> leaks;
+    for (const auto &entry : entries)
+        if (!entry.second.persistent)
+            leaks.push_back({entry.first, &entry.second});
+    if (leaks.empty())
+        return 0;
+
+    std::sort(leaks.begin(), leaks.end(), [](const std::pair<uint64_t, const Entry *> &a, const std::pair<uint64_t, const Entry *> &b)
+              { return a.second->serial < b.second->serial; });
+    size_t leaked_bytes = 0;
+    for (const auto &leak : leaks)
+        leaked_bytes += leak.second->bytes;
+    printf("ERROR::GL_REGISTRY:: %zu GL objects leaked (%.2f MB)\n", leaks.size(), leaked_bytes / 1048576.0);
+    for (const auto &leak : leaks)
+    {
+        const Entry &entry = *leak.second;
+        printf("  %-12s %6u %10.1f KB  %-40s %s:%d\n", type_name(key_type(leak.first)), key_name(leak.first), entry.bytes / 1024.0,
+               entry.label.empty() ? "-" : entry.label.c_str(), entry.file, entry.line);
+    }
+    return leaks.size();
+}
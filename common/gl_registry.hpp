@@ -0,0 +1,97 @@
+#ifndef GL_REGISTRY_HPP
+#define GL_REGISTRY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <glad/glad.h>
+
+enum class GLObjectType
+{
+    BUFFER,
+    TEXTURE,
+    VERTEX_ARRAY,
+    FRAMEBUFFER,
+    RENDERBUFFER,
+    PROGRAM,
+    QUERY,
+    COUNT
+};
+
+/**
+ * @brief GL 对象登记表。
+ *        通过 GL_CREATE / GL_DESTROY 创建和删除的对象会记录类型、估算的显存字节数、调试标签和创建位置，
+ *        按类型统计存活数 / 峰值 / 显存。程序退出（RenderContext 析构）时 dump_leaks() 列出仍然存活的对象。
+ *        有调试标签且驱动支持 KHR_debug 时同时调用 glObjectLabel，RenderDoc 等工具里也能看到名字。
+ *        只在持有 GL 上下文的线程上使用。
+ */
+class GLRegistry
+{
+public:
+    struct CategoryStats
+    {
+        size_t live = 0;
+        size_t peak = 0;
+        size_t created = 0;
+        size_t bytes = 0;
+        size_t peak_bytes = 0;
+    };
+
+    static GLRegistry &instance();
+
+    // glGen* / glCreateProgram 并登记，label 可以为空
+    GLuint create(GLObjectType type, const std::string &label, const char *file, int line);
+    // glDelete* 并注销，name 为 0 时什么都不做
+    void destroy(GLObjectType type, GLuint name);
+
+    // 登记 / 注销别处创建的对象（不调用 GL）
+    void track(GLObjectType type, GLuint name, const std::string &label, const char *file, int line);
+    void untrack(GLObjectType type, GLuint name);
+
+    // 分配存储后更新估算的字节数
+    void set_bytes(GLObjectType type, GLuint name, size_t bytes);
+    void set_label(GLObjectType type, GLuint name, const std::string &label);
+    // 常驻对象（进程生命周期内的缓存）不计入泄漏报告
+    void set_persistent(GLObjectType type, GLuint name);
+
+    CategoryStats get_stats(GLObjectType type) const;
+    size_t get_total_bytes() const;
+    void print_report() const;
+    // 打印所有非常驻的存活对象，返回数量
+    size_t dump_leaks() const;
+
+    static const char *type_name(GLObjectType type);
+    // 估算纹理占用：三通道格式按驱动常见的四通道对齐计算，cubemap 传 layers = 6
+    static size_t texture_bytes(GLenum internal_format, int width, int height, int layers = 1, bool mipmaps = false);
+
+private:
+    struct Entry
+    {
+        std::string label;
+        const char *file;
+        int line;
+        size_t bytes;
+        bool persistent;
+        uint64_t serial; // 创建顺序，泄漏报告按它排序
+    };
+
+    GLRegistry() = default;
+
+    static uint64_t key(GLObjectType type, GLuint name) { return (uint64_t(type) << 32) | name; }
+    static GLObjectType key_type(uint64_t key) { return GLObjectType(key >> 32); }
+    static GLuint key_name(uint64_t key) { return GLuint(key & 0xffffffffu); }
+
+    mutable std::mutex mutex;
+    std::unordered_map<uint64_t, Entry> entries;
+    CategoryStats categories[size_t(GLObjectType::COUNT)];
+    uint64_t next_serial = 0;
+};
+
+// 在调用处记录文件和行号
+#define GL_CREATE(type, label) GLRegistry::instance().create(GLObjectType::type, label, __FILE__, __LINE__)
+#define GL_DESTROY(type, name) GLRegistry::instance().destroy(GLObjectType::type, name)
+#define GL_TRACK(type, name, label) GLRegistry::instance().track(GLObjectType::type, name, label, __FILE__, __LINE__)
+
+#endif // GL_REGISTRY_HPP
@@ -0,0 +1,1007 @@
+#include "gltf_loader.hpp"
+#include "vertex_utils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+namespace
+{
+    // 最小的 JSON DOM：glTF 的 JSON 一般只有几百 KB，读成树后按名字取字段
+    struct JsonValue
+    {
+        enum class Type
+        {
+            NUL,
+            BOOLEAN,
+            NUMBER,
+            STRING,
+            ARRAY,
+            OBJECT
+        };
+
+        Type type = Type::NUL;
+        bool boolean = false;
+        double number = 0.0;
+        std::string string;
+        std::vector<JsonValue> items;
+        std::vector<std::pair<std::string, JsonValue>> members;
+
+        // 不存在的字段 / 越界的下标返回 null
+        const JsonValue &operator[](const char *key) const
+        {
+            for (const auto &member : members)
+            {
+                if (member.first == key)
+                    return member.second;
+            }
+            return null_value();
+        }
+        const JsonValue &operator[](size_t index) const { return index < items.size() ? items[index] : null_value(); }
+        const JsonValue &operator[](int index) const { return index >= 0 ? (*this)[size_t(index)] : null_value(); }
+        size_t size() const { return items.size(); }
+        bool is_null() const { return type == Type::NUL; }
+        double number_or(double fallback) const { return type == Type::NUMBER ? number : fallback; }
+        int int_or(int fallback) const { return type == Type::NUMBER ? static_cast<int>(number) : fallback; }
+        size_t size_or(size_t fallback) const { return type == Type::NUMBER && number >= 0.0 ? static_cast<size_t>(number) : fallback; }
+        bool bool_or(bool fallback) const { return type == Type::BOOLEAN ? boolean : fallback; }
+        const std::string &string_or_empty() const { return type == Type::STRING ? string : null_value().string; }
+
+        static const JsonValue &null_value()
+        {
+            static const JsonValue value;
+            return value;
+        }
+    };
+
+    class JsonParser
+    {
+    public:
+        JsonParser(const char *begin, const char *end) : p(begin), end(end) {}
+
+        bool parse(JsonValue &value)
+        {
+            if (!parse_value(value, 0))
+                return false;
+            skip_space();
+            return p == end || *p == '\0';
+        }
+
+    private:
+        const char *p;
+        const char *end;
+
+        void skip_space()
+        {
+            while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+                p++;
+        }
+
+        bool literal(const char *word)
+        {
+            size_t length = std::strlen(word);
+            if (size_t(end - p) < length || std::memcmp(p, word, length) != 0)
+                return false;
+            p += length;
+            return true;
+        }
+
+        static void append_utf8(std::string &out, uint32_t code)
+        {
+            if (code < 0x80)
+                out += char(code);
+            else if (code < 0x800)
+            {
+                out += char(0xC0 | (code >> 6));
+                out += char(0x80 | (code & 0x3F));
+            }
+            else if (code < 0x10000)
+            {
+                out += char(0xE0 | (code >> 12));
+                out += char(0x80 | ((code >> 6) & 0x3F));
+                out += char(0x80 | (code & 0x3F));
+            }
+            else
+            {
+                out += char(0xF0 | (code >> 18));
+                out += char(0x80 | ((code >> 12) & 0x3F));
+                out += char(0x80 | ((code >> 6) & 0x3F));
+                out += char(0x80 | (code & 0x3F));
+            }
+        }
+
+        bool hex4(uint32_t &code)
+        {
+            if (end - p < 4)
+                return false;
+            code = 0;
+            for (int i = 0; i < 4; i++, p++)
+            {
+                char c = *p;
+                code <<= 4;
+                if (c >= '0' && c <= '9')
+                    code |= c - '0';
+                else if (c >= 'a' && c <= 'f')
+                    code |= c - 'a' + 10;
+                else if (c >= 'A' && c <= 'F')
+                    code |= c - 'A' + 10;
+                else
+                    return false;
+            }
+            return true;
+        }
+
+        bool parse_string(std::string &out)
+        {
+            p++; // "
+            while (p < end && *p != '"')
+            {
+                if (*p != '\\')
+                {
+                    out += *p++;
+                    continue;
+                }
+                if (++p >= end)
+                    return false;
+                char escape = *p++;
+                switch (escape)
+                {
+                case '"':
+                case '\\':
+                case '/':
+                    out += escape;
+                    break;
+                case 'b':
+                    out += '\b';
+                    break;
+                case 'f':
+                    out += '\f';
+                    break;
+                case 'n':
+                    out += '\n';
+                    break;
+                case 'r':
+                    out += '\r';
+                    break;
+                case 't':
+                    out += '\t';
+                    break;
+                case 'u':
+                {
+                    uint32_t code;
+                    if (!hex4(code))
+                        return false;
+                    // 代理对
+                    if (code >= 0xD800 && code < 0xDC00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u')
+                    {
+                        p += 2;
+                        uint32_t low;
+                        if (!hex4(low))
+                            return false;
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    append_utf8(out, code);
+                    break;
+                }
+                default:
+                    return false;
+                }
+            }
+            if (p >= end)
+                return false;
+            p++; // "
+            return true;
+        }
+
+        bool parse_value(JsonValue &value, int depth)
+        {
+            if (depth > 256)
+                return false;
+            skip_space();
+            if (p >= end)
+                return false;
+            switch (*p)
+            {
+            case '{':
+            {
+                value.type = JsonValue::Type::OBJECT;
+                p++;
+                skip_space();
+                if (p < end && *p == '}')
+                {
+                    p++;
+                    return true;
+                }
+                while (true)
+                {
+                    skip_space();
+                    if (p >= end || *p != '"')
+                        return false;
+                    value.members.emplace_back();
+                    if (!parse_string(value.members.back().first))
+                        return false;
+                    skip_space();
+                    if (p >= end || *p++ != ':')
+                        return false;
+                    if (!parse_value(value.members.back().second, depth + 1))
+                        return false;
+                    skip_space();
+                    if (p < end && *p == ',')
+                    {
+                        p++;
+                        continue;
+                    }
+                    if (p < end && *p == '}')
+                    {
+                        p++;
+                        return true;
+                    }
+                    return false;
+                }
+            }
+            case '[':
+            {
+                value.type = JsonValue::Type::ARRAY;
+                p++;
+                skip_space();
+                if (p < end && *p == ']')
+                {
+                    p++;
+                    return true;
+                }
+                while (true)
+                {
+                    value.items.emplace_back();
+                    if (!parse_value(value.items.back(), depth + 1))
+                        return false;
+                    skip_space();
+                    if (p < end && *p == ',')
+                    {
+                        p++;
+                        continue;
+                    }
+                    if (p < end && *p == ']')
+                    {
+                        p++;
+                        return true;
+                    }
+                    return false;
+                }
+            }
+            case '"':
+                value.type = JsonValue::Type::STRING;
+                return parse_string(value.string);
+            case 't':
+                value.type = JsonValue::Type::BOOLEAN;
+                value.boolean = true;
+                return literal("true");
+            case 'f':
+                value.type = JsonValue::Type::BOOLEAN;
+                return literal("false");
+            case 'n':
+                return literal("null");
+            default:
+            {
+                // 数字：复制到缓冲里再 strtod，映射的内存不以 '\0' 结尾
+                char buffer[64];
+                size_t length = 0;
+                while (p < end && length + 1 < sizeof(buffer) && (std::strchr("+-0123456789.eE", *p) != nullptr))
+                    buffer[length++] = *p++;
+                buffer[length] = '\0';
+                char *parsed = nullptr;
+                value.type = JsonValue::Type::NUMBER;
+                value.number = std::strtod(buffer, &parsed);
+                return length > 0 && parsed == buffer + length;
+            }
+            }
+        }
+    };
+
+    struct Accessor
+    {
+        int view = -1; // 没有 bufferView 时全零（稀疏访问器可以这样）
+        size_t offset = 0;
+        size_t count = 0;
+        GLenum component_type = GL_FLOAT; // glTF 的 componentType 就是 GL 枚举值
+        int components = 1;
+        bool normalized = false;
+        size_t stride = 0; // 实际步长（bufferView 的 byteStride 或紧密排列）
+        bool has_min_max = false;
+        glm::vec3 min = glm::vec3(0.0f), max = glm::vec3(0.0f);
+        // 稀疏替换
+        size_t sparse_count = 0;
+        int sparse_index_view = -1, sparse_value_view = -1;
+        size_t sparse_index_offset = 0, sparse_value_offset = 0;
+        GLenum sparse_index_type = GL_UNSIGNED_INT;
+    };
+
+    size_t component_size(GLenum type)
+    {
+        switch (type)
+        {
+        case GL_BYTE:
+        case GL_UNSIGNED_BYTE:
+            return 1;
+        case GL_SHORT:
+        case GL_UNSIGNED_SHORT:
+            return 2;
+        case GL_UNSIGNED_INT:
+        case GL_FLOAT:
+            return 4;
+        default:
+            return 0;
+        }
+    }
+
+    int type_components(const std::string &type)
+    {
+        if (type == "SCALAR")
+            return 1;
+        if (type == "VEC2")
+            return 2;
+        if (type == "VEC3")
+            return 3;
+        if (type == "VEC4" || type == "MAT2")
+            return 4;
+        if (type == "MAT3")
+            return 9;
+        if (type == "MAT4")
+            return 16;
+        return 0;
+    }
+
+    float read_component(const uint8_t *p, GLenum type, bool normalized)
+    {
+        switch (type)
+        {
+        case GL_FLOAT:
+        {
+            float value;
+            std::memcpy(&value, p, 4);
+            return value;
+        }
+        case GL_BYTE:
+        {
+            float value = float(int8_t(*p));
+            return normalized ? std::max(value / 127.0f, -1.0f) : value;
+        }
+        case GL_UNSIGNED_BYTE:
+            return normalized ? *p / 255.0f : float(*p);
+        case GL_SHORT:
+        {
+            int16_t raw;
+            std::memcpy(&raw, p, 2);
+            return normalized ? std::max(raw / 32767.0f, -1.0f) : float(raw);
+        }
+        case GL_UNSIGNED_SHORT:
+        {
+            uint16_t raw;
+            std::memcpy(&raw, p, 2);
+            return normalized ? raw / 65535.0f : float(raw);
+        }
+        case GL_UNSIGNED_INT:
+        {
+            uint32_t raw;
+            std::memcpy(&raw, p, 4);
+            return float(raw);
+        }
+        default:
+            return 0.0f;
+        }
+    }
+
+    uint32_t read_unsigned(const uint8_t *p, GLenum type)
+    {
+        if (type == GL_UNSIGNED_BYTE)
+            return *p;
+        if (type == GL_UNSIGNED_SHORT)
+        {
+            uint16_t raw;
+            std::memcpy(&raw, p, 2);
+            return raw;
+        }
+        uint32_t raw;
+        std::memcpy(&raw, p, 4);
+        return raw;
+    }
+
+    int base64_value(char c)
+    {
+        if (c >= 'A' && c <= 'Z')
+            return c - 'A';
+        if (c >= 'a' && c <= 'z')
+            return c - 'a' + 26;
+        if (c >= '0' && c <= '9')
+            return c - '0' + 52;
+        if (c == '+' || c == '-')
+            return 62;
+        if (c == '/' || c == '_')
+            return 63;
+        return -1;
+    }
+
+    // data:[<mime>];base64,<data>
+    bool decode_data_uri(const std::string &uri, std::vector<uint8_t> &out)
+    {
+        size_t comma = uri.find(',');
+        if (uri.compare(0, 5, "data:") != 0 || comma == std::string::npos || uri.rfind(";base64", comma) == std::string::npos)
+            return false;
+        uint32_t bits = 0;
+        int bit_count = 0;
+        for (size_t i = comma + 1; i < uri.size(); i++)
+        {
+            int value = base64_value(uri[i]);
+            if (value < 0)
+                continue; // '=' 填充
+            bits = (bits << 6) | uint32_t(value);
+            bit_count += 6;
+            if (bit_count >= 8)
+            {
+                bit_count -= 8;
+                out.push_back(uint8_t(bits >> bit_count));
+            }
+        }
+        return true;
+    }
+
+    // URI 里的 %20 等
+    std::string decode_uri(const std::string &uri)
+    {
+        std::string out;
+        for (size_t i = 0; i < uri.size(); i++)
+        {
+            if (uri[i] == '%' && i + 2 < uri.size())
+            {
+                char hex[3] = {uri[i + 1], uri[i + 2], '\0'};
+                char *parsed = nullptr;
+                long value = std::strtol(hex, &parsed, 16);
+                if (parsed == hex + 2)
+                {
+                    out += char(value);
+                    i += 2;
+                    continue;
+                }
+            }
+            out += uri[i];
+        }
+        return out;
+    }
+
+    glm::mat4 node_matrix(const JsonValue &node)
+    {
+        const JsonValue &matrix = node["matrix"];
+        if (matrix.size() == 16)
+        {
+            float values[16];
+            for (size_t i = 0; i < 16; i++)
+                values[i] = float(matrix[i].number_or(0.0));
+            return glm::make_mat4(values); // 与 glm 一样是列主序
+        }
+        const JsonValue &t = node["translation"], &r = node["rotation"], &s = node["scale"];
+        glm::mat4 local(1.0f);
+        if (t.size() == 3)
+            local = glm::translate(local, glm::vec3(t[0].number_or(0.0), t[1].number_or(0.0), t[2].number_or(0.0)));
+        if (r.size() == 4)
+            local *= glm::mat4_cast(glm::quat(float(r[3].number_or(1.0)), float(r[0].number_or(0.0)), float(r[1].number_or(0.0)), float(r[2].number_or(0.0))));
+        if (s.size() == 3)
+            local = glm::scale(local, glm::vec3(s[0].number_or(1.0), s[1].number_or(1.0), s[2].number_or(1.0)));
+        return local;
+    }
+
+    // 纹理下标 -> 图片下标
+    int texture_image(const JsonValue &json, const JsonValue &texture_info)
+    {
+        int texture = texture_info["index"].int_or(-1);
+        if (texture < 0)
+            return -1;
+        return json["textures"][size_t(texture)]["source"].int_or(-1);
+    }
+
+    class Loader
+    {
+    public:
+        Loader(const JsonValue &json, std::vector<GltfBufferView> &views, bool force_copy)
+            : json(json), views(views), force_copy(force_copy) {}
+
+        bool parse_accessors()
+        {
+            const JsonValue &list = json["accessors"];
+            for (size_t i = 0; i < list.size(); i++)
+            {
+                const JsonValue &item = list[i];
+                Accessor accessor;
+                accessor.view = item["bufferView"].int_or(-1);
+                accessor.offset = item["byteOffset"].size_or(0);
+                accessor.count = item["count"].size_or(0);
+                accessor.component_type = GLenum(item["componentType"].int_or(0));
+                accessor.components = type_components(item["type"].string_or_empty());
+                accessor.normalized = item["normalized"].bool_or(false);
+                size_t element = component_size(accessor.component_type) * accessor.components;
+                if (element == 0)
+                {
+                    printf("ERROR::GLTF:: accessor %zu has an unsupported type\n", i);
+                    return false;
+                }
+                if (accessor.view >= 0)
+                {
+                    if (size_t(accessor.view) >= views.size())
+                        return error("accessor", i);
+                    accessor.stride = json["bufferViews"][size_t(accessor.view)]["byteStride"].size_or(0);
+                    if (accessor.stride == 0)
+                        accessor.stride = element;
+                    const GltfBufferView &view = views[accessor.view];
+                    if (accessor.count > 0 && accessor.offset + accessor.stride * (accessor.count - 1) + element > view.size)
+                        return error("accessor", i);
+                }
+                const JsonValue &min = item["min"], &max = item["max"];
+                if (accessor.components == 3 && min.size() == 3 && max.size() == 3)
+                {
+                    accessor.has_min_max = true;
+                    accessor.min = glm::vec3(min[0].number_or(0.0), min[1].number_or(0.0), min[2].number_or(0.0));
+                    accessor.max = glm::vec3(max[0].number_or(0.0), max[1].number_or(0.0), max[2].number_or(0.0));
+                }
+                const JsonValue &sparse = item["sparse"];
+                if (!sparse.is_null())
+                {
+                    accessor.sparse_count = sparse["count"].size_or(0);
+                    accessor.sparse_index_view = sparse["indices"]["bufferView"].int_or(-1);
+                    accessor.sparse_index_offset = sparse["indices"]["byteOffset"].size_or(0);
+                    accessor.sparse_index_type = GLenum(sparse["indices"]["componentType"].int_or(GL_UNSIGNED_INT));
+                    accessor.sparse_value_view = sparse["values"]["bufferView"].int_or(-1);
+                    accessor.sparse_value_offset = sparse["values"]["byteOffset"].size_or(0);
+                    if (!sparse_in_range(accessor, element))
+                        return error("sparse accessor", i);
+                }
+                accessors.push_back(accessor);
+            }
+            return true;
+        }
+
+        bool parse_mesh(const JsonValue &mesh, std::vector<GltfPrimitive> &primitives, size_t &copied_bytes)
+        {
+            const JsonValue &list = mesh["primitives"];
+            for (size_t i = 0; i < list.size(); i++)
+            {
+                const JsonValue &item = list[i];
+                int mode = item["mode"].int_or(4);
+                if (mode < 4 || mode > 6)
+                    continue; // 点和线
+                const JsonValue &attributes = item["attributes"];
+                const Accessor *position = accessor(attributes["POSITION"]);
+                if (!position || position->components != 3)
+                    continue;
+                const Accessor *normal = accessor(attributes["NORMAL"]);
+                const Accessor *uv = accessor(attributes["TEXCOORD_0"]);
+                const Accessor *tangent = accessor(attributes["TANGENT"]);
+                const Accessor *indices = accessor(item["indices"]);
+
+                GltfPrimitive primitive;
+                primitive.material = item["material"].int_or(-1);
+                primitive.bounds = position_bounds(*position);
+
+                bool direct = !force_copy && mode == 4 && normal && indices && direct_attribute(*position) && direct_attribute(*normal) &&
+                              (!uv || direct_attribute(*uv)) && (!tangent || direct_attribute(*tangent)) && direct_indices(*indices);
+                if (direct)
+                {
+                    add_attribute(primitive.view, 0, *position);
+                    add_attribute(primitive.view, 1, *normal);
+                    if (uv)
+                        add_attribute(primitive.view, 2, *uv);
+                    if (tangent)
+                        add_attribute(primitive.view, 3, *tangent); // xyz 为切线，w 为副切线方向，顶点着色器取 vec3 时忽略 w
+                    primitive.view.indexSource = indices->view;
+                    primitive.view.indexOffset = indices->offset;
+                    primitive.view.indexType = indices->component_type;
+                    primitive.view.indexCount = static_cast<GLsizei>(indices->count);
+                    primitive.view.vertexCount = position->count;
+                    views[indices->view].used = true;
+                }
+                else
+                {
+                    expand(primitive, mode, *position, normal, uv, tangent, indices);
+                    copied_bytes += primitive.vertices.size() * sizeof(Vertex) + primitive.indices.size() * sizeof(unsigned int);
+                }
+                if (primitive.zero_copy() || !primitive.indices.empty())
+                    primitives.push_back(std::move(primitive));
+            }
+            return true;
+        }
+
+    private:
+        const JsonValue &json;
+        std::vector<GltfBufferView> &views;
+        bool force_copy;
+        std::vector<Accessor> accessors;
+
+        bool error(const char *what, size_t index)
+        {
+            printf("ERROR::GLTF:: %s %zu is out of range\n", what, index);
+            return false;
+        }
+
+        bool sparse_in_range(const Accessor &accessor, size_t element) const
+        {
+            if (accessor.sparse_count == 0)
+                return true;
+            size_t index_size = component_size(accessor.sparse_index_type);
+            if (accessor.sparse_index_view < 0 || size_t(accessor.sparse_index_view) >= views.size() || index_size == 0 ||
+                accessor.sparse_value_view < 0 || size_t(accessor.sparse_value_view) >= views.size())
+                return false;
+            return accessor.sparse_index_offset + index_size * accessor.sparse_count <= views[accessor.sparse_index_view].size &&
+                   accessor.sparse_value_offset + element * accessor.sparse_count <= views[accessor.sparse_value_view].size;
+        }
+
+        const Accessor *accessor(const JsonValue &index) const
+        {
+            int i = index.int_or(-1);
+            return i >= 0 && size_t(i) < accessors.size() ? &accessors[i] : nullptr;
+        }
+
+        bool direct_attribute(const Accessor &accessor) const
+        {
+            // 稀疏的、没有 bufferView 的只能逐元素读出；glTF 不允许顶点属性用 UNSIGNED_INT
+            return accessor.view >= 0 && accessor.sparse_count == 0 && accessor.component_type != GL_UNSIGNED_INT;
+        }
+
+        bool direct_indices(const Accessor &accessor) const
+        {
+            return accessor.view >= 0 && accessor.sparse_count == 0 && accessor.components == 1 &&
+                   (accessor.component_type == GL_UNSIGNED_BYTE || accessor.component_type == GL_UNSIGNED_SHORT || accessor.component_type == GL_UNSIGNED_INT);
+        }
+
+        void add_attribute(MeshView &view, GLuint location, const Accessor &accessor)
+        {
+            VertexAttribute attribute;
+            attribute.location = location;
+            attribute.size = accessor.components;
+            attribute.type = accessor.component_type;
+            attribute.normalized = accessor.normalized ? GL_TRUE : GL_FALSE;
+            attribute.stride = static_cast<GLsizei>(accessor.stride);
+            attribute.offset = accessor.offset;
+            attribute.source = accessor.view;
+            attribute.buffer = 0;
+            view.attributes.push_back(attribute);
+            views[accessor.view].used = true;
+        }
+
+        // 元素 index 的前 components 个分量（不超过 4），已经应用稀疏替换
+        glm::vec4 read(const Accessor &accessor, size_t index) const
+        {
+            glm::vec4 value(0.0f);
+            const uint8_t *element = nullptr;
+            if (accessor.view >= 0)
+                element = views[accessor.view].data + accessor.offset + accessor.stride * index;
+            size_t size = component_size(accessor.component_type);
+            // 稀疏索引按升序排列，二分查找
+            if (accessor.sparse_count > 0)
+            {
+                const uint8_t *indices = views[accessor.sparse_index_view].data + accessor.sparse_index_offset;
+                size_t index_size = component_size(accessor.sparse_index_type);
+                size_t low = 0, high = accessor.sparse_count;
+                while (low < high)
+                {
+                    size_t middle = (low + high) / 2;
+                    if (read_unsigned(indices + middle * index_size, accessor.sparse_index_type) < index)
+                        low = middle + 1;
+                    else
+                        high = middle;
+                }
+                if (low < accessor.sparse_count && read_unsigned(indices + low * index_size, accessor.sparse_index_type) == index)
+                    element = views[accessor.sparse_value_view].data + accessor.sparse_value_offset + low * size * accessor.components;
+            }
+            if (!element)
+                return value;
+            for (int c = 0; c < std::min(accessor.components, 4); c++)
+                value[c] = read_component(element + c * size, accessor.component_type, accessor.normalized);
+            return value;
+        }
+
+        AABB position_bounds(const Accessor &position) const
+        {
+            AABB bounds;
+            if (position.has_min_max && position.sparse_count == 0)
+            {
+                bounds.expand(position.min);
+                bounds.expand(position.max);
+                return bounds;
+            }
+            for (size_t i = 0; i < position.count; i++)
+                bounds.expand(glm::vec3(read(position, i)));
+            return bounds;
+        }
+
+        void expand(GltfPrimitive &primitive, int mode, const Accessor &position, const Accessor *normal, const Accessor *uv,
+                    const Accessor *tangent, const Accessor *indices) const
+        {
+            std::vector<Vertex> &vertices = primitive.vertices;
+            vertices.resize(position.count);
+            for (size_t i = 0; i < position.count; i++)
+            {
+                Vertex vertex = {};
+                vertex.Position = glm::vec3(read(position, i));
+                if (normal && i < normal->count)
+                    vertex.Normal = glm::vec3(read(*normal, i));
+                if (uv && i < uv->count)
+                    vertex.TexCoords = glm::vec2(read(*uv, i));
+                vertices[i] = vertex;
+            }
+
+            std::vector<unsigned int> order;
+            if (indices)
+            {
+                order.resize(indices->count);
+                for (size_t i = 0; i < indices->count; i++)
+                    order[i] = static_cast<unsigned int>(read(*indices, i).x);
+            }
+            else
+            {
+                order.resize(position.count);
+                for (size_t i = 0; i < order.size(); i++)
+                    order[i] = static_cast<unsigned int>(i);
+            }
+            // 条带和扇形转成三角形列表，越界的三角形丢掉
+            std::vector<unsigned int> &out = primitive.indices;
+            size_t triangles = mode == 4 ? order.size() / 3 : (order.size() >= 3 ? order.size() - 2 : 0);
+            out.reserve(triangles * 3);
+            for (size_t t = 0; t < triangles; t++)
+            {
+                unsigned int a, b, c;
+                if (mode == 4)
+                    a = order[t * 3], b = order[t * 3 + 1], c = order[t * 3 + 2];
+                else if (mode == 5)
+                    a = order[t], b = order[t + 1 + (t & 1)], c = order[t + 2 - (t & 1)];
+                else
+                    a = order[0], b = order[t + 1], c = order[t + 2];
+                if (a >= vertices.size() || b >= vertices.size() || c >= vertices.size())
+                    continue;
+                out.push_back(a);
+                out.push_back(b);
+                out.push_back(c);
+            }
+
+            if (!normal)
+                generate_normals(vertices, out);
+            if (tangent)
+            {
+                for (size_t i = 0; i < vertices.size() && i < tangent->count; i++)
+                {
+                    glm::vec4 t = read(*tangent, i);
+                    vertices[i].Tangent = glm::vec3(t);
+                    vertices[i].Bitangent = glm::cross(vertices[i].Normal, glm::vec3(t)) * (t.w < 0.0f ? -1.0f : 1.0f);
+                }
+            }
+            else if (uv)
+                generate_tangents(vertices, out);
+        }
+    };
+
+    const uint32_t GLB_MAGIC = 0x46546C67; // "glTF"
+    const uint32_t GLB_CHUNK_JSON = 0x4E4F534A;
+    const uint32_t GLB_CHUNK_BIN = 0x004E4942;
+
+    uint32_t read_u32(const uint8_t *p)
+    {
+        uint32_t value;
+        std::memcpy(&value, p, 4);
+        return value;
+    }
+}
+
+bool GltfAsset::load(const std::string &path, bool force_copy)
+{
+    *this = GltfAsset();
+    files.emplace_back();
+    MappedFile &file = files.back();
+    if (!file.open(path))
+    {
+        printf("ERROR::GLTF:: failed to open %s\n", path.c_str());
+        return false;
+    }
+    mapped_bytes += file.size();
+    std::string directory;
+    size_t slash = path.find_last_of("/\\");
+    if (slash != std::string::npos)
+        directory = path.substr(0, slash + 1);
+
+    // GLB：12 字节头 + JSON 块 + 可选的 BIN 块
+    const char *json_begin = reinterpret_cast<const char *>(file.data());
+    const char *json_end = json_begin + file.size();
+    const uint8_t *bin = nullptr;
+    size_t bin_size = 0;
+    if (file.size() >= 20 && read_u32(file.data()) == GLB_MAGIC)
+    {
+        size_t length = std::min<size_t>(read_u32(file.data() + 8), file.size());
+        size_t offset = 12;
+        bool has_json = false;
+        while (offset + 8 <= length)
+        {
+            size_t chunk_length = read_u32(file.data() + offset);
+            uint32_t chunk_type = read_u32(file.data() + offset + 4);
+            const uint8_t *chunk = file.data() + offset + 8;
+            if (offset + 8 + chunk_length > length)
+                break;
+            if (chunk_type == GLB_CHUNK_JSON && !has_json)
+            {
+                json_begin = reinterpret_cast<const char *>(chunk);
+                json_end = json_begin + chunk_length;
+                has_json = true;
+            }
+            else if (chunk_type == GLB_CHUNK_BIN && !bin)
+            {
+                bin = chunk;
+                bin_size = chunk_length;
+            }
+            offset += 8 + ((chunk_length + 3) & ~size_t(3));
+        }
+        if (!has_json)
+        {
+            printf("ERROR::GLTF:: %s has no JSON chunk\n", path.c_str());
+            return false;
+        }
+    }
+
+    JsonValue json;
+    if (!JsonParser(json_begin, json_end).parse(json))
+    {
+        printf("ERROR::GLTF:: %s: malformed JSON\n", path.c_str());
+        return false;
+    }
+    if (json["asset"]["version"].string_or_empty().compare(0, 1, "2") != 0)
+    {
+        printf("ERROR::GLTF:: %s is not glTF 2.0\n", path.c_str());
+        return false;
+    }
+
+    // buffers：GLB 的第一个没有 uri 的 buffer 是 BIN 块，其余为外部文件或 data URI
+    std::vector<std::pair<const uint8_t *, size_t>> buffers;
+    const JsonValue &buffer_list = json["buffers"];
+    for (size_t i = 0; i < buffer_list.size(); i++)
+    {
+        const std::string &uri = buffer_list[i]["uri"].string_or_empty();
+        if (uri.empty())
+        {
+            buffers.push_back({bin, bin_size});
+        }
+        else if (uri.compare(0, 5, "data:") == 0)
+        {
+            decoded.emplace_back();
+            if (!decode_data_uri(uri, decoded.back()))
+            {
+                printf("ERROR::GLTF:: buffer %zu has an unsupported data URI\n", i);
+                return false;
+            }
+            buffers.push_back({decoded.back().data(), decoded.back().size()});
+        }
+        else
+        {
+            files.emplace_back();
+            if (!files.back().open(directory + decode_uri(uri)))
+            {
+                printf("ERROR::GLTF:: failed to open buffer %s\n", (directory + uri).c_str());
+                return false;
+            }
+            mapped_bytes += files.back().size();
+            buffers.push_back({files.back().data(), files.back().size()});
+        }
+        if (!buffers.back().first || buffers.back().second < buffer_list[i]["byteLength"].size_or(0))
+        {
+            printf("ERROR::GLTF:: buffer %zu is missing or truncated\n", i);
+            return false;
+        }
+    }
+
+    const JsonValue &view_list = json["bufferViews"];
+    for (size_t i = 0; i < view_list.size(); i++)
+    {
+        size_t buffer = view_list[i]["buffer"].size_or(SIZE_MAX);
+        size_t offset = view_list[i]["byteOffset"].size_or(0);
+        size_t length = view_list[i]["byteLength"].size_or(0);
+        if (buffer >= buffers.size() || offset + length > buffers[buffer].second)
+        {
+            printf("ERROR::GLTF:: bufferView %zu is out of range\n", i);
+            return false;
+        }
+        GltfBufferView view;
+        view.data = buffers[buffer].first + offset;
+        view.size = length;
+        buffer_views.push_back(view);
+    }
+
+    const JsonValue &image_list = json["images"];
+    for (size_t i = 0; i < image_list.size(); i++)
+    {
+        GltfImage image;
+        const std::string &uri = image_list[i]["uri"].string_or_empty();
+        int view = image_list[i]["bufferView"].int_or(-1);
+        if (view >= 0 && size_t(view) < buffer_views.size())
+        {
+            image.data = buffer_views[view].data;
+            image.size = buffer_views[view].size;
+        }
+        else if (uri.compare(0, 5, "data:") == 0)
+        {
+            decoded.emplace_back();
+            decode_data_uri(uri, decoded.back());
+            image.data = decoded.back().data();
+            image.size = decoded.back().size();
+        }
+        else
+            image.uri = decode_uri(uri);
+        images.push_back(image);
+    }
+
+    const JsonValue &material_list = json["materials"];
+    for (size_t i = 0; i < material_list.size(); i++)
+    {
+        const JsonValue &item = material_list[i];
+        const JsonValue &pbr = item["pbrMetallicRoughness"];
+        GltfMaterial material;
+        material.name = item["name"].string_or_empty();
+        const JsonValue &factor = pbr["baseColorFactor"];
+        if (factor.size() == 4)
+            material.base_color_factor = glm::vec4(factor[0].number_or(1.0), factor[1].number_or(1.0), factor[2].number_or(1.0), factor[3].number_or(1.0));
+        material.metallic_factor = float(pbr["metallicFactor"].number_or(1.0));
+        material.roughness_factor = float(pbr["roughnessFactor"].number_or(1.0));
+        material.base_color = texture_image(json, pbr["baseColorTexture"]);
+        material.metallic_roughness = texture_image(json, pbr["metallicRoughnessTexture"]);
+        material.normal = texture_image(json, item["normalTexture"]);
+        material.occlusion = texture_image(json, item["occlusionTexture"]);
+        material.emissive = texture_image(json, item["emissiveTexture"]);
+        materials.push_back(material);
+    }
+
+    Loader loader(json, buffer_views, force_copy);
+    if (!loader.parse_accessors())
+        return false;
+    const JsonValue &mesh_list = json["meshes"];
+    meshes.resize(mesh_list.size());
+    for (size_t i = 0; i < mesh_list.size(); i++)
+        loader.parse_mesh(mesh_list[i], meshes[i], copied_bytes);
+
+    const JsonValue &node_list = json["nodes"];
+    for (size_t i = 0; i < node_list.size(); i++)
+    {
+        GltfNode node;
+        node.name = node_list[i]["name"].string_or_empty();
+        node.local = node_matrix(node_list[i]);
+        node.mesh = node_list[i]["mesh"].int_or(-1);
+        if (node.mesh >= int(meshes.size()))
+            node.mesh = -1;
+        const JsonValue &children = node_list[i]["children"];
+        for (size_t c = 0; c < children.size(); c++)
+        {
+            int child = children[c].int_or(-1);
+            if (child >= 0 && size_t(child) < node_list.size())
+                node.children.push_back(child);
+        }
+        nodes.push_back(node);
+    }
+
+    // 默认场景；没有 scenes 时所有不是别人子节点的节点都是根
+    const JsonValue &scenes = json["scenes"];
+    const JsonValue &scene_roots = scenes[json["scene"].size_or(0)]["nodes"];
+    if (!scenes.is_null() && !scene_roots.is_null())
+    {
+        for (size_t i = 0; i < scene_roots.size(); i++)
+        {
+            int root = scene_roots[i].int_or(-1);
+            if (root >= 0 && size_t(root) < nodes.size())
+                roots.push_back(root);
+        }
+    }
+    else
+    {
+        std::vector<bool> is_child(nodes.size(), false);
+        for (const GltfNode &node : nodes)
+            for (int child : node.children)
+                is_child[child] = true;
+        for (size_t i = 0; i < nodes.size(); i++)
+            if (!is_child[i])
+                roots.push_back(int(i));
+    }
+    return true;
+}
@@ -0,0 +1,94 @@
+#ifndef GLTF_LOADER_HPP
+#define GLTF_LOADER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "bounds.hpp"
+#include "mapped_file.hpp"
+#include "mesh.hpp"
+
+// 一段可以直接上传的 bufferView，data 指向映射的文件或解码后的 data URI
+struct GltfBufferView
+{
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+    bool used = false; // 被某个零拷贝图元引用，需要上传成 GL 缓冲
+};
+
+// 外部图片（uri 相对 .gltf 所在目录）或内嵌图片（GLB 的 bufferView / data URI，data 不为空）
+struct GltfImage
+{
+    std::string uri;
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+};
+
+// metallic-roughness 材质，贴图为 GltfAsset::images 下标，没有时为 -1
+struct GltfMaterial
+{
+    std::string name;
+    glm::vec4 base_color_factor = glm::vec4(1.0f);
+    float metallic_factor = 1.0f;
+    float roughness_factor = 1.0f;
+    int base_color = -1;
+    int metallic_roughness = -1; // G = 粗糙度，B = 金属度，与 texcook 的 ORM 通道一致
+    int normal = -1;
+    int occlusion = -1; // R；和 metallic_roughness 是同一张图时就是完整的 ORM
+    int emissive = -1;
+};
+
+struct GltfPrimitive
+{
+    int material = -1;
+    AABB bounds;
+    // 布局允许时属性和索引直接引用 bufferView（VertexAttribute::source 为 GltfAsset::buffer_views 下标），vertices / indices 为空；
+    // 否则（缺法线、稀疏访问器、不是三角形列表、没有索引、force_copy）展开成 Vertex
+    MeshView view;
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+
+    bool zero_copy() const { return !view.attributes.empty(); }
+};
+
+struct GltfNode
+{
+    std::string name;
+    glm::mat4 local = glm::mat4(1.0f);
+    int mesh = -1; // GltfAsset::meshes 下标
+    std::vector<int> children;
+};
+
+/**
+ * @brief glTF 2.0 加载（.glb，或 .gltf + 外部 .bin / data URI），只做 CPU 端工作，不碰 GL。
+ *        GLB 和外部 .bin 整体 mmap，JSON 用一个很小的解析器读成 DOM；
+ *        三角形列表图元的 POSITION / NORMAL / TEXCOORD_0 / TANGENT 和索引只记录成 bufferView 上的 MeshView，
+ *        上传时每个 bufferView 从映射的内存直接 glBufferData 一次，多个图元、多个节点共用，顶点数据不经过 Vertex 也不拷贝。
+ *        布局不允许时退回到逐元素读出、补法线和切线的 Vertex 网格。
+ *        纹理坐标原点与 Model 里 Assimp 的 aiProcess_FlipUVs 之后一致，不需要翻转。
+ *        不支持的部分（蒙皮、动画、变形目标、相机、灯光、纹理采样器设置）忽略。失败时打印错误并返回 false。
+ */
+class GltfAsset
+{
+public:
+    // force_copy 为 true 时所有图元都展开成 Vertex（静态烘焙需要在 CPU 上变换顶点）
+    bool load(const std::string &path, bool force_copy = false);
+
+    std::vector<GltfBufferView> buffer_views;
+    std::vector<GltfImage> images;
+    std::vector<GltfMaterial> materials;
+    std::vector<std::vector<GltfPrimitive>> meshes;
+    std::vector<GltfNode> nodes;
+    std::vector<int> roots; // 默认场景的根节点
+
+    size_t mapped_bytes = 0; // 映射的 .glb / .bin 大小
+    size_t copied_bytes = 0; // 退回路径展开成 Vertex / 索引的字节数
+
+private:
+    std::vector<MappedFile> files;             // .glb 和外部 .bin
+    std::vector<std::vector<uint8_t>> decoded; // data URI 解码结果
+};
+
+#endif // GLTF_LOADER_HPP
@@ -0,0 +1,187 @@
+#include "job_system.hpp"
+#include <algorithm>
+
+namespace
+{
+    // 当前线程所属的任务系统和队列下标，外部线程为空
+    thread_local const JobSystem *tls_owner = nullptr;
+    thread_local size_t tls_queue_index = 0;
+}
+
+JobSystem::JobSystem(unsigned int worker_count)
+{
+    if (worker_count == 0)
+    {
+        unsigned int hardware = std::thread::hardware_concurrency();
+        worker_count = hardware > 1 ? hardware - 1 : 1;
+    }
+    for (unsigned int i = 0; i <= worker_count; i++)
+        queues.push_back(std::make_unique<WorkQueue>());
+    for (unsigned int i = 0; i < worker_count; i++)
+        workers.emplace_back(&JobSystem::worker_loop, this, i);
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        running = false;
+    }
+    sleep_condition.notify_all();
+    for (auto &worker : workers)
+        worker.join();
+}
+
+size_t JobSystem::current_queue() const
+{
+    return tls_owner == this ? tls_queue_index : queues.size() - 1;
+}
+
+void JobSystem::submit(Job job, JobCounter *counter)
+{
+    if (counter)
+        counter->value.fetch_add(1, std::memory_order_relaxed);
+    {
+        WorkQueue &queue = *queues[current_queue()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(Task{std::move(job), counter});
+    }
+    queued_tasks.fetch_add(1, std::memory_order_release);
+    {
+        // 加锁后再通知，避免工作线程检查完条件、进入等待之前丢失唤醒
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+    }
+    sleep_condition.notify_one();
+}
+
+bool JobSystem::pop_local(size_t queue_index, Task &task)
+{
+    WorkQueue &queue = *queues[queue_index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+        return false;
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool JobSystem::steal(size_t thief_index, Task &task)
+{
+    size_t queue_count = queues.size();
+    for (size_t offset = 1; offset < queue_count; offset++)
+    {
+        WorkQueue &queue = *queues[(thief_index + offset) % queue_count];
+        std::unique_lock<std::mutex> lock(queue.mutex, std::try_to_lock);
+        if (!lock.owns_lock() || queue.tasks.empty())
+            continue;
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void JobSystem::execute(Task &task)
+{
+    queued_tasks.fetch_sub(1, std::memory_order_relaxed);
+    task.job();
+    if (task.counter)
+        task.counter->value.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+bool JobSystem::try_run_one(size_t queue_index)
+{
+    Task task;
+    if (pop_local(queue_index, task) || steal(queue_index, task))
+    {
+        execute(task);
+        return true;
+    }
+    return false;
+}
+
+void JobSystem::worker_loop(unsigned int index)
+{
+    tls_owner = this;
+    tls_queue_index = index;
+    while (running)
+    {
+        if (try_run_one(index))
+            continue;
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        sleep_condition.wait(lock, [this]
+                             { return !running || queued_tasks.load(std::memory_order_acquire) > 0; });
+    }
+}
+
+void JobSystem::wait(JobCounter &counter)
+{
+    size_t queue_index = current_queue();
+    while (counter.value.load(std::memory_order_acquire) > 0)
+    {
+        if (!try_run_one(queue_index))
+            std::this_thread::yield();
+    }
+}
+
+void JobSystem::parallel_for(size_t count, size_t grain, const std::function<void(size_t, size_t)> &fn)
+{
+    if (count == 0)
+        return;
+    grain = std::max<size_t>(grain, 1);
+    if (count <= grain)
+    {
+        fn(0, count);
+        return;
+    }
+    JobCounter counter;
+    for (size_t begin = 0; begin < count; begin += grain)
+    {
+        size_t end = std::min(begin + grain, count);
+        submit([&fn, begin, end]
+               { fn(begin, end); },
+               &counter);
+    }
+    wait(counter);
+}
+
+TaskGraph::TaskId TaskGraph::add(JobSystem::Job job, std::initializer_list<TaskId> dependencies)
+{
+    TaskId id = static_cast<TaskId>(nodes.size());
+    nodes.push_back(std::make_unique<Node>());
+    nodes.back()->job = std::move(job);
+    for (TaskId dependency : dependencies)
+        add_dependency(id, dependency);
+    return id;
+}
+
+void TaskGraph::add_dependency(TaskId task, TaskId dependency)
+{
+    nodes[dependency]->successors.push_back(task);
+    nodes[task]->dependency_count++;
+}
+
+void TaskGraph::launch(JobSystem &jobs, TaskId id, JobCounter &counter)
+{
+    jobs.submit([this, &jobs, id, &counter]
+                {
+                    Node &node = *nodes[id];
+                    node.job();
+                    // 后继任务在本任务的计数减一之前提交，计数器不会提前归零
+                    for (TaskId successor : node.successors)
+                        if (nodes[successor]->pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                            launch(jobs, successor, counter); },
+                &counter);
+}
+
+void TaskGraph::run(JobSystem &jobs)
+{
+    for (auto &node : nodes)
+        node->pending.store(node->dependency_count, std::memory_order_relaxed);
+
+    JobCounter counter;
+    for (TaskId id = 0; id < nodes.size(); id++)
+        if (nodes[id]->dependency_count == 0)
+            launch(jobs, id, counter);
+    jobs.wait(counter);
+}
@@ -0,0 +1,109 @@
+#ifndef JOB_SYSTEM_HPP
+#define JOB_SYSTEM_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 等待一组任务完成的计数器
+struct JobCounter
+{
+    std::atomic<int> value{0};
+};
+
+/**
+ * @brief 工作窃取任务系统。
+ *        每个工作线程有自己的双端队列：自己从尾部取（LIFO，缓存友好），空闲线程从其他队列头部偷（FIFO，偷到的粒度大）。
+ *        非工作线程（如持有 GL 上下文的主线程）提交的任务放进额外的一个队列；wait() 时调用线程也参与执行，不会空等。
+ */
+class JobSystem
+{
+public:
+    using Job = std::function<void()>;
+
+    // worker_count 为 0 时使用 硬件线程数 - 1（主线程也会参与执行）
+    explicit JobSystem(unsigned int worker_count = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+
+    // 提交任务，counter 不为空时提交前加一、完成后减一
+    void submit(Job job, JobCounter *counter = nullptr);
+
+    // 等待计数器归零，期间当前线程会执行队列中的任务
+    void wait(JobCounter &counter);
+
+    // 把 [0, count) 按 grain 切块并行执行 fn(begin, end)，阻塞直到全部完成
+    void parallel_for(size_t count, size_t grain, const std::function<void(size_t, size_t)> &fn);
+
+    unsigned int get_worker_count() const { return static_cast<unsigned int>(workers.size()); }
+    // 包括主线程在内可并行执行的线程数
+    unsigned int get_thread_count() const { return get_worker_count() + 1; }
+
+private:
+    struct Task
+    {
+        Job job;
+        JobCounter *counter;
+    };
+
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<WorkQueue>> queues; // 最后一个属于外部线程
+    std::atomic<bool> running{true};
+    std::atomic<int> queued_tasks{0};
+    std::mutex sleep_mutex;
+    std::condition_variable sleep_condition;
+
+    void worker_loop(unsigned int index);
+    size_t current_queue() const;
+    bool pop_local(size_t queue_index, Task &task);
+    bool steal(size_t thief_index, Task &task);
+    bool try_run_one(size_t queue_index);
+    void execute(Task &task);
+};
+
+/**
+ * @brief 带依赖关系的任务图。先 add 所有任务，run 时依赖都完成的任务才会被提交。
+ */
+class TaskGraph
+{
+public:
+    using TaskId = uint32_t;
+
+    TaskId add(JobSystem::Job job, std::initializer_list<TaskId> dependencies = {});
+    void add_dependency(TaskId task, TaskId dependency);
+
+    // 执行整个图，阻塞直到所有任务完成；同一个图可以每帧重复 run
+    void run(JobSystem &jobs);
+
+    void clear() { nodes.clear(); }
+    size_t size() const { return nodes.size(); }
+
+private:
+    struct Node
+    {
+        JobSystem::Job job;
+        std::vector<TaskId> successors;
+        int dependency_count = 0;
+        std::atomic<int> pending{0};
+    };
+
+    std::vector<std::unique_ptr<Node>> nodes;
+
+    void launch(JobSystem &jobs, TaskId id, JobCounter &counter);
+};
+
+#endif // JOB_SYSTEM_HPP
@@ -0,0 +1,205 @@
+#include "ktx2.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+    const uint8_t KTX2_IDENTIFIER[12] = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+    // 标识 + 9 个 uint32 的头 + DFD / KVD / SGD 索引，之后紧跟层索引
+    const size_t HEADER_SIZE = 12 + 9 * 4 + 4 * 4 + 2 * 8;
+
+    void put_u8(std::vector<uint8_t> &out, uint32_t value) { out.push_back(static_cast<uint8_t>(value)); }
+
+    void put_u16(std::vector<uint8_t> &out, uint32_t value)
+    {
+        put_u8(out, value & 0xff);
+        put_u8(out, (value >> 8) & 0xff);
+    }
+
+    void put_u32(std::vector<uint8_t> &out, uint32_t value)
+    {
+        put_u16(out, value & 0xffff);
+        put_u16(out, value >> 16);
+    }
+
+    void put_u64(std::vector<uint8_t> &out, uint64_t value)
+    {
+        put_u32(out, static_cast<uint32_t>(value));
+        put_u32(out, static_cast<uint32_t>(value >> 32));
+    }
+
+    uint32_t get_u32(const uint8_t *data)
+    {
+        return uint32_t(data[0]) | (uint32_t(data[1]) << 8) | (uint32_t(data[2]) << 16) | (uint32_t(data[3]) << 24);
+    }
+
+    uint64_t get_u64(const uint8_t *data)
+    {
+        return uint64_t(get_u32(data)) | (uint64_t(get_u32(data + 4)) << 32);
+    }
+
+    void pad_to(std::vector<uint8_t> &out, size_t alignment)
+    {
+        while (out.size() % alignment)
+            out.push_back(0);
+    }
+
+    // Khronos Data Format 基本描述块：颜色模型 + 每个 BC 子块一个 sample
+    std::vector<uint8_t> build_dfd(BlockFormat format)
+    {
+        struct Sample
+        {
+            uint32_t bit_offset, bit_length, channel;
+        };
+        uint8_t color_model;
+        Sample samples[2] = {};
+        uint32_t sample_count = 1;
+        switch (format)
+        {
+        case BlockFormat::BC1:
+            color_model = 128; // KHR_DF_MODEL_BC1A
+            samples[0] = {0, 64, 0};
+            break;
+        case BlockFormat::BC3:
+            color_model = 130; // KHR_DF_MODEL_BC3：alpha 块在前
+            samples[0] = {0, 64, 15};
+            samples[1] = {64, 64, 0};
+            sample_count = 2;
+            break;
+        case BlockFormat::BC4:
+            color_model = 131; // KHR_DF_MODEL_BC4
+            samples[0] = {0, 64, 0};
+            break;
+        case BlockFormat::BC5:
+            color_model = 132; // KHR_DF_MODEL_BC5：红、绿两个块
+            samples[0] = {0, 64, 0};
+            samples[1] = {64, 64, 1};
+            sample_count = 2;
+            break;
+        case BlockFormat::BC7:
+        default:
+            color_model = 134; // KHR_DF_MODEL_BC7
+            samples[0] = {0, 128, 0};
+            break;
+        }
+
+        std::vector<uint8_t> block;
+        uint32_t block_size = 24 + 16 * sample_count;
+        put_u32(block, 4 + block_size);          // dfdTotalSize
+        put_u32(block, 0);                       // vendorId = KHRONOS, descriptorType = BASICFORMAT
+        put_u32(block, 2 | (block_size << 16));  // versionNumber = 1.3, descriptorBlockSize
+        put_u8(block, color_model);
+        put_u8(block, 1);                        // BT.709 原色
+        put_u8(block, 1);                        // 线性传输：与 GL_RGB 加载的 PNG 一致，由着色器自己做 gamma
+        put_u8(block, 0);                        // 直通 alpha
+        put_u32(block, 3 | (3 << 8));            // 4x4x1x1 块（各维减一）
+        put_u32(block, static_cast<uint32_t>(block_bytes(format)));
+        put_u32(block, 0);
+        for (uint32_t i = 0; i < sample_count; i++)
+        {
+            const Sample &sample = samples[i];
+            put_u16(block, sample.bit_offset);
+            put_u8(block, sample.bit_length - 1);
+            put_u8(block, sample.channel);
+            put_u32(block, 0); // samplePosition
+            put_u32(block, 0);
+            put_u32(block, 0xffffffffu);
+        }
+        return block;
+    }
+}
+
+bool read_ktx2_header(const uint8_t *data, size_t size, Ktx2Header &header)
+{
+    if (size < HEADER_SIZE || std::memcmp(data, KTX2_IDENTIFIER, 12) != 0)
+        return false;
+    header.vk_format = get_u32(data + 12);
+    header.width = get_u32(data + 20);
+    header.height = get_u32(data + 24);
+    header.depth = get_u32(data + 28);
+    header.layers = get_u32(data + 32);
+    header.faces = get_u32(data + 36);
+    uint32_t level_count = std::max(1u, get_u32(data + 40));
+    header.supercompression = get_u32(data + 44);
+    if (size < HEADER_SIZE + size_t(level_count) * 24)
+        return false;
+
+    header.levels.resize(level_count);
+    for (uint32_t i = 0; i < level_count; i++)
+    {
+        const uint8_t *entry = data + HEADER_SIZE + size_t(i) * 24;
+        header.levels[i].offset = get_u64(entry);
+        header.levels[i].length = get_u64(entry + 8);
+        if (header.levels[i].offset > size || header.levels[i].length > size - header.levels[i].offset)
+            return false;
+    }
+    return true;
+}
+
+bool write_ktx2(const std::string &path, BlockFormat format, int width, int height, const std::vector<std::vector<uint8_t>> &levels)
+{
+    const uint32_t level_count = static_cast<uint32_t>(levels.size());
+
+    std::vector<uint8_t> dfd = build_dfd(format);
+    std::vector<uint8_t> kvd;
+    {
+        const char key_value[] = "KTXwriter\0texcook";
+        put_u32(kvd, sizeof(key_value));
+        kvd.insert(kvd.end(), key_value, key_value + sizeof(key_value));
+        pad_to(kvd, 4);
+    }
+
+    size_t dfd_offset = HEADER_SIZE + size_t(level_count) * 24;
+    size_t kvd_offset = dfd_offset + dfd.size();
+    size_t data_offset = kvd_offset + kvd.size();
+
+    // 数据区从最小的一层开始写，每层按块大小对齐
+    size_t alignment = block_bytes(format);
+    std::vector<uint64_t> offsets(level_count);
+    for (uint32_t i = level_count; i-- > 0;)
+    {
+        data_offset = (data_offset + alignment - 1) / alignment * alignment;
+        offsets[i] = data_offset;
+        data_offset += levels[i].size();
+    }
+
+    std::vector<uint8_t> file(KTX2_IDENTIFIER, KTX2_IDENTIFIER + 12);
+    put_u32(file, block_vk_format(format));
+    put_u32(file, 1); // typeSize
+    put_u32(file, static_cast<uint32_t>(width));
+    put_u32(file, static_cast<uint32_t>(height));
+    put_u32(file, 0); // pixelDepth
+    put_u32(file, 0); // layerCount
+    put_u32(file, 1); // faceCount
+    put_u32(file, level_count);
+    put_u32(file, 0); // supercompressionScheme
+    put_u32(file, static_cast<uint32_t>(dfd_offset));
+    put_u32(file, static_cast<uint32_t>(dfd.size()));
+    put_u32(file, static_cast<uint32_t>(kvd_offset));
+    put_u32(file, static_cast<uint32_t>(kvd.size()));
+    put_u64(file, 0); // sgdByteOffset
+    put_u64(file, 0); // sgdByteLength
+    for (uint32_t i = 0; i < level_count; i++)
+    {
+        put_u64(file, offsets[i]);
+        put_u64(file, levels[i].size());
+        put_u64(file, levels[i].size());
+    }
+    file.insert(file.end(), dfd.begin(), dfd.end());
+    file.insert(file.end(), kvd.begin(), kvd.end());
+    for (uint32_t i = level_count; i-- > 0;)
+    {
+        file.resize(offsets[i], 0);
+        file.insert(file.end(), levels[i].begin(), levels[i].end());
+    }
+
+    std::ofstream stream(path, std::ios::binary);
+    if (!stream || !stream.write(reinterpret_cast<const char *>(file.data()), file.size()))
+    {
+        printf("ERROR::KTX2:: failed to write %s\n", path.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,37 @@
+#ifndef KTX2_HPP
+#define KTX2_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "block_compression.hpp"
+
+struct Ktx2Level
+{
+    uint64_t offset; // 相对文件开头
+    uint64_t length;
+};
+
+// KTX2 头里运行时需要的字段
+struct Ktx2Header
+{
+    uint32_t vk_format = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t depth = 0;
+    uint32_t layers = 0;
+    uint32_t faces = 0;
+    uint32_t supercompression = 0;
+    std::vector<Ktx2Level> levels; // levels[0] 为最大的一层
+};
+
+// 解析并校验文件头和层索引（各层数据都在 size 范围内），不拷贝像素数据
+bool read_ktx2_header(const uint8_t *data, size_t size, Ktx2Header &header);
+
+/**
+ * @brief 写 KTX2 容器（不做超压缩）。levels[0] 为最大的一层，每层是 compress_image 的输出。
+ *        数据描述块（DFD）按 KTX2 规范为 BC 格式填写，其他工具（ktx info、RenderDoc）可以直接打开。
+ */
+bool write_ktx2(const std::string &path, BlockFormat format, int width, int height, const std::vector<std::vector<uint8_t>> &levels);
+
+#endif // KTX2_HPP
@@ -33,57 +33,57 @@ void LightManager::clear_lights()
     area_lights.clear();
 }
 
-void LightManager::apply_lights(const std::shared_ptr<Shader> &shader)
+void LightManager::apply_lights(Shader &shader)
 {
 
     // 传递 PointLights
-    shader->use();
+    shader.use();
     for (size_t i = 0; i < point_lights.size(); ++i)
     {
-        shader->setVec3("point_lights[" + std::to_string(i) + "].position", point_lights[i].position);
-        shader->setVec3("point_lights[" + std::to_string(i) + "].color", point_lights[i].color);
-        shader->setFloat("point_lights[" + std::to_string(i) + "].constant", point_lights[i].constant);
-        shader->setFloat("point_lights[" + std::to_string(i) + "].linear", point_lights[i].linear);
-        shader->setFloat("point_lights[" + std::to_string(i) + "].quadratic", point_lights[i].quadratic);
+        shader.setVec3("point_lights[" + std::to_string(i) + "].position", point_lights[i].position);
+        shader.setVec3("point_lights[" + std::to_string(i) + "].color", point_lights[i].color);
+        shader.setFloat("point_lights[" + std::to_string(i) + "].constant", point_lights[i].constant);
+        shader.setFloat("point_lights[" + std::to_string(i) + "].linear", point_lights[i].linear);
+        shader.setFloat("point_lights[" + std::to_string(i) + "].quadratic", point_lights[i].quadratic);
     }
     if (point_lights.size() > 0)
-        shader->setInt("num_point_lights", point_lights.size());
+        shader.setInt("num_point_lights", point_lights.size());
 
     // 传递 DirectionalLights
     for (size_t i = 0; i < directional_lights.size(); ++i)
     {
-        shader->setVec3("directional_lights[" + std::to_string(i) + "].direction", directional_lights[i].direction);
-        shader->setVec3("directional_lights[" + std::to_string(i) + "].color", directional_lights[i].color);
+        shader.setVec3("directional_lights[" + std::to_string(i) + "].direction", directional_lights[i].direction);
+        shader.setVec3("directional_lights[" + std::to_string(i) + "].color", directional_lights[i].color);
     }
     if (directional_lights.size() > 0)
-        shader->setInt("num_directional_lights", directional_lights.size());
+        shader.setInt("num_directional_lights", directional_lights.size());
 
     // 传递 SpotLights
     for (size_t i = 0; i < spot_lights.size(); ++i)
     {
-        shader->setVec3("spot_lights[" + std::to_string(i) + "].position", spot_lights[i].position);
-        shader->setVec3("spot_lights[" + std::to_string(i) + "].direction", spot_lights[i].direction);
-        shader->setVec3("spot_lights[" + std::to_string(i) + "].color", spot_lights[i].color);
-        shader->setFloat("spot_lights[" + std::to_string(i) + "].cutOff", spot_lights[i].cutOff);
-        shader->setFloat("spot_lights[" + std::to_string(i) + "].outerCutOff", spot_lights[i].outerCutOff);
-        shader->setFloat("spot_lights[" + std::to_string(i) + "].constant", spot_lights[i].constant);
-        shader->setFloat("spot_lights[" + std::to_string(i) + "].linear", spot_lights[i].linear);
-        shader->setFloat("spot_lights[" + std::to_string(i) + "].quadratic", spot_lights[i].quadratic);
+        shader.setVec3("spot_lights[" + std::to_string(i) + "].position", spot_lights[i].position);
+        shader.setVec3("spot_lights[" + std::to_string(i) + "].direction", spot_lights[i].direction);
+        shader.setVec3("spot_lights[" + std::to_string(i) + "].color", spot_lights[i].color);
+        shader.setFloat("spot_lights[" + std::to_string(i) + "].cutOff", spot_lights[i].cutOff);
+        shader.setFloat("spot_lights[" + std::to_string(i) + "].outerCutOff", spot_lights[i].outerCutOff);
+        shader.setFloat("spot_lights[" + std::to_string(i) + "].constant", spot_lights[i].constant);
+        shader.setFloat("spot_lights[" + std::to_string(i) + "].linear", spot_lights[i].linear);
+        shader.setFloat("spot_lights[" + std::to_string(i) + "].quadratic", spot_lights[i].quadratic);
     }
     if (spot_lights.size() > 0)
-        shader->setInt("num_spot_lights", spot_lights.size());
+        shader.setInt("num_spot_lights", spot_lights.size());
 
     // 传递 AreaLights
     for (size_t i = 0; i < area_lights.size(); i++)
     {
         const auto &light = area_lights[i];
-        shader->setVec3("area_lights[" + std::to_string(i) + "].position", light.position);
-        shader->setVec3("area_lights[" + std::to_string(i) + "].normal", light.normal);
-        shader->setVec3("area_lights[" + std::to_string(i) + "].color", light.color / static_cast<float>(light.num_samples));
-        shader->setFloat("area_lights[" + std::to_string(i) + "].width", light.width);
-        shader->setFloat("area_lights[" + std::to_string(i) + "].height", light.height);
-        shader->setInt("area_lights[" + std::to_string(i) + "].num_samples", light.num_samples);
+        shader.setVec3("area_lights[" + std::to_string(i) + "].position", light.position);
+        shader.setVec3("area_lights[" + std::to_string(i) + "].normal", light.normal);
+        shader.setVec3("area_lights[" + std::to_string(i) + "].color", light.color / static_cast<float>(light.num_samples));
+        shader.setFloat("area_lights[" + std::to_string(i) + "].width", light.width);
+        shader.setFloat("area_lights[" + std::to_string(i) + "].height", light.height);
+        shader.setInt("area_lights[" + std::to_string(i) + "].num_samples", light.num_samples);
     }
     if (area_lights.size() > 0)
-        shader->setInt("num_area_lights", area_lights.size());
+        shader.setInt("num_area_lights", area_lights.size());
 }
@@ -7,42 +7,13 @@
 #include "GLFW/glfw3.h"
 #include "GLFW/glfw3native.h"
 #include "stb_image.h"
+#include "gl_registry.hpp"
+#include "texture_loader.hpp"
 
+// 有同名 .ktx2 / .dds 时直接上传压缩数据，见 texture_loader.hpp
 GLuint load_texture(const char *imagepath)
 {
-    unsigned int texture;
-    glGenTextures(1, &texture);
-    // 加载并生成纹理
-    int width, height, nrChannels;
-    unsigned char *data = stbi_load(imagepath, &width, &height, &nrChannels, 0);
-    if (data)
-    {
-        GLenum format;
-        if (nrChannels == 1)
-            format = GL_RED;
-        else if (nrChannels == 3)
-            format = GL_RGB;
-        else if (nrChannels == 4)
-            format = GL_RGBA;
-
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        // 为当前绑定的纹理对象设置环绕、过滤方式
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        std::cout << "Texture loaded:" << imagepath << std::endl;
-    }
-    else
-    {
-        std::cout << "Failed to load texture" << imagepath << std::endl;
-    }
-    stbi_image_free(data);
-    return texture;
+    return load_texture_file(imagepath);
 }
 
 // loads a cubemap texture from 6 individual texture faces
@@ -56,14 +27,13 @@ GLuint load_texture(const char *imagepath)
 // -------------------------------------------------------
 GLuint load_cubemap(std::vector<std::string> faces)
 {
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
+    unsigned int textureID = GL_CREATE(TEXTURE, faces.empty() ? std::string() : faces[0]);
     glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
 
-    int width, height, nrChannels;
+    int width = 0, height = 0, nrChannels;
     for (unsigned int i = 0; i < faces.size(); i++)
     {
-        unsigned char *data = stbi_load(faces[i].c_str(), &width, &height, &nrChannels, 0);
+        unsigned char *data = load_image_pixels(faces[i], &width, &height, &nrChannels);
         if (data)
         {
             glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
@@ -76,6 +46,7 @@ GLuint load_cubemap(std::vector<std::string> faces)
             stbi_image_free(data);
         }
     }
+    GLRegistry::instance().set_bytes(GLObjectType::TEXTURE, textureID, GLRegistry::texture_bytes(GL_RGB, width, height, 6));
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -88,18 +59,22 @@ GLuint load_cubemap(std::vector<std::string> faces)
 // 加载 HDR 图像并创建 OpenGL 纹理
 GLuint load_HDR_texture(const char *imagepath, const int &format = GL_RGB16F)
 {
-    stbi_set_flip_vertically_on_load(true); // 翻转图像以匹配 OpenGL 的坐标系
+    // 翻转图像以匹配 OpenGL 的坐标系；只改当前线程的设置，TextureUploadQueue 在工作线程上解码的普通纹理不受影响
+    stbi_set_flip_vertically_on_load_thread(true);
     int width, height, nrComponents;
-    float *data = stbi_loadf(imagepath, &width, &height, &nrComponents, 0);
+    float *data = load_image_pixels_float(imagepath, &width, &height, &nrComponents);
+    // 恢复默认，避免之后加载的普通纹理被意外翻转（压缩纹理不翻转）
+    stbi_set_flip_vertically_on_load_thread(false);
     unsigned int textureID;
 
     if (data)
     {
-        glGenTextures(1, &textureID);
+        textureID = GL_CREATE(TEXTURE, imagepath);
         glBindTexture(GL_TEXTURE_2D, textureID);
 
         // 使用 GL_RGB16F 或 GL_RGB32F 以支持 HDR 的浮点精度
         glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, GL_RGB, GL_FLOAT, data);
+        GLRegistry::instance().set_bytes(GLObjectType::TEXTURE, textureID, GLRegistry::texture_bytes(format, width, height));
 
         // 纹理参数
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
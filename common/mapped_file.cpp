@@ -0,0 +1,117 @@
+#include "mapped_file.hpp"
+#include "asset_archive.hpp"
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+        std::swap(bytes, other.bytes);
+        std::swap(length, other.length);
+        std::swap(mapped, other.mapped);
+        std::swap(decoded, other.decoded);
+#ifdef _WIN32
+        std::swap(mapping, other.mapping);
+#endif
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::string &path)
+{
+    close();
+    if (AssetArchive::instance().read(path, bytes, length, decoded))
+    {
+        // 与磁盘上的空文件一样视为失败
+        if (length == 0)
+            close();
+        return bytes != nullptr;
+    }
+    return open_file(path);
+}
+
+bool MappedFile::open_file(const std::string &path)
+{
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+    // 映射对象持有文件的引用，文件句柄可以立即关闭
+    HANDLE file_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!file_mapping)
+        return false;
+    void *view = MapViewOfFile(file_mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view)
+    {
+        CloseHandle(file_mapping);
+        return false;
+    }
+    mapping = file_mapping;
+    bytes = static_cast<const uint8_t *>(view);
+    length = static_cast<size_t>(file_size.QuadPart);
+#else
+    int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0)
+        return false;
+    struct stat info;
+    if (fstat(file, &info) != 0 || info.st_size == 0)
+    {
+        ::close(file);
+        return false;
+    }
+    void *view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    ::close(file);
+    if (view == MAP_FAILED)
+        return false;
+    bytes = static_cast<const uint8_t *>(view);
+    length = static_cast<size_t>(info.st_size);
+#endif
+    mapped = true;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (!mapped)
+    {
+        bytes = nullptr;
+        length = 0;
+        std::vector<uint8_t>().swap(decoded);
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(bytes);
+    CloseHandle(mapping);
+    mapping = nullptr;
+#else
+    munmap(const_cast<uint8_t *>(bytes), length);
+#endif
+    mapped = false;
+    bytes = nullptr;
+    length = 0;
+}
@@ -0,0 +1,45 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 只读内存映射文件。数据按需由操作系统换页读入，不经过额外的拷贝；只能移动，析构时解除映射。
+ *        open 先查已挂载的资源包（见 asset_archive.hpp），包里有这个路径时直接引用包内数据，压缩的条目解压到自己的缓冲。
+ */
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string &path) { open(path); }
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+
+    // 失败（文件不存在、空文件）时返回 false，不打印错误
+    bool open(const std::string &path);
+    // 只映射磁盘上的文件，不查资源包（资源包本身和打包工具用它）
+    bool open_file(const std::string &path);
+    void close();
+
+    bool is_open() const { return bytes != nullptr; }
+    const uint8_t *data() const { return bytes; }
+    size_t size() const { return length; }
+
+private:
+    const uint8_t *bytes = nullptr;
+    size_t length = 0;
+    bool mapped = false;          // bytes 是自己的映射；否则指向资源包或 decoded
+    std::vector<uint8_t> decoded; // 资源包里压缩条目的解压结果
+#ifdef _WIN32
+    void *mapping = nullptr; // CreateFileMapping 返回的句柄
+#endif
+};
+
+#endif // MAPPED_FILE_HPP
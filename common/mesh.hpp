@@ -6,8 +6,13 @@
 #include "glm/gtc/matrix_transform.hpp"
 
 #include "shader.hpp"
+#include "bounds.hpp"
+#include "render_stats.hpp"
+#include "gl_handle.hpp"
 
+#include <cstring>
 #include <string>
+#include <utility>
 #include <vector>
 #include <map>
 
@@ -33,38 +38,126 @@ struct Vertex
     float m_Weights[MAX_BONE_INFLUENCE];
 };
 
+// 位置拆成单独的流时，其余属性的交错布局（76 字节）
+struct ShadingVertex
+{
+    glm::vec3 Normal;
+    glm::vec2 TexCoords;
+    glm::vec3 Tangent;
+    glm::vec3 Bitangent;
+    int m_BoneIDs[MAX_BONE_INFLUENCE];
+    float m_Weights[MAX_BONE_INFLUENCE];
+};
+
+// DrawGeometry 用哪个 VAO：SHADING 带全部属性；DEPTH 只有位置（location 0），给深度预通道、阴影这类只写深度的通道
+enum class MeshPass
+{
+    SHADING,
+    DEPTH,
+};
+
 struct Texture
 {
     unsigned int id;
-    string type; // 例如: "texture_diffuse", "texture_specular", "texture_normal", "texture_metallic"
+    string type; // 例如: "texture_diffuse", "texture_specular", "texture_normal", "texture_metallic", "texture_orm"
     string path;
 };
 
+// 直接引用外部缓冲（如 glTF 的 bufferView）的一个顶点属性，数据不经过 Vertex
+struct VertexAttribute
+{
+    GLuint location;
+    GLint size;
+    GLenum type;
+    GLboolean normalized;
+    GLsizei stride; // 0 为紧密排列
+    size_t offset;  // 在缓冲中的字节偏移
+    int source;     // 缓冲在持有者那里的下标
+    GLuint buffer;  // 上传前为 0，由持有缓冲的一方在 Mesh::upload 之前填写
+};
+
+// 外部缓冲上的网格：各属性和索引都只是缓冲里的一段
+struct MeshView
+{
+    vector<VertexAttribute> attributes;
+    int indexSource = -1;
+    GLuint indexBuffer = 0;
+    size_t indexOffset = 0;
+    GLenum indexType = GL_UNSIGNED_INT; // GL_UNSIGNED_BYTE / SHORT / INT
+    GLsizei indexCount = 0;
+    size_t vertexCount = 0;
+};
+
 class Mesh
 {
 public:
     // mesh Data
     vector<Vertex> vertices;
     vector<unsigned int> indices;
-    vector<Texture> textures;
-    unsigned int VAO;
+    vector<Texture> textures; // 纹理归 Model 所有，这里只引用
+    VertexArrayHandle VAO;      // 着色用，全部属性
+    VertexArrayHandle depthVAO; // 只有位置；交错布局的网格没有，DEPTH 通道退回 VAO
+    AABB bounds; // 模型空间包围盒
+    int arrayLayer = -1; // Model::buildTextureArray 之后为该网格纹理在数组中的层
+    MeshView view;       // 外部缓冲网格的布局，普通网格的 attributes 为空
 
     // constructor
-    Mesh(vector<Vertex> vertices, vector<unsigned int> indices, vector<Texture> textures)
-        : vertices(vertices), indices(indices), textures(textures)
+    // upload 为 false 时只保存 CPU 数据（可以在工作线程构造），之后在 GL 线程调用 upload()
+    Mesh(vector<Vertex> vertices, vector<unsigned int> indices, vector<Texture> textures, bool upload = true)
+        : vertices(std::move(vertices)), indices(std::move(indices)), textures(std::move(textures))
+    {
+        for (const Vertex &vertex : this->vertices)
+            bounds.expand(vertex.Position);
+        if (upload)
+            setupMesh();
+    }
+
+    // 外部缓冲上的网格：vertices / indices 为空，upload 只创建 VAO，缓冲归调用者所有
+    Mesh(MeshView view, vector<Texture> textures, const AABB &bounds)
+        : textures(std::move(textures)), bounds(bounds), view(std::move(view))
+    {
+    }
+
+    // 持有 GL 对象，只能移动
+    Mesh(Mesh &&) = default;
+    Mesh &operator=(Mesh &&) = default;
+    Mesh(const Mesh &) = delete;
+    Mesh &operator=(const Mesh &) = delete;
+
+    // 创建顶点 / 索引缓冲，已经上传过时什么也不做
+    void upload()
     {
-        setupMesh();
+        if (!VAO)
+            setupMesh();
     }
+    bool isUploaded() const { return static_cast<bool>(VAO); }
+    // 上传时写入的字节数，用于分帧上传的预算；外部缓冲网格不写缓冲
+    size_t gpuBytes() const { return vertices.size() * sizeof(Vertex) + indices.size() * sizeof(unsigned int); }
+    bool isView() const { return !view.attributes.empty(); }
+    // 上传时把位置单独放进一个紧密的流（12 字节 / 顶点），其余属性放进 ShadingVertex 流（76 字节），
+    // 深度通道的 VAO 只读位置流，总大小与交错布局相同；关闭时是一个 88 字节的交错流，深度通道也读它。
+    // 只影响之后上传的网格。外部缓冲网格本来就是分开的流，总有深度 VAO
+    static bool &separatePositionStream()
+    {
+        static bool enabled = true;
+        return enabled;
+    }
+    GLsizei indexCount() const { return isView() ? view.indexCount : static_cast<GLsizei>(indices.size()); }
 
-    unsigned int createDefaultTexture()
+    // 缺少某类贴图时绑定的 1x1 白色纹理，所有网格共用一张
+    static unsigned int getDefaultTexture()
     {
-        unsigned int textureID;
-        glGenTextures(1, &textureID);
+        static unsigned int textureID = 0;
+        if (textureID != 0)
+            return textureID;
+        textureID = GL_CREATE(TEXTURE, "mesh default white");
         glBindTexture(GL_TEXTURE_2D, textureID);
 
         // 创建一个 1x1 的白色像素数据
         unsigned char whitePixel[3] = {255, 255, 255}; // 白色或其他中性色
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 1, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, whitePixel);
+        GLRegistry::instance().set_bytes(GLObjectType::TEXTURE, textureID, GLRegistry::texture_bytes(GL_RGB, 1, 1));
+        GLRegistry::instance().set_persistent(GLObjectType::TEXTURE, textureID);
 
         // 设置纹理参数
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -77,96 +170,211 @@ public:
     // render the mesh
     void Draw(Shader &shader)
     {
+        if (!VAO)
+            return; // 还没上传
         // 确保所有 PBR 纹理都绑定到固定的纹理单元位置
-        unsigned int defaultTextureID = createDefaultTexture(); // 初始化时调用一次
+        unsigned int defaultTextureID = getDefaultTexture();
         unsigned int textureUnit = 0;
 
-        for (const auto &type : {"texture_diffuse", "texture_specular", "texture_normal",
-                                 "texture_height", "texture_metallic", "texture_roughness", "texture_ao"})
+        auto findTexture = [this](const char *type) -> const Texture *
         {
-            bool textureFound = false;
-
-            for (unsigned int i = 0; i < textures.size(); i++)
-            {
-                if (textures[i].type == type)
-                {
-                    // 激活指定的纹理单元并绑定
-                    glActiveTexture(GL_TEXTURE0 + textureUnit);
-                    glBindTexture(GL_TEXTURE_2D, textures[i].id);
-
-                    // 将对应 uniform 设置为这个纹理单元
-                    glUniform1i(glGetUniformLocation(shader.ID, (std::string(type) + "1").c_str()), textureUnit);
-                    // printf("name: %s, number: %d\n", (std::string(type) + "1").c_str(), textureUnit);
-
-                    textureFound = true;
-                    break; // 该类型找到就可以跳出循环
-                }
-            }
-
-            if (!textureFound)
-            {
-                glActiveTexture(GL_TEXTURE0 + textureUnit);
-                glBindTexture(GL_TEXTURE_2D, defaultTextureID); // 使用默认的白色纹理
-            }
-
+            for (const Texture &texture : textures)
+                if (texture.type == type)
+                    return &texture;
+            return nullptr;
+        };
+        auto bindTexture = [&](const Texture *texture, const char *uniform)
+        {
+            // 激活指定的纹理单元并绑定；缺少这类贴图或分阶段加载时纹理还没创建（id 为 0）先用白色
+            glActiveTexture(GL_TEXTURE0 + textureUnit);
+            glBindTexture(GL_TEXTURE_2D, texture && texture->id ? texture->id : defaultTextureID);
+            count_texture_bind();
+            // 将对应 uniform 设置为这个纹理单元
+            glUniform1i(glGetUniformLocation(shader.ID, uniform), textureUnit);
             textureUnit++;
+        };
+
+        // 单元 0-6 依次为下面七类贴图，uniform 名为 <类型>1
+        // ORM 纹理（R = AO，G = 粗糙度，B = 金属度）固定在单元 7 的 texture_orm1，有它时 use_texture_orm 为真，
+        // 着色器从 G / B 读粗糙度和金属度；AO 始终读 texture_ao1.r，没有单独的 AO 贴图时 ORM 同时绑到 AO 单元
+        // glTF 的 metallicRoughness 贴图 R 通道不是 AO，同样占单元 7，但不当作 AO
+        const Texture *orm = findTexture("texture_orm");
+        const Texture *metallicRoughness = orm ? orm : findTexture("texture_metallic_roughness");
+        for (const char *type : {"texture_diffuse", "texture_specular", "texture_normal",
+                                 "texture_height", "texture_metallic", "texture_roughness", "texture_ao"})
+        {
+            const Texture *texture = findTexture(type);
+            if (!texture && std::strcmp(type, "texture_ao") == 0)
+                texture = orm;
+            bindTexture(texture, (std::string(type) + "1").c_str());
         }
+        bindTexture(metallicRoughness, "texture_orm1");
+        glUniform1i(glGetUniformLocation(shader.ID, "use_texture_orm"), metallicRoughness != nullptr);
 
         // draw mesh
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, static_cast<unsigned int>(indices.size()), GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
+        DrawGeometry();
 
         // always good practice to set everything back to defaults once configured.
         glActiveTexture(GL_TEXTURE0);
     }
 
+    // 只绘制几何体，纹理由调用者绑定
+    void DrawGeometry(MeshPass pass = MeshPass::SHADING)
+    {
+        if (!VAO)
+            return;
+        glBindVertexArray(pass == MeshPass::DEPTH && depthVAO ? depthVAO.get() : VAO.get());
+        glDrawElements(GL_TRIANGLES, indexCount(), view.indexType, (void *)view.indexOffset);
+        count_vertex_array_bind();
+        count_draw(GL_TRIANGLES, indexCount());
+        glBindVertexArray(0);
+    }
+
 private:
     // render data
-    unsigned int VBO, EBO;
+    BufferHandle VBO, EBO;
+    BufferHandle positionVBO; // separatePositionStream 时的位置流，VBO 里是 ShadingVertex
+
+    // 位置以外的属性（1 ~ 6），V 为 Vertex 或 ShadingVertex，数据在当前绑定的 GL_ARRAY_BUFFER 里
+    template <typename V>
+    static void setShadingAttributes()
+    {
+        glEnableVertexAttribArray(1); // 法线
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(V), (void *)offsetof(V, Normal));
+
+        glEnableVertexAttribArray(2); // 纹理坐标
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(V), (void *)offsetof(V, TexCoords));
+
+        glEnableVertexAttribArray(3); // 切线
+        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(V), (void *)offsetof(V, Tangent));
+
+        glEnableVertexAttribArray(4); // 副切线
+        glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(V), (void *)offsetof(V, Bitangent));
+
+        glEnableVertexAttribArray(5); // 骨骼ID
+        glVertexAttribIPointer(5, 4, GL_INT, sizeof(V), (void *)offsetof(V, m_BoneIDs));
+
+        glEnableVertexAttribArray(6); // 骨骼权重
+        glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(V), (void *)offsetof(V, m_Weights));
+    }
 
     // initializes all the buffer objects/arrays
     void setupMesh()
     {
+        if (isView())
+        {
+            setupView();
+            return;
+        }
+        if (separatePositionStream())
+        {
+            setupSplitStreams();
+            return;
+        }
         // create buffers/arrays
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glGenBuffers(1, &EBO);
+        VAO.reset(GL_CREATE(VERTEX_ARRAY, "mesh"));
+        VBO.reset(GL_CREATE(BUFFER, "mesh vertices"));
 
-        glBindVertexArray(VAO);
+        glBindVertexArray(VAO.get());
         // load data into vertex buffers
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO.get());
         // A great thing about structs is that their memory layout is sequential for all its items.
         // The effect is that we can simply pass a pointer to the struct and it translates perfectly to a glm::vec3/2 array which
         // again translates to 3/2 floats which translates to a byte array.
         glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+        GLRegistry::instance().set_bytes(GLObjectType::BUFFER, VBO.get(), vertices.size() * sizeof(Vertex));
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+        uploadIndices();
 
         // set the vertex attribute pointers
         glEnableVertexAttribArray(0); // 位置
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)0);
+        setShadingAttributes<Vertex>();
 
-        glEnableVertexAttribArray(1); // 法线
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, Normal));
+        glBindVertexArray(0);
+    }
 
-        glEnableVertexAttribArray(2); // 纹理坐标
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, TexCoords));
+    void uploadIndices()
+    {
+        EBO.reset(GL_CREATE(BUFFER, "mesh indices"));
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO.get());
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+        GLRegistry::instance().set_bytes(GLObjectType::BUFFER, EBO.get(), indices.size() * sizeof(unsigned int));
+    }
 
-        glEnableVertexAttribArray(3); // 切线
-        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, Tangent));
+    // 位置流 + ShadingVertex 流，两个 VAO 共用位置流和索引缓冲
+    void setupSplitStreams()
+    {
+        vector<glm::vec3> positions(vertices.size());
+        vector<ShadingVertex> shading(vertices.size());
+        for (size_t i = 0; i < vertices.size(); i++)
+        {
+            const Vertex &vertex = vertices[i];
+            positions[i] = vertex.Position;
+            ShadingVertex &target = shading[i];
+            target.Normal = vertex.Normal;
+            target.TexCoords = vertex.TexCoords;
+            target.Tangent = vertex.Tangent;
+            target.Bitangent = vertex.Bitangent;
+            std::memcpy(target.m_BoneIDs, vertex.m_BoneIDs, sizeof(target.m_BoneIDs));
+            std::memcpy(target.m_Weights, vertex.m_Weights, sizeof(target.m_Weights));
+        }
 
-        glEnableVertexAttribArray(4); // 副切线
-        glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, Bitangent));
+        positionVBO.reset(GL_CREATE(BUFFER, "mesh positions"));
+        glBindBuffer(GL_ARRAY_BUFFER, positionVBO.get());
+        glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec3), positions.data(), GL_STATIC_DRAW);
+        GLRegistry::instance().set_bytes(GLObjectType::BUFFER, positionVBO.get(), positions.size() * sizeof(glm::vec3));
+        VBO.reset(GL_CREATE(BUFFER, "mesh shading attributes"));
+        glBindBuffer(GL_ARRAY_BUFFER, VBO.get());
+        glBufferData(GL_ARRAY_BUFFER, shading.size() * sizeof(ShadingVertex), shading.data(), GL_STATIC_DRAW);
+        GLRegistry::instance().set_bytes(GLObjectType::BUFFER, VBO.get(), shading.size() * sizeof(ShadingVertex));
+
+        VAO.reset(GL_CREATE(VERTEX_ARRAY, "mesh"));
+        glBindVertexArray(VAO.get());
+        uploadIndices();
+        glBindBuffer(GL_ARRAY_BUFFER, positionVBO.get());
+        glEnableVertexAttribArray(0); // 位置
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void *)0);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO.get());
+        setShadingAttributes<ShadingVertex>();
 
-        glEnableVertexAttribArray(5); // 骨骼ID
-        glVertexAttribIPointer(5, 4, GL_INT, sizeof(Vertex), (void *)offsetof(Vertex, m_BoneIDs));
+        depthVAO.reset(GL_CREATE(VERTEX_ARRAY, "mesh depth"));
+        glBindVertexArray(depthVAO.get());
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO.get());
+        glBindBuffer(GL_ARRAY_BUFFER, positionVBO.get());
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void *)0);
 
-        glEnableVertexAttribArray(6); // 骨骼权重
-        glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, m_Weights));
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
 
+    // 只记录属性指针；没有的属性不启用，着色器读到常量 (0, 0, 0, 1)
+    void setupView()
+    {
+        VAO.reset(GL_CREATE(VERTEX_ARRAY, "mesh view"));
+        glBindVertexArray(VAO.get());
+        for (const VertexAttribute &attribute : view.attributes)
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, attribute.buffer);
+            glEnableVertexAttribArray(attribute.location);
+            glVertexAttribPointer(attribute.location, attribute.size, attribute.type, attribute.normalized, attribute.stride, (void *)attribute.offset);
+        }
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, view.indexBuffer);
+
+        for (const VertexAttribute &attribute : view.attributes)
+        {
+            if (attribute.location != 0)
+                continue;
+            depthVAO.reset(GL_CREATE(VERTEX_ARRAY, "mesh view depth"));
+            glBindVertexArray(depthVAO.get());
+            glBindBuffer(GL_ARRAY_BUFFER, attribute.buffer);
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, attribute.size, attribute.type, attribute.normalized, attribute.stride, (void *)attribute.offset);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, view.indexBuffer);
+        }
         glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
     }
 };
 #endif
@@ -1,67 +1,308 @@
 #include "model.hpp"
+#include "profiler.hpp"
+#include "texture_loader.hpp"
+#include "orm_packing.hpp"
+#include "obj_parser.hpp"
+#include "gltf_loader.hpp"
+#include "asset_archive.hpp"
+#include <assimp/DefaultIOSystem.h>
+#include <assimp/MemoryIOWrapper.h>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
-unsigned int TextureFromFile(const char *path, const string &directory, bool gamma = false)
+unsigned int TextureFromFile(const char *path, const string &directory, TextureUploadQueue *uploads, bool gamma = false)
 {
-    string filename = string(path);
-    filename = directory + '/' + filename;
+    PROFILE_CPU_SCOPE("TextureFromFile");
+    // 目录里有 texcook 生成的同名 .ktx2 / .dds 时直接上传压缩数据；给了上传队列时原图在后台解码、分帧上传
+    string filename = directory + '/' + string(path);
+    return uploads ? uploads->load(filename) : load_texture_file(filename);
+}
 
-    // unsigned int textureID = load_image(filename.c_str());
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
+Model::Model(string const &path, bool gamma, bool bake_static, TextureUploadQueue *uploads)
+    : gammaCorrection(gamma), bakeStatic(bake_static), textureUploads(uploads), importJobs(nullptr)
+{
+    printf("start load model: %s\n", path.c_str());
+    if (importScene(path))
+        uploadStep(SIZE_MAX);
+    printf("end load model: %s\n", path.c_str());
+}
+
+namespace
+{
+    // MappedFile 要先于 MemoryIOStream 构造
+    struct AssetFileHolder
+    {
+        MappedFile file;
+    };
 
-    int width, height, nrComponents;
-    unsigned char *data = stbi_load(filename.c_str(), &width, &height, &nrComponents, 0);
-    if (data)
+    class AssetIOStream : private AssetFileHolder, public Assimp::MemoryIOStream
     {
-        GLenum format;
-        if (nrComponents == 1)
-            format = GL_RED;
-        else if (nrComponents == 3)
-            format = GL_RGB;
-        else if (nrComponents == 4)
-            format = GL_RGBA;
+    public:
+        explicit AssetIOStream(MappedFile &&mapped) : AssetFileHolder{std::move(mapped)}, Assimp::MemoryIOStream(file.data(), file.size()) {}
+    };
 
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
+    // 挂载了资源包时交给 Assimp：模型和它引用的 .mtl 等先从包里读，包里没有的仍由默认实现打开
+    class AssetIOSystem : public Assimp::DefaultIOSystem
+    {
+    public:
+        bool Exists(const char *path) const override
+        {
+            return AssetArchive::instance().contains(path) || DefaultIOSystem::Exists(path);
+        }
 
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        Assimp::IOStream *Open(const char *path, const char *mode = "rb") override
+        {
+            MappedFile file;
+            if (std::strchr(mode, 'w') == nullptr && AssetArchive::instance().contains(path) && file.open(path))
+                return new AssetIOStream(std::move(file));
+            return DefaultIOSystem::Open(path, mode);
+        }
+    };
 
-        std::cout << "Texture successful to loaded at path: " << path << std::endl;
-        stbi_image_free(data);
+    bool hasExtension(const string &path, const char *extension)
+    {
+        size_t length = std::strlen(extension);
+        if (path.size() < length)
+            return false;
+        for (size_t i = 0; i < length; i++)
+        {
+            if (std::tolower(static_cast<unsigned char>(path[path.size() - length + i])) != extension[i])
+                return false;
+        }
+        return true;
     }
-    else
+
+    // 把节点网格的顶点变换到模型空间，并扩展包围盒
+    void bakeVertices(vector<Vertex> &vertices, const glm::mat4 &world, const glm::mat3 &normal_matrix, AABB &bounds)
     {
-        std::cout << "Texture failed to load at path: " << path << std::endl;
-        stbi_image_free(data);
+        glm::mat3 tangent_matrix(world);
+        for (Vertex &vertex : vertices)
+        {
+            vertex.Position = glm::vec3(world * glm::vec4(vertex.Position, 1.0f));
+            vertex.Normal = glm::normalize(normal_matrix * vertex.Normal);
+            vertex.Tangent = tangent_matrix * vertex.Tangent;
+            vertex.Bitangent = tangent_matrix * vertex.Bitangent;
+            bounds.expand(vertex.Position);
+        }
     }
+}
 
-    return textureID;
+Model::Model()
+    : gammaCorrection(false), bakeStatic(false), textureUploads(nullptr), importJobs(nullptr)
+{
 }
 
-Model::Model(string const &path, bool gamma) : gammaCorrection(gamma)
+Model::~Model()
+{
+    // texture_handles 随后删除纹理名，上传队列不能再碰它们
+    if (textureUploads)
+    {
+        for (const Texture &texture : textures_loaded)
+        {
+            if (texture.id)
+                textureUploads->cancel(texture.id);
+        }
+    }
+}
+
+bool Model::importScene(string const &path)
 {
-    printf("start load model: %s\n", path.c_str());
     loadModel(path);
-    printf("end load model: %s\n", path.c_str());
+    return !meshes.empty();
+}
+
+bool Model::uploadStep(size_t byte_budget, size_t *uploaded_bytes)
+{
+    PROFILE_CPU_SCOPE("Model::uploadStep");
+    size_t uploaded = 0;
+    bool progressed = false;
+    // glTF 先把网格引用的 bufferView 从映射的文件直接上传，网格只是其上的 VAO
+    while (gltfAsset && uploadedBuffers < gltfAsset->buffer_views.size())
+    {
+        const GltfBufferView &view = gltfAsset->buffer_views[uploadedBuffers];
+        if (!view.used)
+        {
+            buffer_handles.emplace_back();
+            uploadedBuffers++;
+            continue;
+        }
+        if (progressed && uploaded + view.size > byte_budget)
+            break;
+        GLuint buffer = GL_CREATE(BUFFER, "gltf bufferView");
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glBufferData(GL_ARRAY_BUFFER, view.size, view.data, GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        GLRegistry::instance().set_bytes(GLObjectType::BUFFER, buffer, view.size);
+        buffer_handles.emplace_back(buffer);
+        uploadedBuffers++;
+        uploaded += view.size;
+        progressed = true;
+    }
+    // 再网格，出现顺序与绘制顺序一致
+    while ((!gltfAsset || uploadedBuffers == gltfAsset->buffer_views.size()) && uploadedMeshes < meshes.size())
+    {
+        Mesh &mesh = meshes[uploadedMeshes];
+        size_t bytes = mesh.gpuBytes();
+        if (progressed && uploaded + bytes > byte_budget)
+            break;
+        if (mesh.isView())
+        {
+            for (VertexAttribute &attribute : mesh.view.attributes)
+                attribute.buffer = buffer_handles[attribute.source].get();
+            mesh.view.indexBuffer = buffer_handles[mesh.view.indexSource].get();
+        }
+        meshes[uploadedMeshes++].upload();
+        uploaded += bytes;
+        progressed = true;
+    }
+    // 再纹理：有上传队列时 load 立即返回占位纹理，解码和上传在队列里分帧进行；
+    // 否则在这里同步解码上传，按登记表里纹理显存的增量计入预算
+    while (uploadedMeshes == meshes.size() && uploadedTextures < textures_loaded.size())
+    {
+        if (progressed && uploaded >= byte_budget)
+            break;
+        size_t before = GLRegistry::instance().get_stats(GLObjectType::TEXTURE).bytes;
+        loadTexture(uploadedTextures++);
+        size_t after = GLRegistry::instance().get_stats(GLObjectType::TEXTURE).bytes;
+        uploaded += after > before ? after - before : 0;
+        progressed = true;
+    }
+    if (uploaded_bytes)
+        *uploaded_bytes += uploaded;
+    if (isUploaded())
+        gltfAsset.reset(); // 解除文件映射
+    return isUploaded();
 }
 
-void Model::Draw(Shader &shader)
+void Model::loadTexture(size_t index)
 {
+    Texture &texture = textures_loaded[index];
+    // glTF 内嵌的图片登记为 "#<图片下标>"
+    size_t image = texture.path.size() > 1 && texture.path[0] == '#' ? std::strtoul(texture.path.c_str() + 1, nullptr, 10) : SIZE_MAX;
+    if (gltfAsset && image < gltfAsset->images.size())
+        texture.id = load_texture_memory(gltfAsset->images[image].data, gltfAsset->images[image].size, this->directory + '/' + texture.path);
+    else if (texture.type == "texture_orm" && (hasExtension(texture.path, ".ktx2") || hasExtension(texture.path, ".dds")))
+        texture.id = load_compressed_texture(this->directory + '/' + texture.path);
+    else
+        texture.id = TextureFromFile(texture.path.c_str(), this->directory, textureUploads);
+    texture_handles.emplace_back(texture.id);
+    for (Mesh &mesh : meshes)
+    {
+        for (Texture &used : mesh.textures)
+        {
+            if (used.path == texture.path)
+                used.id = texture.id;
+        }
+    }
+}
+
+void Model::setMeshTransform(Shader &shader, unsigned int mesh, const glm::mat4 &model_matrix, const glm::mat3 &model_normal, const char *model_uniform)
+{
+    // mat3(A * B) = mat3(A) * mat3(B)，所以法线矩阵也可以拆开相乘：节点部分在 TransformSystem::update 里已经批量算好
+    uint32_t node = mesh_nodes[mesh];
+    shader.setMat4(model_uniform, model_matrix * nodes.get_world(node));
+    shader.setMat3("normalMatrix", model_normal * nodes.get_normal_matrix(node));
+}
+
+void Model::Draw(Shader &shader, const glm::mat4 &model_matrix, const char *model_uniform)
+{
+    glm::mat3 model_normal;
+    TransformSystem::normal_matrix_batch(&model_matrix, &model_normal, 1);
     for (unsigned int i = 0; i < meshes.size(); i++)
+    {
+        setMeshTransform(shader, i, model_matrix, model_normal, model_uniform);
         meshes[i].Draw(shader);
+    }
+}
+
+void Model::DrawDepth(Shader &shader, const glm::mat4 &model_matrix)
+{
+    for (unsigned int i = 0; i < meshes.size(); i++)
+    {
+        shader.setMat4("model", model_matrix * nodes.get_world(mesh_nodes[i]));
+        meshes[i].DrawGeometry(MeshPass::DEPTH);
+    }
+}
+
+bool Model::buildTextureArray(const string &type)
+{
+    TextureArrayBuilder builder;
+    vector<int> materials(meshes.size(), -1);
+    for (size_t i = 0; i < meshes.size(); i++)
+    {
+        for (const Texture &texture : meshes[i].textures)
+        {
+            if (texture.type == type)
+            {
+                materials[i] = builder.add(directory + '/' + texture.path);
+                break;
+            }
+        }
+        if (materials[i] < 0)
+        {
+            printf("ERROR::MODEL:: mesh %zu has no %s, texture array not built\n", i, type.c_str());
+            return false;
+        }
+    }
+
+    TextureArrays arrays = builder.build(directory + " " + type);
+    if (!arrays.single_array())
+        return false;
+    for (size_t i = 0; i < meshes.size(); i++)
+    {
+        if (arrays[materials[i]].array < 0)
+            return false;
+    }
+    for (size_t i = 0; i < meshes.size(); i++)
+        meshes[i].arrayLayer = arrays[materials[i]].layer;
+    textureArrays = std::move(arrays);
+    return true;
+}
+
+void Model::DrawTextureArray(Shader &shader, const glm::mat4 &model_matrix, const char *model_uniform)
+{
+    glm::mat3 model_normal;
+    TransformSystem::normal_matrix_batch(&model_matrix, &model_normal, 1);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, textureArrays.arrays[0].get());
+    count_texture_bind();
+    GLint layerLocation = glGetUniformLocation(shader.ID, "material_layer");
+    for (unsigned int i = 0; i < meshes.size(); i++)
+    {
+        setMeshTransform(shader, i, model_matrix, model_normal, model_uniform);
+        glUniform1i(layerLocation, meshes[i].arrayLayer);
+        meshes[i].DrawGeometry();
+    }
 }
 
 void Model::loadModel(string const &path)
 {
+    PROFILE_CPU_SCOPE("Model::loadModel");
+    if (hasExtension(path, ".obj"))
+    {
+        loadObj(path);
+        return;
+    }
+    if (hasExtension(path, ".gltf") || hasExtension(path, ".glb"))
+    {
+        loadGltf(path);
+        return;
+    }
     // read file via ASSIMP
     Assimp::Importer importer;
-    const aiScene *scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
+    if (AssetArchive::instance().is_mounted())
+        importer.SetIOHandler(new AssetIOSystem); // Importer 负责删除
+    const aiScene *scene = nullptr;
+    {
+        PROFILE_CPU_SCOPE("Assimp::ReadFile");
+        // JoinIdenticalVertices 把展开的面顶点焊接回共享顶点，ImproveCacheLocality 按顶点缓存重排三角形
+        scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace |
+                                            aiProcess_JoinIdenticalVertices | aiProcess_ImproveCacheLocality);
+    }
     // check for errors
     if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) // if is Not Zero
     {
@@ -73,22 +314,321 @@ void Model::loadModel(string const &path)
 
     // process ASSIMP's root node recursively
     processNode(scene->mRootNode, scene);
+
+    // 计算节点世界矩阵后再求包围盒
+    nodes.update();
+    if (bakeStatic)
+    {
+        bakeStaticMeshes(scene);
+    }
+    else
+    {
+        for (unsigned int i = 0; i < meshes.size(); i++)
+        {
+            AABB mesh_bounds = meshes[i].bounds.transformed(nodes.get_world(mesh_nodes[i]));
+            submeshes.push_back(SubMesh{mesh_nodes[i], i, 0, static_cast<uint32_t>(meshes[i].indices.size()), mesh_bounds});
+            bounds.expand(mesh_bounds);
+        }
+    }
+
+    std::vector<AABB> submesh_bounds;
+    for (const SubMesh &submesh : submeshes)
+        submesh_bounds.push_back(submesh.bounds);
+    submesh_bvh.build(submesh_bounds);
+}
+
+void Model::loadObj(string const &path)
+{
+    ObjParseOptions options;
+    options.jobs = importJobs;
+    // 只有一个根节点，烘焙就是按材质合并
+    options.merge_objects = bakeStatic;
+    ObjScene scene;
+    {
+        PROFILE_CPU_SCOPE("parse_obj");
+        if (!parse_obj(path, scene, options))
+            return;
+    }
+    directory = path.substr(0, path.find_last_of('/'));
+
+    uint32_t root = nodes.create();
+    nodes.update();
+    vector<vector<Texture>> materialTextures(scene.materials.size());
+    vector<bool> materialRegistered(scene.materials.size(), false);
+    for (ObjMesh &objMesh : scene.meshes)
+    {
+        vector<Texture> textures;
+        if (objMesh.material >= 0)
+        {
+            if (!materialRegistered[objMesh.material])
+            {
+                materialTextures[objMesh.material] = objMaterialTextures(scene.materials[objMesh.material]);
+                materialRegistered[objMesh.material] = true;
+            }
+            textures = materialTextures[objMesh.material];
+        }
+        uint32_t mesh_index = static_cast<uint32_t>(meshes.size());
+        meshes.push_back(Mesh(std::move(objMesh.vertices), std::move(objMesh.indices), std::move(textures), false));
+        mesh_nodes.push_back(root);
+        const Mesh &mesh = meshes.back();
+        submeshes.push_back(SubMesh{root, mesh_index, 0, static_cast<uint32_t>(mesh.indices.size()), mesh.bounds});
+        bounds.expand(mesh.bounds);
+    }
+    printf("parsed obj %s: %zu meshes, %zu triangles\n", path.c_str(), meshes.size(), scene.triangles);
+
+    std::vector<AABB> submesh_bounds;
+    for (const SubMesh &submesh : submeshes)
+        submesh_bounds.push_back(submesh.bounds);
+    submesh_bvh.build(submesh_bounds);
 }
 
-void Model::processNode(aiNode *node, const aiScene *scene)
+vector<Texture> Model::objMaterialTextures(const ObjMaterial &material)
 {
+    // 类型对应关系与 Assimp 的 OBJ 导入一致：map_Bump 为 HEIGHT -> texture_normal，map_Ka 为 AMBIENT -> texture_height
+    vector<Texture> textures;
+    const std::pair<const string *, const char *> maps[] = {
+        {&material.diffuse_map, "texture_diffuse"},
+        {&material.specular_map, "texture_specular"},
+        {material.bump_map.empty() ? &material.normal_map : &material.bump_map, "texture_normal"},
+        {&material.ambient_map, "texture_height"},
+    };
+    for (const auto &map : maps)
+    {
+        if (!map.first->empty())
+            textures.push_back(registerTexture(*map.first, map.second));
+    }
+    if (registerOrmTexture({material.metallic_map, material.roughness_map, string()}, textures))
+        return textures;
+    if (!material.metallic_map.empty())
+        textures.push_back(registerTexture(material.metallic_map, "texture_metallic"));
+    if (!material.roughness_map.empty())
+        textures.push_back(registerTexture(material.roughness_map, "texture_roughness"));
+    return textures;
+}
+
+void Model::loadGltf(string const &path)
+{
+    shared_ptr<GltfAsset> asset = std::make_shared<GltfAsset>();
+    {
+        PROFILE_CPU_SCOPE("GltfAsset::load");
+        // 烘焙要在 CPU 上变换顶点，不能直接引用 bufferView
+        if (!asset->load(path, bakeStatic))
+            return;
+    }
+    directory = path.substr(0, path.find_last_of('/'));
+
+    // glTF 的场景根节点挂在一个单位矩阵节点下；畸形文件里的环只展开一次
+    uint32_t root = nodes.create();
+    vector<std::pair<uint32_t, int>> meshNodes; // (nodes 中的节点, glTF 网格)
+    vector<bool> visited(asset->nodes.size(), false);
+    std::function<void(int, uint32_t)> createNode = [&](int index, uint32_t parent)
+    {
+        if (visited[index])
+            return;
+        visited[index] = true;
+        const GltfNode &node = asset->nodes[index];
+        uint32_t created = nodes.create(parent, node.local);
+        if (node.mesh >= 0)
+            meshNodes.push_back({created, node.mesh});
+        for (int child : node.children)
+            createNode(child, created);
+    };
+    for (int index : asset->roots)
+        createNode(index, root);
+    nodes.update();
+
+    vector<vector<Texture>> materialTextures(asset->materials.size());
+    vector<bool> materialRegistered(asset->materials.size(), false);
+    auto texturesFor = [&](int material)
+    {
+        if (material < 0 || size_t(material) >= asset->materials.size())
+            return vector<Texture>();
+        if (!materialRegistered[material])
+        {
+            gltfAsset = asset; // gltfMaterialTextures 需要图片表
+            materialTextures[material] = gltfMaterialTextures(asset->materials[material]);
+            materialRegistered[material] = true;
+        }
+        return materialTextures[material];
+    };
+
+    size_t directMeshes = 0;
+    if (bakeStatic)
+    {
+        // 与 bakeStaticMeshes 一样按材质合并，顶点已在模型空间
+        std::map<int, vector<std::pair<uint32_t, const GltfPrimitive *>>> materialGroups;
+        for (const auto &ref : meshNodes)
+            for (const GltfPrimitive &primitive : asset->meshes[ref.second])
+                materialGroups[primitive.material].push_back({ref.first, &primitive});
+        uint32_t bakedNode = nodes.create();
+        nodes.update();
+        for (auto &group : materialGroups)
+        {
+            vector<Vertex> vertices;
+            vector<unsigned int> indices;
+            uint32_t mesh_index = static_cast<uint32_t>(meshes.size());
+            for (const auto &ref : group.second)
+            {
+                vector<Vertex> primitiveVertices = ref.second->vertices;
+                AABB mesh_bounds;
+                bakeVertices(primitiveVertices, nodes.get_world(ref.first), nodes.get_normal_matrix(ref.first), mesh_bounds);
+                unsigned int base_vertex = static_cast<unsigned int>(vertices.size());
+                uint32_t first_index = static_cast<uint32_t>(indices.size());
+                for (unsigned int index : ref.second->indices)
+                    indices.push_back(base_vertex + index);
+                vertices.insert(vertices.end(), primitiveVertices.begin(), primitiveVertices.end());
+                submeshes.push_back(SubMesh{ref.first, mesh_index, first_index, static_cast<uint32_t>(ref.second->indices.size()), mesh_bounds});
+                bounds.expand(mesh_bounds);
+            }
+            meshes.push_back(Mesh(std::move(vertices), std::move(indices), texturesFor(group.first), false));
+            mesh_nodes.push_back(bakedNode);
+        }
+    }
+    else
+    {
+        for (const auto &ref : meshNodes)
+        {
+            for (const GltfPrimitive &primitive : asset->meshes[ref.second])
+            {
+                uint32_t mesh_index = static_cast<uint32_t>(meshes.size());
+                if (primitive.zero_copy())
+                {
+                    meshes.push_back(Mesh(primitive.view, texturesFor(primitive.material), primitive.bounds));
+                    directMeshes++;
+                }
+                else
+                    meshes.push_back(Mesh(primitive.vertices, primitive.indices, texturesFor(primitive.material), false));
+                mesh_nodes.push_back(ref.first);
+                AABB mesh_bounds = primitive.bounds.transformed(nodes.get_world(ref.first));
+                submeshes.push_back(SubMesh{ref.first, mesh_index, 0, static_cast<uint32_t>(meshes.back().indexCount()), mesh_bounds});
+                bounds.expand(mesh_bounds);
+            }
+        }
+    }
+    // 展开的顶点已经复制进网格，资源里只留映射和图片
+    for (vector<GltfPrimitive> &primitives : asset->meshes)
+    {
+        for (GltfPrimitive &primitive : primitives)
+        {
+            vector<Vertex>().swap(primitive.vertices);
+            vector<unsigned int>().swap(primitive.indices);
+        }
+    }
+    if (directMeshes > 0 || !textures_loaded.empty())
+        gltfAsset = asset;
+    printf("glTF %s: %zu meshes (%zu on shared bufferViews), %.1f MB mapped, %.1f MB expanded\n", path.c_str(), meshes.size(), directMeshes,
+           asset->mapped_bytes / (1024.0 * 1024.0), asset->copied_bytes / (1024.0 * 1024.0));
+
+    std::vector<AABB> submesh_bounds;
+    for (const SubMesh &submesh : submeshes)
+        submesh_bounds.push_back(submesh.bounds);
+    submesh_bvh.build(submesh_bounds);
+}
+
+vector<Texture> Model::gltfMaterialTextures(const GltfMaterial &material)
+{
+    // metallicRoughness 贴图的 G / B 与 texcook 的 ORM 一致；occlusion 也在同一张图的 R 里时整张作为 texture_orm，
+    // 否则 R 不是 AO，登记为 texture_metallic_roughness，occlusion 单独登记为 texture_ao
+    vector<Texture> textures;
+    auto imagePath = [this](int image)
+    {
+        const GltfImage &source = gltfAsset->images[image];
+        return source.data ? "#" + std::to_string(image) : source.uri;
+    };
+    const bool packedOcclusion = material.occlusion == material.metallic_roughness;
+    const std::pair<int, const char *> maps[] = {
+        {material.base_color, "texture_diffuse"},
+        {material.normal, "texture_normal"},
+        {material.metallic_roughness, packedOcclusion ? "texture_orm" : "texture_metallic_roughness"},
+        {packedOcclusion ? -1 : material.occlusion, "texture_ao"},
+    };
+    for (const auto &map : maps)
+    {
+        if (map.first >= 0 && size_t(map.first) < gltfAsset->images.size())
+            textures.push_back(registerTexture(imagePath(map.first), map.second));
+    }
+    return textures;
+}
+
+void Model::bakeStaticMeshes(const aiScene *scene)
+{
+    // 按材质分组，同一材质的所有节点网格合并进一个顶点/索引缓冲
+    std::map<unsigned int, vector<std::pair<uint32_t, unsigned int>>> material_groups;
+    for (const auto &ref : node_mesh_refs)
+        material_groups[scene->mMeshes[ref.second]->mMaterialIndex].push_back(ref);
+
+    // 烘焙后的顶点已在模型空间，挂到一个单位矩阵节点上
+    uint32_t baked_node = nodes.create();
+    nodes.update();
+
+    size_t source_draws = node_mesh_refs.size();
+    for (auto &group : material_groups)
+    {
+        vector<Vertex> vertices;
+        vector<unsigned int> indices;
+        vector<Texture> textures;
+        uint32_t mesh_index = static_cast<uint32_t>(meshes.size());
+        for (const auto &ref : group.second)
+        {
+            vector<Vertex> mesh_vertices;
+            vector<unsigned int> mesh_indices;
+            vector<Texture> mesh_textures;
+            extractMesh(scene->mMeshes[ref.second], scene, mesh_vertices, mesh_indices, mesh_textures);
+            if (textures.empty())
+                textures = mesh_textures;
+
+            AABB mesh_bounds;
+            bakeVertices(mesh_vertices, nodes.get_world(ref.first), nodes.get_normal_matrix(ref.first), mesh_bounds);
+
+            // 记录原始节点对应的索引区间，供拾取使用
+            unsigned int base_vertex = static_cast<unsigned int>(vertices.size());
+            uint32_t first_index = static_cast<uint32_t>(indices.size());
+            for (unsigned int index : mesh_indices)
+                indices.push_back(base_vertex + index);
+            vertices.insert(vertices.end(), mesh_vertices.begin(), mesh_vertices.end());
+            submeshes.push_back(SubMesh{ref.first, mesh_index, first_index, static_cast<uint32_t>(mesh_indices.size()), mesh_bounds});
+            bounds.expand(mesh_bounds);
+        }
+        meshes.push_back(Mesh(vertices, indices, textures, false));
+        mesh_nodes.push_back(baked_node);
+    }
+    printf("baked %zu node meshes into %zu draws\n", source_draws, meshes.size());
+}
+
+int Model::pick(const Ray &ray, float &t) const
+{
+    return submesh_bvh.raycast(ray, t);
+}
+
+void Model::processNode(aiNode *node, const aiScene *scene, uint32_t parent)
+{
+    // aiMatrix4x4 为行主序，glm 为列主序，需要转置
+    const aiMatrix4x4 &m = node->mTransformation;
+    glm::mat4 local(m.a1, m.b1, m.c1, m.d1,
+                    m.a2, m.b2, m.c2, m.d2,
+                    m.a3, m.b3, m.c3, m.d3,
+                    m.a4, m.b4, m.c4, m.d4);
+    uint32_t node_index = nodes.create(parent, local);
+
     // process each mesh located at the current node
     for (unsigned int i = 0; i < node->mNumMeshes; i++)
     {
         // the node object only contains indices to index the actual objects in the scene.
         // the scene contains all the data, node is just to keep stuff organized (like relations between nodes).
+        if (bakeStatic)
+        {
+            // 烘焙模式下先只记录引用，等世界矩阵算完再统一合并
+            node_mesh_refs.push_back({node_index, node->mMeshes[i]});
+            continue;
+        }
         aiMesh *mesh = scene->mMeshes[node->mMeshes[i]];
         meshes.push_back(processMesh(mesh, scene));
+        mesh_nodes.push_back(node_index);
     }
     // after we've processed all of the meshes (if any) we then recursively process each of the children nodes
     for (unsigned int i = 0; i < node->mNumChildren; i++)
     {
-        processNode(node->mChildren[i], scene);
+        processNode(node->mChildren[i], scene, node_index);
     }
 }
 
@@ -98,7 +638,14 @@ Mesh Model::processMesh(aiMesh *mesh, const aiScene *scene)
     vector<Vertex> vertices;
     vector<unsigned int> indices;
     vector<Texture> textures;
+    extractMesh(mesh, scene, vertices, indices, textures);
 
+    // return a mesh object created from the extracted mesh data
+    return Mesh(vertices, indices, textures, false);
+}
+
+void Model::extractMesh(aiMesh *mesh, const aiScene *scene, vector<Vertex> &vertices, vector<unsigned int> &indices, vector<Texture> &textures)
+{
     // walk through each of the mesh's vertices
     for (unsigned int i = 0; i < mesh->mNumVertices; i++)
     {
@@ -173,6 +720,10 @@ Mesh Model::processMesh(aiMesh *mesh, const aiScene *scene)
     textures.insert(textures.end(), heightMaps.begin(), heightMaps.end());
 
     // PBR 相关贴图
+    // texcook 把金属度 / 粗糙度 / AO 打包成了一张 ORM 纹理时只加载它，着色器一次采样读出三个通道
+    if (loadOrmTexture(material, textures))
+        return;
+
     // 5. metallic maps
     std::vector<Texture> metallicMaps = loadMaterialTextures(material, aiTextureType_METALNESS, "texture_metallic");
     textures.insert(textures.end(), metallicMaps.begin(), metallicMaps.end());
@@ -184,9 +735,41 @@ Mesh Model::processMesh(aiMesh *mesh, const aiScene *scene)
     // 7. ao maps
     std::vector<Texture> aoMaps = loadMaterialTextures(material, aiTextureType_AMBIENT_OCCLUSION, "texture_ao");
     textures.insert(textures.end(), aoMaps.begin(), aoMaps.end());
+}
 
-    // return a mesh object created from the extracted mesh data
-    return Mesh(vertices, indices, textures);
+bool Model::loadOrmTexture(aiMaterial *mat, vector<Texture> &textures)
+{
+    vector<string> paths;
+    for (aiTextureType type : {aiTextureType_METALNESS, aiTextureType_DIFFUSE_ROUGHNESS, aiTextureType_AMBIENT_OCCLUSION})
+    {
+        aiString str;
+        paths.push_back(mat->GetTextureCount(type) > 0 && mat->GetTexture(type, 0, &str) == AI_SUCCESS ? string(str.C_Str()) : string());
+    }
+    return registerOrmTexture(paths, textures);
+}
+
+bool Model::registerOrmTexture(const vector<string> &paths, vector<Texture> &textures)
+{
+    for (const string &path : paths)
+    {
+        OrmChannel channel;
+        string packedPath;
+        if (path.empty() || !find_orm_channel(path, channel, packedPath))
+            continue;
+        for (const Texture &loaded : textures_loaded)
+        {
+            if (loaded.path == packedPath)
+            {
+                textures.push_back(loaded);
+                return true;
+            }
+        }
+        if (!asset_exists(this->directory + '/' + packedPath))
+            return false;
+        textures.push_back(registerTexture(packedPath, "texture_orm"));
+        return true;
+    }
+    return false;
 }
 
 vector<Texture> Model::loadMaterialTextures(aiMaterial *mat, aiTextureType type, string typeName)
@@ -196,26 +779,30 @@ vector<Texture> Model::loadMaterialTextures(aiMaterial *mat, aiTextureType type,
     {
         aiString str;
         mat->GetTexture(type, i, &str);
-        // check if texture was loaded before and if so, continue to next iteration: skip loading a new texture
-        bool skip = false;
-        for (unsigned int j = 0; j < textures_loaded.size(); j++)
+        textures.push_back(registerTexture(str.C_Str(), typeName));
+    }
+    return textures;
+}
+
+Texture Model::registerTexture(const string &path, const string &typeName)
+{
+    // check if texture was loaded before and if so, skip loading a new texture
+    for (const Texture &loaded : textures_loaded)
+    {
+        if (loaded.path == path)
         {
-            if (std::strcmp(textures_loaded[j].path.data(), str.C_Str()) == 0)
-            {
-                textures.push_back(textures_loaded[j]);
-                skip = true; // a texture with the same filepath has already been loaded, continue to next one. (optimization)
-                break;
-            }
-        }
-        if (!skip)
-        { // if texture hasn't been loaded already, load it
-            Texture texture;
-            texture.id = TextureFromFile(str.C_Str(), this->directory);
+            // a texture with the same filepath has already been loaded, continue to next one. (optimization)
+            // glTF 里同一张图可以担任不同角色，网格里记录这次的用途
+            Texture texture = loaded;
             texture.type = typeName;
-            texture.path = str.C_Str();
-            textures.push_back(texture);
-            textures_loaded.push_back(texture); // store it as texture loaded for entire model, to ensure we won't unnecessary load duplicate textures.
+            return texture;
         }
     }
-    return textures;
+    // if texture hasn't been loaded already, load it
+    Texture texture;
+    texture.id = 0;
+    texture.type = typeName;
+    texture.path = path;
+    textures_loaded.push_back(texture); // store it as texture loaded for entire model, to ensure we won't unnecessary load duplicate textures.
+    return texture;
 }
@@ -11,42 +11,143 @@
 
 #include "mesh.hpp"
 #include "shader.hpp"
+#include "bounds.hpp"
+#include "transform_system.hpp"
+#include "bvh.hpp"
+#include "texture_upload.hpp"
+#include "texture_array.hpp"
 
 #include <string>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <vector>
 using namespace std;
 
+class JobSystem;
+class GltfAsset;
+struct GltfMaterial;
+struct ObjMaterial;
+
 class Model
 {
 public:
+    // 原始节点网格在合并后网格中的位置，用于拾取
+    struct SubMesh
+    {
+        uint32_t node;        // nodes 中的节点
+        uint32_t mesh;        // meshes 中的网格
+        uint32_t first_index; // 在该网格索引缓冲中的起始位置
+        uint32_t index_count;
+        AABB bounds; // 模型空间包围盒
+    };
+
     // constructor, expects a filepath to a 3D model.
-    Model(string const &path, bool gamma = false);
+    // bake_static 为 true 时把节点变换烘焙进顶点，并按材质合并网格（只适用于静态物体）
+    // 网格和纹理都持有 GL 对象，Model 只能移动
+    // uploads 不为空时纹理通过上传队列异步加载，先显示占位色；队列要比模型活得久，析构时取消还没传完的纹理
+    Model(string const &path, bool gamma = false, bool bake_static = false, TextureUploadQueue *uploads = nullptr);
+
+    // 分阶段加载用的空模型：先设置 gammaCorrection / bakeStatic / textureUploads / importJobs，
+    // 再在任意线程调用 importScene，之后在 GL 线程反复调用 uploadStep 直到返回 true
+    Model();
+    ~Model();
+    // 移动构造后源对象的 textures_loaded 为空，析构不会取消新对象的纹理；
+    // 不提供移动赋值：默认实现会不经取消就替换目标的 texture_handles，上传队列可能写进被复用的纹理名
+    Model(Model &&) = default;
+    Model &operator=(Model &&) = delete;
+
+    // 只做 CPU 端工作：Assimp 解析（.obj 用 parse_obj，设置了 importJobs 时并行；.gltf / .glb 用 GltfAsset，只映射文件）、顶点焊接、缓存优化、静态烘焙、包围盒和 BVH，不碰 GL；失败返回 false
+    bool importScene(string const &path);
+    // GL 线程：按顺序创建网格缓冲（glTF 先上传 bufferView），再加载纹理；每次至少前进一个网格 / 一张纹理，累计超过 byte_budget 就返回。
+    // 全部完成时返回 true；uploaded_bytes 不为空时加上本次上传的字节数
+    bool uploadStep(size_t byte_budget, size_t *uploaded_bytes = nullptr);
+    bool isUploaded() const { return uploadedMeshes == meshes.size() && uploadedTextures == textures_loaded.size(); }
 
     // draws the model, and thus all its meshes
-    void Draw(Shader &shader);
+    // 每个网格设置 model_uniform = model_matrix * 节点世界矩阵，以及对应的 normalMatrix，
+    // 多节点模型（glTF、带层级的 Assimp 场景）按节点变换摆放，与 bounds / pick 一致
+    void Draw(Shader &shader, const glm::mat4 &model_matrix, const char *model_uniform = "model");
+    // 只写深度（深度预通道、阴影贴图）：每个网格只设置 model，不绑定纹理，用只读位置流的深度 VAO 绘制；变换与 Draw 相同
+    void DrawDepth(Shader &shader, const glm::mat4 &model_matrix);
+
+    // 把各网格 type 类型的纹理（如 "texture_diffuse"）从原图重新解码，合成一个 GL_TEXTURE_2D_ARRAY，
+    // 尺寸不同的在 CPU 上缩放；成功后每个网格的 arrayLayer 指向自己的层。
+    // 有网格缺这种纹理、或格式不一致需要多个数组时返回 false，只能继续用 Draw
+    bool buildTextureArray(const string &type);
+    // 数组绑定到 0 号纹理单元（sampler2DArray），每个网格只更新变换和 material_layer uniform，整个模型一次绑定
+    void DrawTextureArray(Shader &shader, const glm::mat4 &model_matrix, const char *model_uniform = "model");
 
     // model data
     vector<Texture> textures_loaded; // stores all the textures loaded so far, optimization to make sure textures aren't loaded more than once.
+    vector<TextureHandle> texture_handles; // 与 textures_loaded 一一对应，负责删除纹理
+    vector<BufferHandle> buffer_handles;   // glTF 的 bufferView，零拷贝网格的 MeshView 引用它们；没被引用的为空
+    TextureArrays textureArrays;           // buildTextureArray 的结果
     vector<Mesh> meshes;
     string directory;
     bool gammaCorrection;
+    AABB bounds; // 所有网格的模型空间包围盒（已包含节点变换）
+    TransformSystem nodes;          // aiNode 层级，保留 mTransformation
+    vector<uint32_t> mesh_nodes;    // meshes[i] 所在的节点
+    vector<SubMesh> submeshes;      // 每个 (节点, aiMesh) 一项，烘焙后仍保留原始节点信息
+    bool bakeStatic;
+    TextureUploadQueue *textureUploads; // 加载纹理；析构时用它取消还没传完的纹理
+    JobSystem *importJobs;              // 不为空时 .obj 在这些线程上并行解析，只在加载期间使用
+
+    // 模型空间射线拾取，返回命中的 submeshes 下标，未命中返回 -1
+    int pick(const Ray &ray, float &t) const;
 
 private:
     // loads a model with supported ASSIMP extensions from file and stores the resulting meshes in the meshes vector.
+    // .obj 不经过 Assimp，交给 parse_obj；.gltf / .glb 交给 GltfAsset
     void loadModel(string const &path);
 
+    // glTF 节点层级挂在一个根节点下，每个 (节点, 图元) 一个网格；布局允许的图元直接引用 bufferView，
+    // bakeStatic 时全部展开成 Vertex 并按材质合并
+    void loadGltf(string const &path);
+    vector<Texture> gltfMaterialTextures(const GltfMaterial &material);
+
+    // .obj 只有一个根节点，每个 (对象, 材质) 一个网格；bakeStatic 时只按材质分网格
+    void loadObj(string const &path);
+    vector<Texture> objMaterialTextures(const ObjMaterial &material);
+
     // processes a node in a recursive fashion. Processes each individual mesh located at the node and repeats this process on its children nodes (if any).
-    void processNode(aiNode *node, const aiScene *scene);
+    void processNode(aiNode *node, const aiScene *scene, uint32_t parent = TransformSystem::INVALID_NODE);
 
     Mesh processMesh(aiMesh *mesh, const aiScene *scene);
 
+    // 只提取 CPU 端数据，不创建 GL 对象
+    void extractMesh(aiMesh *mesh, const aiScene *scene, vector<Vertex> &vertices, vector<unsigned int> &indices, vector<Texture> &textures);
+
+    // 将 node_mesh_refs 中的网格变换到模型空间并按材质合并
+    void bakeStaticMeshes(const aiScene *scene);
+
+    vector<std::pair<uint32_t, unsigned int>> node_mesh_refs; // 烘焙模式下收集的 (节点, aiMesh 下标)
+    BVH submesh_bvh;
+    shared_ptr<GltfAsset> gltfAsset; // 保持 glTF 文件映射，上传完成后释放
+    size_t uploadedBuffers = 0;      // gltfAsset->buffer_views 中已经处理的个数
+    size_t uploadedMeshes = 0;       // meshes 中已经创建 GL 缓冲的个数
+    size_t uploadedTextures = 0;     // textures_loaded 中已经加载的个数
+
+    // Draw / DrawTextureArray 共用：设置第 mesh 个网格的模型矩阵和法线矩阵，model_normal 为 model_matrix 的法线矩阵
+    void setMeshTransform(Shader &shader, unsigned int mesh, const glm::mat4 &model_matrix, const glm::mat3 &model_normal, const char *model_uniform);
+
+    // 创建 textures_loaded[index] 的 GL 纹理，并把 id 填回引用它的网格
+    void loadTexture(size_t index);
+
     // checks all material textures of a given type and loads the textures if they're not loaded yet.
     // the required info is returned as a Texture struct.
+    // 导入阶段只登记路径（id 为 0），纹理在 uploadStep 里创建
     vector<Texture> loadMaterialTextures(aiMaterial *mat, aiTextureType type, string typeName);
+    // 找到材质对应的 <材质>_orm.ktx2 并登记为 texture_orm，不存在时返回 false
+    bool loadOrmTexture(aiMaterial *mat, vector<Texture> &textures);
+
+    // 按路径登记一张纹理，同一路径只登记一次
+    Texture registerTexture(const string &path, const string &typeName);
+    // paths 为金属度 / 粗糙度 / AO 贴图路径（可以为空串）
+    bool registerOrmTexture(const vector<string> &paths, vector<Texture> &textures);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include "model_loader.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+namespace
+{
+    using clock = std::chrono::steady_clock;
+
+    double elapsed_ms(clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    }
+}
+
+ModelLoader::ModelLoader(JobSystem &jobs, TextureUploadQueue *uploads, size_t frame_budget)
+    : jobs(jobs), uploads(uploads), frame_budget(std::max<size_t>(frame_budget, 1))
+{
+}
+
+ModelLoader::~ModelLoader()
+{
+    // 导入任务引用着句柄，必须等它们结束
+    jobs.wait(import_counter);
+}
+
+std::shared_ptr<AsyncModel> ModelLoader::load(const std::string &path, bool gamma, bool bake_static)
+{
+    std::shared_ptr<AsyncModel> handle = std::make_shared<AsyncModel>();
+    handle->path = path;
+    handle->model.reset(new Model());
+    handle->model->gammaCorrection = gamma;
+    handle->model->bakeStatic = bake_static;
+    handle->model->textureUploads = uploads;
+    handle->model->importJobs = &jobs; // .obj 的分块解析在同一个任务系统里展开，导入线程 wait 时也参与执行
+
+    AsyncModel *raw = handle.get();
+    jobs.submit([raw]()
+                {
+                    PROFILE_CPU_SCOPE("import_model");
+                    clock::time_point start = clock::now();
+                    bool imported = raw->model->importScene(raw->path);
+                    raw->import_ms = elapsed_ms(start);
+                    raw->state.store(imported ? AsyncModel::State::UPLOADING : AsyncModel::State::FAILED, std::memory_order_release); },
+                &import_counter);
+    pending.push_back(handle);
+    return handle;
+}
+
+void ModelLoader::update()
+{
+    PROFILE_CPU_SCOPE("model_loader");
+    clock::time_point start = clock::now();
+    stats.frame_bytes = upload(frame_budget);
+    stats.frame_ms = elapsed_ms(start);
+    stats.max_frame_ms = std::max(stats.max_frame_ms, stats.frame_ms);
+}
+
+void ModelLoader::flush()
+{
+    jobs.wait(import_counter);
+    upload(SIZE_MAX);
+}
+
+size_t ModelLoader::upload(size_t budget)
+{
+    size_t uploaded = 0;
+    for (auto it = pending.begin(); it != pending.end();)
+    {
+        AsyncModel &handle = **it;
+        AsyncModel::State state = handle.get_state();
+        if (state == AsyncModel::State::FAILED)
+        {
+            printf("ERROR::MODEL_LOADER:: failed to load %s\n", handle.path.c_str());
+            it = pending.erase(it);
+            continue;
+        }
+        // 预算用完或还在导入时，后面的模型留到下一帧；已导入的模型不必等前面的
+        if (state == AsyncModel::State::IMPORTING || uploaded >= budget)
+        {
+            ++it;
+            continue;
+        }
+
+        clock::time_point start = clock::now();
+        bool done = handle.model->uploadStep(budget - uploaded, &uploaded);
+        handle.upload_ms += elapsed_ms(start);
+        if (!done)
+        {
+            ++it;
+            continue;
+        }
+        handle.state.store(AsyncModel::State::READY, std::memory_order_release);
+        stats.completed++;
+        printf("Model loaded (async): %s, %zu meshes, import %.1f ms on worker, upload %.1f ms on GL thread\n",
+               handle.path.c_str(), handle.model->meshes.size(), handle.import_ms, handle.upload_ms);
+        it = pending.erase(it);
+    }
+    return uploaded;
+}
@@ -0,0 +1,88 @@
+#ifndef MODEL_LOADER_HPP
+#define MODEL_LOADER_HPP
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include "model.hpp"
+#include "job_system.hpp"
+#include "texture_upload.hpp"
+
+// ModelLoader::load 返回的句柄，READY 之前调用者画占位物体
+class AsyncModel
+{
+public:
+    enum class State
+    {
+        IMPORTING, // 工作线程上解析 / 焊接 / 优化
+        UPLOADING, // GL 线程上分帧创建缓冲和纹理，已上传的网格可以绘制
+        READY,
+        FAILED
+    };
+
+    State get_state() const { return state.load(std::memory_order_acquire); }
+    bool is_ready() const { return get_state() == State::READY; }
+    // IMPORTING / FAILED 时为空；UPLOADING 时只能在 GL 线程使用，未上传的网格 Draw 会跳过
+    Model *get() { return get_state() == State::UPLOADING || is_ready() ? model.get() : nullptr; }
+    const Model *get() const { return get_state() == State::UPLOADING || is_ready() ? model.get() : nullptr; }
+    const std::string &get_path() const { return path; }
+    double get_import_ms() const { return import_ms; }
+    double get_upload_ms() const { return upload_ms; }
+
+private:
+    friend class ModelLoader;
+
+    std::string path;
+    std::unique_ptr<Model> model;
+    std::atomic<State> state{State::IMPORTING};
+    double import_ms = 0.0; // 工作线程上的耗时
+    double upload_ms = 0.0; // GL 线程上各帧耗时之和
+};
+
+/**
+ * @brief 后台模型加载。load() 立即返回句柄，Model::importScene（Assimp / parse_obj 解析、顶点焊接、缓存优化、静态烘焙）在工作线程执行；
+ *        update() 每帧在 GL 线程上把导入完成的模型按 frame_budget 字节分帧创建顶点 / 索引缓冲和纹理（Model::uploadStep），
+ *        窗口不会因为大模型卡住。给了 TextureUploadQueue 时纹理先是占位色，由队列在后台解码、分帧上传，调用者照常每帧 update 队列。
+ *        句柄持有模型，loader 析构时等待还在导入的任务。load / update / flush 只能在 GL 线程调用。
+ */
+class ModelLoader
+{
+public:
+    struct Stats
+    {
+        size_t completed = 0;
+        size_t frame_bytes = 0;    // 上一次 update() 上传的字节数
+        double frame_ms = 0.0;     // 上一次 update() 在 GL 线程上的耗时
+        double max_frame_ms = 0.0; // 所有 update() 中最长的一次
+    };
+
+    explicit ModelLoader(JobSystem &jobs, TextureUploadQueue *uploads = nullptr, size_t frame_budget = size_t(4) << 20);
+    ~ModelLoader();
+
+    ModelLoader(const ModelLoader &) = delete;
+    ModelLoader &operator=(const ModelLoader &) = delete;
+
+    std::shared_ptr<AsyncModel> load(const std::string &path, bool gamma = false, bool bake_static = false);
+
+    // 每帧调用一次，不阻塞
+    void update();
+    // 忽略预算，等待所有模型导入并上传完成（纹理队列需要另外 flush）
+    void flush();
+
+    size_t get_pending() const { return pending.size(); }
+    const Stats &get_stats() const { return stats; }
+
+private:
+    JobSystem &jobs;
+    TextureUploadQueue *uploads;
+    size_t frame_budget;
+    JobCounter import_counter;
+    std::vector<std::shared_ptr<AsyncModel>> pending; // 按 load 顺序
+    Stats stats;
+
+    // 推进导入完成的模型，返回本次上传的字节数
+    size_t upload(size_t budget);
+};
+
+#endif // MODEL_LOADER_HPP
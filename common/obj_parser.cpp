@@ -0,0 +1,688 @@
+#include "obj_parser.hpp"
+#include "job_system.hpp"
+#include "mapped_file.hpp"
+#include "vertex_utils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+
+namespace
+{
+    // 块内的负索引先记成相对块起点的位置再加上这个偏移，和绝对索引（>= 0）、缺失（-1）区分开；合并时再加上块的起始元素数
+    const int32_t RELATIVE_BIAS = -(1 << 30);
+    const int32_t MISSING = -1;
+
+    struct Corner
+    {
+        int32_t v, vt, vn;
+    };
+
+    // 块内的一段状态，usemtl / o / g 时开始新的一段
+    struct Run
+    {
+        std::string object;
+        std::string material;
+        bool has_object = false; // 为 false 时沿用上一块结束时的状态
+        bool has_material = false;
+    };
+
+    struct Chunk
+    {
+        const char *begin = nullptr, *end = nullptr;
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec2> uvs;
+        std::vector<glm::vec3> normals;
+        std::vector<Corner> corners;          // 每三个一个三角形
+        std::vector<uint32_t> triangle_runs;  // 每个三角形所属的段
+        std::vector<Run> runs;                // runs[0] 继承上一块
+        std::vector<std::string> libraries;   // mtllib
+        size_t invalid_faces = 0;
+        // 合并阶段填写
+        size_t position_base = 0, uv_base = 0, normal_base = 0;
+        std::vector<int> run_meshes;
+    };
+
+    inline bool is_space(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    inline void skip_space(const char *&p, const char *end)
+    {
+        while (p < end && is_space(*p))
+            p++;
+    }
+
+    inline bool is_digit(char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    const double POWERS_OF_TEN[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+    // [+-]digits[.digits][(e|E)[+-]digits]：最多取 19 位有效数字，再乘 / 除 10 的幂（10^22 以内是精确的 double）
+    bool parse_float(const char *&cursor, const char *end, float &value)
+    {
+        const char *p = cursor;
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+'))
+            negative = *p++ == '-';
+        uint64_t mantissa = 0;
+        int exponent = 0, digits = 0;
+        bool any = false;
+        for (; p < end && is_digit(*p); p++, any = true)
+        {
+            if (digits < 19)
+            {
+                mantissa = mantissa * 10 + (*p - '0');
+                digits += mantissa != 0;
+            }
+            else
+                exponent++;
+        }
+        if (p < end && *p == '.')
+        {
+            for (p++; p < end && is_digit(*p); p++, any = true)
+            {
+                if (digits < 19)
+                {
+                    mantissa = mantissa * 10 + (*p - '0');
+                    digits += mantissa != 0;
+                    exponent--;
+                }
+            }
+        }
+        if (!any)
+            return false;
+        if (p < end && (*p == 'e' || *p == 'E'))
+        {
+            const char *q = p + 1;
+            bool negative_exponent = false;
+            if (q < end && (*q == '-' || *q == '+'))
+                negative_exponent = *q++ == '-';
+            if (q < end && is_digit(*q))
+            {
+                int e = 0;
+                for (; q < end && is_digit(*q); q++)
+                    e = std::min(e * 10 + (*q - '0'), 100000);
+                exponent += negative_exponent ? -e : e;
+                p = q;
+            }
+        }
+
+        double result = static_cast<double>(mantissa);
+        if (mantissa != 0)
+        {
+            for (; exponent > 22; exponent -= 22)
+                result *= 1e22;
+            for (; exponent < -22; exponent += 22)
+                result /= 1e22;
+            result = exponent >= 0 ? result * POWERS_OF_TEN[exponent] : result / POWERS_OF_TEN[-exponent];
+        }
+        value = static_cast<float>(negative ? -result : result);
+        cursor = p;
+        return true;
+    }
+
+    bool parse_index(const char *&cursor, const char *end, int64_t &value)
+    {
+        const char *p = cursor;
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+'))
+            negative = *p++ == '-';
+        if (p >= end || !is_digit(*p))
+            return false;
+        int64_t result = 0;
+        for (; p < end && is_digit(*p); p++)
+            result = std::min<int64_t>(result * 10 + (*p - '0'), INT32_MAX);
+        value = negative ? -result : result;
+        cursor = p;
+        return true;
+    }
+
+    // OBJ 索引从 1 开始，负数相对于当前已经出现的元素个数
+    int32_t encode_index(int64_t index, size_t local_count)
+    {
+        if (index > 0 && index <= INT32_MAX / 2)
+            return static_cast<int32_t>(index - 1);
+        if (index < 0 && -index <= (1 << 29))
+            return RELATIVE_BIAS + static_cast<int32_t>(static_cast<int64_t>(local_count) + index);
+        return MISSING;
+    }
+
+    int32_t decode_index(int32_t value, size_t base, size_t total)
+    {
+        if (value == MISSING)
+            return MISSING;
+        int64_t index = value < RELATIVE_BIAS / 2 ? int64_t(value) - RELATIVE_BIAS + int64_t(base) : int64_t(value);
+        return index >= 0 && index < int64_t(total) ? static_cast<int32_t>(index) : MISSING;
+    }
+
+    int read_floats(const char *&p, const char *end, float *values, int count)
+    {
+        int read = 0;
+        for (; read < count; read++)
+        {
+            skip_space(p, end);
+            if (!parse_float(p, end, values[read]))
+                break;
+        }
+        return read;
+    }
+
+    // 行首关键字后面必须是空白或行尾
+    bool keyword(const char *p, const char *end, const char *word, size_t length)
+    {
+        return size_t(end - p) >= length && std::memcmp(p, word, length) == 0 && (p + length == end || is_space(p[length]));
+    }
+
+    std::string rest_of_line(const char *p, const char *end)
+    {
+        skip_space(p, end);
+        while (end > p && is_space(end[-1]))
+            end--;
+        return std::string(p, end);
+    }
+
+    void parse_face(Chunk &chunk, const char *p, const char *end, std::vector<Corner> &polygon)
+    {
+        polygon.clear();
+        while (true)
+        {
+            skip_space(p, end);
+            if (p >= end || *p == '#')
+                break;
+            Corner corner = {MISSING, MISSING, MISSING};
+            int64_t index = 0;
+            if (!parse_index(p, end, index))
+            {
+                chunk.invalid_faces++;
+                return;
+            }
+            corner.v = encode_index(index, chunk.positions.size());
+            if (p < end && *p == '/')
+            {
+                p++;
+                if (p < end && *p != '/' && parse_index(p, end, index))
+                    corner.vt = encode_index(index, chunk.uvs.size());
+                if (p < end && *p == '/')
+                {
+                    p++;
+                    if (parse_index(p, end, index))
+                        corner.vn = encode_index(index, chunk.normals.size());
+                }
+            }
+            if (corner.v == MISSING)
+            {
+                chunk.invalid_faces++;
+                return;
+            }
+            polygon.push_back(corner);
+            while (p < end && !is_space(*p))
+                p++;
+        }
+        if (polygon.size() < 3)
+            return; // 点、线不是面
+        // 扇形三角化
+        uint32_t run = static_cast<uint32_t>(chunk.runs.size() - 1);
+        for (size_t i = 1; i + 1 < polygon.size(); i++)
+        {
+            chunk.corners.push_back(polygon[0]);
+            chunk.corners.push_back(polygon[i]);
+            chunk.corners.push_back(polygon[i + 1]);
+            chunk.triangle_runs.push_back(run);
+        }
+    }
+
+    void parse_chunk(Chunk &chunk)
+    {
+        chunk.runs.push_back(Run());
+        std::vector<Corner> polygon;
+        const char *p = chunk.begin;
+        while (p < chunk.end)
+        {
+            const char *line_end = static_cast<const char *>(std::memchr(p, '\n', chunk.end - p));
+            if (!line_end)
+                line_end = chunk.end;
+            skip_space(p, line_end);
+            if (p < line_end)
+            {
+                char c = *p;
+                if (c == 'v' && p + 1 < line_end)
+                {
+                    float values[3] = {0.0f, 0.0f, 0.0f};
+                    if (is_space(p[1]))
+                    {
+                        p++;
+                        read_floats(p, line_end, values, 3); // 顶点颜色等多余的分量忽略
+                        chunk.positions.push_back(glm::vec3(values[0], values[1], values[2]));
+                    }
+                    else if (p[1] == 't' && (p + 2 == line_end || is_space(p[2])))
+                    {
+                        p += 2;
+                        read_floats(p, line_end, values, 2);
+                        chunk.uvs.push_back(glm::vec2(values[0], values[1]));
+                    }
+                    else if (p[1] == 'n' && (p + 2 == line_end || is_space(p[2])))
+                    {
+                        p += 2;
+                        read_floats(p, line_end, values, 3);
+                        chunk.normals.push_back(glm::vec3(values[0], values[1], values[2]));
+                    }
+                }
+                else if (c == 'f' && (p + 1 == line_end || is_space(p[1])))
+                {
+                    parse_face(chunk, p + 1, line_end, polygon);
+                }
+                else if ((c == 'o' || c == 'g') && (p + 1 == line_end || is_space(p[1])))
+                {
+                    Run run = chunk.runs.back();
+                    run.object = rest_of_line(p + 1, line_end);
+                    run.has_object = true;
+                    chunk.runs.push_back(run);
+                }
+                else if (keyword(p, line_end, "usemtl", 6))
+                {
+                    Run run = chunk.runs.back();
+                    run.material = rest_of_line(p + 6, line_end);
+                    run.has_material = true;
+                    chunk.runs.push_back(run);
+                }
+                else if (keyword(p, line_end, "mtllib", 6))
+                {
+                    chunk.libraries.push_back(rest_of_line(p + 6, line_end));
+                }
+            }
+            p = line_end + 1;
+        }
+    }
+
+    std::string directory_of(const std::string &path)
+    {
+        size_t slash = path.find_last_of("/\\");
+        return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+    }
+
+    // 焊接用的开放寻址表，键为 (v, vt, vn)
+    class CornerTable
+    {
+    public:
+        explicit CornerTable(size_t corners)
+        {
+            size_t capacity = 16;
+            while (capacity < corners * 2)
+                capacity *= 2;
+            slots.assign(capacity, Slot{{MISSING, MISSING, MISSING}, UINT32_MAX});
+            mask = capacity - 1;
+        }
+
+        // 返回已有的顶点下标，或者把 next 插入并返回 next
+        uint32_t find_or_insert(const Corner &key, uint32_t next)
+        {
+            size_t hash = (uint32_t(key.v) * 0x9E3779B1u) ^ (uint32_t(key.vt) * 0x85EBCA77u) ^ (uint32_t(key.vn) * 0xC2B2AE3Du);
+            for (size_t i = (hash ^ (hash >> 15)) & mask;; i = (i + 1) & mask)
+            {
+                Slot &slot = slots[i];
+                if (slot.index == UINT32_MAX)
+                {
+                    slot = Slot{key, next};
+                    return next;
+                }
+                if (slot.key.v == key.v && slot.key.vt == key.vt && slot.key.vn == key.vn)
+                    return slot.index;
+            }
+        }
+
+    private:
+        struct Slot
+        {
+            Corner key;
+            uint32_t index;
+        };
+        std::vector<Slot> slots;
+        size_t mask = 0;
+    };
+
+    struct Attributes
+    {
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec2> uvs;
+        std::vector<glm::vec3> normals;
+    };
+
+    void build_mesh(const Corner *corners, size_t triangle_count, const Attributes &attributes, bool flip_uvs, ObjMesh &mesh)
+    {
+        CornerTable table(triangle_count * 3);
+        std::vector<int32_t> position_indices; // 每个输出顶点的 v，用于生成平滑法线
+        std::vector<uint8_t> missing_normal;   // 该顶点的角没有 vn，需要生成法线
+        size_t missing_normals = 0;
+        mesh.vertices.reserve(triangle_count * 3 / 2);
+        mesh.indices.reserve(triangle_count * 3);
+        for (size_t i = 0; i < triangle_count * 3; i++)
+        {
+            const Corner &corner = corners[i];
+            uint32_t index = table.find_or_insert(corner, static_cast<uint32_t>(mesh.vertices.size()));
+            if (index == mesh.vertices.size())
+            {
+                Vertex vertex = {};
+                vertex.Position = attributes.positions[corner.v];
+                if (corner.vn != MISSING)
+                {
+                    vertex.Normal = attributes.normals[corner.vn];
+                    mesh.has_normals = true;
+                }
+                if (corner.vt != MISSING)
+                {
+                    glm::vec2 uv = attributes.uvs[corner.vt];
+                    vertex.TexCoords = flip_uvs ? glm::vec2(uv.x, 1.0f - uv.y) : uv;
+                    mesh.has_uvs = true;
+                }
+                mesh.vertices.push_back(vertex);
+                position_indices.push_back(corner.v);
+                missing_normal.push_back(corner.vn == MISSING);
+                missing_normals += corner.vn == MISSING;
+            }
+            mesh.indices.push_back(index);
+        }
+
+        std::vector<Vertex> &vertices = mesh.vertices;
+        if (missing_normals > 0)
+        {
+            // 共享同一个 v 的顶点累加相邻三角形的（面积加权）法线；同一网格里有的面带 vn、有的不带时只补没有 vn 的顶点
+            std::unordered_map<int32_t, glm::vec3> sums;
+            sums.reserve(vertices.size());
+            for (size_t i = 0; i < mesh.indices.size(); i += 3)
+            {
+                unsigned int a = mesh.indices[i], b = mesh.indices[i + 1], c = mesh.indices[i + 2];
+                glm::vec3 normal = glm::cross(vertices[b].Position - vertices[a].Position, vertices[c].Position - vertices[a].Position);
+                for (unsigned int index : {a, b, c})
+                    sums[position_indices[index]] += normal;
+            }
+            for (size_t i = 0; i < vertices.size(); i++)
+            {
+                if (!missing_normal[i])
+                    continue;
+                glm::vec3 sum = sums[position_indices[i]];
+                float length = glm::length(sum);
+                vertices[i].Normal = length > 0.0f ? sum / length : glm::vec3(0.0f, 1.0f, 0.0f);
+            }
+        }
+
+        if (mesh.has_uvs)
+            generate_tangents(vertices, mesh.indices);
+    }
+
+    void read_color(const char *p, const char *end, glm::vec3 &color)
+    {
+        float values[3] = {0.0f, 0.0f, 0.0f};
+        int read = read_floats(p, end, values, 3);
+        if (read == 1)
+            values[1] = values[2] = values[0];
+        if (read > 0)
+            color = glm::vec3(values[0], values[1], values[2]);
+    }
+
+    // 贴图语句可能带 -bm 1.0 之类的选项，文件名取最后一个空白之后的部分
+    std::string map_file(const char *p, const char *end)
+    {
+        std::string rest = rest_of_line(p, end);
+        size_t space = rest.find_last_of(" \t");
+        return space == std::string::npos ? rest : rest.substr(space + 1);
+    }
+}
+
+bool parse_mtl(const std::string &path, std::vector<ObjMaterial> &materials)
+{
+    MappedFile file;
+    if (!file.open(path))
+    {
+        printf("ERROR::OBJ:: failed to open material library %s\n", path.c_str());
+        return false;
+    }
+    const char *p = reinterpret_cast<const char *>(file.data());
+    const char *end = p + file.size();
+    ObjMaterial *material = nullptr;
+    while (p < end)
+    {
+        const char *line_end = static_cast<const char *>(std::memchr(p, '\n', end - p));
+        if (!line_end)
+            line_end = end;
+        skip_space(p, line_end);
+        const char *word_end = p;
+        while (word_end < line_end && !is_space(*word_end))
+            word_end++;
+        std::string word(p, word_end);
+        if (word == "newmtl")
+        {
+            materials.push_back(ObjMaterial());
+            material = &materials.back();
+            material->name = rest_of_line(word_end, line_end);
+        }
+        else if (material)
+        {
+            const char *q = word_end;
+            float value = 0.0f;
+            if (word == "Ka")
+                read_color(q, line_end, material->ambient);
+            else if (word == "Kd")
+                read_color(q, line_end, material->diffuse);
+            else if (word == "Ks")
+                read_color(q, line_end, material->specular);
+            else if (word == "Ns" && read_floats(q, line_end, &value, 1))
+                material->shininess = value;
+            else if (word == "d" && read_floats(q, line_end, &value, 1))
+                material->opacity = value;
+            else if (word == "Tr" && read_floats(q, line_end, &value, 1))
+                material->opacity = 1.0f - value;
+            else if (word == "map_Ka")
+                material->ambient_map = map_file(q, line_end);
+            else if (word == "map_Kd")
+                material->diffuse_map = map_file(q, line_end);
+            else if (word == "map_Ks")
+                material->specular_map = map_file(q, line_end);
+            else if (word == "map_Bump" || word == "map_bump" || word == "bump")
+                material->bump_map = map_file(q, line_end);
+            else if (word == "norm" || word == "map_Kn")
+                material->normal_map = map_file(q, line_end);
+            else if (word == "map_d")
+                material->opacity_map = map_file(q, line_end);
+            else if (word == "map_Pr")
+                material->roughness_map = map_file(q, line_end);
+            else if (word == "map_Pm")
+                material->metallic_map = map_file(q, line_end);
+        }
+        p = line_end + 1;
+    }
+    return true;
+}
+
+bool parse_obj(const std::string &path, ObjScene &scene, const ObjParseOptions &options)
+{
+    scene = ObjScene();
+    MappedFile file;
+    if (!file.open(path))
+    {
+        printf("ERROR::OBJ:: failed to open %s\n", path.c_str());
+        return false;
+    }
+
+    // 1. 按行边界切块并行解析
+    const char *data = reinterpret_cast<const char *>(file.data());
+    const char *end = data + file.size();
+    size_t chunk_size = std::max<size_t>(options.chunk_size, 4096);
+    std::vector<Chunk> chunks;
+    for (const char *p = data; p < end;)
+    {
+        const char *chunk_end = p + std::min<size_t>(chunk_size, end - p);
+        if (chunk_end < end)
+        {
+            const char *newline = static_cast<const char *>(std::memchr(chunk_end, '\n', end - chunk_end));
+            chunk_end = newline ? newline + 1 : end;
+        }
+        chunks.push_back(Chunk());
+        chunks.back().begin = p;
+        chunks.back().end = chunk_end;
+        p = chunk_end;
+    }
+    if (options.jobs && chunks.size() > 1)
+        options.jobs->parallel_for(chunks.size(), 1, [&chunks](size_t begin, size_t end)
+                                   { for (size_t i = begin; i < end; i++) parse_chunk(chunks[i]); });
+    else
+        for (Chunk &chunk : chunks)
+            parse_chunk(chunk);
+
+    // 2. 合并属性，顺延各块的 usemtl / o / g 状态并给每段分配网格
+    Attributes attributes;
+    std::vector<std::string> libraries;
+    size_t invalid_faces = 0;
+    for (Chunk &chunk : chunks)
+    {
+        chunk.position_base = attributes.positions.size();
+        chunk.uv_base = attributes.uvs.size();
+        chunk.normal_base = attributes.normals.size();
+        attributes.positions.insert(attributes.positions.end(), chunk.positions.begin(), chunk.positions.end());
+        attributes.uvs.insert(attributes.uvs.end(), chunk.uvs.begin(), chunk.uvs.end());
+        attributes.normals.insert(attributes.normals.end(), chunk.normals.begin(), chunk.normals.end());
+        std::vector<glm::vec3>().swap(chunk.positions);
+        std::vector<glm::vec2>().swap(chunk.uvs);
+        std::vector<glm::vec3>().swap(chunk.normals);
+        libraries.insert(libraries.end(), chunk.libraries.begin(), chunk.libraries.end());
+        invalid_faces += chunk.invalid_faces;
+    }
+
+    if (options.load_materials)
+    {
+        std::string directory = directory_of(path);
+        for (const std::string &library : libraries)
+            parse_mtl(directory + library, scene.materials);
+    }
+    std::unordered_map<std::string, int> material_indices;
+    for (size_t i = 0; i < scene.materials.size(); i++)
+        material_indices.emplace(scene.materials[i].name, static_cast<int>(i));
+
+    std::unordered_map<std::string, int> mesh_indices;
+    std::string object, material;
+    for (Chunk &chunk : chunks)
+    {
+        for (Run &run : chunk.runs)
+        {
+            if (run.has_object)
+                object = run.object;
+            else
+                run.object = object;
+            if (run.has_material)
+                material = run.material;
+            else
+                run.material = material;
+            std::string key = options.merge_objects ? run.material : run.object + '\n' + run.material;
+            auto found = mesh_indices.find(key);
+            if (found == mesh_indices.end())
+            {
+                found = mesh_indices.emplace(key, static_cast<int>(scene.meshes.size())).first;
+                ObjMesh mesh;
+                mesh.name = options.merge_objects ? run.material : run.object;
+                auto named = material_indices.find(run.material);
+                mesh.material = named != material_indices.end() ? named->second : -1;
+                scene.meshes.push_back(std::move(mesh));
+            }
+            chunk.run_meshes.push_back(found->second);
+            // 段内的变化已经写进了各段，下一块从这一块最后的状态继续
+            object = run.object;
+            material = run.material;
+        }
+    }
+
+    // 3. 按网格计数排序三角形，同时把索引换成全局的
+    size_t mesh_count = scene.meshes.size();
+    std::vector<size_t> offsets(chunks.size() * mesh_count, 0);
+    std::vector<size_t> mesh_first(mesh_count + 1, 0);
+    for (size_t c = 0; c < chunks.size(); c++)
+        for (uint32_t run : chunks[c].triangle_runs)
+            offsets[c * mesh_count + chunks[c].run_meshes[run]]++;
+    size_t total = 0;
+    for (size_t m = 0; m < mesh_count; m++)
+    {
+        mesh_first[m] = total;
+        for (size_t c = 0; c < chunks.size(); c++)
+        {
+            size_t count = offsets[c * mesh_count + m];
+            offsets[c * mesh_count + m] = total;
+            total += count;
+        }
+    }
+    mesh_first[mesh_count] = total;
+
+    std::vector<Corner> sorted(total * 3);
+    std::vector<uint8_t> valid(total, 1);
+    auto scatter = [&](size_t begin, size_t end)
+    {
+        for (size_t c = begin; c < end; c++)
+        {
+            const Chunk &chunk = chunks[c];
+            size_t *cursor = &offsets[c * mesh_count];
+            for (size_t t = 0; t < chunk.triangle_runs.size(); t++)
+            {
+                size_t slot = cursor[chunk.run_meshes[chunk.triangle_runs[t]]]++;
+                for (int k = 0; k < 3; k++)
+                {
+                    const Corner &corner = chunk.corners[t * 3 + k];
+                    Corner &global = sorted[slot * 3 + k];
+                    global.v = decode_index(corner.v, chunk.position_base, attributes.positions.size());
+                    global.vt = decode_index(corner.vt, chunk.uv_base, attributes.uvs.size());
+                    global.vn = decode_index(corner.vn, chunk.normal_base, attributes.normals.size());
+                    if (global.v == MISSING)
+                        valid[slot] = 0;
+                }
+            }
+        }
+    };
+    if (options.jobs && chunks.size() > 1)
+        options.jobs->parallel_for(chunks.size(), 1, scatter);
+    else
+        scatter(0, chunks.size());
+    chunks.clear();
+
+    // 越界的三角形去掉（索引错误的文件），在各网格内部压紧
+    size_t dropped = 0;
+    for (size_t m = 0; m < mesh_count; m++)
+    {
+        size_t write = mesh_first[m];
+        for (size_t t = mesh_first[m]; t < mesh_first[m + 1]; t++)
+        {
+            if (!valid[t])
+                continue;
+            if (write != t)
+                std::copy(&sorted[t * 3], &sorted[t * 3] + 3, &sorted[write * 3]);
+            write++;
+        }
+        dropped += mesh_first[m + 1] - write;
+        offsets[m] = write - mesh_first[m]; // 复用为有效三角形数
+    }
+
+    // 4. 各网格并行焊接顶点、生成法线和切线
+    auto build = [&](size_t begin, size_t end)
+    {
+        for (size_t m = begin; m < end; m++)
+            build_mesh(&sorted[mesh_first[m] * 3], offsets[m], attributes, options.flip_uvs, scene.meshes[m]);
+    };
+    if (options.jobs && mesh_count > 1)
+        options.jobs->parallel_for(mesh_count, 1, build);
+    else
+        build(0, mesh_count);
+
+    // 没有三角形的网格（只有 usemtl 没有面）去掉
+    scene.meshes.erase(std::remove_if(scene.meshes.begin(), scene.meshes.end(), [](const ObjMesh &mesh)
+                                      { return mesh.indices.empty(); }),
+                       scene.meshes.end());
+    scene.positions = attributes.positions.size();
+    scene.uvs = attributes.uvs.size();
+    scene.normals = attributes.normals.size();
+    scene.triangles = total - dropped;
+    if (invalid_faces + dropped > 0)
+        printf("ERROR::OBJ:: %s: skipped %zu malformed faces and %zu triangles with out-of-range indices\n", path.c_str(), invalid_faces, dropped);
+    return true;
+}
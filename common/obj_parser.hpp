@@ -0,0 +1,72 @@
+#ifndef OBJ_PARSER_HPP
+#define OBJ_PARSER_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "mesh.hpp"
+
+class JobSystem;
+
+// MTL 中的一个材质，贴图路径相对于 MTL 所在目录
+struct ObjMaterial
+{
+    std::string name;
+    glm::vec3 ambient = glm::vec3(0.0f);  // Ka
+    glm::vec3 diffuse = glm::vec3(1.0f);  // Kd
+    glm::vec3 specular = glm::vec3(0.0f); // Ks
+    float shininess = 0.0f;               // Ns
+    float opacity = 1.0f;                 // d（或 1 - Tr）
+    std::string ambient_map;              // map_Ka
+    std::string diffuse_map;              // map_Kd
+    std::string specular_map;             // map_Ks
+    std::string bump_map;                 // map_Bump / bump，与 Assimp 一样当作法线贴图使用
+    std::string normal_map;               // norm / map_Kn
+    std::string opacity_map;              // map_d
+    std::string roughness_map;            // map_Pr（PBR 扩展）
+    std::string metallic_map;             // map_Pm（PBR 扩展）
+};
+
+// 一个 (对象, 材质) 的索引网格，可以直接交给 Mesh
+struct ObjMesh
+{
+    std::string name; // o / g 的名字
+    int material = -1; // ObjScene::materials 下标，没有 usemtl 或找不到时为 -1
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    bool has_normals = false; // 文件里带法线；没有 vn 的顶点用生成的平滑法线
+    bool has_uvs = false;
+};
+
+struct ObjScene
+{
+    std::vector<ObjMesh> meshes;
+    std::vector<ObjMaterial> materials;
+    // 文件里的元素个数
+    size_t positions = 0, uvs = 0, normals = 0, triangles = 0;
+};
+
+struct ObjParseOptions
+{
+    JobSystem *jobs = nullptr; // 为空时单线程解析
+    size_t chunk_size = 1 << 20; // 每块大约的字节数，块边界落在行尾
+    bool flip_uvs = true;        // v = 1 - v，与 Model 里 Assimp 的 aiProcess_FlipUVs 一致
+    bool merge_objects = false;  // 忽略 o / g，只按材质分网格（静态烘焙）
+    bool load_materials = true;  // 解析 mtllib 引用的 MTL
+};
+
+/**
+ * @brief 高吞吐的 OBJ 解析器。
+ *        文件整体 mmap，按 chunk_size 在行边界切块，各块并行解析（手写的数字解析，不经过 fscanf / strtof 的 locale 处理），
+ *        块内的负索引先记成相对位置，合并时加上前面各块的元素数；usemtl / o / g 的状态也在合并时顺延到下一块。
+ *        面可以是任意多边形（扇形三角化），v、v/vt、v//vn、v/vt/vn 都支持。
+ *        输出按 (对象, 材质) 分组的索引网格：相同 v/vt/vn 组合的角焊接成一个顶点，缺法线时按位置生成平滑法线，
+ *        有纹理坐标时计算切线 / 副切线，各网格的构建也并行进行。失败时打印错误并返回 false。
+ */
+bool parse_obj(const std::string &path, ObjScene &scene, const ObjParseOptions &options = ObjParseOptions());
+
+// 追加 path 中的材质；失败时打印错误并返回 false
+bool parse_mtl(const std::string &path, std::vector<ObjMaterial> &materials);
+
+#endif // OBJ_PARSER_HPP
@@ -0,0 +1,66 @@
+#include "orm_packing.hpp"
+#include <algorithm>
+#include <cctype>
+
+bool find_orm_channel(const std::string &path, OrmChannel &channel, std::string &packed_path)
+{
+    size_t slash = path.find_last_of("/\\");
+    size_t name_begin = slash == std::string::npos ? 0 : slash + 1;
+    size_t dot = path.find_last_of('.');
+    size_t name_end = dot == std::string::npos || dot < name_begin ? path.size() : dot;
+
+    std::string name = path.substr(name_begin, name_end - name_begin);
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c)
+                   { return static_cast<char>(std::tolower(c)); });
+
+    // "_ao" 带下划线，避免误匹配 "chaos" 之类的名字
+    static const struct
+    {
+        const char *key;
+        OrmChannel channel;
+        size_t skip; // 保留在打包文件名里的前缀字符数
+    } keys[] = {{"occlusion", OrmChannel::OCCLUSION, 0}, {"_ao", OrmChannel::OCCLUSION, 1},
+                {"roughness", OrmChannel::ROUGHNESS, 0}, {"metallic", OrmChannel::METALLIC, 0},
+                {"metalness", OrmChannel::METALLIC, 0}};
+    for (const auto &key : keys)
+    {
+        size_t found = name.find(key.key);
+        if (found == std::string::npos)
+            continue;
+        size_t keep = found + key.skip;
+        size_t length = std::char_traits<char>::length(key.key) - key.skip;
+        channel = key.channel;
+        packed_path = path.substr(0, name_begin + keep) + "orm" + path.substr(name_begin + keep + length, name_end - name_begin - keep - length) + ".ktx2";
+        return true;
+    }
+    return false;
+}
+
+ImageRGBA pack_orm(const ImageRGBA *channels[size_t(OrmChannel::COUNT)])
+{
+    ImageRGBA packed;
+    for (size_t c = 0; c < size_t(OrmChannel::COUNT); c++)
+        if (channels[c])
+        {
+            packed.width = std::max(packed.width, channels[c]->width);
+            packed.height = std::max(packed.height, channels[c]->height);
+        }
+    packed.pixels.assign(size_t(packed.width) * packed.height * 4, 255);
+
+    for (size_t c = 0; c < size_t(OrmChannel::COUNT); c++)
+    {
+        const ImageRGBA *source = channels[c];
+        if (!source)
+            continue;
+        for (int y = 0; y < packed.height; y++)
+        {
+            int sy = y * source->height / packed.height;
+            for (int x = 0; x < packed.width; x++)
+            {
+                int sx = x * source->width / packed.width;
+                packed.pixels[(size_t(y) * packed.width + x) * 4 + c] = source->pixels[(size_t(sy) * source->width + sx) * 4];
+            }
+        }
+    }
+    return packed;
+}
@@ -0,0 +1,28 @@
+#ifndef ORM_PACKING_HPP
+#define ORM_PACKING_HPP
+
+#include <string>
+#include "block_compression.hpp"
+
+// ORM 打包纹理的通道顺序，与 glTF 的 occlusionRoughnessMetallic 约定相同
+enum class OrmChannel
+{
+    OCCLUSION, // R
+    ROUGHNESS, // G
+    METALLIC,  // B
+    COUNT
+};
+
+/**
+ * @brief 根据文件名判断纹理属于 ORM 的哪个通道（_ao / occlusion、roughness、metallic / metalness，不区分大小写），
+ *        并给出打包后的路径：文件名里的关键字换成 orm、扩展名换成 .ktx2，
+ *        例如 metalgrid2_AO.png、metalgrid2_roughness.png -> metalgrid2_orm.ktx2。
+ *        texcook 用它把同一材质的三张贴图分组，运行时用它找打包好的纹理。
+ */
+bool find_orm_channel(const std::string &path, OrmChannel &channel, std::string &packed_path);
+
+// 打包：每张图取 R 通道，缺少的通道填 255（与 Mesh 缺贴图时绑定的白色纹理一致），
+// 尺寸不一致时按最大的一张最近邻采样。至少要有一张图
+ImageRGBA pack_orm(const ImageRGBA *channels[size_t(OrmChannel::COUNT)]);
+
+#endif // ORM_PACKING_HPP
@@ -0,0 +1,423 @@
+#include "profiler.hpp"
+#include "gl_registry.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+    struct CpuMarker
+    {
+        const char *name;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    // 每个线程各自的 CPU 作用域栈，嵌套深度互不影响
+    thread_local std::vector<CpuMarker> tls_cpu_stack;
+
+    double to_ms(std::chrono::steady_clock::duration duration)
+    {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    // 线程在 trace 中的编号，按第一次记录事件的顺序分配
+    std::atomic<uint32_t> next_thread_id{1};
+
+    uint32_t current_thread_id()
+    {
+        thread_local uint32_t id = next_thread_id++;
+        return id;
+    }
+}
+
+void Profiler::Scope::push(float ms)
+{
+    if (history.size() < HISTORY_SIZE)
+        history.push_back(ms);
+    else
+        history[history_next] = ms;
+    history_next = (history_next + 1) % HISTORY_SIZE;
+}
+
+Profiler &Profiler::instance()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+int Profiler::find_scope(const char *name, bool gpu, int depth)
+{
+    std::string key = (gpu ? "gpu:" : "cpu:") + std::string(name);
+    auto found = scope_index.find(key);
+    if (found != scope_index.end())
+        return found->second;
+    Scope scope;
+    scope.name = name;
+    scope.gpu = gpu;
+    scope.depth = depth;
+    scopes.push_back(scope);
+    int index = static_cast<int>(scopes.size() - 1);
+    scope_index[key] = index;
+    return index;
+}
+
+void Profiler::begin_frame()
+{
+    if (!enabled)
+        return;
+    clock::time_point now = clock::now();
+    std::lock_guard<std::mutex> lock(mutex);
+    gl_thread = current_thread_id();
+    if (frame_start.time_since_epoch().count() != 0)
+    {
+        if (capture_state == CaptureState::RECORDING && frame_start >= capture_origin)
+            trace_events.push_back(TraceEvent{"frame", gl_thread, capture_time_us(frame_start), to_ms(now - frame_start) * 1000.0});
+        float frame_ms = static_cast<float>(to_ms(now - frame_start));
+        frame_scope.push(frame_ms);
+        float overhead = frame_ms > 0.0f ? static_cast<float>(frame_overhead_ms / frame_ms * 100.0) : 0.0f;
+        if (overhead_history.size() < HISTORY_SIZE)
+            overhead_history.push_back(overhead);
+        else
+            overhead_history[overhead_next] = overhead;
+        overhead_next = (overhead_next + 1) % HISTORY_SIZE;
+    }
+    frame_start = now;
+    frame_overhead_ms = 0.0;
+    init_gpu();
+}
+
+void Profiler::init_gpu()
+{
+    if (gpu_initialized)
+        return;
+    // 查询对象跟随分析器单例常驻
+    for (GpuFrame &frame : gpu_frames)
+    {
+        glGenQueries(MAX_GPU_SCOPES_PER_FRAME * 2, frame.queries);
+        for (GLuint query : frame.queries)
+        {
+            GL_TRACK(QUERY, query, "profiler timestamp");
+            GLRegistry::instance().set_persistent(GLObjectType::QUERY, query);
+        }
+    }
+    gpu_initialized = true;
+}
+
+void Profiler::end_frame()
+{
+    if (!enabled)
+        return;
+    clock::time_point start = clock::now();
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (Scope &scope : scopes)
+    {
+        if (scope.gpu || scope.frame_ms < 0.0)
+            continue;
+        scope.push(static_cast<float>(scope.frame_ms));
+        scope.frame_ms = -1.0; // -1 表示本帧未进入
+    }
+
+    // 当前帧的查询交给 GPU，回收 FRAME_LATENCY - 1 帧之前的结果
+    gpu_frames[gpu_frame_index].pending = true;
+    gpu_frame_index = (gpu_frame_index + 1) % FRAME_LATENCY;
+    collect_gpu_frame(gpu_frames[gpu_frame_index]);
+
+    // 录满帧数后再等 FRAME_LATENCY 帧，让最后几帧的 GPU 结果也进入 trace
+    if (capture_state != CaptureState::IDLE && --capture_frames_left <= 0)
+    {
+        if (capture_state == CaptureState::RECORDING)
+        {
+            capture_state = CaptureState::DRAINING;
+            capture_frames_left = FRAME_LATENCY;
+        }
+        else
+        {
+            write_trace(capture_path);
+            capture_state = CaptureState::IDLE;
+            trace_events.clear();
+        }
+    }
+
+    frame_overhead_ms += to_ms(clock::now() - start);
+}
+
+double Profiler::capture_time_us(clock::time_point time) const
+{
+    return std::chrono::duration<double, std::micro>(time - capture_origin).count();
+}
+
+void Profiler::collect_gpu_frame(GpuFrame &frame)
+{
+    if (frame.pending && !frame.markers.empty())
+    {
+        GLint available = 0;
+        glGetQueryObjectiv(frame.markers.back().end_query, GL_QUERY_RESULT_AVAILABLE, &available);
+        // 还没完成就丢弃这一帧的数据，而不是等待 GPU
+        if (available)
+        {
+            bool trace = capture_state != CaptureState::IDLE && frame.calibrated;
+            std::map<int, double> frame_ms;
+            for (const GpuMarker &marker : frame.markers)
+            {
+                GLuint64 begin_ns = 0, end_ns = 0;
+                glGetQueryObjectui64v(marker.begin_query, GL_QUERY_RESULT, &begin_ns);
+                glGetQueryObjectui64v(marker.end_query, GL_QUERY_RESULT, &end_ns);
+                frame_ms[marker.scope] += (end_ns - begin_ns) / 1e6;
+                if (trace)
+                    trace_events.push_back(TraceEvent{scopes[marker.scope].name, GPU_THREAD,
+                                                      begin_ns / 1000.0 + frame.clock_offset_us, (end_ns - begin_ns) / 1000.0});
+            }
+            for (const auto &entry : frame_ms)
+                scopes[entry.first].push(static_cast<float>(entry.second));
+        }
+    }
+    frame.markers.clear();
+    frame.open.clear();
+    frame.pending = false;
+    frame.calibrated = false;
+}
+
+void Profiler::begin_cpu(const char *name)
+{
+    if (!enabled)
+        return;
+    tls_cpu_stack.push_back(CpuMarker{name, clock::now()});
+}
+
+void Profiler::end_cpu()
+{
+    if (!enabled || tls_cpu_stack.empty())
+        return;
+    clock::time_point end = clock::now();
+    CpuMarker marker = tls_cpu_stack.back();
+    tls_cpu_stack.pop_back();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    int scope = find_scope(marker.name, false, static_cast<int>(tls_cpu_stack.size()));
+    if (scopes[scope].frame_ms < 0.0)
+        scopes[scope].frame_ms = 0.0;
+    scopes[scope].frame_ms += to_ms(end - marker.start);
+    if (capture_state == CaptureState::RECORDING && marker.start >= capture_origin)
+        trace_events.push_back(TraceEvent{marker.name, current_thread_id(), capture_time_us(marker.start), to_ms(end - marker.start) * 1000.0});
+    frame_overhead_ms += to_ms(clock::now() - end);
+}
+
+void Profiler::begin_gpu(const char *name)
+{
+    if (!enabled)
+        return;
+    clock::time_point start = clock::now();
+    std::lock_guard<std::mutex> lock(mutex);
+    // 第一帧之前（如加载时的 IBL 预计算）也可以计时
+    init_gpu();
+    GpuFrame &frame = gpu_frames[gpu_frame_index];
+    if (frame.markers.size() >= MAX_GPU_SCOPES_PER_FRAME)
+    {
+        frame.open.push_back(-1);
+        return;
+    }
+    if (capture_state == CaptureState::RECORDING && !frame.calibrated)
+    {
+        // GPU 时间戳和 CPU 时钟不同源，每帧对一次表
+        GLint64 gpu_now_ns = 0;
+        glGetInteger64v(GL_TIMESTAMP, &gpu_now_ns);
+        frame.clock_offset_us = capture_time_us(clock::now()) - gpu_now_ns / 1000.0;
+        frame.calibrated = true;
+    }
+    size_t slot = frame.markers.size();
+    int scope = find_scope(name, true, static_cast<int>(frame.open.size()));
+    GpuMarker marker{scope, frame.queries[2 * slot], frame.queries[2 * slot + 1]};
+    glQueryCounter(marker.begin_query, GL_TIMESTAMP);
+    frame.open.push_back(static_cast<int>(slot));
+    frame.markers.push_back(marker);
+    frame_overhead_ms += to_ms(clock::now() - start);
+}
+
+void Profiler::end_gpu()
+{
+    if (!enabled || !gpu_initialized)
+        return;
+    clock::time_point start = clock::now();
+    std::lock_guard<std::mutex> lock(mutex);
+    GpuFrame &frame = gpu_frames[gpu_frame_index];
+    if (frame.open.empty())
+        return;
+    int slot = frame.open.back();
+    frame.open.pop_back();
+    if (slot >= 0)
+        glQueryCounter(frame.markers[slot].end_query, GL_TIMESTAMP);
+    frame_overhead_ms += to_ms(clock::now() - start);
+}
+
+namespace
+{
+    Profiler::ScopeStats make_stats(const std::string &name, bool gpu, int depth, const std::vector<float> &history, int history_next)
+    {
+        Profiler::ScopeStats stats{name, gpu, depth, 0.0f, 0.0f, 0.0f, 0.0f};
+        if (history.empty())
+            return stats;
+        std::vector<float> sorted = history;
+        std::sort(sorted.begin(), sorted.end());
+        double sum = 0.0;
+        for (float ms : sorted)
+            sum += ms;
+        int last = (history_next + static_cast<int>(history.size()) - 1) % static_cast<int>(history.size());
+        stats.last_ms = history[last];
+        stats.min_ms = sorted.front();
+        stats.avg_ms = static_cast<float>(sum / sorted.size());
+        stats.p99_ms = sorted[std::min(sorted.size() - 1, static_cast<size_t>(sorted.size() * 0.99))];
+        return stats;
+    }
+}
+
+std::vector<Profiler::ScopeStats> Profiler::get_stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<ScopeStats> result;
+    for (const Scope &scope : scopes)
+        result.push_back(make_stats(scope.name, scope.gpu, scope.depth, scope.history, scope.history_next));
+    return result;
+}
+
+Profiler::ScopeStats Profiler::get_frame_stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return make_stats("frame", false, 0, frame_scope.history, frame_scope.history_next);
+}
+
+float Profiler::get_overhead_percent() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (overhead_history.empty())
+        return 0.0f;
+    double sum = 0.0;
+    for (float percent : overhead_history)
+        sum += percent;
+    return static_cast<float>(sum / overhead_history.size());
+}
+
+void Profiler::print_summary() const
+{
+    ScopeStats frame = get_frame_stats();
+    printf("frame: %.2f ms avg (%.1f FPS), p99 %.2f ms, profiler overhead %.3f%%\n",
+           frame.avg_ms, frame.avg_ms > 0.0f ? 1000.0f / frame.avg_ms : 0.0f, frame.p99_ms, get_overhead_percent());
+    for (const ScopeStats &scope : get_stats())
+        printf("  %*s[%s] %-24s avg %7.3f  min %7.3f  p99 %7.3f ms\n", scope.depth * 2, "", scope.gpu ? "GPU" : "CPU",
+               scope.name.c_str(), scope.avg_ms, scope.min_ms, scope.p99_ms);
+}
+
+void Profiler::reset()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    scopes.clear();
+    scope_index.clear();
+    frame_scope = Scope();
+    overhead_history.clear();
+    overhead_next = 0;
+    frame_start = clock::time_point();
+}
+
+void Profiler::start_capture(const std::string &path, int frames)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    capture_path = path;
+    capture_frames_left = std::max(frames, 1);
+    capture_origin = clock::now();
+    capture_state = CaptureState::RECORDING;
+    trace_events.clear();
+    for (GpuFrame &frame : gpu_frames)
+        frame.calibrated = false;
+    printf("profiler: capturing %d frames to %s\n", capture_frames_left, path.c_str());
+}
+
+bool Profiler::stop_capture()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (capture_state == CaptureState::IDLE)
+        return false;
+    bool written = write_trace(capture_path);
+    capture_state = CaptureState::IDLE;
+    trace_events.clear();
+    return written;
+}
+
+bool Profiler::is_capturing() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return capture_state != CaptureState::IDLE;
+}
+
+void Profiler::parse_command_line(int argc, char **argv)
+{
+    std::string path;
+    int frames = 120;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strncmp(argv[i], "--trace=", 8) == 0)
+            path = argv[i] + 8;
+        else if (std::strncmp(argv[i], "--trace-frames=", 15) == 0)
+            frames = std::atoi(argv[i] + 15);
+    }
+    if (!path.empty())
+        start_capture(path, frames);
+}
+
+namespace
+{
+    void write_json_string(FILE *file, const std::string &text)
+    {
+        fputc('"', file);
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+                fprintf(file, "\\%c", c);
+            else if (static_cast<unsigned char>(c) < 0x20)
+                fprintf(file, "\\u%04x", c);
+            else
+                fputc(c, file);
+        }
+        fputc('"', file);
+    }
+}
+
+bool Profiler::write_trace(const std::string &path) const
+{
+    FILE *file = fopen(path.c_str(), "w");
+    if (!file)
+    {
+        printf("profiler: failed to open trace file %s\n", path.c_str());
+        return false;
+    }
+
+    // pid 1 是 CPU 各线程，pid 2 是 GPU 时间线
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"CPU\"}},\n");
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":2,\"args\":{\"name\":\"GPU\"}},\n");
+    fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":2,\"tid\":0,\"args\":{\"name\":\"GL queue\"}}");
+    std::vector<uint32_t> threads;
+    for (const TraceEvent &event : trace_events)
+    {
+        if (event.thread != GPU_THREAD && std::find(threads.begin(), threads.end(), event.thread) == threads.end())
+            threads.push_back(event.thread);
+    }
+    for (uint32_t thread : threads)
+    {
+        fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s %u\"}}",
+                thread, thread == gl_thread ? "GL thread" : "thread", thread);
+    }
+    for (const TraceEvent &event : trace_events)
+    {
+        bool gpu = event.thread == GPU_THREAD;
+        fprintf(file, ",\n{\"name\":");
+        write_json_string(file, event.name);
+        fprintf(file, ",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                gpu ? "gpu" : "cpu", gpu ? 2 : 1, gpu ? 0u : event.thread, event.start_us, event.duration_us);
+    }
+    fprintf(file, "\n]}\n");
+    fclose(file);
+    printf("profiler: wrote %zu trace events to %s\n", trace_events.size(), path.c_str());
+    return true;
+}
@@ -0,0 +1,167 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+
+/**
+ * @brief 帧性能分析器。
+ *        CPU 作用域用 steady_clock 计时，可嵌套；GPU 作用域用 GL_TIMESTAMP 查询对计时（GL_TIME_ELAPSED 查询不能嵌套），
+ *        查询结果延迟 FRAME_LATENCY 帧读取，读取前检查 GL_QUERY_RESULT_AVAILABLE，不会让 CPU 等待 GPU。
+ *        每个作用域保留最近 HISTORY_SIZE 帧的耗时，用于统计 min/avg/p99。
+ *        start_capture() 之后逐条记录各线程的 CPU 作用域和 GPU 作用域，捕获指定帧数后写出 Chrome trace-event JSON，
+ *        可以用 chrome://tracing 或 ui.perfetto.dev 打开。在第一次 begin_frame 之前开始捕获还能记录启动阶段。
+ */
+class Profiler
+{
+public:
+    static constexpr int FRAME_LATENCY = 3;
+    static constexpr int HISTORY_SIZE = 240;
+    static constexpr int MAX_GPU_SCOPES_PER_FRAME = 64;
+
+    struct ScopeStats
+    {
+        std::string name;
+        bool gpu;
+        int depth;
+        float last_ms;
+        float min_ms;
+        float avg_ms;
+        float p99_ms;
+    };
+
+    static Profiler &instance();
+
+    void set_enabled(bool enabled) { this->enabled = enabled; }
+    bool is_enabled() const { return enabled; }
+
+    // 每帧开始/结束时在 GL 线程调用
+    void begin_frame();
+    void end_frame();
+
+    void begin_cpu(const char *name);
+    void end_cpu();
+    void begin_gpu(const char *name);
+    void end_gpu();
+
+    // 按首次出现的顺序返回所有作用域的统计
+    std::vector<ScopeStats> get_stats() const;
+    ScopeStats get_frame_stats() const;
+    // 分析器自身耗时占帧时间的百分比（最近 HISTORY_SIZE 帧平均）
+    float get_overhead_percent() const;
+    void print_summary() const;
+    void reset();
+
+    // 捕获接下来 frames 帧（以及开始捕获到第一帧之间）的时间线，结束后写到 path
+    void start_capture(const std::string &path, int frames);
+    // 立即结束捕获并写出文件（如程序在捕获完成前退出）
+    bool stop_capture();
+    bool is_capturing() const;
+    // 解析 --trace=<文件> 和 --trace-frames=<帧数>，有 --trace 时立即开始捕获
+    void parse_command_line(int argc, char **argv);
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    struct Scope
+    {
+        std::string name;
+        bool gpu = false;
+        int depth = 0;
+        double frame_ms = -1.0; // 当前帧累计，-1 表示本帧未进入
+        std::vector<float> history;
+        int history_next = 0;
+
+        void push(float ms);
+    };
+
+    struct GpuMarker
+    {
+        int scope;
+        GLuint begin_query;
+        GLuint end_query;
+    };
+
+    struct GpuFrame
+    {
+        GLuint queries[MAX_GPU_SCOPES_PER_FRAME * 2] = {0};
+        std::vector<GpuMarker> markers;
+        std::vector<int> open; // 尚未结束的 GPU 作用域在 markers 中的下标
+        bool pending = false;
+        bool calibrated = false;
+        double clock_offset_us = 0.0; // GPU 时间戳换算到捕获时间线的偏移
+    };
+
+    enum class CaptureState
+    {
+        IDLE,
+        RECORDING,
+        DRAINING // 不再记录新事件，等待最后几帧的 GPU 查询结果
+    };
+
+    struct TraceEvent
+    {
+        std::string name;
+        uint32_t thread; // GPU_THREAD 表示 GPU 时间线
+        double start_us; // 相对 capture_origin
+        double duration_us;
+    };
+
+    static constexpr uint32_t GPU_THREAD = 0xffffffffu;
+
+    Profiler() = default;
+
+    void init_gpu();
+    int find_scope(const char *name, bool gpu, int depth);
+    void collect_gpu_frame(GpuFrame &frame);
+    double capture_time_us(clock::time_point time) const;
+    bool write_trace(const std::string &path) const;
+
+    bool enabled = true;
+    mutable std::mutex mutex;
+    std::vector<Scope> scopes;
+    std::map<std::string, int> scope_index; // "cpu:名字" / "gpu:名字" -> scopes 下标
+    GpuFrame gpu_frames[FRAME_LATENCY];
+    int gpu_frame_index = 0;
+    bool gpu_initialized = false;
+
+    clock::time_point frame_start;
+    Scope frame_scope;
+    double frame_overhead_ms = 0.0;
+    std::vector<float> overhead_history;
+    int overhead_next = 0;
+
+    CaptureState capture_state = CaptureState::IDLE;
+    std::string capture_path;
+    int capture_frames_left = 0;
+    clock::time_point capture_origin;
+    uint32_t gl_thread = 0;
+    std::vector<TraceEvent> trace_events;
+};
+
+// RAII 作用域
+class ProfileCpuScope
+{
+public:
+    explicit ProfileCpuScope(const char *name) { Profiler::instance().begin_cpu(name); }
+    ~ProfileCpuScope() { Profiler::instance().end_cpu(); }
+};
+
+class ProfileGpuScope
+{
+public:
+    explicit ProfileGpuScope(const char *name) { Profiler::instance().begin_gpu(name); }
+    ~ProfileGpuScope() { Profiler::instance().end_gpu(); }
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_CPU_SCOPE(name) ProfileCpuScope PROFILE_CONCAT(profile_cpu_scope_, __LINE__)(name)
+#define PROFILE_GPU_SCOPE(name) ProfileGpuScope PROFILE_CONCAT(profile_gpu_scope_, __LINE__)(name)
+
+#endif // PROFILER_HPP
@@ -0,0 +1,52 @@
+#ifndef PROFILER_OVERLAY_HPP
+#define PROFILER_OVERLAY_HPP
+
+// 性能分析器的 ImGui 面板，只在链接了 ImGui 的程序中包含
+#include "imgui.h"
+#include "profiler.hpp"
+
+inline void draw_profiler_overlay(Profiler &profiler = Profiler::instance())
+{
+    ImGui::Begin("Profiler");
+
+    bool enabled = profiler.is_enabled();
+    if (ImGui::Checkbox("enabled", &enabled))
+        profiler.set_enabled(enabled);
+    ImGui::SameLine();
+    if (ImGui::Button("reset"))
+        profiler.reset();
+
+    Profiler::ScopeStats frame = profiler.get_frame_stats();
+    ImGui::Text("frame %.2f ms (%.1f FPS)  p99 %.2f ms", frame.avg_ms, frame.avg_ms > 0.0f ? 1000.0f / frame.avg_ms : 0.0f, frame.p99_ms);
+    float overhead = profiler.get_overhead_percent();
+    ImGui::TextColored(overhead < 1.0f ? ImVec4(0.6f, 1.0f, 0.6f, 1.0f) : ImVec4(1.0f, 0.4f, 0.4f, 1.0f),
+                       "profiler overhead %.3f%%", overhead);
+
+    if (ImGui::BeginTable("scopes", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+    {
+        ImGui::TableSetupColumn("scope");
+        ImGui::TableSetupColumn("last ms");
+        ImGui::TableSetupColumn("min ms");
+        ImGui::TableSetupColumn("avg ms");
+        ImGui::TableSetupColumn("p99 ms");
+        ImGui::TableHeadersRow();
+        for (const Profiler::ScopeStats &scope : profiler.get_stats())
+        {
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0);
+            ImGui::Text("%*s%s %s", scope.depth * 2, "", scope.gpu ? "[GPU]" : "[CPU]", scope.name.c_str());
+            ImGui::TableSetColumnIndex(1);
+            ImGui::Text("%.3f", scope.last_ms);
+            ImGui::TableSetColumnIndex(2);
+            ImGui::Text("%.3f", scope.min_ms);
+            ImGui::TableSetColumnIndex(3);
+            ImGui::Text("%.3f", scope.avg_ms);
+            ImGui::TableSetColumnIndex(4);
+            ImGui::Text("%.3f", scope.p99_ms);
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
+
+#endif // PROFILER_OVERLAY_HPP
@@ -0,0 +1,252 @@
+#include "render_context.hpp"
+#include "gl_handle.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef HAVE_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+void RenderContextDesc::parse_command_line(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--headless") == 0)
+            headless = true;
+        else if (std::strcmp(argv[i], "--window") == 0)
+            headless = false;
+        else if (std::strncmp(argv[i], "--frames=", 9) == 0)
+            frame_limit = std::atoi(argv[i] + 9);
+        else if (std::strncmp(argv[i], "--size=", 7) == 0)
+            std::sscanf(argv[i] + 7, "%dx%d", &width, &height);
+    }
+    // 无窗口时没有人去关窗口，默认渲染有限帧
+    if (headless && frame_limit == 0)
+        frame_limit = 60;
+}
+
+size_t RenderContext::leak_count = 0;
+
+std::unique_ptr<RenderContext> RenderContext::create(const RenderContextDesc &desc)
+{
+    if (desc.headless)
+    {
+        std::unique_ptr<HeadlessContext> context(new HeadlessContext(desc));
+        if (context->is_valid())
+            return context;
+        return nullptr;
+    }
+    std::unique_ptr<GlfwContext> context(new GlfwContext(desc));
+    if (context->is_valid())
+        return context;
+    return nullptr;
+}
+
+void RenderContext::begin_frame()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, get_framebuffer());
+    glViewport(0, 0, width, height);
+}
+
+void RenderContext::read_pixels(std::vector<unsigned char> &pixels) const
+{
+    pixels.resize(size_t(width) * height * 4);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, get_framebuffer());
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+}
+
+// ---------------------------------------------------------------- GLFW
+
+GlfwContext::GlfwContext(const RenderContextDesc &desc)
+{
+    frame_limit = desc.frame_limit;
+    if (!glfwInit())
+    {
+        printf("ERROR::GLFW:: failed to initialize\n");
+        return;
+    }
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    window = glfwCreateWindow(desc.width, desc.height, desc.title.c_str(), NULL, NULL);
+    if (!window)
+    {
+        printf("ERROR::GLFW:: failed to create window\n");
+        glfwTerminate();
+        return;
+    }
+    glfwMakeContextCurrent(window);
+    gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
+    glfwSetScrollCallback(window, camera_scroll_callback);
+    glfwGetFramebufferSize(window, &width, &height);
+    glViewport(0, 0, width, height);
+}
+
+GlfwContext::~GlfwContext()
+{
+    if (window)
+    {
+        GLDeletionQueue::instance().flush();
+        leak_count = GLRegistry::instance().dump_leaks();
+        glfwTerminate();
+    }
+}
+
+bool GlfwContext::should_close() const
+{
+    return glfwWindowShouldClose(window) != 0 || glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS ||
+           (frame_limit > 0 && frame_index >= frame_limit);
+}
+
+void GlfwContext::begin_frame()
+{
+    glfwGetFramebufferSize(window, &width, &height);
+    RenderContext::begin_frame();
+}
+
+void GlfwContext::end_frame()
+{
+    glfwSwapBuffers(window);
+    glfwPollEvents();
+    GLDeletionQueue::instance().end_frame();
+    frame_index++;
+}
+
+CameraInput GlfwContext::get_camera_input()
+{
+    CameraInput input;
+    if (!poll_camera_input(window, input))
+    {
+        // 光标在窗口外时不响应输入，但仍然更新矩阵
+        input.rotate_x = 0.0f;
+        input.rotate_y = 0.0f;
+    }
+    return input;
+}
+
+// ---------------------------------------------------------------- EGL
+
+HeadlessContext::HeadlessContext(const RenderContextDesc &desc) : fixed_timestep(desc.fixed_timestep)
+{
+    width = desc.width;
+    height = desc.height;
+    frame_limit = desc.frame_limit;
+#ifdef HAVE_EGL
+    // 优先用 Mesa 的 surfaceless 平台，其次是 EGL 设备（NVIDIA 无显示器），最后是默认显示
+    EGLDisplay egl_display = EGL_NO_DISPLAY;
+    PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (get_platform_display)
+    {
+        egl_display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+        PFNEGLQUERYDEVICESEXTPROC query_devices = (PFNEGLQUERYDEVICESEXTPROC)eglGetProcAddress("eglQueryDevicesEXT");
+        EGLDeviceEXT device;
+        EGLint device_count = 0;
+        if (egl_display == EGL_NO_DISPLAY && query_devices && query_devices(1, &device, &device_count) && device_count > 0)
+            egl_display = get_platform_display(EGL_PLATFORM_DEVICE_EXT, device, NULL);
+    }
+    if (egl_display == EGL_NO_DISPLAY)
+        egl_display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    EGLint major = 0, minor = 0;
+    if (egl_display == EGL_NO_DISPLAY || !eglInitialize(egl_display, &major, &minor))
+    {
+        printf("ERROR::EGL:: failed to initialize display\n");
+        return;
+    }
+    display = egl_display;
+    eglBindAPI(EGL_OPENGL_API);
+
+    const EGLint config_attributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+        EGL_NONE};
+    EGLConfig config;
+    EGLint config_count = 0;
+    if (!eglChooseConfig(egl_display, config_attributes, &config, 1, &config_count) || config_count == 0)
+    {
+        printf("ERROR::EGL:: no OpenGL config\n");
+        return;
+    }
+
+    const EGLint context_attributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE};
+    EGLContext egl_context = eglCreateContext(egl_display, config, EGL_NO_CONTEXT, context_attributes);
+    // 不需要任何 surface，渲染全部进 FBO
+    if (egl_context == EGL_NO_CONTEXT || !eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, egl_context))
+    {
+        printf("ERROR::EGL:: failed to create OpenGL 3.3 core context\n");
+        if (egl_context != EGL_NO_CONTEXT)
+            eglDestroyContext(egl_display, egl_context);
+        return;
+    }
+    context = egl_context;
+    gladLoadGLLoader((GLADloadproc)eglGetProcAddress);
+    printf("headless context: EGL %d.%d, %s\n", major, minor, (const char *)glGetString(GL_RENDERER));
+
+    GLRegistry &registry = GLRegistry::instance();
+    color_buffer = GL_CREATE(RENDERBUFFER, "headless color");
+    glBindRenderbuffer(GL_RENDERBUFFER, color_buffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    registry.set_bytes(GLObjectType::RENDERBUFFER, color_buffer, GLRegistry::texture_bytes(GL_RGBA8, width, height));
+    depth_buffer = GL_CREATE(RENDERBUFFER, "headless depth");
+    glBindRenderbuffer(GL_RENDERBUFFER, depth_buffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    registry.set_bytes(GLObjectType::RENDERBUFFER, depth_buffer, GLRegistry::texture_bytes(GL_DEPTH24_STENCIL8, width, height));
+    framebuffer = GL_CREATE(FRAMEBUFFER, "headless output");
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_buffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth_buffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        printf("ERROR::FRAMEBUFFER:: headless framebuffer is not complete\n");
+    glViewport(0, 0, width, height);
+#else
+    printf("ERROR::EGL:: built without EGL, headless rendering is unavailable\n");
+#endif
+}
+
+HeadlessContext::~HeadlessContext()
+{
+#ifdef HAVE_EGL
+    if (context)
+    {
+        GL_DESTROY(FRAMEBUFFER, framebuffer);
+        GL_DESTROY(RENDERBUFFER, color_buffer);
+        GL_DESTROY(RENDERBUFFER, depth_buffer);
+        // 场景对象应在上下文之前析构，此时还存活的都是泄漏
+        GLDeletionQueue::instance().flush();
+        leak_count = GLRegistry::instance().dump_leaks();
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(display, context);
+    }
+    if (display)
+        eglTerminate(display);
+#endif
+}
+
+void HeadlessContext::end_frame()
+{
+    // 没有 SwapBuffers 来划分帧，显式提交命令
+    glFlush();
+    GLDeletionQueue::instance().end_frame();
+    frame_index++;
+}
+
+CameraInput HeadlessContext::get_camera_input()
+{
+    CameraInput input;
+    if (frame_index < static_cast<int>(camera_script.size()))
+        input = camera_script[frame_index];
+    input.delta_time = fixed_timestep;
+    input.width = width;
+    input.height = height;
+    return input;
+}
@@ -0,0 +1,117 @@
+#ifndef RENDER_CONTEXT_HPP
+#define RENDER_CONTEXT_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include "camera_control.hpp"
+
+struct RenderContextDesc
+{
+    int width = 1280;
+    int height = 720;
+    std::string title = "scene";
+    bool headless = false;
+    int frame_limit = 0;               // 渲染多少帧后 should_close 返回 true，0 表示不限
+    float fixed_timestep = 1.0f / 60.0f; // 无窗口模式下每帧推进的时间
+
+    // 解析 --headless / --window、--frames=<帧数>、--size=<宽>x<高>
+    void parse_command_line(int argc, char **argv);
+};
+
+/**
+ * @brief OpenGL 上下文后端。
+ *        GlfwContext 打开窗口并渲染到默认帧缓冲；HeadlessContext 用 EGL 创建无窗口（surfaceless）上下文，
+ *        渲染到自建的 FBO，可以在没有显示器的 CI / 基准测试机器上运行（Mesa llvmpipe 即可）。
+ *        程序不应直接绑定帧缓冲 0，而是绑定 get_framebuffer()。
+ */
+class RenderContext
+{
+public:
+    virtual ~RenderContext() = default;
+
+    static std::unique_ptr<RenderContext> create(const RenderContextDesc &desc);
+
+    virtual bool is_headless() const = 0;
+    virtual bool should_close() const = 0;
+    // 绑定输出帧缓冲并设置视口
+    virtual void begin_frame();
+    // 交换缓冲 / 推进时间，并处理输入事件
+    virtual void end_frame() = 0;
+    virtual double get_time() const = 0;
+    virtual bool is_key_pressed(int key) const = 0;
+    virtual CameraInput get_camera_input() = 0;
+    virtual GLuint get_framebuffer() const = 0;
+
+    int get_width() const { return width; }
+    int get_height() const { return height; }
+    int get_frame_index() const { return frame_index; }
+
+    // 同步读回当前输出（RGBA8，左下角为原点）
+    void read_pixels(std::vector<unsigned char> &pixels) const;
+
+    // 最近一次析构的上下文在 dump_leaks 中报告的泄漏对象数，测试程序在上下文析构后据此返回失败
+    static size_t get_leak_count() { return leak_count; }
+
+protected:
+    static size_t leak_count;
+    int width = 0, height = 0;
+    int frame_index = 0;
+    int frame_limit = 0;
+};
+
+class GlfwContext : public RenderContext
+{
+public:
+    explicit GlfwContext(const RenderContextDesc &desc);
+    ~GlfwContext() override;
+
+    bool is_valid() const { return window != nullptr; }
+    GLFWwindow *get_window() const { return window; }
+
+    bool is_headless() const override { return false; }
+    bool should_close() const override;
+    void begin_frame() override;
+    void end_frame() override;
+    double get_time() const override { return glfwGetTime(); }
+    bool is_key_pressed(int key) const override { return glfwGetKey(window, key) == GLFW_PRESS; }
+    CameraInput get_camera_input() override;
+    GLuint get_framebuffer() const override { return 0; }
+
+private:
+    GLFWwindow *window = nullptr;
+};
+
+class HeadlessContext : public RenderContext
+{
+public:
+    explicit HeadlessContext(const RenderContextDesc &desc);
+    ~HeadlessContext() override;
+
+    bool is_valid() const { return context != nullptr; }
+
+    // 脚本化相机输入：第 i 帧使用 script[i]，超出部分使用空输入
+    void set_camera_script(const std::vector<CameraInput> &script) { camera_script = script; }
+
+    bool is_headless() const override { return true; }
+    bool should_close() const override { return frame_limit > 0 && frame_index >= frame_limit; }
+    void end_frame() override;
+    double get_time() const override { return frame_index * double(fixed_timestep); }
+    bool is_key_pressed(int) const override { return false; }
+    CameraInput get_camera_input() override;
+    GLuint get_framebuffer() const override { return framebuffer; }
+
+private:
+    void *display = nullptr; // EGLDisplay
+    void *context = nullptr; // EGLContext
+    GLuint framebuffer = 0;
+    GLuint color_buffer = 0;
+    GLuint depth_buffer = 0;
+    float fixed_timestep;
+    std::vector<CameraInput> camera_script;
+};
+
+#endif // RENDER_CONTEXT_HPP
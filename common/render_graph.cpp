@@ -0,0 +1,448 @@
+#include "render_graph.hpp"
+#include "gl_registry.hpp"
+#include <algorithm>
+#include <cstdio>
+
+bool RenderTextureDesc::is_depth() const
+{
+    return internal_format == GL_DEPTH_COMPONENT16 || internal_format == GL_DEPTH_COMPONENT24 ||
+           internal_format == GL_DEPTH_COMPONENT32F || internal_format == GL_DEPTH24_STENCIL8 ||
+           internal_format == GL_DEPTH32F_STENCIL8;
+}
+
+size_t RenderTextureDesc::size_in_bytes() const
+{
+    size_t bytes_per_pixel;
+    switch (internal_format)
+    {
+    case GL_R8:
+        bytes_per_pixel = 1;
+        break;
+    case GL_RG8:
+    case GL_R16F:
+    case GL_DEPTH_COMPONENT16:
+        bytes_per_pixel = 2;
+        break;
+    case GL_RGB8:
+        bytes_per_pixel = 3;
+        break;
+    case GL_RGB16F:
+        bytes_per_pixel = 6;
+        break;
+    case GL_RGBA16F:
+    case GL_RG32F:
+    case GL_DEPTH32F_STENCIL8:
+        bytes_per_pixel = 8;
+        break;
+    case GL_RGB32F:
+        bytes_per_pixel = 12;
+        break;
+    case GL_RGBA32F:
+        bytes_per_pixel = 16;
+        break;
+    default: // GL_RGBA8, GL_RG16F, GL_R32F, GL_R11F_G11F_B10F, GL_DEPTH_COMPONENT24/32F, GL_DEPTH24_STENCIL8
+        bytes_per_pixel = 4;
+        break;
+    }
+    return static_cast<size_t>(width) * height * bytes_per_pixel;
+}
+
+namespace
+{
+    // 根据内部格式选择 glTexImage2D 需要的 format/type
+    void texture_format_for(GLenum internal_format, GLenum &format, GLenum &type)
+    {
+        switch (internal_format)
+        {
+        case GL_DEPTH24_STENCIL8:
+            format = GL_DEPTH_STENCIL;
+            type = GL_UNSIGNED_INT_24_8;
+            return;
+        case GL_DEPTH32F_STENCIL8:
+            format = GL_DEPTH_STENCIL;
+            type = GL_FLOAT_32_UNSIGNED_INT_24_8_REV;
+            return;
+        case GL_DEPTH_COMPONENT16:
+        case GL_DEPTH_COMPONENT24:
+        case GL_DEPTH_COMPONENT32F:
+            format = GL_DEPTH_COMPONENT;
+            type = GL_FLOAT;
+            return;
+        case GL_R8:
+        case GL_R16F:
+        case GL_R32F:
+            format = GL_RED;
+            break;
+        case GL_RG8:
+        case GL_RG16F:
+        case GL_RG32F:
+            format = GL_RG;
+            break;
+        case GL_RGB8:
+        case GL_RGB16F:
+        case GL_RGB32F:
+        case GL_R11F_G11F_B10F:
+            format = GL_RGB;
+            break;
+        default:
+            format = GL_RGBA;
+            break;
+        }
+        type = (internal_format == GL_R8 || internal_format == GL_RG8 || internal_format == GL_RGB8 || internal_format == GL_RGBA8)
+                   ? GL_UNSIGNED_BYTE
+                   : GL_FLOAT;
+    }
+}
+
+RenderGraph::ResourceId RenderGraph::PassBuilder::create(const std::string &name, const RenderTextureDesc &desc)
+{
+    Resource resource;
+    resource.name = name;
+    resource.desc = desc;
+    graph.resources.push_back(resource);
+    return write(static_cast<ResourceId>(graph.resources.size() - 1));
+}
+
+RenderGraph::ResourceId RenderGraph::PassBuilder::read(ResourceId resource)
+{
+    graph.passes[pass].reads.push_back(resource);
+    return resource;
+}
+
+RenderGraph::ResourceId RenderGraph::PassBuilder::write(ResourceId resource)
+{
+    graph.passes[pass].writes.push_back(resource);
+    return resource;
+}
+
+void RenderGraph::PassBuilder::side_effect()
+{
+    graph.passes[pass].side_effect = true;
+}
+
+GLuint RenderGraph::PassContext::get_texture(ResourceId resource) const
+{
+    return graph.get_resource_texture(resource);
+}
+
+RenderGraph::~RenderGraph()
+{
+    release();
+}
+
+void RenderGraph::add_pass(const std::string &name, const std::function<void(PassBuilder &)> &setup, std::function<void(PassContext &)> execute)
+{
+    Pass pass;
+    pass.name = name;
+    pass.execute = std::move(execute);
+    passes.push_back(std::move(pass));
+    PassBuilder builder(*this, static_cast<uint32_t>(passes.size() - 1));
+    setup(builder);
+}
+
+RenderGraph::ResourceId RenderGraph::import_texture(const std::string &name, GLuint texture, const RenderTextureDesc &desc, GLenum target, GLint level)
+{
+    Resource resource;
+    resource.name = name;
+    resource.desc = desc;
+    resource.imported = true;
+    resource.imported_texture = texture;
+    resource.target = target;
+    resource.level = level;
+    resources.push_back(resource);
+    return static_cast<ResourceId>(resources.size() - 1);
+}
+
+void RenderGraph::mark_output(ResourceId resource)
+{
+    resources[resource].output = true;
+}
+
+bool RenderGraph::compile()
+{
+    stats = Stats();
+    stats.declared_passes = passes.size();
+
+    // 1. 从输出反向标记需要的资源，不写任何需要资源、也没有副作用的 pass 被剔除
+    std::vector<bool> needed(resources.size(), false);
+    for (size_t i = 0; i < resources.size(); i++)
+        needed[i] = resources[i].output;
+    for (size_t p = passes.size(); p-- > 0;)
+    {
+        Pass &pass = passes[p];
+        bool contributes = pass.side_effect;
+        for (ResourceId resource : pass.writes)
+            contributes = contributes || needed[resource];
+        pass.culled = !contributes;
+        if (pass.culled)
+            continue;
+        for (ResourceId resource : pass.reads)
+            needed[resource] = true;
+    }
+
+    // 2. 声明顺序即合法的拓扑序（只能读前面 pass 写过的资源），保留未剔除的 pass，并计算临时资源生命周期
+    execution_order.clear();
+    for (Resource &resource : resources)
+    {
+        resource.first_use = resource.last_use = -1;
+        resource.physical = -1;
+    }
+    for (uint32_t p = 0; p < passes.size(); p++)
+    {
+        if (passes[p].culled)
+            continue;
+        int position = static_cast<int>(execution_order.size());
+        execution_order.push_back(p);
+        for (ResourceId resource : passes[p].reads)
+        {
+            Resource &r = resources[resource];
+            if (!r.imported && r.first_use < 0)
+                printf("RenderGraph: pass '%s' reads '%s' before it is written\n", passes[p].name.c_str(), r.name.c_str());
+            r.last_use = position;
+        }
+        for (ResourceId resource : passes[p].writes)
+        {
+            Resource &r = resources[resource];
+            if (r.first_use < 0)
+                r.first_use = position;
+            r.last_use = position;
+        }
+    }
+
+    // 3. 按执行顺序贪心分配物理纹理：描述相同且上一个使用者已结束的纹理可以复用
+    for (PhysicalTexture &physical : pool)
+    {
+        physical.used = false;
+        physical.free_after = -1;
+    }
+    std::vector<std::vector<ResourceId>> first_used_at(execution_order.size());
+    for (ResourceId id = 0; id < resources.size(); id++)
+    {
+        const Resource &resource = resources[id];
+        if (resource.imported || resource.first_use < 0)
+            continue;
+        first_used_at[resource.first_use].push_back(id);
+        stats.transient_resources++;
+        stats.naive_bytes += resource.desc.size_in_bytes();
+    }
+    for (int position = 0; position < static_cast<int>(execution_order.size()); position++)
+    {
+        for (ResourceId id : first_used_at[position])
+        {
+            Resource &resource = resources[id];
+            int chosen = -1;
+            for (int i = 0; i < static_cast<int>(pool.size()); i++)
+            {
+                if (pool[i].desc == resource.desc && (!pool[i].used || pool[i].free_after < position))
+                {
+                    chosen = i;
+                    break;
+                }
+            }
+            if (chosen < 0)
+            {
+                pool.push_back(PhysicalTexture{resource.desc, 0, -1, false});
+                chosen = static_cast<int>(pool.size() - 1);
+            }
+            pool[chosen].used = true;
+            pool[chosen].free_after = resource.last_use;
+            resource.physical = chosen;
+        }
+    }
+
+    size_t pool_bytes = 0;
+    for (PhysicalTexture &physical : pool)
+    {
+        pool_bytes += physical.desc.size_in_bytes();
+        physical.unused_compiles = physical.used ? 0 : physical.unused_compiles + 1;
+        if (!physical.used)
+            continue;
+        stats.physical_textures++;
+        stats.aliased_bytes += physical.desc.size_in_bytes();
+    }
+    stats.executed_passes = execution_order.size();
+
+    // 4. 释放长期没用到的纹理；池子超出预算时本帧没用到的全部释放。还没创建的新纹理（texture 为 0）超出预算时也丢掉
+    bool over_budget = memory_budget > 0 && pool_bytes > memory_budget;
+    bool fits = memory_budget == 0 || stats.aliased_bytes <= memory_budget;
+    std::vector<bool> keep(pool.size(), true);
+    bool any_released = false;
+    for (size_t i = 0; i < pool.size(); i++)
+    {
+        const PhysicalTexture &physical = pool[i];
+        if ((!physical.used && (over_budget || physical.unused_compiles > POOL_RETAIN_FRAMES)) || (!fits && physical.texture == 0))
+        {
+            keep[i] = false;
+            any_released = true;
+        }
+    }
+    if (any_released)
+        release_pool_entries(keep);
+    for (const PhysicalTexture &physical : pool)
+        stats.pool_bytes += physical.desc.size_in_bytes();
+
+    if (!fits)
+    {
+        printf("RenderGraph: transient memory %.2f MB exceeds budget %.2f MB\n",
+               stats.aliased_bytes / 1048576.0, memory_budget / 1048576.0);
+        return false;
+    }
+
+    // 5. 创建新增的物理纹理
+    for (size_t i = 0; i < pool.size(); i++)
+    {
+        PhysicalTexture &physical = pool[i];
+        if (physical.texture != 0)
+            continue;
+        GLenum format, type;
+        texture_format_for(physical.desc.internal_format, format, type);
+        physical.texture = GL_CREATE(TEXTURE, "render graph transient");
+        glBindTexture(GL_TEXTURE_2D, physical.texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, physical.desc.internal_format, physical.desc.width, physical.desc.height, 0, format, type, nullptr);
+        GLRegistry::instance().set_bytes(GLObjectType::TEXTURE, physical.texture, physical.desc.size_in_bytes());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    for (uint32_t p : execution_order)
+        passes[p].framebuffer = passes[p].writes.empty() ? 0 : get_framebuffer(passes[p].writes);
+    return true;
+}
+
+void RenderGraph::release_pool_entries(const std::vector<bool> &keep)
+{
+    // 引用被释放纹理的 FBO 一起删掉
+    for (auto entry = framebuffer_cache.begin(); entry != framebuffer_cache.end();)
+    {
+        bool stale = false;
+        for (const Attachment &attachment : entry->first)
+        {
+            for (size_t i = 0; i < pool.size(); i++)
+                stale = stale || (!keep[i] && pool[i].texture != 0 && pool[i].texture == attachment.texture);
+        }
+        if (stale)
+        {
+            GL_DESTROY(FRAMEBUFFER, entry->second);
+            entry = framebuffer_cache.erase(entry);
+        }
+        else
+            ++entry;
+    }
+
+    std::vector<int> remap(pool.size(), -1);
+    size_t kept = 0;
+    for (size_t i = 0; i < pool.size(); i++)
+    {
+        if (!keep[i])
+        {
+            GL_DESTROY(TEXTURE, pool[i].texture);
+            if (pool[i].texture != 0)
+                stats.released_textures++;
+            continue;
+        }
+        remap[i] = static_cast<int>(kept);
+        pool[kept++] = pool[i];
+    }
+    pool.resize(kept);
+    for (Resource &resource : resources)
+    {
+        if (resource.physical >= 0)
+            resource.physical = remap[resource.physical];
+    }
+}
+
+GLuint RenderGraph::get_resource_texture(ResourceId resource) const
+{
+    const Resource &r = resources[resource];
+    if (r.imported)
+        return r.imported_texture;
+    return r.physical >= 0 ? pool[r.physical].texture : 0;
+}
+
+GLuint RenderGraph::get_framebuffer(const std::vector<ResourceId> &attachments)
+{
+    std::vector<Attachment> textures;
+    for (ResourceId resource : attachments)
+        textures.push_back(Attachment{get_resource_texture(resource), resources[resource].target, resources[resource].level});
+    auto found = framebuffer_cache.find(textures);
+    if (found != framebuffer_cache.end())
+        return found->second;
+
+    GLuint framebuffer = GL_CREATE(FRAMEBUFFER, "render graph");
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    std::vector<GLenum> draw_buffers;
+    for (size_t i = 0; i < attachments.size(); i++)
+    {
+        const RenderTextureDesc &desc = resources[attachments[i]].desc;
+        GLenum attachment;
+        if (desc.is_depth())
+            attachment = (desc.internal_format == GL_DEPTH24_STENCIL8 || desc.internal_format == GL_DEPTH32F_STENCIL8) ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+        else
+        {
+            attachment = GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(draw_buffers.size());
+            draw_buffers.push_back(attachment);
+        }
+        glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, textures[i].target, textures[i].texture, textures[i].level);
+    }
+    if (draw_buffers.empty())
+        glDrawBuffer(GL_NONE);
+    else
+        glDrawBuffers(static_cast<GLsizei>(draw_buffers.size()), draw_buffers.data());
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        printf("RenderGraph: framebuffer is not complete\n");
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    framebuffer_cache[textures] = framebuffer;
+    return framebuffer;
+}
+
+void RenderGraph::execute()
+{
+    for (uint32_t p : execution_order)
+    {
+        Pass &pass = passes[p];
+        PassContext context(*this);
+        context.framebuffer = pass.framebuffer;
+        if (!pass.writes.empty())
+        {
+            const RenderTextureDesc &desc = resources[pass.writes[0]].desc;
+            context.width = desc.width;
+            context.height = desc.height;
+            glBindFramebuffer(GL_FRAMEBUFFER, pass.framebuffer);
+            glViewport(0, 0, desc.width, desc.height);
+        }
+        else
+        {
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        }
+        pass.execute(context);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void RenderGraph::reset()
+{
+    passes.clear();
+    resources.clear();
+    execution_order.clear();
+}
+
+void RenderGraph::release()
+{
+    for (auto &entry : framebuffer_cache)
+        GL_DESTROY(FRAMEBUFFER, entry.second);
+    framebuffer_cache.clear();
+    for (PhysicalTexture &physical : pool)
+        GL_DESTROY(TEXTURE, physical.texture);
+    pool.clear();
+}
+
+void RenderGraph::print_stats() const
+{
+    printf("RenderGraph: %zu/%zu passes, %zu transient resources -> %zu textures, %.2f MB this frame, pool holds %.2f MB (naive %.2f MB, saved %.2f MB)\n",
+           stats.executed_passes, stats.declared_passes, stats.transient_resources, stats.physical_textures,
+           stats.aliased_bytes / 1048576.0, stats.pool_bytes / 1048576.0, stats.naive_bytes / 1048576.0, stats.saved_bytes() / 1048576.0);
+}
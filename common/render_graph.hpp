@@ -0,0 +1,189 @@
+#ifndef RENDER_GRAPH_HPP
+#define RENDER_GRAPH_HPP
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+
+// 渲染目标描述，格式和尺寸都相同的资源才能共用同一块显存
+struct RenderTextureDesc
+{
+    int width = 0;
+    int height = 0;
+    GLenum internal_format = GL_RGBA8;
+
+    bool operator==(const RenderTextureDesc &other) const
+    {
+        return width == other.width && height == other.height && internal_format == other.internal_format;
+    }
+    bool is_depth() const;
+    size_t size_in_bytes() const;
+};
+
+/**
+ * @brief 声明式渲染图。
+ *        每帧先 add_pass 声明各个 pass 读写哪些资源，compile() 剔除对输出没有贡献的 pass，
+ *        计算临时资源的生命周期，并让生命周期不重叠、描述相同的临时资源共用同一张物理纹理。
+ *        物理纹理和 FBO 在帧之间保留复用。
+ *
+ * 用法：
+ *     RenderGraph::ResourceId hdr;
+ *     graph.add_pass("scene", [&](RenderGraph::PassBuilder &builder)
+ *                    { hdr = builder.create("hdr", {width, height, GL_RGBA16F});
+ *                      builder.create("depth", {width, height, GL_DEPTH_COMPONENT24}); },
+ *                    [&](RenderGraph::PassContext &context) { ...draw... });
+ *     graph.add_pass("tonemap", [&](RenderGraph::PassBuilder &builder)
+ *                    { builder.read(hdr); builder.side_effect(); },
+ *                    [&](RenderGraph::PassContext &context) { glBindTexture(GL_TEXTURE_2D, context.get_texture(hdr)); ... });
+ *     graph.compile();
+ *     graph.execute();
+ *     graph.reset();
+ */
+class RenderGraph
+{
+public:
+    using ResourceId = uint32_t;
+    static constexpr ResourceId INVALID_RESOURCE = 0xffffffffu;
+
+    class PassBuilder
+    {
+    public:
+        // 创建临时资源并作为本 pass 的输出
+        ResourceId create(const std::string &name, const RenderTextureDesc &desc);
+        ResourceId read(ResourceId resource);
+        ResourceId write(ResourceId resource);
+        // 有外部可见效果（如写默认帧缓冲），永远不会被剔除
+        void side_effect();
+
+    private:
+        friend class RenderGraph;
+        PassBuilder(RenderGraph &graph, uint32_t pass) : graph(graph), pass(pass) {}
+        RenderGraph &graph;
+        uint32_t pass;
+    };
+
+    class PassContext
+    {
+    public:
+        GLuint get_texture(ResourceId resource) const;
+        GLuint get_framebuffer() const { return framebuffer; }
+        int get_width() const { return width; }
+        int get_height() const { return height; }
+
+    private:
+        friend class RenderGraph;
+        PassContext(const RenderGraph &graph) : graph(graph) {}
+        const RenderGraph &graph;
+        GLuint framebuffer = 0;
+        int width = 0, height = 0;
+    };
+
+    struct Stats
+    {
+        size_t declared_passes = 0;
+        size_t executed_passes = 0;
+        size_t transient_resources = 0;
+        size_t physical_textures = 0;
+        size_t naive_bytes = 0;       // 每个临时资源单独分配时的显存
+        size_t aliased_bytes = 0;     // 复用后本帧用到的显存
+        size_t pool_bytes = 0;        // 纹理池实际持有的显存（包含本帧没用到、还没释放的纹理）
+        size_t released_textures = 0; // 本次 compile 从纹理池释放的纹理数
+        size_t saved_bytes() const { return naive_bytes > pool_bytes ? naive_bytes - pool_bytes : 0; }
+    };
+
+    RenderGraph() = default;
+    ~RenderGraph();
+    RenderGraph(const RenderGraph &) = delete;
+    RenderGraph &operator=(const RenderGraph &) = delete;
+
+    void add_pass(const std::string &name, const std::function<void(PassBuilder &)> &setup, std::function<void(PassContext &)> execute);
+
+    // 引入外部纹理（如 IBL 立方体贴图、最终输出），不参与复用。
+    // target 为 GL_TEXTURE_CUBE_MAP_POSITIVE_X + i 时引入立方体贴图的一个面，写它的 pass 渲染到这个面；level 为写入的 mip 层
+    ResourceId import_texture(const std::string &name, GLuint texture, const RenderTextureDesc &desc, GLenum target = GL_TEXTURE_2D, GLint level = 0);
+    // 标记为图的输出，写它的 pass 不会被剔除
+    void mark_output(ResourceId resource);
+
+    // 临时资源的显存预算（字节），0 表示不限制。纹理池超出预算时先释放本帧没用到的纹理
+    void set_memory_budget(size_t bytes) { memory_budget = bytes; }
+
+    // 剔除、排序、分配物理纹理；连续 POOL_RETAIN_FRAMES 次 compile 没用到的纹理被释放；超出显存预算时返回 false
+    bool compile();
+    void execute();
+    // 清空本帧声明的 pass 和资源，保留物理纹理池
+    void reset();
+    // 释放物理纹理池和 FBO
+    void release();
+
+    const Stats &get_stats() const { return stats; }
+    void print_stats() const;
+
+private:
+    struct Resource
+    {
+        std::string name;
+        RenderTextureDesc desc;
+        bool imported = false;
+        bool output = false;
+        GLuint imported_texture = 0;
+        GLenum target = GL_TEXTURE_2D; // 导入资源作为附件时的目标（立方体贴图的面）
+        GLint level = 0;
+        int physical = -1; // 临时资源对应的物理纹理
+        int first_use = -1, last_use = -1;
+    };
+
+    struct Pass
+    {
+        std::string name;
+        std::function<void(PassContext &)> execute;
+        std::vector<ResourceId> reads;
+        std::vector<ResourceId> writes;
+        bool side_effect = false;
+        bool culled = false;
+        GLuint framebuffer = 0;
+    };
+
+    struct PhysicalTexture
+    {
+        RenderTextureDesc desc;
+        GLuint texture = 0;
+        int free_after = -1;          // 最后一个使用它的 pass，之后才能被复用
+        bool used = false;            // 本帧是否被分配
+        uint32_t unused_compiles = 0; // 连续多少次 compile 没有被分配
+    };
+
+    // 纹理池里的纹理连续这么多次 compile 没用到就释放（帧之间的短暂波动不反复创建）
+    static constexpr uint32_t POOL_RETAIN_FRAMES = 60;
+
+    // 某个附件：纹理、附加目标和 mip 层
+    struct Attachment
+    {
+        GLuint texture;
+        GLenum target;
+        GLint level;
+        bool operator<(const Attachment &other) const
+        {
+            if (texture != other.texture)
+                return texture < other.texture;
+            return target != other.target ? target < other.target : level < other.level;
+        }
+    };
+
+    std::vector<Resource> resources;
+    std::vector<Pass> passes;
+    std::vector<uint32_t> execution_order;
+    std::vector<PhysicalTexture> pool;
+    std::map<std::vector<Attachment>, GLuint> framebuffer_cache; // 附件组合 -> FBO
+    size_t memory_budget = 0;
+    Stats stats;
+
+    GLuint get_resource_texture(ResourceId resource) const;
+    GLuint get_framebuffer(const std::vector<ResourceId> &attachments);
+    // 释放 keep 为 false 的纹理和引用它们的 FBO，并重排 resources 的 physical 下标
+    void release_pool_entries(const std::vector<bool> &keep);
+};
+
+#endif // RENDER_GRAPH_HPP
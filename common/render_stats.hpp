@@ -0,0 +1,46 @@
+#ifndef RENDER_STATS_HPP
+#define RENDER_STATS_HPP
+
+#include <cstdint>
+#include <glad/glad.h>
+
+/**
+ * @brief 每帧的绘制统计：绘制调用、三角形数和状态切换次数。
+ *        由 Mesh::Draw、render_cube/render_sphere、Shader::use、Skybox::render 等公共绘制路径累加，
+ *        程序自己直接调用 glDraw* 时用 count_draw 补上。统计的是发出的调用次数，不去重。
+ */
+struct RenderStats
+{
+    uint64_t draw_calls = 0;
+    uint64_t triangles = 0;
+    uint64_t program_binds = 0;
+    uint64_t texture_binds = 0;
+    uint64_t vertex_array_binds = 0;
+
+    uint64_t state_changes() const { return program_binds + texture_binds + vertex_array_binds; }
+    void reset() { *this = RenderStats(); }
+};
+
+inline RenderStats &render_stats()
+{
+    static RenderStats stats;
+    return stats;
+}
+
+inline void count_draw(GLenum mode, GLsizei count, GLsizei instance_count = 1)
+{
+    RenderStats &stats = render_stats();
+    stats.draw_calls++;
+    uint64_t triangles = 0;
+    if (mode == GL_TRIANGLES)
+        triangles = count / 3;
+    else if ((mode == GL_TRIANGLE_STRIP || mode == GL_TRIANGLE_FAN) && count > 2)
+        triangles = count - 2;
+    stats.triangles += triangles * instance_count;
+}
+
+inline void count_program_bind() { render_stats().program_binds++; }
+inline void count_texture_bind() { render_stats().texture_binds++; }
+inline void count_vertex_array_bind() { render_stats().vertex_array_binds++; }
+
+#endif // RENDER_STATS_HPP
@@ -2,21 +2,106 @@
 #define RENDERABLE_MODEL_H
 
 #include "model.hpp"
+#include "model_loader.hpp"
 #include "shader.hpp"
+#include "bounds.hpp"
 #include <memory>
 #include <glm/glm.hpp>
 
 class RenderableModel
 {
 public:
-    RenderableModel(const std::string &modelPath, std::shared_ptr<Shader> shader, bool gamma = false)
-        : model(modelPath, gamma), shader(std::move(shader)) {}
+    RenderableModel(const std::string &modelPath, std::shared_ptr<Shader> shader, bool gamma = false, bool bake_static = false)
+        : model(modelPath, gamma, bake_static), shader(std::move(shader)) {}
+
+    // 后台加载：构造立即返回，模型就绪前 draw_model 画一个单位立方体占位
+    RenderableModel(ModelLoader &loader, const std::string &modelPath, std::shared_ptr<Shader> shader, bool gamma = false, bool bake_static = false)
+        : shader(std::move(shader)), asset(loader.load(modelPath, gamma, bake_static)) {}
 
     virtual void draw(const glm::mat4 &projection, const glm::mat4 &view, const glm::vec3 &cameraPos) = 0;
 
+    // 世界空间包围盒，供场景 BVH 剔除和拾取使用；后台加载完成前为占位立方体的包围盒，就绪后需要重建 BVH
+    virtual AABB get_world_bounds() const
+    {
+        if (asset && !asset->is_ready())
+        {
+            AABB placeholder;
+            placeholder.expand(glm::vec3(-0.5f));
+            placeholder.expand(glm::vec3(0.5f));
+            return placeholder.transformed(model_matrix);
+        }
+        return get_model().bounds.transformed(model_matrix);
+    }
+
+    void set_model_matrix(const glm::mat4 &matrix) { model_matrix = matrix; }
+    const glm::mat4 &get_model_matrix() const { return model_matrix; }
+
+    bool is_ready() const { return !asset || asset->is_ready(); }
+
 protected:
     std::shared_ptr<Shader> shader;
-    Model model;
+    Model model; // 同步加载的模型；后台加载时为空，使用 get_model()
+
+    // 后台加载时只能在 is_ready() 之后调用
+    Model &get_model() { return asset ? *asset->get() : model; }
+    const Model &get_model() const { return asset ? *asset->get() : model; }
+
+    // 以 model_matrix 画模型（每个网格再乘节点世界矩阵，设置 "model" 和 "normalMatrix"），还在后台加载时画占位立方体；
+    // 其余 uniform 由调用者设置。上传过程中已经上传的网格逐个出现
+    void draw_model(Shader &shader)
+    {
+        if (!asset || asset->is_ready())
+        {
+            placeholder.reset(); // 模型就绪后不再需要占位立方体
+            get_model().Draw(shader, model_matrix);
+        }
+        else if (asset->get_state() == AsyncModel::State::UPLOADING)
+            asset->get()->Draw(shader, model_matrix);
+        else
+        {
+            if (!placeholder)
+                placeholder = make_placeholder_mesh();
+            shader.setMat4("model", model_matrix);
+            shader.setMat3("normalMatrix", glm::transpose(glm::inverse(glm::mat3(model_matrix))));
+            placeholder->Draw(shader);
+        }
+    }
+
+    glm::mat4 model_matrix = glm::mat4(1.0f);
+
+private:
+    std::shared_ptr<AsyncModel> asset;
+    // 占位立方体随 RenderableModel 析构，与场景其它 GL 对象一起在上下文销毁前释放
+    std::unique_ptr<Mesh> placeholder;
+
+    // 边长为 1 的立方体，没有纹理（Mesh::Draw 绑定白色）
+    static std::unique_ptr<Mesh> make_placeholder_mesh()
+    {
+        vector<Vertex> vertices;
+        vector<unsigned int> indices;
+        const glm::vec3 normals[6] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+        for (const glm::vec3 &n : normals)
+        {
+            // 每个面四个顶点，u / v 为面内的两个轴
+            glm::vec3 u = n.x != 0.0f ? glm::vec3(0, 1, 0) : glm::vec3(1, 0, 0);
+            glm::vec3 v = glm::cross(n, u);
+            unsigned int base = static_cast<unsigned int>(vertices.size());
+            for (int corner = 0; corner < 4; corner++)
+            {
+                glm::vec2 uv(corner & 1, corner >> 1);
+                Vertex vertex = {};
+                vertex.Position = 0.5f * (n + (uv.x * 2.0f - 1.0f) * u + (uv.y * 2.0f - 1.0f) * v);
+                vertex.Normal = n;
+                vertex.TexCoords = uv;
+                vertex.Tangent = u;
+                vertex.Bitangent = v;
+                vertices.push_back(vertex);
+            }
+            for (unsigned int index : {0u, 1u, 3u, 0u, 3u, 2u})
+                indices.push_back(base + index);
+        }
+        return std::unique_ptr<Mesh>(new Mesh(vertices, indices, vector<Texture>()));
+    }
 };
 
 #endif // RENDERABLE_MODEL_H
@@ -5,6 +5,7 @@
 #include "shader_manager.hpp"
 #include "renderable_model.hpp"
 #include "light_manager.hpp"
+#include "bvh.hpp"
 
 class Scene
 {
@@ -15,12 +16,55 @@ public:
 
     virtual void render(const glm::mat4 &projection, const glm::mat4 &view, glm::vec3 &camera_pos) = 0;
 
+    // 模型增删后重建 BVH
+    void build_bvh()
+    {
+        bvh.build(collect_world_bounds());
+    }
+
+    // 模型只是移动时刷新 BVH 包围盒，比重建便宜得多
+    void refit_bvh()
+    {
+        bvh.refit(collect_world_bounds());
+    }
+
+    // 返回视锥内模型在 models 中的下标
+    std::vector<uint32_t> cull(const glm::mat4 &projection, const glm::mat4 &view) const
+    {
+        std::vector<uint32_t> visible;
+        bvh.query_frustum(Frustum(projection * view), visible);
+        return visible;
+    }
+
+    // 鼠标拾取，射线一般来自 Camera::get_pick_ray，未命中返回 nullptr
+    std::shared_ptr<RenderableModel> pick(const Ray &ray, float *distance = nullptr) const
+    {
+        float t;
+        int hit = bvh.raycast(ray, t);
+        if (hit < 0)
+            return nullptr;
+        if (distance)
+            *distance = t;
+        return models[hit];
+    }
+
 protected:
     virtual void setup_scene() = 0;
 
     ShaderManager &shader_manager;
     LightManager light_manager;
     std::vector<std::shared_ptr<RenderableModel>> models;
+    BVH bvh;
+
+private:
+    std::vector<AABB> collect_world_bounds() const
+    {
+        std::vector<AABB> bounds;
+        bounds.reserve(models.size());
+        for (const auto &model : models)
+            bounds.push_back(model->get_world_bounds());
+        return bounds;
+    }
 };
 
-#endif // SCENE_HPP
\ No newline at end of file
+#endif // SCENE_HPP
@@ -1,9 +1,23 @@
 #include "Shader.hpp"
+#include "profiler.hpp"
+#include "render_stats.hpp"
+#include "gl_handle.hpp"
+#include "mapped_file.hpp"
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <vector>
 
+// 着色器源码经过 MappedFile 读取，资源包里有时直接从包里读
+static bool read_shader_source(const char *path, std::string &code)
+{
+    MappedFile file;
+    if (!file.open(path))
+        return false;
+    code.assign(reinterpret_cast<const char *>(file.data()), file.size());
+    return true;
+}
+
 GLuint LoadShaders(const char *vertex_file_path, const char *fragment_file_path)
 {
 
@@ -13,15 +27,7 @@ GLuint LoadShaders(const char *vertex_file_path, const char *fragment_file_path)
 
     // Read the Vertex Shader code from the file
     std::string VertexShaderCode;
-    std::ifstream VertexShaderStream(vertex_file_path, std::ios::in);
-    if (VertexShaderStream.is_open())
-    {
-        std::stringstream sstr;
-        sstr << VertexShaderStream.rdbuf();
-        VertexShaderCode = sstr.str();
-        VertexShaderStream.close();
-    }
-    else
+    if (!read_shader_source(vertex_file_path, VertexShaderCode))
     {
         printf("Impossible to open %s. Are you in the right directory ? Don't forget to read the FAQ !\n", vertex_file_path);
         getchar();
@@ -30,14 +36,7 @@ GLuint LoadShaders(const char *vertex_file_path, const char *fragment_file_path)
 
     // Read the Fragment Shader code from the file
     std::string FragmentShaderCode;
-    std::ifstream FragmentShaderStream(fragment_file_path, std::ios::in);
-    if (FragmentShaderStream.is_open())
-    {
-        std::stringstream sstr;
-        sstr << FragmentShaderStream.rdbuf();
-        FragmentShaderCode = sstr.str();
-        FragmentShaderStream.close();
-    }
+    read_shader_source(fragment_file_path, FragmentShaderCode);
 
     GLint Result = GL_FALSE;
     int InfoLogLength;
@@ -107,47 +106,20 @@ Shader::Shader(const std::string &vertexPath, const std::string &fragmentPath, c
 // 构造函数读取并构建着色器
 Shader::Shader(const char *vertexPath, const char *fragmentPath, const char *geometryPath)
 {
+    PROFILE_CPU_SCOPE("Shader::Shader");
     printf("start load shader: %s, %s, %s\n", vertexPath, fragmentPath, geometryPath);
 
     // 1. retrieve the vertex/fragment source code from filePath
     std::string vertexCode;
     std::string fragmentCode;
     std::string geometryCode;
-    std::ifstream vShaderFile;
-    std::ifstream fShaderFile;
-    std::ifstream gShaderFile;
-    // ensure ifstream objects can throw exceptions:
-    vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    gShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    try
+    const char *paths[] = {vertexPath, fragmentPath, geometryPath};
+    std::string *codes[] = {&vertexCode, &fragmentCode, &geometryCode};
+    for (int i = 0; i < 3; i++)
     {
-        // open files
-        vShaderFile.open(vertexPath);
-        fShaderFile.open(fragmentPath);
-        std::stringstream vShaderStream, fShaderStream;
-        // read file's buffer contents into streams
-        vShaderStream << vShaderFile.rdbuf();
-        fShaderStream << fShaderFile.rdbuf();
-        // close file handlers
-        vShaderFile.close();
-        fShaderFile.close();
-        // convert stream into string
-        vertexCode = vShaderStream.str();
-        fragmentCode = fShaderStream.str();
         // if geometry shader path is present, also load a geometry shader
-        if (geometryPath != nullptr)
-        {
-            gShaderFile.open(geometryPath);
-            std::stringstream gShaderStream;
-            gShaderStream << gShaderFile.rdbuf();
-            gShaderFile.close();
-            geometryCode = gShaderStream.str();
-        }
-    }
-    catch (std::ifstream::failure &e)
-    {
-        std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
+        if (paths[i] != nullptr && !read_shader_source(paths[i], *codes[i]))
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << paths[i] << std::endl;
     }
     const char *vShaderCode = vertexCode.c_str();
     const char *fShaderCode = fragmentCode.c_str();
@@ -174,7 +146,7 @@ Shader::Shader(const char *vertexPath, const char *fragmentPath, const char *geo
         checkCompileErrors(geometry, "GEOMETRY");
     }
     // shader Program
-    ID = glCreateProgram();
+    ID = GL_CREATE(PROGRAM, fragmentPath);
     glAttachShader(ID, vertex);
     glAttachShader(ID, fragment);
     if (geometryPath != nullptr)
@@ -188,9 +160,33 @@ Shader::Shader(const char *vertexPath, const char *fragmentPath, const char *geo
         glDeleteShader(geometry);
 }
 
+Shader::~Shader()
+{
+    if (ID != 0)
+        GLDeletionQueue::instance().enqueue(GLObjectType::PROGRAM, ID);
+}
+
+Shader::Shader(Shader &&other) noexcept : ID(other.ID)
+{
+    other.ID = 0;
+}
+
+Shader &Shader::operator=(Shader &&other) noexcept
+{
+    if (this != &other)
+    {
+        if (ID != 0)
+            GLDeletionQueue::instance().enqueue(GLObjectType::PROGRAM, ID);
+        ID = other.ID;
+        other.ID = 0;
+    }
+    return *this;
+}
+
 void Shader::use()
 {
     glUseProgram(ID);
+    count_program_bind();
 }
 
 void Shader::setBool(const std::string &name, bool value) const
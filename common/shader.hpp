@@ -18,6 +18,13 @@ public:
     // 构造函数，加载和编译着色器
     Shader(const char *vertexPath, const char *fragmentPath, const char *geometrypath = nullptr);
     Shader(const std::string &vertexPath, const std::string &fragmentPath, const std::string &geometry_path = "");
+    // 程序对象交给 GLDeletionQueue 延迟删除；Shader 只能移动，共享请用 shared_ptr。
+    // ID 仍是公开的裸名字（不用 ProgramHandle），兼容直接 glGetUniformLocation(shader.ID, ...) 的代码
+    ~Shader();
+    Shader(Shader &&other) noexcept;
+    Shader &operator=(Shader &&other) noexcept;
+    Shader(const Shader &) = delete;
+    Shader &operator=(const Shader &) = delete;
 
     // 使用着色器程序
     void use();
@@ -1,19 +1,15 @@
 #include "skybox.hpp"
+#include "render_stats.hpp"
+#include "texture_loader.hpp"
 
 Skybox::Skybox(const std::vector<std::string> &faces, const std::string &vertex_path, const std::string &fragment_path)
     : skybox_shader(vertex_path, fragment_path)
 {
-    cubemap_texture = load_cubemap(faces);
+    cubemap_texture.reset(load_cubemap(faces));
 
     setup_skybox();
 }
 
-Skybox::~Skybox()
-{
-    glDeleteVertexArrays(1, &skybox_VAO);
-    glDeleteBuffers(1, &skybox_VBO);
-}
-
 void Skybox::setup_skybox()
 {
     float skybox_vertices[] = {
@@ -60,26 +56,26 @@ void Skybox::setup_skybox()
         -1.0f, -1.0f, 1.0f,
         1.0f, -1.0f, 1.0f};
 
-    glGenVertexArrays(1, &skybox_VAO);
-    glGenBuffers(1, &skybox_VBO);
-    glBindVertexArray(skybox_VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, skybox_VBO);
+    skybox_VAO.reset(GL_CREATE(VERTEX_ARRAY, "skybox"));
+    skybox_VBO.reset(GL_CREATE(BUFFER, "skybox vertices"));
+    glBindVertexArray(skybox_VAO.get());
+    glBindBuffer(GL_ARRAY_BUFFER, skybox_VBO.get());
     glBufferData(GL_ARRAY_BUFFER, sizeof(skybox_vertices), &skybox_vertices, GL_STATIC_DRAW);
+    GLRegistry::instance().set_bytes(GLObjectType::BUFFER, skybox_VBO.get(), sizeof(skybox_vertices));
 
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
 }
 
-unsigned int Skybox::load_cubemap(const std::vector<std::string> &faces)
+GLuint Skybox::load_cubemap(const std::vector<std::string> &faces)
 {
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
+    unsigned int textureID = GL_CREATE(TEXTURE, faces.empty() ? std::string("skybox") : faces[0]);
     glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
 
-    int width, height, nr_channels;
+    int width = 0, height = 0, nr_channels;
     for (unsigned int i = 0; i < faces.size(); i++)
     {
-        unsigned char *data = stbi_load(faces[i].c_str(), &width, &height, &nr_channels, 0);
+        unsigned char *data = load_image_pixels(faces[i], &width, &height, &nr_channels);
         if (data)
         {
             glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
@@ -92,6 +88,7 @@ unsigned int Skybox::load_cubemap(const std::vector<std::string> &faces)
             stbi_image_free(data);
         }
     }
+    GLRegistry::instance().set_bytes(GLObjectType::TEXTURE, textureID, GLRegistry::texture_bytes(GL_RGB, width, height, 6));
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -111,9 +108,12 @@ void Skybox::render(const glm::mat4 &view, const glm::mat4 &projection)
     skybox_shader.setMat4("view", view_no_translation);
     skybox_shader.setMat4("projection", projection);
 
-    glBindVertexArray(skybox_VAO);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, cubemap_texture);
+    glBindVertexArray(skybox_VAO.get());
+    glBindTexture(GL_TEXTURE_CUBE_MAP, cubemap_texture.get());
     glDrawArrays(GL_TRIANGLES, 0, 36);
+    count_vertex_array_bind();
+    count_texture_bind();
+    count_draw(GL_TRIANGLES, 36);
 
     // 恢复深度函数
     glDepthFunc(GL_LESS);
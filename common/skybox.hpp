@@ -5,18 +5,21 @@
 
 #include "stb_image.h"
 #include "shader.hpp" // 包含Shader类，用于加载和使用着色器
+#include "gl_handle.hpp"
 
 class Skybox
 {
 public:
     Skybox(const std::vector<std::string> &faces, const std::string &vertex_shader, const std::string &fragment_shader);
     void render(const glm::mat4 &view, const glm::mat4 &projection);
-    ~Skybox();
 
 private:
-    unsigned int skybox_VAO, skybox_VBO, cubemap_texture;
+    // 成员都只能移动，Skybox 也只能移动
+    VertexArrayHandle skybox_VAO;
+    BufferHandle skybox_VBO;
+    TextureHandle cubemap_texture;
     Shader skybox_shader;
 
-    unsigned int load_cubemap(const std::vector<std::string> &faces);
+    GLuint load_cubemap(const std::vector<std::string> &faces);
     void setup_skybox();
 };
\ No newline at end of file
@@ -0,0 +1,191 @@
+#include "texture_array.hpp"
+#include "profiler.hpp"
+#include "texture_loader.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <utility>
+
+#include "stb_image.h"
+
+namespace
+{
+    GLenum channel_format(int channels)
+    {
+        switch (channels)
+        {
+        case 1:
+            return GL_RED;
+        case 2:
+            return GL_RG;
+        case 3:
+            return GL_RGB;
+        default:
+            return GL_RGBA;
+        }
+    }
+
+    // 沿一个方向重采样：lines 条长度为 source_length 的线，元素间隔 step（以像素计），线与线间隔 line_step
+    void resample_axis(const std::vector<float> &source, std::vector<float> &result, int channels, int lines,
+                       int source_length, int result_length, size_t step, size_t line_step, size_t result_step, size_t result_line_step)
+    {
+        float scale = float(source_length) / result_length;
+        float support = std::max(1.0f, scale); // 缩小时三角滤波覆盖整个源像素范围
+        std::vector<std::pair<int, float>> taps;
+        std::vector<size_t> tap_begin(result_length + 1, 0);
+        for (int i = 0; i < result_length; i++)
+        {
+            float center = (i + 0.5f) * scale - 0.5f;
+            int first = static_cast<int>(std::ceil(center - support)), last = static_cast<int>(std::floor(center + support));
+            float total = 0.0f;
+            size_t begin = taps.size();
+            for (int s = first; s <= last; s++)
+            {
+                float weight = 1.0f - std::abs(s - center) / support;
+                if (weight <= 0.0f)
+                    continue;
+                taps.push_back({std::min(std::max(s, 0), source_length - 1), weight});
+                total += weight;
+            }
+            for (size_t t = begin; t < taps.size(); t++)
+                taps[t].second /= total;
+            tap_begin[i + 1] = taps.size();
+        }
+
+        for (int line = 0; line < lines; line++)
+            for (int i = 0; i < result_length; i++)
+                for (int c = 0; c < channels; c++)
+                {
+                    float value = 0.0f;
+                    for (size_t t = tap_begin[i]; t < tap_begin[i + 1]; t++)
+                        value += source[(line * line_step + taps[t].first * step) * channels + c] * taps[t].second;
+                    result[(line * result_line_step + i * result_step) * channels + c] = value;
+                }
+    }
+}
+
+std::vector<unsigned char> resize_image(const unsigned char *pixels, int width, int height, int channels, int new_width, int new_height)
+{
+    std::vector<float> source(pixels, pixels + size_t(width) * height * channels);
+    // 先横向再纵向
+    std::vector<float> horizontal(size_t(new_width) * height * channels);
+    resample_axis(source, horizontal, channels, height, width, new_width, 1, width, 1, new_width);
+    std::vector<float> vertical(size_t(new_width) * new_height * channels);
+    resample_axis(horizontal, vertical, channels, new_width, height, new_height, new_width, 1, new_width, 1);
+
+    std::vector<unsigned char> result(vertical.size());
+    for (size_t i = 0; i < vertical.size(); i++)
+        result[i] = static_cast<unsigned char>(std::min(std::max(vertical[i] + 0.5f, 0.0f), 255.0f));
+    return result;
+}
+
+TextureArrayBuilder::TextureArrayBuilder(int width, int height)
+    : forced_width(width > 0 && height > 0 ? width : 0), forced_height(width > 0 && height > 0 ? height : 0)
+{
+}
+
+int TextureArrayBuilder::add(const std::string &path)
+{
+    for (size_t i = 0; i < images.size(); i++)
+        if (images[i].path == path)
+            return static_cast<int>(i);
+
+    PROFILE_CPU_SCOPE("decode_array_layer");
+    Image image;
+    image.path = path;
+    unsigned char *data = load_image_pixels(path, &image.width, &image.height, &image.channels);
+    if (data)
+    {
+        image.pixels.assign(data, data + size_t(image.width) * image.height * image.channels);
+        stbi_image_free(data);
+    }
+    else
+    {
+        printf("ERROR::TEXTURE_ARRAY:: failed to load %s\n", path.c_str());
+    }
+    images.push_back(std::move(image));
+    return static_cast<int>(images.size() - 1);
+}
+
+TextureArrays TextureArrayBuilder::build(const std::string &label)
+{
+    PROFILE_CPU_SCOPE("build_texture_arrays");
+    TextureArrays result;
+    result.layers.resize(images.size());
+
+    // 按通道数分组，map 保证数组顺序稳定
+    std::map<int, std::vector<int>> groups;
+    for (size_t i = 0; i < images.size(); i++)
+        if (!images[i].pixels.empty())
+            groups[images[i].channels].push_back(static_cast<int>(i));
+
+    GLint max_layers = 256;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &max_layers);
+    GLint previous_texture = 0, alignment = 4;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D_ARRAY, &previous_texture);
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    for (const auto &group : groups)
+    {
+        const std::vector<int> &members = group.second;
+        int width = forced_width, height = forced_height;
+        if (width == 0)
+        {
+            // 组内最常见的尺寸，一样多时取面积大的
+            std::map<std::pair<int, int>, int> counts;
+            int best = 0;
+            for (int material : members)
+            {
+                const Image &image = images[material];
+                int count = ++counts[{image.width, image.height}];
+                if (count > best || (count == best && image.width * image.height > width * height))
+                {
+                    best = count;
+                    width = image.width;
+                    height = image.height;
+                }
+            }
+        }
+
+        GLenum format = channel_format(group.first);
+        for (size_t first = 0; first < members.size(); first += max_layers)
+        {
+            int layers = static_cast<int>(std::min(members.size() - first, size_t(max_layers)));
+            GLuint texture = GL_CREATE(TEXTURE, label);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, format, width, height, layers, 0, format, GL_UNSIGNED_BYTE, nullptr);
+            int resized = 0;
+            for (int layer = 0; layer < layers; layer++)
+            {
+                int material = members[first + layer];
+                const Image &image = images[material];
+                if (image.width == width && image.height == height)
+                {
+                    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, width, height, 1, format, GL_UNSIGNED_BYTE, image.pixels.data());
+                }
+                else
+                {
+                    std::vector<unsigned char> pixels = resize_image(image.pixels.data(), image.width, image.height, image.channels, width, height);
+                    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, width, height, 1, format, GL_UNSIGNED_BYTE, pixels.data());
+                    resized++;
+                }
+                result.layers[material] = TextureArrayLayer{static_cast<int>(result.arrays.size()), layer};
+            }
+            glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            GLRegistry::instance().set_bytes(GLObjectType::TEXTURE, texture, GLRegistry::texture_bytes(format, width, height, layers, true));
+            result.arrays.emplace_back(texture);
+            printf("Texture array built: %s (%dx%d, %d layers, %d resized)\n", label.c_str(), width, height, layers, resized);
+        }
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, previous_texture);
+    images.clear();
+    return result;
+}
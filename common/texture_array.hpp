@@ -0,0 +1,62 @@
+#ifndef TEXTURE_ARRAY_HPP
+#define TEXTURE_ARRAY_HPP
+
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include "gl_handle.hpp"
+
+// 材质 ID 在数组纹理中的位置
+struct TextureArrayLayer
+{
+    int array = -1; // TextureArrays::arrays 下标，加载失败为 -1
+    int layer = -1;
+};
+
+// build() 的结果：数组纹理归这里所有
+struct TextureArrays
+{
+    std::vector<TextureHandle> arrays;
+    std::vector<TextureArrayLayer> layers; // 下标为 add() 返回的材质 ID
+
+    const TextureArrayLayer &operator[](int material) const { return layers[material]; }
+    bool single_array() const { return arrays.size() == 1; }
+};
+
+/**
+ * @brief 把一组同格式的纹理合并成 GL_TEXTURE_2D_ARRAY，不同材质的物体共用一次绑定，
+ *        着色器里用层号采样 sampler2DArray，从而可以合成一次实例化 / 多物体绘制。
+ *        add() 按加入顺序分配材质 ID 并在 CPU 上解码；build() 按像素格式（R / RG / RGB / RGBA）分组，
+ *        每组生成一个数组纹理：组内尺寸不一致的图缩放到该组最常见的尺寸（构造时给了尺寸则统一缩放到该尺寸），
+ *        每层一次 glTexSubImage3D，最后整体 glGenerateMipmap。
+ *        只读取原图，不使用 texcook 烘焙的压缩纹理。build() 只能在 GL 线程调用。
+ */
+class TextureArrayBuilder
+{
+public:
+    // width / height 为 0 时按组内最常见的尺寸
+    explicit TextureArrayBuilder(int width = 0, int height = 0);
+
+    // 返回材质 ID；同一路径只解码一次，返回同一个 ID；解码失败时打印错误，build() 后该 ID 没有对应的层
+    int add(const std::string &path);
+    // label 用于 GL 对象登记；调用后已解码的像素被释放，builder 可以重新使用
+    TextureArrays build(const std::string &label);
+
+    size_t size() const { return images.size(); }
+
+private:
+    struct Image
+    {
+        std::string path;
+        int width = 0, height = 0, channels = 0;
+        std::vector<unsigned char> pixels;
+    };
+
+    int forced_width, forced_height;
+    std::vector<Image> images;
+};
+
+// 按通道数缩放 8 位图像：缩小时用覆盖范围内的三角滤波（不会混叠），放大时退化为双线性
+std::vector<unsigned char> resize_image(const unsigned char *pixels, int width, int height, int channels, int new_width, int new_height);
+
+#endif // TEXTURE_ARRAY_HPP
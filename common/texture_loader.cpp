@@ -0,0 +1,481 @@
+#include "texture_loader.hpp"
+#include "gl_registry.hpp"
+#include "ktx2.hpp"
+#include "mapped_file.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "stb_image.h"
+
+// S3TC 不在 GL 3.3 核心里，glad 没有生成这些枚举
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT 0x83F2
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT 0x8C4D
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT 0x8C4E
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
+namespace
+{
+    using clock = std::chrono::steady_clock;
+
+    bool has_extension(const char *name)
+    {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; i++)
+        {
+            const char *extension = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, i));
+            if (extension && std::strcmp(extension, name) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    // RGTC 是 3.0 核心功能；S3TC 和 BPTC 要看扩展，桌面驱动基本都有，不支持时回退到原图
+    bool format_supported(GLenum format)
+    {
+        static const bool s3tc = has_extension("GL_EXT_texture_compression_s3tc");
+        static const bool bptc = GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 2) ||
+                                 has_extension("GL_ARB_texture_compression_bptc");
+        switch (format)
+        {
+        case GL_COMPRESSED_RED_RGTC1:
+        case GL_COMPRESSED_SIGNED_RED_RGTC1:
+        case GL_COMPRESSED_RG_RGTC2:
+        case GL_COMPRESSED_SIGNED_RG_RGTC2:
+            return true;
+        case GL_COMPRESSED_RGBA_BPTC_UNORM:
+        case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+            return bptc;
+        default:
+            return s3tc;
+        }
+    }
+
+    size_t format_block_bytes(GLenum format)
+    {
+        switch (format)
+        {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RED_RGTC1:
+        case GL_COMPRESSED_SIGNED_RED_RGTC1:
+            return 8;
+        default:
+            return 16;
+        }
+    }
+
+    GLenum vk_format_to_gl(uint32_t vk_format)
+    {
+        switch (vk_format)
+        {
+        case 131: // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+            return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case 132: // VK_FORMAT_BC1_RGB_SRGB_BLOCK
+            return GL_COMPRESSED_SRGB_S3TC_DXT1_EXT;
+        case 133: // VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+            return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+        case 134: // VK_FORMAT_BC1_RGBA_SRGB_BLOCK
+            return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;
+        case 135: // VK_FORMAT_BC2_UNORM_BLOCK
+            return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+        case 136: // VK_FORMAT_BC2_SRGB_BLOCK
+            return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT;
+        case 137: // VK_FORMAT_BC3_UNORM_BLOCK
+            return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case 138: // VK_FORMAT_BC3_SRGB_BLOCK
+            return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+        case 139: // VK_FORMAT_BC4_UNORM_BLOCK
+            return GL_COMPRESSED_RED_RGTC1;
+        case 140: // VK_FORMAT_BC4_SNORM_BLOCK
+            return GL_COMPRESSED_SIGNED_RED_RGTC1;
+        case 141: // VK_FORMAT_BC5_UNORM_BLOCK
+            return GL_COMPRESSED_RG_RGTC2;
+        case 142: // VK_FORMAT_BC5_SNORM_BLOCK
+            return GL_COMPRESSED_SIGNED_RG_RGTC2;
+        case 145: // VK_FORMAT_BC7_UNORM_BLOCK
+            return GL_COMPRESSED_RGBA_BPTC_UNORM;
+        case 146: // VK_FORMAT_BC7_SRGB_BLOCK
+            return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+        default:
+            return GL_NONE;
+        }
+    }
+
+    GLenum dxgi_format_to_gl(uint32_t dxgi_format)
+    {
+        switch (dxgi_format)
+        {
+        case 71: // DXGI_FORMAT_BC1_UNORM
+            return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+        case 72: // DXGI_FORMAT_BC1_UNORM_SRGB
+            return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;
+        case 74: // DXGI_FORMAT_BC2_UNORM
+            return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+        case 75: // DXGI_FORMAT_BC2_UNORM_SRGB
+            return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT;
+        case 77: // DXGI_FORMAT_BC3_UNORM
+            return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case 78: // DXGI_FORMAT_BC3_UNORM_SRGB
+            return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+        case 80: // DXGI_FORMAT_BC4_UNORM
+            return GL_COMPRESSED_RED_RGTC1;
+        case 81: // DXGI_FORMAT_BC4_SNORM
+            return GL_COMPRESSED_SIGNED_RED_RGTC1;
+        case 83: // DXGI_FORMAT_BC5_UNORM
+            return GL_COMPRESSED_RG_RGTC2;
+        case 84: // DXGI_FORMAT_BC5_SNORM
+            return GL_COMPRESSED_SIGNED_RG_RGTC2;
+        case 98: // DXGI_FORMAT_BC7_UNORM
+            return GL_COMPRESSED_RGBA_BPTC_UNORM;
+        case 99: // DXGI_FORMAT_BC7_UNORM_SRGB
+            return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+        default:
+            return GL_NONE;
+        }
+    }
+
+    uint32_t read_u32(const uint8_t *data)
+    {
+        return uint32_t(data[0]) | (uint32_t(data[1]) << 8) | (uint32_t(data[2]) << 16) | (uint32_t(data[3]) << 24);
+    }
+
+    constexpr uint32_t fourcc(char a, char b, char c, char d)
+    {
+        return uint32_t(uint8_t(a)) | (uint32_t(uint8_t(b)) << 8) | (uint32_t(uint8_t(c)) << 16) | (uint32_t(uint8_t(d)) << 24);
+    }
+
+    size_t level_bytes(GLenum format, int width, int height)
+    {
+        return size_t((width + 3) / 4) * ((height + 3) / 4) * format_block_bytes(format);
+    }
+
+    bool parse_ktx2(const MappedFile &file, CompressedImage &image)
+    {
+        Ktx2Header header;
+        if (!read_ktx2_header(file.data(), file.size(), header))
+            return false;
+        // 只处理未超压缩的单张 2D 纹理
+        if (header.supercompression != 0 || header.depth > 1 || header.layers > 1 || header.faces != 1)
+            return false;
+        image.format = vk_format_to_gl(header.vk_format);
+        image.width = static_cast<int>(header.width);
+        image.height = static_cast<int>(header.height);
+        for (const Ktx2Level &level : header.levels)
+            image.levels.push_back({file.data() + level.offset, static_cast<size_t>(level.length)});
+        return image.format != GL_NONE;
+    }
+
+    bool parse_dds(const MappedFile &file, CompressedImage &image)
+    {
+        const uint8_t *data = file.data();
+        if (file.size() < 128 || read_u32(data) != fourcc('D', 'D', 'S', ' '))
+            return false;
+        image.height = static_cast<int>(read_u32(data + 12));
+        image.width = static_cast<int>(read_u32(data + 16));
+        uint32_t level_count = std::max(1u, read_u32(data + 28));
+        uint32_t pixel_format_fourcc = read_u32(data + 84);
+        uint32_t caps2 = read_u32(data + 112);
+        size_t offset = 128;
+
+        switch (pixel_format_fourcc)
+        {
+        case fourcc('D', 'X', 'T', '1'):
+            image.format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+            break;
+        case fourcc('D', 'X', 'T', '3'):
+            image.format = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+            break;
+        case fourcc('D', 'X', 'T', '5'):
+            image.format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+            break;
+        case fourcc('A', 'T', 'I', '1'):
+        case fourcc('B', 'C', '4', 'U'):
+            image.format = GL_COMPRESSED_RED_RGTC1;
+            break;
+        case fourcc('A', 'T', 'I', '2'):
+        case fourcc('B', 'C', '5', 'U'):
+            image.format = GL_COMPRESSED_RG_RGTC2;
+            break;
+        case fourcc('D', 'X', '1', '0'):
+            if (file.size() < 148)
+                return false;
+            // 扩展头：只接受单张 2D 纹理（resourceDimension = 3，arraySize = 1，非 cubemap）
+            if (read_u32(data + 132) != 3 || (read_u32(data + 136) & 0x4) || read_u32(data + 140) > 1)
+                return false;
+            image.format = dxgi_format_to_gl(read_u32(data + 128));
+            offset = 148;
+            break;
+        default:
+            return false;
+        }
+        if (image.format == GL_NONE || (caps2 & 0x200)) // DDSCAPS2_CUBEMAP
+            return false;
+
+        int width = image.width, height = image.height;
+        for (uint32_t i = 0; i < level_count; i++)
+        {
+            size_t size = level_bytes(image.format, width, height);
+            if (offset + size > file.size())
+                return false;
+            image.levels.push_back({data + offset, size});
+            offset += size;
+            width = std::max(1, width / 2);
+            height = std::max(1, height / 2);
+        }
+        return true;
+    }
+
+    GLuint upload_compressed(const CompressedImage &image, const std::string &label, size_t &gpu_bytes)
+    {
+        GLuint texture = GL_CREATE(TEXTURE, label);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        gpu_bytes = 0;
+        int width = image.width, height = image.height;
+        for (size_t level = 0; level < image.levels.size(); level++)
+        {
+            glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), image.format, width, height, 0,
+                                   static_cast<GLsizei>(image.levels[level].size), image.levels[level].data);
+            gpu_bytes += image.levels[level].size;
+            width = std::max(1, width / 2);
+            height = std::max(1, height / 2);
+        }
+        GLRegistry::instance().set_bytes(GLObjectType::TEXTURE, texture, gpu_bytes);
+
+        // mip 链可能不完整（如只烘焙到 4x4），限制最高层，否则纹理不完整采样为黑色
+        bool mipmapped = image.levels.size() > 1;
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(image.levels.size() - 1));
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipmapped ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        return texture;
+    }
+
+    bool ends_with(const std::string &text, const char *suffix)
+    {
+        size_t length = std::strlen(suffix);
+        return text.size() >= length && text.compare(text.size() - length, length, suffix) == 0;
+    }
+
+    std::string replace_extension(const std::string &path, const char *extension)
+    {
+        size_t dot = path.find_last_of('.');
+        size_t slash = path.find_last_of("/\\");
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+            return path + extension;
+        return path.substr(0, dot) + extension;
+    }
+
+    GLuint load_compressed(const std::string &path, TextureFileType &type, size_t &gpu_bytes)
+    {
+        MappedFile file;
+        CompressedImage image;
+        if (!open_compressed_texture(path, file, image))
+            return 0;
+        PROFILE_CPU_SCOPE("load_compressed_texture");
+        type = ends_with(path, ".dds") ? TextureFileType::DDS : TextureFileType::KTX2;
+        return upload_compressed(image, path, gpu_bytes);
+    }
+
+    GLuint upload_image(unsigned char *data, int width, int height, int channels, const std::string &label, size_t &gpu_bytes)
+    {
+        GLenum format = GL_RGB;
+        if (channels == 1)
+            format = GL_RED;
+        else if (channels == 4)
+            format = GL_RGBA;
+
+        GLuint texture = GL_CREATE(TEXTURE, label);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        gpu_bytes = GLRegistry::texture_bytes(format, width, height, 1, true);
+        GLRegistry::instance().set_bytes(GLObjectType::TEXTURE, texture, gpu_bytes);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        stbi_image_free(data);
+        return texture;
+    }
+
+    GLuint load_image(const std::string &path, size_t &gpu_bytes)
+    {
+        PROFILE_CPU_SCOPE("load_image_texture");
+        int width, height, channels;
+        unsigned char *data = load_image_pixels(path, &width, &height, &channels);
+        if (!data)
+            return 0;
+        return upload_image(data, width, height, channels, path, gpu_bytes);
+    }
+}
+
+bool open_compressed_texture(const std::string &path, MappedFile &file, CompressedImage &image)
+{
+    if (!file.open(path))
+        return false;
+    image = CompressedImage();
+    bool parsed = ends_with(path, ".dds") ? parse_dds(file, image) : parse_ktx2(file, image);
+    if (!parsed || image.width <= 0 || image.height <= 0 || image.levels.empty())
+    {
+        printf("ERROR::TEXTURE_LOADER:: %s is not a supported 2D block-compressed texture\n", path.c_str());
+        return false;
+    }
+    int width = image.width, height = image.height;
+    for (const CompressedLevel &level : image.levels)
+    {
+        if (level.size < level_bytes(image.format, width, height))
+        {
+            printf("ERROR::TEXTURE_LOADER:: %s is truncated\n", path.c_str());
+            return false;
+        }
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+    if (!format_supported(image.format))
+    {
+        printf("texture loader: compressed format 0x%04X of %s not supported by the driver, falling back\n", image.format, path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool open_cooked_texture(const std::string &path, MappedFile &file, CompressedImage &image)
+{
+    for (const char *extension : {".ktx2", ".dds"})
+        if (open_compressed_texture(replace_extension(path, extension), file, image))
+            return true;
+    return false;
+}
+
+TextureLoadStats &TextureLoadStats::instance()
+{
+    static TextureLoadStats stats;
+    return stats;
+}
+
+void TextureLoadStats::record(TextureFileType type, double milliseconds, size_t gpu_bytes)
+{
+    Entry &entry = entries[size_t(type)];
+    entry.count++;
+    entry.milliseconds += milliseconds;
+    entry.gpu_bytes += gpu_bytes;
+}
+
+void TextureLoadStats::print_report() const
+{
+    printf("%-10s %8s %12s %12s %12s\n", "textures", "count", "total ms", "avg ms", "GPU MB");
+    for (size_t i = 0; i < size_t(TextureFileType::COUNT); i++)
+    {
+        const Entry &entry = entries[i];
+        if (entry.count == 0)
+            continue;
+        printf("%-10s %8zu %12.2f %12.2f %12.2f\n", type_name(TextureFileType(i)), entry.count, entry.milliseconds,
+               entry.milliseconds / entry.count, entry.gpu_bytes / 1048576.0);
+    }
+}
+
+void TextureLoadStats::reset()
+{
+    for (Entry &entry : entries)
+        entry = Entry();
+}
+
+const char *TextureLoadStats::type_name(TextureFileType type)
+{
+    static const char *names[] = {"ktx2", "dds", "image"};
+    return type < TextureFileType::COUNT ? names[size_t(type)] : "unknown";
+}
+
+GLuint load_compressed_texture(const std::string &path)
+{
+    clock::time_point start = clock::now();
+    TextureFileType type;
+    size_t gpu_bytes = 0;
+    GLuint texture = load_compressed(path, type, gpu_bytes);
+    if (texture)
+        TextureLoadStats::instance().record(type, std::chrono::duration<double, std::milli>(clock::now() - start).count(), gpu_bytes);
+    return texture;
+}
+
+GLuint load_cooked_texture(const std::string &path)
+{
+    for (const char *extension : {".ktx2", ".dds"})
+    {
+        if (GLuint texture = load_compressed_texture(replace_extension(path, extension)))
+        {
+            printf("Texture loaded (%s): %s\n", extension + 1, path.c_str());
+            return texture;
+        }
+    }
+    return 0;
+}
+
+GLuint load_texture_file(const std::string &path)
+{
+    if (GLuint texture = load_cooked_texture(path))
+        return texture;
+
+    clock::time_point start = clock::now();
+    size_t gpu_bytes = 0;
+    GLuint texture = load_image(path, gpu_bytes);
+    if (!texture)
+    {
+        printf("ERROR::TEXTURE_LOADER:: failed to load %s\n", path.c_str());
+        return 0;
+    }
+    TextureLoadStats::instance().record(TextureFileType::IMAGE, std::chrono::duration<double, std::milli>(clock::now() - start).count(), gpu_bytes);
+    printf("Texture loaded: %s\n", path.c_str());
+    return texture;
+}
+
+unsigned char *load_image_pixels(const std::string &path, int *width, int *height, int *channels, int desired_channels)
+{
+    MappedFile file;
+    if (!file.open(path))
+        return nullptr;
+    return stbi_load_from_memory(file.data(), static_cast<int>(file.size()), width, height, channels, desired_channels);
+}
+
+float *load_image_pixels_float(const std::string &path, int *width, int *height, int *channels, int desired_channels)
+{
+    MappedFile file;
+    if (!file.open(path))
+        return nullptr;
+    return stbi_loadf_from_memory(file.data(), static_cast<int>(file.size()), width, height, channels, desired_channels);
+}
+
+GLuint load_texture_memory(const uint8_t *bytes, size_t size, const std::string &label)
+{
+    PROFILE_CPU_SCOPE("load_image_texture");
+    clock::time_point start = clock::now();
+    int width, height, channels;
+    unsigned char *data = stbi_load_from_memory(bytes, static_cast<int>(size), &width, &height, &channels, 0);
+    if (!data)
+    {
+        printf("ERROR::TEXTURE_LOADER:: failed to decode %s\n", label.c_str());
+        return 0;
+    }
+    size_t gpu_bytes = 0;
+    GLuint texture = upload_image(data, width, height, channels, label, gpu_bytes);
+    TextureLoadStats::instance().record(TextureFileType::IMAGE, std::chrono::duration<double, std::milli>(clock::now() - start).count(), gpu_bytes);
+    printf("Texture loaded: %s\n", label.c_str());
+    return texture;
+}
@@ -0,0 +1,90 @@
+#ifndef TEXTURE_LOADER_HPP
+#define TEXTURE_LOADER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include "mapped_file.hpp"
+
+// 纹理实际从哪种文件加载
+enum class TextureFileType
+{
+    KTX2,  // texcook 生成的块压缩纹理
+    DDS,   // 其他工具导出的块压缩纹理
+    IMAGE, // png / jpg 等，stb_image 解码
+    COUNT
+};
+
+struct CompressedLevel
+{
+    const uint8_t *data;
+    size_t size;
+};
+
+// 从 KTX2 / DDS 里解析出的、可以直接上传的压缩纹理；data 指向映射的文件，levels[0] 为最大一级
+struct CompressedImage
+{
+    GLenum format = GL_NONE;
+    int width = 0;
+    int height = 0;
+    std::vector<CompressedLevel> levels;
+};
+
+/**
+ * @brief 按文件类型累计纹理加载次数、耗时和显存，用来对比压缩纹理和原图两条加载路径。只在 GL 线程使用。
+ */
+class TextureLoadStats
+{
+public:
+    struct Entry
+    {
+        size_t count = 0;
+        double milliseconds = 0.0;
+        size_t gpu_bytes = 0;
+    };
+
+    static TextureLoadStats &instance();
+
+    void record(TextureFileType type, double milliseconds, size_t gpu_bytes);
+    Entry get(TextureFileType type) const { return entries[size_t(type)]; }
+    void print_report() const;
+    void reset();
+
+    static const char *type_name(TextureFileType type);
+
+private:
+    TextureLoadStats() = default;
+
+    Entry entries[size_t(TextureFileType::COUNT)];
+};
+
+/**
+ * @brief 加载 2D 纹理：先找同名的 .ktx2，再找 .dds，存在且驱动支持其格式时把文件映射到内存，
+ *        各层压缩数据直接交给 glCompressedTexImage2D，不解码也不 glGenerateMipmap；
+ *        都没有时用 stb_image 解码原图并生成 mip。失败返回 0。
+ *        压缩纹理按文件中的行顺序上传（第一行对应 t = 0），与 stb_image 不翻转时一致。
+ */
+GLuint load_texture_file(const std::string &path);
+
+// 从内存里的 png / jpg 等解码（如 GLB 内嵌的图片），label 用于日志和 GL 对象标签；失败返回 0
+GLuint load_texture_memory(const uint8_t *data, size_t size, const std::string &label);
+
+// stb_image 解码图片文件，经过 MappedFile（资源包里有时直接从包里读）；结果用 stbi_image_free 释放，失败返回 nullptr
+unsigned char *load_image_pixels(const std::string &path, int *width, int *height, int *channels, int desired_channels = 0);
+// 同上，.hdr 等解码成 float
+float *load_image_pixels_float(const std::string &path, int *width, int *height, int *channels, int desired_channels = 0);
+
+// 只找同名的 .ktx2 / .dds，都没有时返回 0 且不打印错误
+GLuint load_cooked_texture(const std::string &path);
+
+// 只加载 KTX2 / DDS（按扩展名区分），失败返回 0；文件不存在时不打印错误
+GLuint load_compressed_texture(const std::string &path);
+
+// 映射并解析 KTX2 / DDS，检查各层大小和驱动是否支持该格式，不上传；image 只在 file 打开期间有效
+bool open_compressed_texture(const std::string &path, MappedFile &file, CompressedImage &image);
+// 依次尝试同名的 .ktx2 / .dds
+bool open_cooked_texture(const std::string &path, MappedFile &file, CompressedImage &image);
+
+#endif // TEXTURE_LOADER_HPP
@@ -0,0 +1,257 @@
+#include "texture_streamer.hpp"
+#include "gl_registry.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+namespace
+{
+    int level_dimension(int size, int level)
+    {
+        return std::max(1, size >> level);
+    }
+}
+
+TextureStreamer::TextureStreamer(size_t budget, size_t upload_budget, int tail_size)
+    : budget(budget), upload_budget(std::max<size_t>(upload_budget, 1)), tail_size(std::max(tail_size, 1))
+{
+}
+
+TextureStreamer::~TextureStreamer() = default;
+
+GLuint TextureStreamer::load(const std::string &path)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::unique_ptr<Entry> entry(new Entry());
+    if (!open_cooked_texture(path, entry->file, entry->image))
+        return 0;
+    PROFILE_CPU_SCOPE("load_streamed_texture");
+
+    entry->path = path;
+    const CompressedImage &image = entry->image;
+    int last = static_cast<int>(image.levels.size()) - 1;
+    entry->tail = last;
+    for (int level = 0; level <= last; level++)
+    {
+        if (std::max(level_dimension(image.width, level), level_dimension(image.height, level)) <= tail_size)
+        {
+            entry->tail = level;
+            break;
+        }
+    }
+    entry->base = entry->tail;
+    entry->wanted = entry->tail;
+
+    entry->texture = GL_CREATE(TEXTURE, path);
+    glBindTexture(GL_TEXTURE_2D, entry->texture);
+    size_t bytes = 0;
+    for (int level = entry->tail; level <= last; level++)
+    {
+        glCompressedTexImage2D(GL_TEXTURE_2D, level, image.format, level_dimension(image.width, level), level_dimension(image.height, level), 0,
+                               static_cast<GLsizei>(image.levels[level].size), image.levels[level].data);
+        bytes += image.levels[level].size;
+    }
+    // 比 BASE_LEVEL 大的级别没有定义，不影响纹理完整性
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, entry->tail);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, last);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, last > 0 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    GLRegistry::instance().set_bytes(GLObjectType::TEXTURE, entry->texture, bytes);
+
+    stats.textures++;
+    stats.resident_bytes += bytes;
+    for (const CompressedLevel &level : image.levels)
+        stats.full_bytes += level.size;
+    TextureFileType type = entry->file.size() >= 4 && entry->file.data()[0] == 'D' ? TextureFileType::DDS : TextureFileType::KTX2;
+    TextureLoadStats::instance().record(type, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(), bytes);
+    printf("Texture loaded (streamed from mip %d): %s\n", entry->tail, path.c_str());
+
+    GLuint texture = entry->texture;
+    entries[texture] = std::move(entry);
+    return texture;
+}
+
+void TextureStreamer::unload(GLuint texture)
+{
+    auto found = entries.find(texture);
+    if (found == entries.end())
+        return;
+    const Entry &entry = *found->second;
+    stats.resident_bytes -= resident_size(entry);
+    for (const CompressedLevel &level : entry.image.levels)
+        stats.full_bytes -= level.size;
+    stats.textures--;
+    entries.erase(found);
+}
+
+void TextureStreamer::set_view(const glm::mat4 &projection, int height)
+{
+    projection_scale = projection[1][1];
+    viewport_height = std::max(height, 1);
+}
+
+void TextureStreamer::request(GLuint texture, float uv_density, float distance)
+{
+    auto found = entries.find(texture);
+    if (found == entries.end())
+        return;
+    const CompressedImage &image = found->second->image;
+    // 一个像素覆盖的世界尺寸 * 每世界单位的纹素数 = 每像素纹素数，取 log2 即需要的 mip
+    float world_per_pixel = 2.0f * std::max(distance, 0.0f) / (projection_scale * viewport_height);
+    float texels_per_pixel = std::max(image.width, image.height) * uv_density * world_per_pixel;
+    request_level(texture, texels_per_pixel > 0.0f ? std::log2(texels_per_pixel) : 0.0f);
+}
+
+void TextureStreamer::request_level(GLuint texture, float level)
+{
+    auto found = entries.find(texture);
+    if (found == entries.end())
+        return;
+    Entry &entry = *found->second;
+    // 三线性过滤会同时采样 floor(level) 这一级
+    int wanted = std::min(std::max(static_cast<int>(std::floor(level)), 0), entry.tail);
+    entry.wanted = std::min(entry.wanted, wanted);
+    entry.last_used = frame;
+}
+
+void TextureStreamer::update()
+{
+    PROFILE_CPU_SCOPE("texture_streamer");
+    GLint previous_texture = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous_texture);
+    stats.streamed_in = 0;
+    stats.evicted = 0;
+    stats.starved = 0;
+
+    std::vector<Entry *> pending;
+    stats.wanted_bytes = 0;
+    for (auto &item : entries)
+    {
+        Entry &entry = *item.second;
+        for (size_t level = entry.wanted; level < entry.image.levels.size(); level++)
+            stats.wanted_bytes += entry.image.levels[level].size;
+        if (entry.wanted < entry.base)
+            pending.push_back(&entry);
+    }
+    // 缺得越多越先补；每轮每张纹理只补一级，预算有限时各纹理一起逐渐变清晰
+    std::sort(pending.begin(), pending.end(), [](const Entry *a, const Entry *b)
+              { return a->base - a->wanted > b->base - b->wanted; });
+
+    // 腾出 bytes 的空间：只释放比本帧需求更清晰的级别（没被上报的纹理需求为 tail），最久没用的先释放
+    auto make_room = [this](size_t bytes)
+    {
+        while (stats.resident_bytes + bytes > budget)
+        {
+            Entry *victim = nullptr;
+            for (auto &item : entries)
+            {
+                Entry &entry = *item.second;
+                if (entry.base >= entry.wanted)
+                    continue;
+                if (!victim || entry.last_used < victim->last_used ||
+                    (entry.last_used == victim->last_used && level_size(entry, entry.base) > level_size(*victim, victim->base)))
+                    victim = &entry;
+            }
+            if (!victim)
+                return false;
+            evict_level(*victim);
+        }
+        return true;
+    };
+
+    size_t uploaded = 0;
+    bool progress = true;
+    while (progress)
+    {
+        progress = false;
+        for (Entry *entry : pending)
+        {
+            if (entry->base <= entry->wanted)
+                continue;
+            size_t bytes = level_size(*entry, entry->base - 1);
+            if (uploaded > 0 && uploaded + bytes > upload_budget)
+            {
+                progress = false;
+                break;
+            }
+            if (!make_room(bytes))
+                continue;
+            upload_level(*entry, entry->base - 1);
+            uploaded += bytes;
+            progress = true;
+        }
+    }
+    // 预算被调小时也要回到预算以内
+    make_room(0);
+
+    for (auto &item : entries)
+    {
+        Entry &entry = *item.second;
+        // 上传预算用完只是分帧，不算压力；空间腾不出来才算
+        if (entry.wanted < entry.base && stats.resident_bytes + level_size(entry, entry.base - 1) > budget)
+            stats.starved++;
+        entry.wanted = entry.tail;
+    }
+    glBindTexture(GL_TEXTURE_2D, previous_texture);
+    frame++;
+}
+
+void TextureStreamer::upload_level(Entry &entry, int level)
+{
+    const CompressedImage &image = entry.image;
+    glBindTexture(GL_TEXTURE_2D, entry.texture);
+    glCompressedTexImage2D(GL_TEXTURE_2D, level, image.format, level_dimension(image.width, level), level_dimension(image.height, level), 0,
+                           static_cast<GLsizei>(image.levels[level].size), image.levels[level].data);
+    // 新的一级数据已经完整，再放开采样
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+    entry.base = level;
+    stats.resident_bytes += image.levels[level].size;
+    stats.streamed_in += image.levels[level].size;
+    stats.total_streamed_in += image.levels[level].size;
+    GLRegistry::instance().set_bytes(GLObjectType::TEXTURE, entry.texture, resident_size(entry));
+}
+
+void TextureStreamer::evict_level(Entry &entry)
+{
+    const CompressedImage &image = entry.image;
+    int level = entry.base;
+    glBindTexture(GL_TEXTURE_2D, entry.texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level + 1);
+    // GL 3.3 不能单独释放某一级，重定义为 0x0 让驱动回收存储
+    glCompressedTexImage2D(GL_TEXTURE_2D, level, image.format, 0, 0, 0, 0, nullptr);
+    entry.base = level + 1;
+    stats.resident_bytes -= image.levels[level].size;
+    stats.evicted += image.levels[level].size;
+    stats.total_evicted += image.levels[level].size;
+    GLRegistry::instance().set_bytes(GLObjectType::TEXTURE, entry.texture, resident_size(entry));
+}
+
+size_t TextureStreamer::resident_size(const Entry &entry) const
+{
+    size_t bytes = 0;
+    for (size_t level = entry.base; level < entry.image.levels.size(); level++)
+        bytes += entry.image.levels[level].size;
+    return bytes;
+}
+
+void TextureStreamer::print_report() const
+{
+    printf("%-60s %11s %6s %6s %10s\n", "streamed texture", "size", "mip", "tail", "MB");
+    std::vector<const Entry *> sorted;
+    for (const auto &item : entries)
+        sorted.push_back(item.second.get());
+    std::sort(sorted.begin(), sorted.end(), [](const Entry *a, const Entry *b)
+              { return a->path < b->path; });
+    for (const Entry *entry : sorted)
+    {
+        char size[32];
+        snprintf(size, sizeof(size), "%dx%d", entry->image.width, entry->image.height);
+        printf("%-60s %11s %6d %6d %10.2f\n", entry->path.c_str(), size, entry->base, entry->tail, resident_size(*entry) / 1048576.0);
+    }
+    printf("resident %.2f / %.2f MB budget (all mips %.2f MB, last frame wanted %.2f MB), %d textures starved%s\n",
+           stats.resident_bytes / 1048576.0, budget / 1048576.0, stats.full_bytes / 1048576.0, stats.wanted_bytes / 1048576.0,
+           stats.starved, stats.wanted_bytes > budget ? ", over budget" : "");
+}
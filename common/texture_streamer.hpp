@@ -0,0 +1,114 @@
+#ifndef TEXTURE_STREAMER_HPP
+#define TEXTURE_STREAMER_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "mapped_file.hpp"
+#include "texture_loader.hpp"
+
+/**
+ * @brief 按屏幕需求决定 mip 驻留的纹理流送器，只管理 texcook 烘焙的 KTX2 / DDS（完整 mip 链映射在内存里）。
+ *        加载时只上传不超过 tail_size 的几级小 mip，GL_TEXTURE_BASE_LEVEL 指向已驻留的最大一级；
+ *        每帧用 request() 上报各纹理的 UV 密度和到相机的距离，update() 估算需要的 mip，
+ *        逐级向上补全（每帧不超过 upload_budget 字节），显存超出 budget 时按 LRU 把暂时不需要的最大一级丢掉
+ *        （先抬高 BASE_LEVEL，再把该层重定义为 0x0 释放存储）。只能在 GL 线程使用。
+ */
+class TextureStreamer
+{
+public:
+    struct Stats
+    {
+        size_t textures = 0;
+        size_t resident_bytes = 0; // 当前驻留的压缩数据
+        size_t full_bytes = 0;     // 全部 mip 都驻留时的大小
+        size_t wanted_bytes = 0;   // 本帧需求全部满足时的大小
+        size_t streamed_in = 0;    // 本帧上传的字节数
+        size_t evicted = 0;        // 本帧释放的字节数
+        int starved = 0;           // 本帧因预算不足没能补全的纹理数
+        size_t total_streamed_in = 0;
+        size_t total_evicted = 0;
+    };
+
+    explicit TextureStreamer(size_t budget = size_t(256) << 20, size_t upload_budget = size_t(8) << 20, int tail_size = 64);
+    ~TextureStreamer();
+
+    TextureStreamer(const TextureStreamer &) = delete;
+    TextureStreamer &operator=(const TextureStreamer &) = delete;
+
+    // 找同名的 .ktx2 / .dds 并只上传小 mip；没有烘焙过的纹理返回 0，由调用者走普通加载
+    GLuint load(const std::string &path);
+    // 停止管理并解除映射；纹理仍归调用者删除
+    void unload(GLuint texture);
+
+    // 每帧先设置投影（只用到 projection[1][1]）和视口高度
+    void set_view(const glm::mat4 &projection, int viewport_height);
+    // uv_density 为每世界单位对应的 UV 长度，distance 为表面到相机的距离；同一帧多次上报取最清晰的需求
+    void request(GLuint texture, float uv_density, float distance);
+    // 直接指定需要的 mip（0 为原尺寸）
+    void request_level(GLuint texture, float level);
+
+    // 每帧调用一次：补全需要的 mip，超预算时按 LRU 释放
+    void update();
+
+    void set_budget(size_t bytes) { budget = bytes; }
+    size_t get_budget() const { return budget; }
+    const Stats &get_stats() const { return stats; }
+    void print_report() const;
+
+private:
+    struct Entry
+    {
+        std::string path;
+        MappedFile file;
+        CompressedImage image;
+        GLuint texture = 0;
+        int tail = 0;           // 始终驻留的最大一级
+        int base = 0;           // 当前驻留的最大一级（BASE_LEVEL）
+        int wanted = 0;         // 本帧需要的级别，没有上报时为 tail
+        uint64_t last_used = 0; // 最近一次被上报的帧
+    };
+
+    size_t budget;
+    size_t upload_budget;
+    int tail_size;
+    float projection_scale = 1.0f;
+    int viewport_height = 1;
+    uint64_t frame = 1;
+    std::unordered_map<GLuint, std::unique_ptr<Entry>> entries;
+    Stats stats;
+
+    size_t level_size(const Entry &entry, int level) const { return entry.image.levels[level].size; }
+    size_t resident_size(const Entry &entry) const;
+    void upload_level(Entry &entry, int level);
+    void evict_level(Entry &entry);
+};
+
+// 每世界单位的 UV 长度：sqrt(UV 面积 / 世界面积)
+inline float uv_density(float world_area, float uv_area)
+{
+    return world_area > 0.0f ? std::sqrt(uv_area / world_area) : 0.0f;
+}
+
+// 按三角形累加面积求网格的平均 UV 密度，VertexT 需要 Position（vec3）和 TexCoords（vec2）成员
+template <typename VertexT>
+float compute_uv_density(const std::vector<VertexT> &vertices, const std::vector<unsigned int> &indices)
+{
+    float world_area = 0.0f, uv_area = 0.0f;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        const VertexT &a = vertices[indices[i]], &b = vertices[indices[i + 1]], &c = vertices[indices[i + 2]];
+        world_area += 0.5f * glm::length(glm::cross(b.Position - a.Position, c.Position - a.Position));
+        glm::vec2 e1 = b.TexCoords - a.TexCoords, e2 = c.TexCoords - a.TexCoords;
+        uv_area += 0.5f * std::abs(e1.x * e2.y - e1.y * e2.x);
+    }
+    return uv_density(world_area, uv_area);
+}
+
+#endif // TEXTURE_STREAMER_HPP
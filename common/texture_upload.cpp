@@ -0,0 +1,304 @@
+#include "texture_upload.hpp"
+#include "gl_registry.hpp"
+#include "profiler.hpp"
+#include "texture_loader.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "stb_image.h"
+
+namespace
+{
+    using clock = std::chrono::steady_clock;
+
+    GLenum channel_format(int channels)
+    {
+        switch (channels)
+        {
+        case 1:
+            return GL_RED;
+        case 2:
+            return GL_RG;
+        case 3:
+            return GL_RGB;
+        default:
+            return GL_RGBA;
+        }
+    }
+
+    // 占位颜色：各通道 0.5，法线贴图解出来接近 (0, 0, 1)
+    const unsigned char PLACEHOLDER[4] = {128, 128, 128, 255};
+
+    bool fence_signaled(GLsync fence, bool wait)
+    {
+        if (!wait)
+        {
+            GLenum status = glClientWaitSync(fence, 0, 0);
+            return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+        }
+        // 第一次等待要求刷新命令队列，否则 fence 可能永远不会被提交
+        GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+        while (glClientWaitSync(fence, flags, 1000000000) == GL_TIMEOUT_EXPIRED)
+            flags = 0;
+        return true;
+    }
+
+    double elapsed_ms(clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    }
+}
+
+TextureUploadQueue::TextureUploadQueue(JobSystem &jobs, size_t frame_budget, int ring_size)
+    : jobs(jobs), frame_budget(std::max<size_t>(frame_budget, 1)), slot_bytes(std::max<size_t>(frame_budget / 2, 1)),
+      slots(ring_size > 0 ? ring_size : 1)
+{
+    for (Slot &slot : slots)
+        slot.buffer = GL_CREATE(BUFFER, "texture upload staging");
+}
+
+TextureUploadQueue::~TextureUploadQueue()
+{
+    flush();
+    for (Slot &slot : slots)
+    {
+        if (slot.fence)
+            glDeleteSync(slot.fence);
+        GL_DESTROY(BUFFER, slot.buffer);
+    }
+}
+
+GLuint TextureUploadQueue::load(const std::string &path)
+{
+    if (GLuint texture = load_cooked_texture(path))
+        return texture;
+
+    std::unique_ptr<Request> request(new Request());
+    request->path = path;
+    request->texture = GL_CREATE(TEXTURE, path);
+    glBindTexture(GL_TEXTURE_2D, request->texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, PLACEHOLDER);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    Request *raw = request.get();
+    jobs.submit([raw]()
+                {
+                    PROFILE_CPU_SCOPE("decode_texture");
+                    raw->pixels = load_image_pixels(raw->path, &raw->width, &raw->height, &raw->channels);
+                    raw->failed = raw->pixels == nullptr;
+                    raw->decoded.store(true, std::memory_order_release); },
+                &decode_counter);
+    GLuint texture = request->texture;
+    requests.push_back(std::move(request));
+    return texture;
+}
+
+void TextureUploadQueue::update()
+{
+    PROFILE_CPU_SCOPE("texture_upload");
+    clock::time_point start = clock::now();
+    GLint previous_texture = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous_texture);
+    stats.frame_bytes = 0;
+
+    // 先上传拷贝已经完成的段（按暂存顺序），超出预算的留到下一帧；至少传一段，保证大纹理也能前进
+    while (staged > 0 && slots[oldest].copy.value.load(std::memory_order_acquire) == 0)
+    {
+        const Slot &slot = slots[oldest];
+        size_t bytes = slot.request->row_bytes() * slot.rows;
+        if (stats.frame_bytes > 0 && stats.frame_bytes + bytes > frame_budget)
+            break;
+        upload_oldest();
+    }
+    // 再把空闲的暂存缓冲交给工作线程填充，下一帧上传
+    while (stage(false))
+        ;
+    retire_finished();
+    glBindTexture(GL_TEXTURE_2D, previous_texture);
+
+    stats.frame_ms = elapsed_ms(start);
+    stats.max_frame_ms = std::max(stats.max_frame_ms, stats.frame_ms);
+}
+
+void TextureUploadQueue::flush()
+{
+    jobs.wait(decode_counter);
+    while (!requests.empty())
+    {
+        while (staged > 0)
+        {
+            jobs.wait(slots[oldest].copy);
+            upload_oldest();
+        }
+        while (stage(true))
+            ;
+        retire_finished();
+    }
+}
+
+void TextureUploadQueue::cancel(GLuint texture)
+{
+    // 解码任务和已经暂存的拷贝还在引用请求，请求由 retire_finished 在它们结束后移除
+    for (const std::unique_ptr<Request> &request : requests)
+    {
+        if (request->texture == texture && !request->cancelled)
+        {
+            request->cancelled = true;
+            return;
+        }
+    }
+}
+
+bool TextureUploadQueue::stage(bool wait)
+{
+    if (staged == static_cast<int>(slots.size()))
+        return false;
+    Slot &slot = slots[(oldest + staged) % slots.size()];
+    if (slot.fence)
+    {
+        // 上一次从这个缓冲上传的命令还没执行完，下一帧再用
+        if (!fence_signaled(slot.fence, wait))
+            return false;
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+    }
+
+    Request *request = nullptr;
+    for (const std::unique_ptr<Request> &candidate : requests)
+    {
+        if (candidate->decoded.load(std::memory_order_acquire) && !candidate->failed && !candidate->cancelled &&
+            candidate->staged_rows < candidate->height)
+        {
+            request = candidate.get();
+            break;
+        }
+    }
+    if (!request)
+        return false;
+
+    clock::time_point start = clock::now();
+    if (request->staged_rows == 0)
+        begin_texture(*request);
+    size_t row_bytes = request->row_bytes();
+    int rows = std::min(request->height - request->staged_rows, std::max(1, static_cast<int>(slot_bytes / row_bytes)));
+    size_t size = row_bytes * rows;
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+    if (slot.capacity < size)
+    {
+        slot.capacity = std::max(size, slot_bytes);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, slot.capacity, nullptr, GL_STREAM_DRAW);
+        GLRegistry::instance().set_bytes(GLObjectType::BUFFER, slot.buffer, slot.capacity);
+    }
+    // INVALIDATE_BUFFER 让驱动换一块新存储（孤立化），不必等 GPU 读完旧内容
+    void *destination = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (!destination)
+    {
+        printf("ERROR::TEXTURE_UPLOAD:: failed to map staging buffer for %s\n", request->path.c_str());
+        request->failed = true;
+        return false;
+    }
+
+    slot.request = request;
+    slot.first_row = request->staged_rows;
+    slot.rows = rows;
+    const unsigned char *source = request->pixels + row_bytes * slot.first_row;
+    jobs.submit([destination, source, size]()
+                { std::memcpy(destination, source, size); },
+                &slot.copy);
+    request->staged_rows += rows;
+    request->milliseconds += elapsed_ms(start);
+    staged++;
+    return true;
+}
+
+void TextureUploadQueue::upload_oldest()
+{
+    clock::time_point start = clock::now();
+    Slot &slot = slots[oldest];
+    Request &request = *slot.request;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    // 上传完成前被 cancel() 的纹理跳过，映射的缓冲照常解除
+    if (!request.cancelled)
+    {
+        GLint alignment = 4;
+        glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glBindTexture(GL_TEXTURE_2D, request.texture);
+        // 绑定了 PIXEL_UNPACK 缓冲时最后一个参数是缓冲内偏移
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, slot.first_row, request.width, slot.rows, channel_format(request.channels),
+                        GL_UNSIGNED_BYTE, nullptr);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    size_t bytes = request.row_bytes() * slot.rows;
+    stats.frame_bytes += bytes;
+    stats.total_bytes += bytes;
+    request.uploaded_rows += slot.rows;
+    slot.request = nullptr;
+    oldest = (oldest + 1) % slots.size();
+    staged--;
+    request.milliseconds += elapsed_ms(start);
+    if (!request.failed && !request.cancelled && request.uploaded_rows == request.height)
+        finish_texture(request);
+}
+
+void TextureUploadQueue::begin_texture(Request &request)
+{
+    // 按真实尺寸定义第 0 层，同时把最小一级定义成 1x1 占位色，只采样这一级；第 0 层逐段填充时画面不会出现未定义内容
+    int top_level = 0;
+    while ((std::max(request.width, request.height) >> (top_level + 1)) > 0)
+        top_level++;
+    GLenum format = channel_format(request.channels);
+    glBindTexture(GL_TEXTURE_2D, request.texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, format, request.width, request.height, 0, format, GL_UNSIGNED_BYTE, nullptr);
+    if (top_level > 0)
+        glTexImage2D(GL_TEXTURE_2D, top_level, format, 1, 1, 0, format, GL_UNSIGNED_BYTE, PLACEHOLDER);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, top_level);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, top_level);
+}
+
+void TextureUploadQueue::finish_texture(Request &request)
+{
+    GLenum format = channel_format(request.channels);
+    glBindTexture(GL_TEXTURE_2D, request.texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 1000);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    size_t gpu_bytes = GLRegistry::texture_bytes(format, request.width, request.height, 1, true);
+    GLRegistry::instance().set_bytes(GLObjectType::TEXTURE, request.texture, gpu_bytes);
+    TextureLoadStats::instance().record(TextureFileType::IMAGE, request.milliseconds, gpu_bytes);
+    stats.completed++;
+    printf("Texture loaded (streamed): %s\n", request.path.c_str());
+}
+
+void TextureUploadQueue::retire_finished()
+{
+    for (auto it = requests.begin(); it != requests.end();)
+    {
+        Request &request = **it;
+        // 失败或取消的请求要等已经暂存的段都处理完，槽里不能留下悬空指针
+        bool stopped = request.failed || request.cancelled;
+        bool done = request.decoded.load(std::memory_order_acquire) &&
+                    (stopped ? request.uploaded_rows == request.staged_rows : request.uploaded_rows == request.height);
+        if (!done)
+        {
+            ++it;
+            continue;
+        }
+        if (request.failed && !request.cancelled)
+            printf("ERROR::TEXTURE_UPLOAD:: failed to load %s\n", request.path.c_str());
+        stbi_image_free(request.pixels);
+        it = requests.erase(it);
+    }
+}
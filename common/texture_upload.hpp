@@ -0,0 +1,102 @@
+#ifndef TEXTURE_UPLOAD_HPP
+#define TEXTURE_UPLOAD_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include "job_system.hpp"
+
+/**
+ * @brief 流式纹理上传队列。
+ *        load() 立即返回纹理名（先是 1x1 灰色占位），stb_image 解码放在工作线程；
+ *        update() 每帧在 GL 线程上把解码好的图像按行分段：映射一个孤立化（INVALIDATE_BUFFER）的 PIXEL_UNPACK 缓冲，
+ *        由工作线程把这一段拷进去，下一帧解除映射后从缓冲 glTexSubImage2D，整个过程 GL 线程不碰像素数据。
+ *        每帧提交的字节数不超过 frame_budget（至少一段），大纹理分几帧传完，不会卡帧。
+ *        上传期间纹理的 BASE_LEVEL / MAX_LEVEL 指向最小一级的 1x1 灰色，第 0 层传完后恢复并 glGenerateMipmap。
+ *        已经用 texcook 压缩过的纹理（同名 .ktx2 / .dds）直接同步加载。
+ *        纹理归调用者所有，上传完成前删除纹理要先 cancel()：纹理名删除后可能被新纹理复用，队列无法自己判断。
+ *        所有函数只能在 GL 线程调用。
+ */
+class TextureUploadQueue
+{
+public:
+    struct Stats
+    {
+        size_t completed = 0;      // 已完成的纹理数
+        size_t total_bytes = 0;    // 经过 PBO 上传的总字节数
+        size_t frame_bytes = 0;    // 上一次 update() 提交的字节数
+        double frame_ms = 0.0;     // 上一次 update() 在 GL 线程上的耗时
+        double max_frame_ms = 0.0; // 所有 update() 中最长的一次
+    };
+
+    // frame_budget 为每帧 glTexSubImage2D 的字节上限；每个暂存缓冲为预算的一半，ring_size 个缓冲轮流使用
+    explicit TextureUploadQueue(JobSystem &jobs, size_t frame_budget = 8 << 20, int ring_size = 4);
+    ~TextureUploadQueue();
+
+    TextureUploadQueue(const TextureUploadQueue &) = delete;
+    TextureUploadQueue &operator=(const TextureUploadQueue &) = delete;
+
+    // 失败（文件不存在等）时纹理保持占位，并打印错误
+    GLuint load(const std::string &path);
+
+    // 每帧调用一次，不阻塞
+    void update();
+    // 忽略预算，等待所有纹理解码并上传完成
+    void flush();
+    // 放弃 texture 尚未完成的上传，之后不再访问这个纹理名；调用者删除 load() 返回的纹理前调用，不在队列中时什么也不做
+    void cancel(GLuint texture);
+
+    size_t get_pending() const { return requests.size(); }
+    const Stats &get_stats() const { return stats; }
+
+private:
+    struct Request
+    {
+        std::string path;
+        GLuint texture = 0;
+        // 以下由解码任务写入，decoded 置位后 GL 线程才读取
+        unsigned char *pixels = nullptr;
+        int width = 0, height = 0, channels = 0;
+        bool failed = false;
+        bool cancelled = false; // cancel() 之后只等解码任务和已暂存的拷贝结束，不再碰纹理
+        std::atomic<bool> decoded{false};
+
+        int staged_rows = 0;   // 已经分配到暂存缓冲的行数
+        int uploaded_rows = 0; // 已经 glTexSubImage2D 的行数
+        double milliseconds = 0.0;
+
+        size_t row_bytes() const { return size_t(width) * channels; }
+    };
+
+    struct Slot
+    {
+        GLuint buffer = 0;
+        size_t capacity = 0;
+        GLsync fence = nullptr; // 上一次从这个缓冲上传的命令
+        JobCounter copy;        // 工作线程往映射内存里拷贝
+        Request *request = nullptr;
+        int first_row = 0, rows = 0;
+    };
+
+    JobSystem &jobs;
+    size_t frame_budget;
+    size_t slot_bytes;
+    std::vector<Slot> slots;
+    int oldest = 0; // 最早暂存、尚未上传的槽
+    int staged = 0;
+    std::deque<std::unique_ptr<Request>> requests;
+    JobCounter decode_counter;
+    Stats stats;
+
+    bool stage(bool wait);
+    void upload_oldest();
+    void begin_texture(Request &request);
+    void finish_texture(Request &request);
+    void retire_finished();
+};
+
+#endif // TEXTURE_UPLOAD_HPP
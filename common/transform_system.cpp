@@ -0,0 +1,201 @@
+#include "transform_system.hpp"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define TRANSFORM_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace
+{
+    // 列主序 4x4 乘法：out 的第 j 列 = a * b 的第 j 列
+    inline void multiply_mat4(const glm::mat4 &a, const glm::mat4 &b, glm::mat4 &out)
+    {
+#ifdef TRANSFORM_USE_SSE
+        const float *pa = &a[0][0];
+        const float *pb = &b[0][0];
+        float *po = &out[0][0];
+        __m128 a0 = _mm_loadu_ps(pa);
+        __m128 a1 = _mm_loadu_ps(pa + 4);
+        __m128 a2 = _mm_loadu_ps(pa + 8);
+        __m128 a3 = _mm_loadu_ps(pa + 12);
+        for (int j = 0; j < 4; j++)
+        {
+            __m128 r = _mm_mul_ps(a0, _mm_set1_ps(pb[4 * j + 0]));
+            r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_set1_ps(pb[4 * j + 1])));
+            r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_set1_ps(pb[4 * j + 2])));
+            r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_set1_ps(pb[4 * j + 3])));
+            _mm_storeu_ps(po + 4 * j, r);
+        }
+#else
+        out = a * b;
+#endif
+    }
+
+#ifdef TRANSFORM_USE_SSE
+    inline __m128 cross_sse(__m128 a, __m128 b)
+    {
+        __m128 a_yzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+        __m128 b_yzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+        __m128 c = _mm_sub_ps(_mm_mul_ps(a, b_yzx), _mm_mul_ps(a_yzx, b));
+        return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+    }
+#endif
+
+    // transpose(inverse(m3)) = 余子式矩阵 / det，列分别为 m1×m2, m2×m0, m0×m1
+    inline void normal_matrix(const glm::mat4 &m, glm::mat3 &out)
+    {
+#ifdef TRANSFORM_USE_SSE
+        const float *p = &m[0][0];
+        __m128 m0 = _mm_loadu_ps(p);
+        __m128 m1 = _mm_loadu_ps(p + 4);
+        __m128 m2 = _mm_loadu_ps(p + 8);
+        __m128 c0 = cross_sse(m1, m2);
+        __m128 c1 = cross_sse(m2, m0);
+        __m128 c2 = cross_sse(m0, m1);
+        float result[12];
+        _mm_storeu_ps(result, c0);
+        _mm_storeu_ps(result + 4, c1);
+        _mm_storeu_ps(result + 8, c2);
+        float det = p[0] * result[0] + p[1] * result[1] + p[2] * result[2];
+        float inv_det = det != 0.0f ? 1.0f / det : 0.0f;
+        for (int col = 0; col < 3; col++)
+            for (int row = 0; row < 3; row++)
+                out[col][row] = result[4 * col + row] * inv_det;
+#else
+        glm::vec3 m0(m[0]), m1(m[1]), m2(m[2]);
+        glm::vec3 c0 = glm::cross(m1, m2), c1 = glm::cross(m2, m0), c2 = glm::cross(m0, m1);
+        float det = glm::dot(m0, c0);
+        out = glm::mat3(c0, c1, c2) * (det != 0.0f ? 1.0f / det : 0.0f);
+#endif
+    }
+}
+
+uint32_t TransformSystem::create(uint32_t parent, const glm::mat4 &local)
+{
+    uint32_t node = static_cast<uint32_t>(parents.size());
+    uint32_t depth = parent == INVALID_NODE ? 0 : depths[parent] + 1;
+    parents.push_back(parent);
+    depths.push_back(depth);
+    locals.push_back(local);
+    worlds.push_back(local);
+    normal_matrices.push_back(glm::mat3(1.0f));
+    dirty.push_back(1);
+    changed.push_back(0);
+    if (levels.size() <= depth)
+        levels.resize(depth + 1);
+    levels[depth].push_back(node);
+    any_dirty = true;
+    return node;
+}
+
+void TransformSystem::set_local(uint32_t node, const glm::mat4 &local)
+{
+    locals[node] = local;
+    dirty[node] = 1;
+    any_dirty = true;
+}
+
+void TransformSystem::clear()
+{
+    parents.clear();
+    depths.clear();
+    locals.clear();
+    worlds.clear();
+    normal_matrices.clear();
+    dirty.clear();
+    changed.clear();
+    levels.clear();
+    any_dirty = false;
+    last_update_count = 0;
+}
+
+bool TransformSystem::begin_update()
+{
+    last_update_count = 0;
+    if (!any_dirty)
+        return false;
+    std::fill(changed.begin(), changed.end(), 0);
+    return true;
+}
+
+void TransformSystem::update_worlds(size_t level, size_t begin, size_t end)
+{
+    const std::vector<uint32_t> &nodes = levels[level];
+    for (size_t i = begin; i < end; i++)
+    {
+        uint32_t node = nodes[i];
+        uint32_t parent = parents[node];
+        bool parent_changed = parent != INVALID_NODE && changed[parent];
+        if (!dirty[node] && !parent_changed)
+            continue;
+        if (parent == INVALID_NODE)
+            worlds[node] = locals[node];
+        else
+            multiply_mat4(worlds[parent], locals[node], worlds[node]);
+        dirty[node] = 0;
+        changed[node] = 1;
+    }
+}
+
+void TransformSystem::update_level_range(size_t level, size_t begin, size_t end)
+{
+    update_worlds(level, begin, end);
+    const std::vector<uint32_t> &nodes = levels[level];
+    for (size_t i = begin; i < end; i++)
+    {
+        uint32_t node = nodes[i];
+        if (changed[node])
+            normal_matrix(worlds[node], normal_matrices[node]);
+    }
+}
+
+void TransformSystem::update_normal_matrices()
+{
+    // 按节点编号找出连续的 changed 区间，每段一次批量计算；全部节点都变化时就是整个 SoA 数组一次算完
+    size_t count = changed.size();
+    size_t i = 0;
+    while (i < count)
+    {
+        if (!changed[i])
+        {
+            i++;
+            continue;
+        }
+        size_t end = i + 1;
+        while (end < count && changed[end])
+            end++;
+        normal_matrix_batch(&worlds[i], &normal_matrices[i], end - i);
+        i = end;
+    }
+}
+
+void TransformSystem::end_update()
+{
+    last_update_count = static_cast<size_t>(std::count(changed.begin(), changed.end(), 1));
+    any_dirty = false;
+}
+
+void TransformSystem::update()
+{
+    if (!begin_update())
+        return;
+    // 世界矩阵必须按层算（子节点依赖父节点），法线矩阵互不依赖，放到最后按连续数组批量算
+    for (size_t level = 0; level < levels.size(); level++)
+        update_worlds(level, 0, levels[level].size());
+    update_normal_matrices();
+    end_update();
+}
+
+void TransformSystem::multiply_batch(const glm::mat4 *parent, const glm::mat4 *local, glm::mat4 *out, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        multiply_mat4(parent[i], local[i], out[i]);
+}
+
+void TransformSystem::normal_matrix_batch(const glm::mat4 *world, glm::mat3 *out, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        normal_matrix(world[i], out[i]);
+}
@@ -0,0 +1,67 @@
+#ifndef TRANSFORM_SYSTEM_HPP
+#define TRANSFORM_SYSTEM_HPP
+
+#include <cstdint>
+#include <vector>
+#include "glm/glm.hpp"
+
+/**
+ * @brief 父子层级变换系统。
+ *        局部矩阵、世界矩阵、法线矩阵按 SoA 分别连续存放；修改局部矩阵只标记 dirty，
+ *        update() 按层级批量重算被修改节点及其子树，矩阵乘法和法线矩阵使用 SSE。
+ *        约束：父节点必须先于子节点创建（下标更小），这样按层遍历即可保证父节点先算完。
+ */
+class TransformSystem
+{
+public:
+    static constexpr uint32_t INVALID_NODE = 0xffffffffu;
+
+    // 创建节点，返回节点编号
+    uint32_t create(uint32_t parent = INVALID_NODE, const glm::mat4 &local = glm::mat4(1.0f));
+
+    void set_local(uint32_t node, const glm::mat4 &local);
+    const glm::mat4 &get_local(uint32_t node) const { return locals[node]; }
+    const glm::mat4 &get_world(uint32_t node) const { return worlds[node]; }
+    const glm::mat3 &get_normal_matrix(uint32_t node) const { return normal_matrices[node]; }
+    uint32_t get_parent(uint32_t node) const { return parents[node]; }
+
+    // 重新计算所有 dirty 节点及其子树的世界矩阵和法线矩阵
+    void update();
+
+    void clear();
+    size_t size() const { return parents.size(); }
+    size_t get_level_count() const { return levels.size(); }
+    const std::vector<uint32_t> &get_level(size_t level) const { return levels[level]; }
+    // 最近一次 update 实际重算的节点数
+    size_t get_last_update_count() const { return last_update_count; }
+
+    // 批量计算 out[i] = parent[i] * local[i]，可被外部（如并行任务）直接调用
+    static void multiply_batch(const glm::mat4 *parent, const glm::mat4 *local, glm::mat4 *out, size_t count);
+    // 批量计算法线矩阵 transpose(inverse(mat3(world)))
+    static void normal_matrix_batch(const glm::mat4 *world, glm::mat3 *out, size_t count);
+
+    // 只更新某一层中给定范围的节点，供多线程按层分块调用；调用方需保证上一层已完成
+    void update_level_range(size_t level, size_t begin, size_t end);
+    // 多线程更新前后的准备/收尾，update() 内部即为 begin_update + 逐层 update_level_range + end_update
+    bool begin_update();
+    void end_update();
+
+private:
+    // 只重算世界矩阵，标记 changed
+    void update_worlds(size_t level, size_t begin, size_t end);
+    // 对所有 changed 节点批量计算法线矩阵
+    void update_normal_matrices();
+
+    std::vector<uint32_t> parents;
+    std::vector<uint32_t> depths;
+    std::vector<glm::mat4> locals;
+    std::vector<glm::mat4> worlds;
+    std::vector<glm::mat3> normal_matrices;
+    std::vector<uint8_t> dirty;   // 局部矩阵被修改
+    std::vector<uint8_t> changed; // 本次 update 中世界矩阵发生了变化
+    std::vector<std::vector<uint32_t>> levels;
+    bool any_dirty = false;
+    size_t last_update_count = 0;
+};
+
+#endif // TRANSFORM_SYSTEM_HPP
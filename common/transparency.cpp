@@ -0,0 +1,184 @@
+#include "transparency.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include "gl_registry.hpp"
+#include "render_stats.hpp"
+
+namespace
+{
+    // 从远到近的排序键：浮点数的位翻转成按无符号整数比较的顺序，再整体取反，距离越大键越小
+    uint32_t back_to_front_key(float distance)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &distance, sizeof(bits));
+        bits = (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+        return ~bits;
+    }
+}
+
+void TransparentSorter::reserve(size_t count)
+{
+    items.reserve(count);
+    scratch.reserve(count);
+    order.reserve(count);
+}
+
+void TransparentSorter::add(uint32_t object, float distance)
+{
+    items.push_back((uint64_t(back_to_front_key(distance)) << 32) | object);
+}
+
+const std::vector<uint32_t> &TransparentSorter::sort_back_to_front()
+{
+    size_t count = items.size();
+    order.resize(count);
+    // 数量很少时直方图的固定开销（4 x 256）比排序本身还大，改用插入排序（同样稳定）
+    if (count <= SMALL_SORT_COUNT)
+    {
+        for (size_t i = 1; i < count; i++)
+        {
+            uint64_t item = items[i];
+            size_t j = i;
+            for (; j > 0 && (items[j - 1] >> 32) > (item >> 32); j--)
+                items[j] = items[j - 1];
+            items[j] = item;
+        }
+        for (size_t i = 0; i < count; i++)
+            order[i] = uint32_t(items[i]);
+        return order;
+    }
+
+    // 一次扫描统计键的 4 个字节
+    size_t histograms[4][256] = {};
+    for (uint64_t item : items)
+    {
+        uint32_t key = uint32_t(item >> 32);
+        for (int pass = 0; pass < 4; pass++)
+            histograms[pass][(key >> (pass * 8)) & 0xff]++;
+    }
+
+    scratch.resize(count);
+    uint64_t *source = items.data(), *target = scratch.data();
+    for (int pass = 0; pass < 4; pass++)
+    {
+        size_t *histogram = histograms[pass];
+        int shift = 32 + pass * 8;
+        // 这个字节全部相同，本趟不改变顺序
+        if (histogram[(source[0] >> shift) & 0xff] == count)
+            continue;
+        size_t offset = 0;
+        for (int digit = 0; digit < 256; digit++)
+        {
+            size_t digit_count = histogram[digit];
+            histogram[digit] = offset;
+            offset += digit_count;
+        }
+        for (size_t i = 0; i < count; i++)
+            target[histogram[(source[i] >> shift) & 0xff]++] = source[i];
+        std::swap(source, target);
+    }
+
+    for (size_t i = 0; i < count; i++)
+        order[i] = uint32_t(source[i]);
+    return order;
+}
+
+WeightedBlendedOIT::WeightedBlendedOIT(const std::string &vertex_shader, const std::string &fragment_shader)
+    : composite_shader(vertex_shader, fragment_shader)
+{
+    empty_vao.reset(GL_CREATE(VERTEX_ARRAY, "oit composite"));
+    composite_shader.use();
+    composite_shader.setInt("accumulationTexture", 0);
+    composite_shader.setInt("weightTexture", 1);
+}
+
+void WeightedBlendedOIT::resize(int width, int height)
+{
+    this->width = width;
+    this->height = height;
+    GLRegistry &registry = GLRegistry::instance();
+
+    accumulation.reset(GL_CREATE(TEXTURE, "oit accumulation"));
+    glBindTexture(GL_TEXTURE_2D, accumulation.get());
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA, GL_HALF_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    registry.set_bytes(GLObjectType::TEXTURE, accumulation.get(), GLRegistry::texture_bytes(GL_RGBA16F, width, height));
+
+    weight.reset(GL_CREATE(TEXTURE, "oit weight"));
+    glBindTexture(GL_TEXTURE_2D, weight.get());
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R16F, width, height, 0, GL_RED, GL_HALF_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    registry.set_bytes(GLObjectType::TEXTURE, weight.get(), GLRegistry::texture_bytes(GL_R16F, width, height));
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    depth.reset(GL_CREATE(RENDERBUFFER, "oit depth"));
+    glBindRenderbuffer(GL_RENDERBUFFER, depth.get());
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    registry.set_bytes(GLObjectType::RENDERBUFFER, depth.get(), GLRegistry::texture_bytes(GL_DEPTH24_STENCIL8, width, height));
+
+    framebuffer.reset(GL_CREATE(FRAMEBUFFER, "oit accumulation"));
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer.get());
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, accumulation.get(), 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, weight.get(), 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth.get());
+    const GLenum draw_buffers[] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+    glDrawBuffers(2, draw_buffers);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        printf("ERROR::TRANSPARENCY:: OIT framebuffer is incomplete\n");
+}
+
+void WeightedBlendedOIT::begin_accumulation(GLuint scene_framebuffer, int width, int height)
+{
+    if (width != this->width || height != this->height || !framebuffer)
+        resize(width, height);
+
+    // 不透明物体的深度
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, scene_framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer.get());
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer.get());
+
+    const GLfloat clear_accumulation[] = {0.0f, 0.0f, 0.0f, 1.0f};
+    const GLfloat clear_weight[] = {0.0f, 0.0f, 0.0f, 0.0f};
+    glClearBufferfv(GL_COLOR, 0, clear_accumulation);
+    glClearBufferfv(GL_COLOR, 1, clear_weight);
+
+    glEnable(GL_DEPTH_TEST);
+    glDepthMask(GL_FALSE);
+    glEnable(GL_BLEND);
+    glBlendFuncSeparate(GL_ONE, GL_ONE, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+void WeightedBlendedOIT::composite(GLuint scene_framebuffer)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, scene_framebuffer);
+    glDepthMask(GL_TRUE);
+    glDisable(GL_DEPTH_TEST);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    composite_shader.use();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, accumulation.get());
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, weight.get());
+    glActiveTexture(GL_TEXTURE0);
+    count_texture_bind();
+    count_texture_bind();
+
+    glBindVertexArray(empty_vao.get());
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    count_vertex_array_bind();
+    count_draw(GL_TRIANGLES, 3);
+    glBindVertexArray(0);
+
+    glEnable(GL_DEPTH_TEST);
+}
+
+size_t WeightedBlendedOIT::get_memory_bytes() const
+{
+    return GLRegistry::texture_bytes(GL_RGBA16F, width, height) + GLRegistry::texture_bytes(GL_R16F, width, height) +
+           GLRegistry::texture_bytes(GL_DEPTH24_STENCIL8, width, height);
+}
@@ -0,0 +1,79 @@
+#ifndef TRANSPARENCY_HPP
+#define TRANSPARENCY_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include "gl_handle.hpp"
+#include "shader.hpp"
+
+enum class TransparencyMode
+{
+    WEIGHTED_OIT, // 加权混合顺序无关透明：单个通道、不排序，重叠多时是近似结果
+    SORTED,       // 从远到近排序后逐个 alpha 混合，结果精确
+};
+
+/**
+ * @brief 透明物体从远到近排序。每帧 clear 后逐个 add(物体编号, 到相机的距离)，sort_back_to_front 返回绘制顺序。
+ *        距离转换成可以按无符号整数比较的 32 位键，和物体编号一起做 4 趟 8 位 LSD 基数排序，O(n)；
+ *        所有字节都相同的一趟直接跳过，几十个以内用插入排序。排序是稳定的，距离相同的物体按提交顺序绘制，不会像 std::map 那样丢掉。
+ *        缓冲在帧之间复用，数量不超过历史最大值时不分配内存。
+ */
+class TransparentSorter
+{
+public:
+    void reserve(size_t count);
+    void clear() { items.clear(); }
+    void add(uint32_t object, float distance);
+    size_t size() const { return items.size(); }
+
+    // 按距离从远到近排列的物体编号
+    const std::vector<uint32_t> &sort_back_to_front();
+
+private:
+    static constexpr size_t SMALL_SORT_COUNT = 64;
+
+    std::vector<uint64_t> items;   // 高 32 位为排序键，低 32 位为物体编号
+    std::vector<uint64_t> scratch; // 基数排序的另一半缓冲
+    std::vector<uint32_t> order;
+};
+
+/**
+ * @brief 加权混合顺序无关透明（McGuire & Bavoil 2013）。
+ *        begin_accumulation 把场景帧缓冲的深度拷进自己的 FBO（只做深度测试，不写深度），透明物体用累积着色器画进两个目标，
+ *        composite 把加权平均的颜色按总透明度混合回场景帧缓冲。透明物体以任意顺序、一次绘制调用就能画完。
+ *        GL 3.3 没有逐目标的混合函数（glBlendFunci），所以所有目标共用
+ *        glBlendFuncSeparate(GL_ONE, GL_ONE, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA)：
+ *          location 0（RGBA16F，清为 (0, 0, 0, 1)）：rgb 累加 C * a * w，alpha 连乘 (1 - a) 得到透过率
+ *          location 1（R16F，清为 0）：累加 a * w
+ *        累积着色器输出 location 0 = vec4(color.rgb * w, color.a)，location 1 = vec4(w)，
+ *        w = color.a * 深度权重（写法见 source/shader/class13/window_oit.fs）。
+ *        场景帧缓冲的深度格式要与内部深度缓冲一致（GL_DEPTH24_STENCIL8，即 RenderContext 的默认格式），否则无法拷贝。
+ */
+class WeightedBlendedOIT
+{
+public:
+    explicit WeightedBlendedOIT(const std::string &vertex_shader = "source/shader/transparency/composite.vs",
+                                const std::string &fragment_shader = "source/shader/transparency/composite.fs");
+
+    // 尺寸变化时重建累积缓冲；绑定累积 FBO，拷贝深度并清空，设置混合和深度状态
+    void begin_accumulation(GLuint scene_framebuffer, int width, int height);
+    // 恢复深度写入和混合函数，把结果合成到 scene_framebuffer（保持绑定）
+    void composite(GLuint scene_framebuffer);
+
+    size_t get_memory_bytes() const;
+
+private:
+    void resize(int width, int height);
+
+    Shader composite_shader;
+    VertexArrayHandle empty_vao; // 全屏三角形由 gl_VertexID 生成，核心模式下仍需绑定一个 VAO
+    FramebufferHandle framebuffer;
+    TextureHandle accumulation;
+    TextureHandle weight;
+    RenderbufferHandle depth;
+    int width = 0, height = 0;
+};
+
+#endif // TRANSPARENCY_HPP
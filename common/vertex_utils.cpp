@@ -0,0 +1,49 @@
+#include "vertex_utils.hpp"
+#include <cmath>
+
+void generate_normals(std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices)
+{
+    std::vector<glm::vec3> sums(vertices.size(), glm::vec3(0.0f));
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        unsigned int a = indices[i], b = indices[i + 1], c = indices[i + 2];
+        glm::vec3 normal = glm::cross(vertices[b].Position - vertices[a].Position, vertices[c].Position - vertices[a].Position);
+        for (unsigned int index : {a, b, c})
+            sums[index] += normal;
+    }
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        float length = glm::length(sums[i]);
+        vertices[i].Normal = length > 0.0f ? sums[i] / length : glm::vec3(0.0f, 1.0f, 0.0f);
+    }
+}
+
+void generate_tangents(std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices)
+{
+    std::vector<glm::vec3> tangents(vertices.size(), glm::vec3(0.0f)), bitangents(vertices.size(), glm::vec3(0.0f));
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        unsigned int a = indices[i], b = indices[i + 1], c = indices[i + 2];
+        glm::vec3 e1 = vertices[b].Position - vertices[a].Position, e2 = vertices[c].Position - vertices[a].Position;
+        glm::vec2 d1 = vertices[b].TexCoords - vertices[a].TexCoords, d2 = vertices[c].TexCoords - vertices[a].TexCoords;
+        float determinant = d1.x * d2.y - d2.x * d1.y;
+        if (std::abs(determinant) < 1e-12f)
+            continue;
+        float inverse = 1.0f / determinant;
+        glm::vec3 tangent = (e1 * d2.y - e2 * d1.y) * inverse;
+        glm::vec3 bitangent = (e2 * d1.x - e1 * d2.x) * inverse;
+        for (unsigned int index : {a, b, c})
+        {
+            tangents[index] += tangent;
+            bitangents[index] += bitangent;
+        }
+    }
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        const glm::vec3 &n = vertices[i].Normal;
+        glm::vec3 t = tangents[i] - n * glm::dot(n, tangents[i]);
+        glm::vec3 b = bitangents[i] - n * glm::dot(n, bitangents[i]);
+        vertices[i].Tangent = glm::length(t) > 0.0f ? glm::normalize(t) : glm::vec3(0.0f);
+        vertices[i].Bitangent = glm::length(b) > 0.0f ? glm::normalize(b) : glm::vec3(0.0f);
+    }
+}
@@ -0,0 +1,13 @@
+#ifndef VERTEX_UTILS_HPP
+#define VERTEX_UTILS_HPP
+
+#include <vector>
+#include "mesh.hpp"
+
+// 相邻三角形的法线按面积加权累加，得到每个顶点的平滑法线；只看索引，位置相同但下标不同的顶点不合并
+void generate_normals(std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices);
+
+// 由位置和纹理坐标累加每个顶点的切线 / 副切线，再对法线做 Gram-Schmidt 正交化；退化的纹理坐标不计入
+void generate_tangents(std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices);
+
+#endif // VERTEX_UTILS_HPP
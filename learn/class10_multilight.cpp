@@ -14,6 +14,7 @@
 #include "assimp/scene.h"
 #include "assimp/postprocess.h"
 #include "sphere.hpp"
+#include "gl_handle.hpp"
 
 const unsigned int WINDOW_WIDTH = 1080;
 const unsigned int WINDOW_HEIGHT = 720;
@@ -254,6 +255,7 @@ int main()
         glBindVertexArray(0);
 
         glfwSwapBuffers(window);
+        GLDeletionQueue::instance().end_frame(); // 释放 GPU 已经用完的延迟删除对象
         glfwPollEvents();
     }
     glDisableVertexAttribArray(0); // 禁用顶点属性数组
@@ -261,6 +263,7 @@ int main()
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
 
+    GLDeletionQueue::instance().flush();
     glfwTerminate();
     return 0;
 }
\ No newline at end of file
@@ -10,6 +10,7 @@
 #include "camera_control.hpp"
 #include "sphere.hpp"
 #include "model.hpp"
+#include "gl_handle.hpp"
 
 const unsigned int WINDOW_WIDTH = 1080;
 const unsigned int WINDOW_HEIGHT = 720;
@@ -112,7 +113,6 @@ int main()
         M = glm::translate(M, glm::vec3(0.f, 0.f, 0.f));
         M = glm::rotate(M, glm::radians(0.0f), glm::vec3(1.0f, 0.0f, 0.0f));
         M = glm::scale(M, glm::vec3(1.f, 1.f, 1.f));
-        shader.setMat4("M", M);
         shader.setMat4("V", V);
         shader.setMat4("P", P);
         shader.setVec3("CameraPosition_worldspace", camera.get_camerapos());
@@ -123,7 +123,7 @@ int main()
         shader.setFloat("pointlight.constant", 1.0f);
         shader.setFloat("pointlight.linear", 0.09);
         shader.setFloat("pointlight.quadratic", 0.032);
-        model.Draw(shader);
+        model.Draw(shader, M, "M");
 
         // 绘制camera球体
         shader_c.use();
@@ -137,6 +137,7 @@ int main()
         glBindVertexArray(0);
 
         glfwSwapBuffers(window);
+        GLDeletionQueue::instance().end_frame(); // 释放 GPU 已经用完的延迟删除对象
         glfwPollEvents();
     }
     glDisableVertexAttribArray(0); // 禁用顶点属性数组
@@ -144,6 +145,7 @@ int main()
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
 
+    GLDeletionQueue::instance().flush();
     glfwTerminate();
     return 0;
 }
\ No newline at end of file
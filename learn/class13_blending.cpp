@@ -7,32 +7,75 @@
 
 #include "shader.hpp"
 #include "camera_control.hpp"
-#include "model.hpp"
+#include "render_context.hpp"
+#include "asset_archive.hpp"
 #include "load_texture.hpp"
+#include "gl_handle.hpp"
+#include "profiler.hpp"
+#include "render_stats.hpp"
+#include "transparency.hpp"
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <vector>
 
 // settings
 const unsigned int WINDOW_WIDTH = 1080;
 const unsigned int WINDOW_HEIGHT = 720;
 
-int main()
+// 创建 VAO/VBO：位置(3) + 纹理坐标(2)
+static void setup_vertex_array(VertexArrayHandle &vao, BufferHandle &vbo, const float *vertices, size_t size, const char *label)
 {
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    vao.reset(GL_CREATE(VERTEX_ARRAY, label));
+    vbo.reset(GL_CREATE(BUFFER, label));
+    glBindVertexArray(vao.get());
+    glBindBuffer(GL_ARRAY_BUFFER, vbo.get());
+    glBufferData(GL_ARRAY_BUFFER, size, vertices, GL_STATIC_DRAW);
+    GLRegistry::instance().set_bytes(GLObjectType::BUFFER, vbo.get(), size);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)(3 * sizeof(float)));
+}
 
-    GLFWwindow *window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "CLASSs 13", NULL, NULL);
-    glfwMakeContextCurrent(window);
+int main(int argc, char **argv)
+{
+    // --transparency=oit|sorted：透明窗户的画法，运行中按 T 切换
+    // --windows=<数量>：在原来 5 扇窗户之外，再在地板上方铺满这么多扇，用于测试大量透明物体
+    TransparencyMode mode = TransparencyMode::WEIGHTED_OIT;
+    size_t extra_windows = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--transparency=sorted") == 0)
+            mode = TransparencyMode::SORTED;
+        else if (std::strcmp(argv[i], "--transparency=oit") == 0)
+            mode = TransparencyMode::WEIGHTED_OIT;
+        else if (std::strncmp(argv[i], "--windows=", 10) == 0)
+            extra_windows = static_cast<size_t>(std::max(0, std::atoi(argv[i] + 10)));
+    }
 
-    gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
+    // --archive=<资源包>：资源先从 asset_pack 打出的包里读
+    AssetArchive::instance().parse_command_line(argc, argv);
 
-    glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+    RenderContextDesc desc;
+    desc.width = WINDOW_WIDTH;
+    desc.height = WINDOW_HEIGHT;
+    desc.title = "CLASSs 13";
+    desc.parse_command_line(argc, argv);
+    std::unique_ptr<RenderContext> context = RenderContext::create(desc);
+    if (!context)
+        return -1;
 
     // build and compile shaders
     // -------------------------
-    Shader shader("shaderprogram/class13_vertexshader", "shaderprogram/class13_fragmentshader");
+    Shader shader("source/shader/class13/class13_vertexshader", "source/shader/class13/class13_fragmentshader");
+    // 窗户按实例绘制，所有窗户一次绘制调用；排序模式按顺序直接混合，OIT 模式输出到累积缓冲
+    Shader window_shader("source/shader/class13/window.vs", "source/shader/class13/window.fs");
+    Shader window_oit_shader("source/shader/class13/window.vs", "source/shader/class13/window_oit.fs");
+    WeightedBlendedOIT oit;
+    TransparentSorter sorter;
 
     // set up vertex data (and buffer(s)) and configure vertex attributes
     // ------------------------------------------------------------------
@@ -97,73 +140,77 @@ int main()
         0.0f, 0.5f, 0.0f, 0.0f, 0.0f,
         1.0f, -0.5f, 0.0f, 1.0f, 1.0f,
         1.0f, 0.5f, 0.0f, 1.0f, 0.0f};
-    // cube VAO
-    unsigned int cubeVAO, cubeVBO;
-    glGenVertexArrays(1, &cubeVAO);
-    glGenBuffers(1, &cubeVBO);
-    glBindVertexArray(cubeVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), &cubeVertices, GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)0);
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)(3 * sizeof(float)));
-    // plane VAO
-    unsigned int planeVAO, planeVBO;
-    glGenVertexArrays(1, &planeVAO);
-    glGenBuffers(1, &planeVBO);
-    glBindVertexArray(planeVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, planeVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(planeVertices), &planeVertices, GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)0);
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)(3 * sizeof(float)));
-    // transparent VAO
-    unsigned int transparentVAO, transparentVBO;
-    glGenVertexArrays(1, &transparentVAO);
-    glGenBuffers(1, &transparentVBO);
-    glBindVertexArray(transparentVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, transparentVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(transparentVertices), transparentVertices, GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)0);
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)(3 * sizeof(float)));
-    glBindVertexArray(0);
+    // cube / plane / window VAO
+    VertexArrayHandle cubeVAO, planeVAO, transparentVAO;
+    BufferHandle cubeVBO, planeVBO, transparentVBO;
+    setup_vertex_array(cubeVAO, cubeVBO, cubeVertices, sizeof(cubeVertices), "class13 cube");
+    setup_vertex_array(planeVAO, planeVBO, planeVertices, sizeof(planeVertices), "class13 plane");
+    setup_vertex_array(transparentVAO, transparentVBO, transparentVertices, sizeof(transparentVertices), "class13 window");
 
     // load textures
     // -------------
-    unsigned int cubeTexture = load_texture("./image/marble.png");
-    unsigned int floorTexture = load_texture("./image/background.bmp");
-    unsigned int transparentTexture = load_texture("./image/blending_transparent_window.png");
+    TextureHandle cubeTexture(load_texture("source/texture/TEXTURE/container.png"));
+    TextureHandle floorTexture(load_texture("source/texture/TEXTURE/container.png"));
+    TextureHandle transparentTexture(load_texture("source/texture/TEXTURE/blending_transparent_window.png"));
 
     // transparent window locations
     // --------------------------------
-    vector<glm::vec3> windows{
+    std::vector<glm::vec3> windows{
         glm::vec3(-1.5f, 0.0f, -0.48f),
         glm::vec3(1.5f, 0.0f, 0.51f),
         glm::vec3(0.0f, 0.0f, 0.7f),
         glm::vec3(-0.3f, 0.0f, -2.3f),
         glm::vec3(0.5f, 0.0f, -0.6f)};
+    // 额外的窗户在地板范围内按网格排列，层层交错，相机从任何方向看都有大量重叠
+    size_t grid = 1;
+    while (grid * grid < extra_windows)
+        grid++;
+    for (size_t i = 0; i < extra_windows; i++)
+    {
+        float u = (i % grid + 0.5f) / grid, v = (i / grid + 0.5f) / grid;
+        windows.push_back(glm::vec3(-5.0f + 9.0f * u, 0.5f * ((i * 7) % 5) / 5.0f, -5.0f + 10.0f * v));
+    }
+
+    // 每扇窗户的偏移是一个实例属性（location 2），每帧按绘制顺序写入
+    std::vector<glm::vec3> window_offsets;
+    window_offsets.reserve(windows.size());
+    sorter.reserve(windows.size());
+    BufferHandle windowInstanceVBO(GL_CREATE(BUFFER, "class13 window offsets"));
+    glBindVertexArray(transparentVAO.get());
+    glBindBuffer(GL_ARRAY_BUFFER, windowInstanceVBO.get());
+    glBufferData(GL_ARRAY_BUFFER, windows.size() * sizeof(glm::vec3), windows.data(), GL_DYNAMIC_DRAW);
+    GLRegistry::instance().set_bytes(GLObjectType::BUFFER, windowInstanceVBO.get(), windows.size() * sizeof(glm::vec3));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void *)0);
+    glVertexAttribDivisor(2, 1);
+    glBindVertexArray(0);
+    bool offsets_sorted = false; // 实例缓冲当前是否为排序后的顺序（OIT 只需要原始顺序，不必每帧上传）
 
     // shader configuration
     // --------------------
     shader.use();
     shader.setInt("texture1", 0);
+    window_shader.use();
+    window_shader.setInt("texture1", 0);
+    window_oit_shader.use();
+    window_oit_shader.setInt("texture1", 0);
 
-    Camera camera(window, 45.0f, glm::vec3(0., 0., 10.));
+    Camera camera(45.0f, glm::vec3(0., 0., 10.));
 
     // configure global opengl state
     // -----------------------------
     glEnable(GL_DEPTH_TEST);
-    glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
+    Profiler &profiler = Profiler::instance();
+    double last_report_time = context->get_time();
+    bool mode_key_down = false;
     // render loop
     // -----------
-    while (glfwWindowShouldClose(window) == 0 && glfwGetKey(window, GLFW_KEY_ESCAPE) != GLFW_PRESS)
+    while (!context->should_close())
     {
+        profiler.begin_frame();
+        context->begin_frame();
         // render
         // ------
         glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
@@ -171,29 +218,21 @@ int main()
 
         // input
         // -----
-        camera.compute_matrices_from_inputs(window);
+        camera.update(context->get_camera_input());
         auto camera_pos = camera.get_pos();
         auto view = camera.view;
         auto projection = camera.projection;
 
-        // sort the transparent windows before rendering
-        // ---------------------------------------------
-        std::map<float, glm::vec3> sorted;
-        for (unsigned int i = 0; i < windows.size(); i++)
-        {
-            float distance = glm::length(camera_pos - windows[i]);
-            sorted[distance] = windows[i];
-        }
-
-        // draw objects
+        // draw opaque objects
+        glDisable(GL_BLEND);
         shader.use();
         glm::mat4 model = glm::mat4(1.0f);
         shader.setMat4("projection", projection);
         shader.setMat4("view", view);
         // cubes
-        glBindVertexArray(cubeVAO);
+        glBindVertexArray(cubeVAO.get());
         glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, cubeTexture);
+        glBindTexture(GL_TEXTURE_2D, cubeTexture.get());
         model = glm::translate(model, glm::vec3(-1.0f, 0.0f, -1.0f));
         shader.setMat4("model", model);
         glDrawArrays(GL_TRIANGLES, 0, 36);
@@ -202,35 +241,85 @@ int main()
         shader.setMat4("model", model);
         glDrawArrays(GL_TRIANGLES, 0, 36);
         // floor
-        glBindVertexArray(planeVAO);
-        glBindTexture(GL_TEXTURE_2D, floorTexture);
+        glBindVertexArray(planeVAO.get());
+        glBindTexture(GL_TEXTURE_2D, floorTexture.get());
         model = glm::mat4(1.0f);
         shader.setMat4("model", model);
         glDrawArrays(GL_TRIANGLES, 0, 6);
-        // windows (from furthest to nearest)
-        glBindVertexArray(transparentVAO);
-        glBindTexture(GL_TEXTURE_2D, transparentTexture);
-        for (std::map<float, glm::vec3>::reverse_iterator it = sorted.rbegin(); it != sorted.rend(); ++it) // 从远到近绘制物体，正确混合alpha通道
+
+        // windows
+        glBindVertexArray(transparentVAO.get());
+        glBindTexture(GL_TEXTURE_2D, transparentTexture.get());
+        GLsizei window_count = static_cast<GLsizei>(windows.size());
+        if (mode == TransparencyMode::SORTED)
         {
-            model = glm::mat4(1.0f);
-            model = glm::translate(model, it->second);
-            shader.setMat4("model", model);
-            glDrawArrays(GL_TRIANGLES, 0, 6);
+            // 从远到近绘制，正确混合 alpha 通道；距离相同的窗户按原顺序都会画出来
+            {
+                PROFILE_CPU_SCOPE("sort windows");
+                sorter.clear();
+                for (unsigned int i = 0; i < windows.size(); i++)
+                    sorter.add(i, glm::length(camera_pos - windows[i]));
+                window_offsets.clear();
+                for (uint32_t index : sorter.sort_back_to_front())
+                    window_offsets.push_back(windows[index]);
+            }
+            glBindBuffer(GL_ARRAY_BUFFER, windowInstanceVBO.get());
+            glBufferSubData(GL_ARRAY_BUFFER, 0, window_offsets.size() * sizeof(glm::vec3), window_offsets.data());
+            offsets_sorted = true;
+
+            profiler.begin_gpu("windows (sorted)");
+            glEnable(GL_BLEND);
+            glDepthMask(GL_FALSE);
+            window_shader.use();
+            window_shader.setMat4("projection", projection);
+            window_shader.setMat4("view", view);
+            glDrawArraysInstanced(GL_TRIANGLES, 0, 6, window_count);
+            glDepthMask(GL_TRUE);
+            glDisable(GL_BLEND);
+            profiler.end_gpu();
         }
+        else
+        {
+            if (offsets_sorted)
+            {
+                glBindBuffer(GL_ARRAY_BUFFER, windowInstanceVBO.get());
+                glBufferSubData(GL_ARRAY_BUFFER, 0, windows.size() * sizeof(glm::vec3), windows.data());
+                offsets_sorted = false;
+            }
 
-        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
-        // -------------------------------------------------------------------------------
-        glfwSwapBuffers(window);
-        glfwPollEvents();
-    }
+            // 任意顺序画进累积缓冲，再合成回场景
+            profiler.begin_gpu("windows (oit)");
+            oit.begin_accumulation(context->get_framebuffer(), context->get_width(), context->get_height());
+            window_oit_shader.use();
+            window_oit_shader.setMat4("projection", projection);
+            window_oit_shader.setMat4("view", view);
+            glBindVertexArray(transparentVAO.get());
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, transparentTexture.get());
+            glDrawArraysInstanced(GL_TRIANGLES, 0, 6, window_count);
+            oit.composite(context->get_framebuffer());
+            glDisable(GL_BLEND);
+            profiler.end_gpu();
+        }
+        count_draw(GL_TRIANGLES, 6, window_count);
+        glBindVertexArray(0);
 
-    // optional: de-allocate all resources once they've outlived their purpose:
-    // ------------------------------------------------------------------------
-    glDeleteVertexArrays(1, &cubeVAO);
-    glDeleteVertexArrays(1, &planeVAO);
-    glDeleteBuffers(1, &cubeVBO);
-    glDeleteBuffers(1, &planeVBO);
+        profiler.end_frame();
+        context->end_frame();
+
+        bool mode_key = context->is_key_pressed(GLFW_KEY_T);
+        if (mode_key && !mode_key_down)
+        {
+            mode = mode == TransparencyMode::SORTED ? TransparencyMode::WEIGHTED_OIT : TransparencyMode::SORTED;
+            printf("transparency: %s\n", mode == TransparencyMode::SORTED ? "sorted" : "weighted blended OIT");
+        }
+        mode_key_down = mode_key;
+        if (context->get_time() - last_report_time >= 1.0)
+        {
+            last_report_time = context->get_time();
+            profiler.print_summary();
+        }
+    }
 
-    glfwTerminate();
     return 0;
 }
@@ -15,6 +15,10 @@
 #include "load_texture.hpp"
 #include "skybox.hpp"
 #include "renderable_model.hpp"
+#include "model_loader.hpp"
+#include "job_system.hpp"
+#include "texture_upload.hpp"
+#include "gl_handle.hpp"
 
 // settings
 const unsigned int WINDOW_WIDTH = 1080 * 2;
@@ -98,7 +102,7 @@ vector<std::string> faces{
 class Object : public RenderableModel
 {
 public:
-    Object(const std::string &model_path, std::shared_ptr<Shader> shader, bool gamma = false) : RenderableModel(model_path, std::move(shader), gamma) {}
+    Object(ModelLoader &loader, const std::string &model_path, std::shared_ptr<Shader> shader, bool gamma = false) : RenderableModel(loader, model_path, std::move(shader), gamma) {}
 
     void draw(const glm::mat4 &projection, const glm::mat4 &view, const glm::vec3 &camera_pos) override
     {
@@ -107,12 +111,13 @@ public:
         M = glm::rotate(M, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
         M = glm::scale(M, glm::vec3(1.f, 1.f, 1.f) * 0.5f);
 
+        set_model_matrix(M);
+
         shader->use();
-        shader->setMat4("model", M);
         shader->setMat4("view", view);
         shader->setMat4("projection", projection);
 
-        model.Draw(*shader);
+        draw_model(*shader);
     }
 };
 
@@ -120,68 +125,83 @@ int main()
 {
     GLFWwindow *window = initialize_glfw_window();
 
-    // build and compile shaders
-    // -------------------------
-    Camera camera(window, 45.0f, glm::vec3(0., 0., 10.));
-
-    Shader shader("source/shader/class14/cubemaps.vs", "source/shader/class14/cubemaps.fs");
-
-    Skybox skybox(faces, "source/shader/class14/skybox.vs", "source/shader/class14/skybox.fs");
-
-    Object nanosuit("source/model/nanosuit_reflection/nanosuit.obj", std::make_shared<Shader>("source/shader/class14/nanosuit.vs", "source/shader/class14/nanosuit.fs"));
-
-    // cube VAO
-    unsigned int cubeVAO, cubeVBO;
-    glGenVertexArrays(1, &cubeVAO);
-    glGenBuffers(1, &cubeVBO);
-    glBindVertexArray(cubeVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), &cubeVertices, GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)0);
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)(5 * sizeof(float)));
-
-    unsigned int cubemapTexture = load_cubemap(faces);
-
-    shader.use();
-    shader.setInt("skybox", 0);
-
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
-    while (glfwWindowShouldClose(window) == 0 && glfwGetKey(window, GLFW_KEY_ESCAPE) != GLFW_PRESS)
+    // 场景对象放在内层作用域里，在最后一次 flush 和 glfwTerminate 之前析构，上下文还在时释放 GL 对象
     {
-        camera.compute_matrices_from_inputs(window);
-        glm::mat4 view = camera.view;
-        glm::mat4 projection = camera.projection;
+        // build and compile shaders
+        // -------------------------
+        Camera camera(window, 45.0f, glm::vec3(0., 0., 10.));
 
-        // render
-        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        Shader shader("source/shader/class14/cubemaps.vs", "source/shader/class14/cubemaps.fs");
 
-        // draw skybox as last
-        skybox.render(view, projection);
+        Skybox skybox(faces, "source/shader/class14/skybox.vs", "source/shader/class14/skybox.fs");
 
-        // draw scene as normal
-        shader.use();
-        glm::mat4 model = glm::mat4(1.0f);
-        shader.setMat4("model", model);
-        shader.setMat4("view", view);
-        shader.setMat4("projection", projection);
-        shader.setVec3("cameraPos", camera.get_pos());
+        // 模型在后台线程导入，每帧上传一部分，加载完成前先画占位立方体
+        JobSystem jobs;
+        TextureUploadQueue uploads(jobs);
+        ModelLoader loader(jobs, &uploads);
+        Object nanosuit(loader, "source/model/nanosuit_reflection/nanosuit.obj", std::make_shared<Shader>("source/shader/class14/nanosuit.vs", "source/shader/class14/nanosuit.fs"));
+
+        // cube VAO
+        unsigned int cubeVAO, cubeVBO;
+        glGenVertexArrays(1, &cubeVAO);
+        glGenBuffers(1, &cubeVBO);
         glBindVertexArray(cubeVAO);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexture);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), &cubeVertices, GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)(5 * sizeof(float)));
 
-        nanosuit.draw(projection, view, camera.get_pos());
+        unsigned int cubemapTexture = load_cubemap(faces);
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        shader.use();
+        shader.setInt("skybox", 0);
+
+        glEnable(GL_DEPTH_TEST);
+        glDepthFunc(GL_LESS);
+        while (glfwWindowShouldClose(window) == 0 && glfwGetKey(window, GLFW_KEY_ESCAPE) != GLFW_PRESS)
+        {
+            loader.update();
+            uploads.update();
+
+            camera.compute_matrices_from_inputs(window);
+            glm::mat4 view = camera.view;
+            glm::mat4 projection = camera.projection;
+
+            // render
+            glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            // draw skybox as last
+            skybox.render(view, projection);
+
+            // draw scene as normal
+            shader.use();
+            glm::mat4 model = glm::mat4(1.0f);
+            shader.setMat4("model", model);
+            shader.setMat4("view", view);
+            shader.setMat4("projection", projection);
+            shader.setVec3("cameraPos", camera.get_pos());
+            glBindVertexArray(cubeVAO);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexture);
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+            glBindVertexArray(0);
+
+            nanosuit.draw(projection, view, camera.get_pos());
+
+            glfwSwapBuffers(window);
+            GLDeletionQueue::instance().end_frame(); // 释放 GPU 已经用完的延迟删除对象
+            glfwPollEvents();
+        }
+        loader.flush();
+        uploads.flush();
+        glDeleteVertexArrays(1, &cubeVAO);
+        glDeleteBuffers(1, &cubeVBO);
+        glDeleteTextures(1, &cubemapTexture);
     }
-    glDeleteVertexArrays(1, &cubeVAO);
-    glDeleteBuffers(1, &cubeVBO);
+    GLDeletionQueue::instance().flush();
     glfwTerminate();
     return 0;
 }
@@ -12,33 +12,21 @@
 
 #include "shader.hpp"
 #include "camera_control.hpp"
+#include "render_context.hpp"
+#include "asset_archive.hpp"
 #include "model.hpp"
 #include "load_texture.hpp"
 #include "draw_base_model.hpp"
 #include "skybox.hpp"
 #include "light_manager.hpp"
 #include "renderable_model.hpp"
+#include "depth_prepass.hpp"
+#include "profiler.hpp"
 
 // settings
 const unsigned int WINDOW_WIDTH = 1080 * 2;
 const unsigned int WINDOW_HEIGHT = 720 * 2;
 
-// 初始化窗口和 OpenGL 上下文
-GLFWwindow *initialize_glfw_window()
-{
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-    GLFWwindow *window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "scene", NULL, NULL);
-    glfwMakeContextCurrent(window);
-    gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
-    glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
-
-    return window;
-}
-
 vector<std::string> faces{
     "source/skybox/sky/right.jpg",
     "source/skybox/sky/left.jpg",
@@ -60,11 +48,20 @@ int nrRows = 7;
 int nrColumns = 7;
 float spacing = 2.5;
 
-int main()
+int main(int argc, char **argv)
 {
-    GLFWwindow *window = initialize_glfw_window();
+    // --archive=<资源包>：资源先从 asset_pack 打出的包里读
+    AssetArchive::instance().parse_command_line(argc, argv);
+
+    RenderContextDesc desc;
+    desc.width = WINDOW_WIDTH;
+    desc.height = WINDOW_HEIGHT;
+    desc.parse_command_line(argc, argv);
+    std::unique_ptr<RenderContext> context = RenderContext::create(desc);
+    if (!context)
+        return -1;
 
-    Camera camera(window, 45.0f, glm::vec3(0., 0., 10.));
+    Camera camera(45.0f, glm::vec3(0., 0., 10.));
 
     Shader shader("source/shader/class15/pbr.vs", "source/shader/class15/pbr_texture.fs");
     Skybox skybox(faces, "source/shader/class14/skybox.vs", "source/shader/class14/skybox.fs");
@@ -82,11 +79,19 @@ int main()
     unsigned int roughness = load_texture("source/model/metalgrid2-dx/metalgrid2_roughness.png");
     unsigned int ao = load_texture("source/model/metalgrid2-dx/metalgrid2_AO.png");
 
+    // 深度预通道，默认关闭：--depth-prepass 开启，运行中按 P 切换，每秒打印一次各通道的 GPU 耗时
+    DepthPrepass depth_prepass;
+    depth_prepass.parse_command_line(argc, argv);
+
     glEnable(GL_DEPTH_TEST);
     glDepthFunc(GL_LESS);
-    while (glfwWindowShouldClose(window) == 0 && glfwGetKey(window, GLFW_KEY_ESCAPE) != GLFW_PRESS)
+    Profiler &profiler = Profiler::instance();
+    double last_report_time = context->get_time();
+    while (!context->should_close())
     {
-        camera.compute_matrices_from_inputs(window);
+        profiler.begin_frame();
+        context->begin_frame();
+        camera.update(context->get_camera_input());
         glm::mat4 view = camera.view;
         glm::mat4 projection = camera.projection;
 
@@ -95,6 +100,54 @@ int main()
 
         skybox.render(view, projection);
 
+        // 小球和光源；深度通道传入深度着色器，shading 为 false，只设置 model
+        auto draw_spheres = [&](Shader &program, bool shading)
+        {
+            glm::mat4 model = glm::mat4(1.0f);
+            for (int row = 0; row < nrRows; ++row)
+            {
+                for (int col = 0; col < nrColumns; ++col)
+                {
+                    model = glm::mat4(1.0f);
+                    model = glm::translate(model, glm::vec3(
+                                                      (col - (nrColumns / 2)) * spacing,
+                                                      (row - (nrRows / 2)) * spacing,
+                                                      0.0f));
+                    program.setMat4("model", model);
+                    if (shading)
+                        program.setMat3("normalMatrix", glm::transpose(glm::inverse(glm::mat3(model))));
+                    render_sphere();
+                }
+            }
+
+            // 画光源
+            for (unsigned int i = 0; i < sizeof(lightPositions) / sizeof(lightPositions[0]); ++i)
+            {
+                glm::vec3 newPos = lightPositions[i];
+                if (shading)
+                {
+                    program.setVec3("lightPositions[" + std::to_string(i) + "]", newPos);
+                    program.setVec3("lightColors[" + std::to_string(i) + "]", lightColors[i]);
+                }
+
+                model = glm::mat4(1.0f);
+                model = glm::translate(model, newPos);
+                model = glm::scale(model, glm::vec3(0.5f));
+                program.setMat4("model", model);
+                if (shading)
+                    program.setMat3("normalMatrix", glm::transpose(glm::inverse(glm::mat3(model))));
+                render_sphere();
+            }
+        };
+
+        if (depth_prepass.is_enabled())
+        {
+            profiler.begin_gpu("depth prepass");
+            draw_spheres(depth_prepass.begin_depth(projection, view), false);
+            profiler.end_gpu();
+        }
+        depth_prepass.begin_shading();
+
         shader.use();
         shader.setMat4("view", view);
         shader.setMat4("projection", projection);
@@ -111,42 +164,20 @@ int main()
         glActiveTexture(GL_TEXTURE4);
         glBindTexture(GL_TEXTURE_2D, ao);
 
-        glm::mat4 model = glm::mat4(1.0f);
-        for (int row = 0; row < nrRows; ++row)
-        {
-            // shader.setFloat("metallic", (float)row / (float)nrRows);
-            for (int col = 0; col < nrColumns; ++col)
-            {
-                model = glm::mat4(1.0f);
-                model = glm::translate(model, glm::vec3(
-                                                  (col - (nrColumns / 2)) * spacing,
-                                                  (row - (nrRows / 2)) * spacing,
-                                                  0.0f));
-                shader.setMat4("model", model);
-                shader.setMat3("normalMatrix", glm::transpose(glm::inverse(glm::mat3(model))));
-                render_sphere();
-            }
-        }
+        profiler.begin_gpu(depth_prepass.is_enabled() ? "spheres (equal depth)" : "spheres");
+        draw_spheres(shader, true);
+        profiler.end_gpu();
+        depth_prepass.end();
+
+        profiler.end_frame();
+        context->end_frame();
 
-        // 画光源
-        for (unsigned int i = 0; i < sizeof(lightPositions) / sizeof(lightPositions[0]); ++i)
+        depth_prepass.update_toggle(context->is_key_pressed(GLFW_KEY_P));
+        if (context->get_time() - last_report_time >= 1.0)
         {
-            glm::vec3 newPos = lightPositions[i] + glm::vec3(sin(glfwGetTime() * 5.0) * 5.0, 0.0, 0.0);
-            newPos = lightPositions[i];
-            shader.setVec3("lightPositions[" + std::to_string(i) + "]", newPos);
-            shader.setVec3("lightColors[" + std::to_string(i) + "]", lightColors[i]);
-
-            model = glm::mat4(1.0f);
-            model = glm::translate(model, newPos);
-            model = glm::scale(model, glm::vec3(0.5f));
-            shader.setMat4("model", model);
-            shader.setMat3("normalMatrix", glm::transpose(glm::inverse(glm::mat3(model))));
-            render_sphere();
+            last_report_time = context->get_time();
+            profiler.print_summary();
         }
-
-        glfwSwapBuffers(window);
-        glfwPollEvents();
     }
-    glfwTerminate();
     return 0;
 }
@@ -8,10 +8,14 @@
 
 #include "shader.hpp"
 #include "camera_control.hpp"
+#include "render_context.hpp"
+#include "asset_archive.hpp"
 #include "model.hpp"
 #include "load_texture.hpp"
 #include "environment_map.hpp"
 #include "draw_base_model.hpp"
+#include "depth_prepass.hpp"
+#include "profiler.hpp"
 #include <iostream>
 
 // settings
@@ -27,22 +31,6 @@ bool firstMouse = true;
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
-// 初始化窗口和 OpenGL 上下文
-GLFWwindow *initialize_glfw_window()
-{
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-    GLFWwindow *window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "scene", NULL, NULL);
-    glfwMakeContextCurrent(window);
-    gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
-    glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
-
-    return window;
-}
-
 // lights
 glm::vec3 lightPositions[] = {
     glm::vec3(-10.0f, 10.0f, 10.0f),
@@ -59,14 +47,27 @@ int nrRows = 7;
 int nrColumns = 7;
 float spacing = 2.5;
 
-int main()
+int main(int argc, char **argv)
 {
-    GLFWwindow *window = initialize_glfw_window();
+    // --archive=<资源包>：资源先从 asset_pack 打出的包里读
+    AssetArchive::instance().parse_command_line(argc, argv);
+
+    RenderContextDesc desc;
+    desc.width = WINDOW_WIDTH;
+    desc.height = WINDOW_HEIGHT;
+    desc.parse_command_line(argc, argv);
+    std::unique_ptr<RenderContext> context = RenderContext::create(desc);
+    if (!context)
+        return -1;
 
     glEnable(GL_DEPTH_TEST);
     glDepthFunc(GL_LEQUAL);
 
-    Camera camera(window, 45.0f, glm::vec3(0., 0., 10.));
+    // 深度预通道，默认关闭：--depth-prepass 开启，运行中按 P 切换，每秒打印一次各通道的 GPU 耗时
+    DepthPrepass depth_prepass;
+    depth_prepass.parse_command_line(argc, argv);
+
+    Camera camera(45.0f, glm::vec3(0., 0., 10.));
 
     Shader pbrShader("source/shader/class15/pbr.vs", "source/shader/class15/pbr.fs");
     Shader backgroundShader("source/shader/class16/background.vs", "source/shader/class16/background.fs");
@@ -74,6 +75,7 @@ int main()
     // 将一个 equirectangular HDR 环境贴图转换为一个立方体贴图 (cubemap)，用于物理渲染（PBR）环境映射
     unsigned int hdrTexture = load_HDR_texture("source/texture/HDR/kloppenheim_06_puresky_4k.hdr", GL_RGB16F);
     unsigned int envCubemap = convert_equirectangular_to_cubemap(hdrTexture, "source/shader/class16/cubemap.vs", "source/shader/class16/equirectangular_to_cubemap.fs");
+    GL_DESTROY(TEXTURE, hdrTexture); // 原始 HDR 贴图只用于生成 cubemap
 
     // 创建了辐照度立方体贴图 (irradiance cubemap)，并使用卷积操作来计算漫反射积分，将环境立方体贴图转换为辐照度图，以用于物理基础渲染 (PBR) 中的间接漫反射光照
     unsigned int irradianceMap = generate_irradiance_map(envCubemap, "source/shader/class16/cubemap.vs", "source/shader/class16/irradiance_convolution.fs");
@@ -96,20 +98,20 @@ int main()
     backgroundShader.use();
     backgroundShader.setInt("environmentMap", 0);
 
-    int scrWidth, scrHeight;
-    glfwGetFramebufferSize(window, &scrWidth, &scrHeight);
-    glViewport(0, 0, scrWidth, scrHeight);
-
-    while (glfwWindowShouldClose(window) == 0 && glfwGetKey(window, GLFW_KEY_ESCAPE) != GLFW_PRESS)
+    Profiler &profiler = Profiler::instance();
+    double last_report_time = context->get_time();
+    while (!context->should_close())
     {
+        profiler.begin_frame();
+        context->begin_frame();
         // per-frame time logic
         // --------------------
-        float currentFrame = static_cast<float>(glfwGetTime());
+        float currentFrame = static_cast<float>(context->get_time());
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
 
         // camera
-        camera.compute_matrices_from_inputs(window);
+        camera.update(context->get_camera_input());
         glm::mat4 view = camera.view;
         glm::mat4 projection = camera.projection;
         glm::vec3 cam_pos = camera.get_pos();
@@ -117,53 +119,76 @@ int main()
         glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        // render scene, supplying the convoluted irradiance map to the final shader.
-        pbrShader.use();
-        pbrShader.setMat4("view", view);
-        pbrShader.setMat4("projection", projection);
-        pbrShader.setVec3("camPos", cam_pos);
-
-        // bind pre-computed IBL data
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
-
         // render rows*column number of spheres with varying metallic/roughness values scaled by rows and columns respectively
-        glm::mat4 model = glm::mat4(1.0f);
-        for (int row = 0; row < nrRows; ++row)
+        // 深度通道和着色通道画同样的几何，shading 为 false 时只设置 model
+        auto draw_spheres = [&](Shader &shader, bool shading)
         {
-            pbrShader.setFloat("metallic", (float)row / (float)nrRows);
-            for (int col = 0; col < nrColumns; ++col)
+            glm::mat4 model = glm::mat4(1.0f);
+            for (int row = 0; row < nrRows; ++row)
             {
-                pbrShader.setFloat("roughness", glm::clamp((float)col / (float)nrColumns, 0.05f, 1.0f));
+                if (shading)
+                    shader.setFloat("metallic", (float)row / (float)nrRows);
+                for (int col = 0; col < nrColumns; ++col)
+                {
+                    if (shading)
+                        shader.setFloat("roughness", glm::clamp((float)col / (float)nrColumns, 0.05f, 1.0f));
+
+                    model = glm::mat4(1.0f);
+                    model = glm::translate(model, glm::vec3(
+                                                      (float)(col - (nrColumns / 2)) * spacing,
+                                                      (float)(row - (nrRows / 2)) * spacing,
+                                                      -2.0f));
+                    shader.setMat4("model", model);
+                    if (shading)
+                        shader.setMat3("normalMatrix", glm::transpose(glm::inverse(glm::mat3(model))));
+                    render_sphere();
+                }
+            }
+
+            // render light source (simply re-render sphere at light positions)
+            // this looks a bit off as we use the same shader, but it'll make their positions obvious and
+            // keeps the codeprint small.
+            for (unsigned int i = 0; i < sizeof(lightPositions) / sizeof(lightPositions[0]); ++i)
+            {
+                glm::vec3 newPos = lightPositions[i];
+                if (shading)
+                {
+                    shader.setVec3("lightPositions[" + std::to_string(i) + "]", newPos);
+                    shader.setVec3("lightColors[" + std::to_string(i) + "]", lightColors[i]);
+                }
 
                 model = glm::mat4(1.0f);
-                model = glm::translate(model, glm::vec3(
-                                                  (float)(col - (nrColumns / 2)) * spacing,
-                                                  (float)(row - (nrRows / 2)) * spacing,
-                                                  -2.0f));
-                pbrShader.setMat4("model", model);
-                pbrShader.setMat3("normalMatrix", glm::transpose(glm::inverse(glm::mat3(model))));
+                model = glm::translate(model, newPos);
+                model = glm::scale(model, glm::vec3(0.5f));
+                shader.setMat4("model", model);
+                if (shading)
+                    shader.setMat3("normalMatrix", glm::transpose(glm::inverse(glm::mat3(model))));
                 render_sphere();
             }
-        }
+        };
 
-        // render light source (simply re-render sphere at light positions)
-        // this looks a bit off as we use the same shader, but it'll make their positions obvious and
-        // keeps the codeprint small.
-        for (unsigned int i = 0; i < sizeof(lightPositions) / sizeof(lightPositions[0]); ++i)
+        if (depth_prepass.is_enabled())
         {
-            glm::vec3 newPos = lightPositions[i] + glm::vec3(sin(glfwGetTime() * 5.0) * 5.0, 0.0, 0.0);
-            newPos = lightPositions[i];
-            pbrShader.setVec3("lightPositions[" + std::to_string(i) + "]", newPos);
-            pbrShader.setVec3("lightColors[" + std::to_string(i) + "]", lightColors[i]);
-
-            model = glm::mat4(1.0f);
-            model = glm::translate(model, newPos);
-            model = glm::scale(model, glm::vec3(0.5f));
-            pbrShader.setMat4("model", model);
-            pbrShader.setMat3("normalMatrix", glm::transpose(glm::inverse(glm::mat3(model))));
-            render_sphere();
+            profiler.begin_gpu("depth prepass");
+            draw_spheres(depth_prepass.begin_depth(projection, view), false);
+            profiler.end_gpu();
         }
+        depth_prepass.begin_shading();
+
+        // render scene, supplying the convoluted irradiance map to the final shader.
+        pbrShader.use();
+        pbrShader.setMat4("view", view);
+        pbrShader.setMat4("projection", projection);
+        pbrShader.setVec3("camPos", cam_pos);
+
+        // bind pre-computed IBL data
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
+
+        profiler.begin_gpu(depth_prepass.is_enabled() ? "spheres (equal depth)" : "spheres");
+        draw_spheres(pbrShader, true);
+        profiler.end_gpu();
+        depth_prepass.end();
 
         // render skybox (render as last to prevent overdraw)
         backgroundShader.use();
@@ -174,10 +199,18 @@ int main()
         // glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap); // display irradiance map
         render_cube();
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        profiler.end_frame();
+        context->end_frame();
+
+        depth_prepass.update_toggle(context->is_key_pressed(GLFW_KEY_P));
+        if (context->get_time() - last_report_time >= 1.0)
+        {
+            last_report_time = context->get_time();
+            profiler.print_summary();
+        }
     }
 
-    glfwTerminate();
+    GL_DESTROY(TEXTURE, envCubemap);
+    GL_DESTROY(TEXTURE, irradianceMap);
     return 0;
 }
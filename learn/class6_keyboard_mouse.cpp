@@ -8,6 +8,7 @@
 #include "shader.hpp"
 #include "load_image.hpp"
 #include "camera_control.hpp"
+#include "gl_handle.hpp"
 
 const unsigned int WINDOW_WIDTH = 1080;
 const unsigned int WINDOW_HEIGHT = 720;
@@ -162,6 +163,7 @@ int main()
         glDrawArrays(GL_TRIANGLES, 0, 12 * 3);
 
         glfwSwapBuffers(window);
+        GLDeletionQueue::instance().end_frame(); // 释放 GPU 已经用完的延迟删除对象
         glfwPollEvents();
     }
     glDisableVertexAttribArray(0); // 禁用顶点属性数组
@@ -169,6 +171,7 @@ int main()
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
 
+    GLDeletionQueue::instance().flush();
     glfwTerminate();
     return 0;
 }
\ No newline at end of file
@@ -8,96 +8,35 @@
 #include <cstring>
 #include "glad/glad.h"
 #include "glm/glm.hpp"
+#include "obj_parser.hpp"
 
-// loadOBJ读取文件路径，把数据写入out_vertices/out_uvs/out_normals。如果出错则返回false
+// loadOBJ读取文件路径，把数据写入out_vertices/out_uvs/out_normals（每个三角形的角展开成三项，供 glDrawArrays 使用）。如果出错则返回false
+// 解析交给 parse_obj：支持任意多边形、负索引和缺少 vt / vn 的面；纹理坐标不翻转，与原来的实现一致
 bool loadOBJ(const char *path, std::vector<glm::vec3> &out_vertices, std::vector<glm::vec2> &out_uvs, std::vector<glm::vec3> &out_normals)
 {
     printf("Loading OBJ file %s...\n", path);
-    std::vector<unsigned int> vertexIndices, uvIndices, normalIndices; // 顶点索引，uv索引，法线索引
-    std::vector<glm::vec3> temp_vertices;                              // 临时顶点
-    std::vector<glm::vec2> temp_uvs;                                   // 临时uv
-    std::vector<glm::vec3> temp_normals;                               // 临时法线
-
-    FILE *file = fopen(path, "r");
-    if (file == NULL)
+    ObjParseOptions options;
+    options.flip_uvs = false;
+    options.merge_objects = true;
+    options.load_materials = false;
+    ObjScene scene;
+    if (!parse_obj(path, scene, options))
     {
         printf("Impossible to open the file !\n");
         return false;
     }
 
-    while (1)
+    // For each vertex of each triangle
+    for (const ObjMesh &mesh : scene.meshes)
     {
-        char lineHeader[128];
-        // 读取第一个单词
-        int res = fscanf(file, "%s", lineHeader);
-        if (res == EOF)
-            break; // EOF = End Of File. Quit the loop.
-        // 如果是顶点
-        if (strcmp(lineHeader, "v") == 0)
-        {
-            glm::vec3 vertex;
-            fscanf(file, "%f %f %f\n", &vertex.x, &vertex.y, &vertex.z);
-            temp_vertices.push_back(vertex);
-        }
-        else if (strcmp(lineHeader, "vt") == 0)
-        {
-            glm::vec2 uv;
-            fscanf(file, "%f %f\n", &uv.x, &uv.y);
-            temp_uvs.push_back(uv);
-        }
-        else if (strcmp(lineHeader, "vn") == 0)
-        {
-            glm::vec3 normal;
-            fscanf(file, "%f %f %f\n", &normal.x, &normal.y, &normal.z);
-            temp_normals.push_back(normal);
-        }
-        else if (strcmp(lineHeader, "f") == 0)
+        for (unsigned int index : mesh.indices)
         {
-            std::string vertex1, vertex2, vertex3;
-            unsigned int vertexIndex[3], uvIndex[3], normalIndex[3];
-            int matches = fscanf(file, "%d/%d/%d %d/%d/%d %d/%d/%d\n",
-                                 &vertexIndex[0], &uvIndex[0], &normalIndex[0],
-                                 &vertexIndex[1], &uvIndex[1], &normalIndex[1],
-                                 &vertexIndex[2], &uvIndex[2], &normalIndex[2]);
-            if (matches != 9)
-            {
-                printf("File can't be read by our simple parser :-( Try exporting with other options\n");
-                return false;
-            }
-            vertexIndices.push_back(vertexIndex[0]);
-            vertexIndices.push_back(vertexIndex[1]);
-            vertexIndices.push_back(vertexIndex[2]);
-            uvIndices.push_back(uvIndex[0]);
-            uvIndices.push_back(uvIndex[1]);
-            uvIndices.push_back(uvIndex[2]);
-            normalIndices.push_back(normalIndex[0]);
-            normalIndices.push_back(normalIndex[1]);
-            normalIndices.push_back(normalIndex[2]);
+            const Vertex &vertex = mesh.vertices[index];
+            out_vertices.push_back(vertex.Position);
+            out_uvs.push_back(vertex.TexCoords);
+            out_normals.push_back(vertex.Normal);
         }
     }
-    // For each vertex of each triangle
-    for (unsigned int i = 0; i < vertexIndices.size(); i++)
-    {
-        unsigned int vertexIndex = vertexIndices[i];
-        glm::vec3 vertex = temp_vertices[vertexIndex - 1];
-        out_vertices.push_back(vertex);
-    }
-    // For each uv of each triangle
-    for (unsigned int i = 0; i < uvIndices.size(); i++)
-    {
-        unsigned int uvIndex = uvIndices[i];
-        glm::vec2 uv = temp_uvs[uvIndex - 1];
-        out_uvs.push_back(uv);
-    }
-    // For each normal of each triangle
-    for (unsigned int i = 0; i < normalIndices.size(); i++)
-    {
-        unsigned int normalIndex = normalIndices[i];
-        glm::vec3 normal = temp_normals[normalIndex - 1];
-        out_normals.push_back(normal);
-    }
-
-    fclose(file);
     return true;
 }
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,18 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoords;
+layout (location = 2) in vec3 aOffset; // 每个窗户一个实例，按绘制顺序排列
+
+out vec2 TexCoords;
+out float ViewDepth;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+    TexCoords = aTexCoords;
+    vec4 view_position = view * vec4(aPos + aOffset, 1.0);
+    ViewDepth = -view_position.z;
+    gl_Position = projection * view_position;
+}
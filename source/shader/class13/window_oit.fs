@@ -0,0 +1,23 @@
+#version 330 core
+// 加权混合 OIT 的累积通道，输出约定见 common/transparency.hpp
+layout (location = 0) out vec4 accumulation;
+layout (location = 1) out vec4 weight;
+
+in vec2 TexCoords;
+in float ViewDepth;
+
+uniform sampler2D texture1;
+
+// McGuire & Bavoil 2013 式 (9)：近处和不透明度高的片元权重大，z 为观察空间深度
+float transparency_weight(float z, float alpha)
+{
+    return alpha * clamp(10.0 / (1e-5 + pow(z / 5.0, 2.0) + pow(z / 200.0, 6.0)), 1e-2, 3e3);
+}
+
+void main()
+{
+    vec4 color = texture(texture1, TexCoords);
+    float w = transparency_weight(ViewDepth, color.a);
+    accumulation = vec4(color.rgb * w, color.a);
+    weight = vec4(w);
+}
@@ -12,6 +12,9 @@ uniform mat4 view;
 uniform mat4 model;
 uniform mat3 normalMatrix;
 
+// 深度预通道（depth_prepass/depth.vs）用同样的表达式，GL_EQUAL 要求两边逐位一致
+invariant gl_Position;
+
 void main()
 {
     TexCoords = aTexCoords;
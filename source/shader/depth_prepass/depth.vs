@@ -0,0 +1,15 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+
+uniform mat4 projection;
+uniform mat4 view;
+uniform mat4 model;
+
+// 与着色通道的顶点着色器（class15/pbr.vs）逐位一致，GL_EQUAL 才能通过
+invariant gl_Position;
+
+void main()
+{
+    vec3 WorldPos = vec3(model * vec4(aPos, 1.0));
+    gl_Position =  projection * view * vec4(WorldPos, 1.0);
+}
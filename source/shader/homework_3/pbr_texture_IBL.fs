@@ -10,6 +10,9 @@ uniform sampler2D normalMap;
 uniform sampler2D metallicMap;
 uniform sampler2D roughnessMap;
 uniform sampler2D aoMap;
+// texcook 打包的 ORM 纹理（R = AO，G = 粗糙度，B = 金属度），开启时一次采样代替上面三张
+uniform sampler2D ormMap;
+uniform bool useOrmMap;
 
 // IBL
 uniform samplerCube irradianceMap;
@@ -72,7 +75,10 @@ const float PI = 3.14159265359;
 // technique somewhere later in the normal mapping tutorial.
 vec3 getNormalFromMap()
 {
-    vec3 tangentNormal = texture(normalMap, TexCoords).xyz * 2.0 - 1.0;
+    // BC5 压缩的法线贴图只保存 xy，z 由单位长度重建（未压缩的贴图同样成立）
+    vec3 tangentNormal;
+    tangentNormal.xy = texture(normalMap, TexCoords).xy * 2.0 - 1.0;
+    tangentNormal.z = sqrt(max(1.0 - dot(tangentNormal.xy, tangentNormal.xy), 0.0));
 
     vec3 Q1  = dFdx(WorldPos);
     vec3 Q2  = dFdy(WorldPos);
@@ -237,9 +243,20 @@ vec3 calculateAreaLight(AreaLight light, vec3 N, vec3 V, vec3 F0, vec3 albedo, f
 void main()
 {		
     vec3 albedo     = pow(texture(albedoMap, TexCoords).rgb, vec3(2.2));
-    float metallic  = texture(metallicMap, TexCoords).r;
-    float roughness = texture(roughnessMap, TexCoords).r;
-    float ao        = texture(aoMap, TexCoords).r;
+    float metallic, roughness, ao;
+    if (useOrmMap)
+    {
+        vec3 orm  = texture(ormMap, TexCoords).rgb;
+        ao        = orm.r;
+        roughness = orm.g;
+        metallic  = orm.b;
+    }
+    else
+    {
+        metallic  = texture(metallicMap, TexCoords).r;
+        roughness = texture(roughnessMap, TexCoords).r;
+        ao        = texture(aoMap, TexCoords).r;
+    }
 
     vec3 N = getNormalFromMap();
     vec3 V = normalize(camPos - WorldPos);
@@ -0,0 +1,20 @@
+#version 330 core
+out vec4 FragColor;
+
+uniform sampler2D accumulationTexture; // rgb: sum(C * a * w), a: prod(1 - a)
+uniform sampler2D weightTexture;       // r: sum(a * w)
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    vec4 accumulation = texelFetch(accumulationTexture, pixel, 0);
+    float revealage = accumulation.a;
+    // 没有透明物体覆盖
+    if (revealage >= 1.0)
+        discard;
+
+    float weight = texelFetch(weightTexture, pixel, 0).r;
+    vec3 average = accumulation.rgb / max(weight, 1e-5);
+    // 与场景按 GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA 混合
+    FragColor = vec4(average, 1.0 - revealage);
+}
@@ -0,0 +1,146 @@
+// 资源打包：把 source/ 下的散文件打成一个资源包，程序加 --archive=<包> 挂载后纹理、着色器和模型都从包里读。
+//
+// asset_pack [目录或文件...] [--output=assets.pak] [--align=64] [--no-compress] [--max-ratio=0.9]
+//            [--exclude=.blend,.txt] [--threads=N] [--verify]
+//
+// 包内路径就是相对当前目录的路径（如 source/model/nanosuit/nanosuit.obj），与程序里写的一致，所以要在项目根目录运行。
+// 每个文件单独用 LZ4 块格式压缩，压缩后不小于原大小的 --max-ratio 时原样存放（png / jpg / ktx2 基本都是这样），
+// 原样存放的条目读取时直接引用映射的包，不经过任何拷贝。--verify 写完后挂载新包，逐个条目与原文件比较。
+// 返回值：0 成功，1 读写错误或校验失败。
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "asset_archive.hpp"
+#include "job_system.hpp"
+#include "mapped_file.hpp"
+
+namespace fs = std::filesystem;
+
+struct PackOptions
+{
+    std::vector<std::string> paths;
+    std::string output = "assets.pak";
+    std::vector<std::string> excludes = default_asset_excludes();
+    AssetPackOptions pack;
+    unsigned int threads = 0;
+    bool verify = false;
+};
+
+static void split_list(const char *text, std::vector<std::string> &items)
+{
+    items.clear();
+    for (const char *begin = text; *begin;)
+    {
+        const char *end = std::strchr(begin, ',');
+        if (!end)
+            end = begin + std::strlen(begin);
+        if (end > begin)
+            items.emplace_back(begin, end);
+        begin = *end ? end + 1 : end;
+    }
+}
+
+static void parse_options(int argc, char **argv, PackOptions &options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        if (std::strncmp(arg, "--output=", 9) == 0)
+            options.output = arg + 9;
+        else if (std::strncmp(arg, "--align=", 8) == 0)
+            options.pack.alignment = static_cast<uint32_t>(std::max(1, std::atoi(arg + 8)));
+        else if (std::strcmp(arg, "--no-compress") == 0)
+            options.pack.compress = false;
+        else if (std::strncmp(arg, "--max-ratio=", 12) == 0)
+            options.pack.max_ratio = static_cast<float>(std::atof(arg + 12));
+        else if (std::strncmp(arg, "--exclude=", 10) == 0)
+            split_list(arg + 10, options.excludes);
+        else if (std::strncmp(arg, "--threads=", 10) == 0)
+            options.threads = static_cast<unsigned int>(std::max(1, std::atoi(arg + 10)) - 1);
+        else if (std::strcmp(arg, "--verify") == 0)
+            options.verify = true;
+        else if (arg[0] != '-')
+            options.paths.push_back(arg);
+    }
+    if (options.paths.empty())
+        options.paths.push_back("source");
+}
+
+// 挂载新包，每个条目经 MappedFile（查包）读出，与 open_file 直接映射的原文件逐字节比较
+static bool verify_archive(const std::string &output, const std::vector<std::pair<std::string, std::string>> &files)
+{
+    AssetArchive &archive = AssetArchive::instance();
+    if (!archive.mount(output))
+        return false;
+    size_t mismatches = 0;
+    for (const auto &file : files)
+    {
+        MappedFile packed, loose;
+        bool same = archive.contains(file.first) && packed.open(file.first) && loose.open_file(file.second) &&
+                    packed.size() == loose.size() && std::memcmp(packed.data(), loose.data(), loose.size()) == 0;
+        if (!same)
+        {
+            printf("ERROR::ASSET_PACK:: %s differs from %s\n", file.first.c_str(), file.second.c_str());
+            mismatches++;
+        }
+    }
+    archive.unmount_all();
+    printf("verify: %zu files, %zu mismatches\n", files.size(), mismatches);
+    return mismatches == 0;
+}
+
+int main(int argc, char **argv)
+{
+    PackOptions options;
+    parse_options(argc, argv, options);
+
+    std::vector<fs::path> sources;
+    bool unreadable = false;
+    for (const std::string &root : options.paths)
+    {
+        std::error_code error;
+        if (fs::is_regular_file(root, error))
+        {
+            sources.push_back(root);
+            continue;
+        }
+        for (fs::recursive_directory_iterator it(root, error), end; !error && it != end; it.increment(error))
+            if (it->is_regular_file() && !is_asset_excluded(it->path().generic_string(), options.excludes))
+                sources.push_back(it->path());
+        if (error)
+        {
+            printf("ERROR::ASSET_PACK:: cannot read %s: %s\n", root.c_str(), error.message().c_str());
+            unreadable = true;
+        }
+    }
+    if (unreadable)
+        return 1;
+    // 按路径排序：同一目录（同一个模型）的文件在包里相邻，输出也是确定的
+    std::sort(sources.begin(), sources.end());
+
+    std::vector<std::pair<std::string, std::string>> files;
+    for (const fs::path &source : sources)
+        files.emplace_back(source.generic_string(), source.string());
+
+    JobSystem jobs(options.threads);
+    options.pack.jobs = &jobs;
+    AssetPackStats stats;
+    auto start = std::chrono::steady_clock::now();
+    if (!write_asset_archive(options.output, files, options.pack, &stats))
+        return 1;
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("asset_pack: %zu files (%zu compressed), %.2f MB -> %.2f MB data, %s %.2f MB, %.2f s on %u threads\n", stats.files,
+           stats.compressed_files, stats.raw_bytes / 1048576.0, stats.stored_bytes / 1048576.0, options.output.c_str(),
+           stats.archive_bytes / 1048576.0, seconds, jobs.get_thread_count());
+
+    if (options.verify && !verify_archive(options.output, files))
+        return 1;
+    return 0;
+}
@@ -0,0 +1,342 @@
+// 可复现的渲染基准：加载指定场景，沿相机路径以固定时间步渲染，跳过预热帧后统计
+// 帧时间分位数、绘制调用、三角形、状态切换和内存（含 GLRegistry 估算的显存），输出 JSON，并可与基线比较。
+//
+// bench --scene=spheres|nanosuit|solar|asteroids [--frames=600] [--warmup=60] [--size=1280x720] [--window]
+//       [--path=<相机路径>] [--output=<结果.json>] [--baseline=<基线.json>] [--threshold=0.10] [--archive=<资源包>]
+//       [--depth-prepass] [--serial-draw-list]
+//
+// 默认无窗口运行；每帧结束时 glFinish，测得的是包含 GPU 执行的整帧时间。
+// 与基线比较时 p50/p95/p99 任一项超过 基线 * (1 + threshold) 即视为退化，返回值为 2；退出时有 GL 对象泄漏返回 3。
+// --depth-prepass 让支持的场景（spheres）先画深度预通道，与不加时的结果对比即为预通道的收益。
+// --serial-draw-list 让 asteroids 在 GL 线程上单线程构建绘制列表，与默认的多线程构建对比即为任务系统的收益。
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "asset_archive.hpp"
+#include "bench_scenes.hpp"
+#include "render_context.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+using bench_clock = std::chrono::steady_clock;
+
+struct BenchOptions
+{
+    std::string scene = "spheres";
+    int frames = 600;
+    int warmup = 60;
+    std::string path;
+    std::string output;
+    std::string baseline;
+    float threshold = 0.10f;
+    bool depth_prepass = false;
+    bool serial_draw_list = false;
+};
+
+struct FrameTimeStats
+{
+    double min_ms = 0.0, avg_ms = 0.0, p50_ms = 0.0, p95_ms = 0.0, p99_ms = 0.0, max_ms = 0.0;
+};
+
+static void parse_options(int argc, char **argv, BenchOptions &options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        if (std::strncmp(arg, "--scene=", 8) == 0)
+            options.scene = arg + 8;
+        else if (std::strncmp(arg, "--frames=", 9) == 0)
+            options.frames = std::max(1, std::atoi(arg + 9));
+        else if (std::strncmp(arg, "--warmup=", 9) == 0)
+            options.warmup = std::max(0, std::atoi(arg + 9));
+        else if (std::strncmp(arg, "--path=", 7) == 0)
+            options.path = arg + 7;
+        else if (std::strncmp(arg, "--output=", 9) == 0)
+            options.output = arg + 9;
+        else if (std::strncmp(arg, "--baseline=", 11) == 0)
+            options.baseline = arg + 11;
+        else if (std::strncmp(arg, "--threshold=", 12) == 0)
+            options.threshold = static_cast<float>(std::atof(arg + 12));
+        else if (std::strcmp(arg, "--depth-prepass") == 0)
+            options.depth_prepass = true;
+        else if (std::strcmp(arg, "--serial-draw-list") == 0)
+            options.serial_draw_list = true;
+    }
+}
+
+static FrameTimeStats compute_stats(std::vector<double> frame_ms)
+{
+    FrameTimeStats stats;
+    if (frame_ms.empty())
+        return stats;
+    std::sort(frame_ms.begin(), frame_ms.end());
+    double sum = 0.0;
+    for (double ms : frame_ms)
+        sum += ms;
+    // 最近秩法取分位数
+    auto percentile = [&frame_ms](double q)
+    { return frame_ms[std::min(frame_ms.size() - 1, static_cast<size_t>(q * frame_ms.size()))]; };
+    stats.min_ms = frame_ms.front();
+    stats.max_ms = frame_ms.back();
+    stats.avg_ms = sum / frame_ms.size();
+    stats.p50_ms = percentile(0.50);
+    stats.p95_ms = percentile(0.95);
+    stats.p99_ms = percentile(0.99);
+    return stats;
+}
+
+// 进程常驻内存（字节），取不到时为 0
+static size_t resident_memory_bytes()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return counters.WorkingSetSize;
+    return 0;
+#else
+    FILE *file = fopen("/proc/self/statm", "r");
+    if (!file)
+        return 0;
+    long pages = 0, resident = 0;
+    int read = fscanf(file, "%ld %ld", &pages, &resident);
+    fclose(file);
+    return read == 2 ? static_cast<size_t>(resident) * 4096 : 0;
+#endif
+}
+
+// 显存占用（KB），只有 NVIDIA 的 GL_NVX_gpu_memory_info 能查到，其它驱动返回 -1
+static long long gpu_memory_used_kb()
+{
+    const GLenum GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX = 0x9048;
+    const GLenum GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX = 0x9049;
+    GLint extension_count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extension_count);
+    for (GLint i = 0; i < extension_count; i++)
+    {
+        const char *name = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, i));
+        if (name && std::strcmp(name, "GL_NVX_gpu_memory_info") == 0)
+        {
+            GLint total = 0, available = 0;
+            glGetIntegerv(GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX, &total);
+            glGetIntegerv(GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &available);
+            return static_cast<long long>(total) - available;
+        }
+    }
+    return -1;
+}
+
+static std::string json_escape(const std::string &text)
+{
+    std::string result;
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+            result += '\\';
+        result += c;
+    }
+    return result;
+}
+
+// 从基线 JSON 的 "frame_ms" 对象里取出一个数值
+static bool read_baseline_value(const std::string &json, const char *key, double &value)
+{
+    size_t object = json.find("\"frame_ms\"");
+    if (object == std::string::npos)
+        return false;
+    size_t position = json.find(std::string("\"") + key + "\"", object);
+    if (position == std::string::npos)
+        return false;
+    position = json.find(':', position);
+    if (position == std::string::npos)
+        return false;
+    value = std::strtod(json.c_str() + position + 1, nullptr);
+    return true;
+}
+
+static bool compare_with_baseline(const std::string &path, const FrameTimeStats &stats, float threshold)
+{
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        printf("ERROR::BENCH:: failed to open baseline %s\n", path.c_str());
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string json = buffer.str();
+
+    struct Metric
+    {
+        const char *key;
+        double current;
+    };
+    const Metric metrics[] = {{"p50", stats.p50_ms}, {"p95", stats.p95_ms}, {"p99", stats.p99_ms}};
+    bool passed = true;
+    printf("%-6s %12s %12s %9s\n", "metric", "baseline ms", "current ms", "change");
+    for (const Metric &metric : metrics)
+    {
+        double baseline = 0.0;
+        if (!read_baseline_value(json, metric.key, baseline) || baseline <= 0.0)
+        {
+            printf("ERROR::BENCH:: baseline has no frame_ms.%s\n", metric.key);
+            return false;
+        }
+        double change = metric.current / baseline - 1.0;
+        bool regressed = change > threshold;
+        passed = passed && !regressed;
+        printf("%-6s %12.3f %12.3f %+8.1f%%%s\n", metric.key, baseline, metric.current, change * 100.0, regressed ? "  REGRESSED" : "");
+    }
+    return passed;
+}
+
+static int run(int argc, char **argv)
+{
+    BenchOptions options;
+    parse_options(argc, argv, options);
+
+    // --archive=<资源包>：资源先从 asset_pack 打出的包里读
+    AssetArchive::instance().parse_command_line(argc, argv);
+
+    RenderContextDesc desc;
+    desc.title = "bench";
+    desc.headless = true;
+    desc.parse_command_line(argc, argv);
+    desc.frame_limit = options.warmup + options.frames;
+    std::unique_ptr<RenderContext> context = RenderContext::create(desc);
+    if (!context)
+        return 1;
+
+    std::unique_ptr<BenchScene> scene = create_bench_scene(options.scene);
+    if (!scene)
+    {
+        printf("ERROR::BENCH:: unknown scene %s (spheres, nanosuit, solar, asteroids)\n", options.scene.c_str());
+        return 1;
+    }
+    scene->set_depth_prepass(options.depth_prepass);
+    scene->set_serial_draw_list(options.serial_draw_list);
+    auto load_start = bench_clock::now();
+    if (!scene->load())
+    {
+        printf("ERROR::BENCH:: failed to load scene %s\n", options.scene.c_str());
+        return 1;
+    }
+    double load_ms = std::chrono::duration<double, std::milli>(bench_clock::now() - load_start).count();
+
+    // 给了 --path 却读不出来时退出，不能悄悄换成默认路径测量
+    CameraPath path;
+    if (options.path.empty())
+        scene->build_default_path(path);
+    else if (!path.load(options.path))
+    {
+        printf("ERROR::BENCH:: camera path %s is missing or has no keys\n", options.path.c_str());
+        return 1;
+    }
+
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LEQUAL);
+
+    Camera camera(45.0f, glm::vec3(0.0f));
+    std::vector<double> frame_ms;
+    frame_ms.reserve(options.frames);
+    RenderStats frame_totals;
+    const float timestep = desc.fixed_timestep;
+    while (!context->should_close())
+    {
+        int frame = context->get_frame_index();
+        float time = frame * timestep;
+        // 路径循环播放，场景时间与窗口/无窗口模式无关
+        glm::vec3 position, target;
+        path.evaluate(path.get_duration() > 0.0f ? std::fmod(time, path.get_duration()) : 0.0f, position, target);
+
+        auto start = bench_clock::now();
+        render_stats().reset();
+        context->begin_frame();
+        camera.look_at(position, target, context->get_width(), context->get_height());
+        scene->render(camera, time);
+        glFinish();
+        double ms = std::chrono::duration<double, std::milli>(bench_clock::now() - start).count();
+        context->end_frame();
+
+        if (frame >= options.warmup)
+        {
+            frame_ms.push_back(ms);
+            const RenderStats &stats = render_stats();
+            frame_totals.draw_calls += stats.draw_calls;
+            frame_totals.triangles += stats.triangles;
+            frame_totals.program_binds += stats.program_binds;
+            frame_totals.texture_binds += stats.texture_binds;
+            frame_totals.vertex_array_binds += stats.vertex_array_binds;
+        }
+    }
+
+    FrameTimeStats stats = compute_stats(frame_ms);
+    size_t measured = std::max<size_t>(frame_ms.size(), 1);
+    const char *renderer = reinterpret_cast<const char *>(glGetString(GL_RENDERER));
+
+    std::ostringstream json;
+    json << "{\n"
+         << "  \"scene\": \"" << json_escape(options.scene) << "\",\n"
+         << "  \"renderer\": \"" << json_escape(renderer ? renderer : "") << "\",\n"
+         << "  \"headless\": " << (context->is_headless() ? "true" : "false") << ",\n"
+         << "  \"depth_prepass\": " << (options.depth_prepass ? "true" : "false") << ",\n"
+         << "  \"serial_draw_list\": " << (options.serial_draw_list ? "true" : "false") << ",\n"
+         << "  \"width\": " << context->get_width() << ",\n"
+         << "  \"height\": " << context->get_height() << ",\n"
+         << "  \"warmup_frames\": " << options.warmup << ",\n"
+         << "  \"frames\": " << frame_ms.size() << ",\n"
+         << "  \"load_ms\": " << load_ms << ",\n"
+         << "  \"texture_load\": {";
+    for (size_t i = 0; i < size_t(TextureFileType::COUNT); i++)
+    {
+        TextureLoadStats::Entry entry = TextureLoadStats::instance().get(TextureFileType(i));
+        json << (i ? ", " : "") << "\"" << TextureLoadStats::type_name(TextureFileType(i)) << "\": {\"count\": " << entry.count
+             << ", \"ms\": " << entry.milliseconds << ", \"gpu_bytes\": " << entry.gpu_bytes << "}";
+    }
+    json << "},\n"
+         << "  \"frame_ms\": {\"min\": " << stats.min_ms << ", \"avg\": " << stats.avg_ms << ", \"p50\": " << stats.p50_ms
+         << ", \"p95\": " << stats.p95_ms << ", \"p99\": " << stats.p99_ms << ", \"max\": " << stats.max_ms << "},\n"
+         << "  \"per_frame\": {\"draw_calls\": " << frame_totals.draw_calls / measured
+         << ", \"triangles\": " << frame_totals.triangles / measured
+         << ", \"state_changes\": " << frame_totals.state_changes() / measured
+         << ", \"program_binds\": " << frame_totals.program_binds / measured
+         << ", \"texture_binds\": " << frame_totals.texture_binds / measured
+         << ", \"vertex_array_binds\": " << frame_totals.vertex_array_binds / measured << "},\n"
+         << "  \"memory\": {\"resident_bytes\": " << resident_memory_bytes() << ", \"gpu_used_kb\": " << gpu_memory_used_kb()
+         << ", \"gl_estimated_bytes\": " << GLRegistry::instance().get_total_bytes() << "}\n"
+         << "}\n";
+
+    printf("%s", json.str().c_str());
+    if (!options.output.empty())
+    {
+        std::ofstream file(options.output);
+        if (!file.is_open())
+        {
+            printf("ERROR::BENCH:: failed to write %s\n", options.output.c_str());
+            return 1;
+        }
+        file << json.str();
+    }
+
+    if (!options.baseline.empty())
+        return compare_with_baseline(options.baseline, stats, options.threshold) ? 0 : 2;
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    // run 返回时场景和上下文都已析构，上下文析构时记下了泄漏的 GL 对象数
+    int result = run(argc, argv);
+    if (result == 0 && RenderContext::get_leak_count() > 0)
+        return 3;
+    return result;
+}
@@ -0,0 +1,601 @@
+#ifndef BENCH_SCENES_HPP
+#define BENCH_SCENES_HPP
+
+// 基准测试 / 图像回归共用的演示场景：球体网格（class_15）、nanosuit 模型（class_11）、太阳系（homework_2）、
+// 小行星带（多线程构建绘制列表）
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "shader.hpp"
+#include "model.hpp"
+#include "camera_control.hpp"
+#include "camera_path.hpp"
+#include "load_texture.hpp"
+#include "draw_base_model.hpp"
+#include "render_stats.hpp"
+#include "gl_handle.hpp"
+#include "transform_system.hpp"
+#include "sphere.hpp"
+#include "texture_array.hpp"
+#include "depth_prepass.hpp"
+#include "draw_list.hpp"
+#include "job_system.hpp"
+#include "profiler.hpp"
+
+class BenchScene
+{
+public:
+    virtual ~BenchScene() = default;
+    virtual bool load() = 0;
+    // time 为场景时间（秒），由调用方按固定步长推进，保证每次运行结果一致
+    virtual void render(Camera &camera, float time) = 0;
+    // 没有指定录制的路径时使用的默认相机路径
+    virtual void build_default_path(CameraPath &path) const = 0;
+
+    // 在 load 之前设置：不透明物体先画深度预通道，着色通道用 GL_EQUAL；没有昂贵着色器的场景忽略它
+    void set_depth_prepass(bool enabled) { depth_prepass_enabled = enabled; }
+    // 在 load 之前设置：绘制列表在 GL 线程上单线程构建，与默认的任务系统并行构建对比；不构建绘制列表的场景忽略它
+    void set_serial_draw_list(bool enabled) { serial_draw_list = enabled; }
+
+protected:
+    bool depth_prepass_enabled = false;
+    bool serial_draw_list = false;
+};
+
+// 7x7 PBR 球体网格 + 两个点光源
+class SphereGridScene : public BenchScene
+{
+public:
+    bool load() override
+    {
+        shader.reset(new Shader("source/shader/class15/pbr.vs", "source/shader/class15/pbr_texture.fs"));
+        shader->use();
+        shader->setInt("albedoMap", 0);
+        shader->setInt("normalMap", 1);
+        shader->setInt("metallicMap", 2);
+        shader->setInt("roughnessMap", 3);
+        shader->setInt("aoMap", 4);
+        textures[0].reset(load_texture("source/model/metalgrid2-dx/metalgrid2_basecolor.png"));
+        textures[1].reset(load_texture("source/model/metalgrid2-dx/metalgrid2_normal-dx.png"));
+        // 有打包好的 ORM 时放在单元 2，只需绑定 3 张纹理
+        textures[2].reset(load_compressed_texture("source/model/metalgrid2-dx/metalgrid2_orm.ktx2"));
+        texture_count = textures[2] ? 3 : 5;
+        if (!textures[2])
+        {
+            textures[2].reset(load_texture("source/model/metalgrid2-dx/metalgrid2_metallic.png"));
+            textures[3].reset(load_texture("source/model/metalgrid2-dx/metalgrid2_roughness.png"));
+            textures[4].reset(load_texture("source/model/metalgrid2-dx/metalgrid2_AO.png"));
+        }
+        shader->setInt("ormMap", 2);
+        shader->setBool("useOrmMap", texture_count == 3);
+        if (depth_prepass_enabled)
+        {
+            depth_prepass.reset(new DepthPrepass());
+            depth_prepass->set_enabled(true); // DepthPrepass 默认关闭
+        }
+        return true;
+    }
+
+    void render(Camera &camera, float) override
+    {
+        const glm::vec3 light_color(150.0f, 150.0f, 150.0f);
+
+        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        if (depth_prepass)
+        {
+            draw_spheres(depth_prepass->begin_depth(camera.projection, camera.view), false);
+            depth_prepass->begin_shading();
+        }
+
+        shader->use();
+        shader->setMat4("view", camera.view);
+        shader->setMat4("projection", camera.projection);
+        shader->setVec3("camPos", camera.get_pos());
+        for (int unit = 0; unit < texture_count; unit++)
+        {
+            glActiveTexture(GL_TEXTURE0 + unit);
+            glBindTexture(GL_TEXTURE_2D, textures[unit].get());
+            count_texture_bind();
+        }
+        glActiveTexture(GL_TEXTURE0);
+
+        for (unsigned int i = 0; i < 2; ++i)
+        {
+            shader->setVec3("lightPositions[" + std::to_string(i) + "]", light_positions[i]);
+            shader->setVec3("lightColors[" + std::to_string(i) + "]", light_color);
+        }
+        draw_spheres(*shader, true);
+        if (depth_prepass)
+            depth_prepass->end();
+    }
+
+    void build_default_path(CameraPath &path) const override
+    {
+        // 从正面推近再绕到侧面
+        path.add_key(0.0f, glm::vec3(0.0f, 0.0f, 25.0f), glm::vec3(0.0f));
+        path.add_key(3.0f, glm::vec3(6.0f, 3.0f, 14.0f), glm::vec3(0.0f));
+        path.add_key(6.0f, glm::vec3(14.0f, -2.0f, 6.0f), glm::vec3(0.0f));
+        path.add_key(9.0f, glm::vec3(-4.0f, 1.0f, 9.0f), glm::vec3(-2.0f, 0.0f, 0.0f));
+        path.add_key(12.0f, glm::vec3(0.0f, 0.0f, 25.0f), glm::vec3(0.0f));
+    }
+
+private:
+    static constexpr int ROWS = 7, COLUMNS = 7;
+    static constexpr float SPACING = 2.5f;
+    const glm::vec3 light_positions[2] = {glm::vec3(0.0f, 0.0f, 10.0f), glm::vec3(0.0f, 0.0f, -10.0f)};
+
+    std::unique_ptr<Shader> shader;
+    TextureHandle textures[5];
+    int texture_count = 5;
+    std::unique_ptr<DepthPrepass> depth_prepass; // 只在 set_depth_prepass(true) 时创建
+
+    // 深度通道与着色通道画同样的球，program 为深度着色器时（shading 为 false）不设置 normalMatrix
+    void draw_spheres(Shader &program, bool shading)
+    {
+        for (int row = 0; row < ROWS; ++row)
+        {
+            for (int col = 0; col < COLUMNS; ++col)
+            {
+                glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3((col - COLUMNS / 2) * SPACING, (row - ROWS / 2) * SPACING, 0.0f));
+                program.setMat4("model", model);
+                if (shading)
+                    program.setMat3("normalMatrix", glm::mat3(1.0f));
+                render_sphere();
+            }
+        }
+        for (unsigned int i = 0; i < 2; ++i)
+        {
+            glm::mat4 model = glm::scale(glm::translate(glm::mat4(1.0f), light_positions[i]), glm::vec3(0.5f));
+            program.setMat4("model", model);
+            if (shading)
+                program.setMat3("normalMatrix", glm::mat3(2.0f));
+            render_sphere();
+        }
+    }
+};
+
+// nanosuit 模型，单个点光源
+class NanosuitScene : public BenchScene
+{
+public:
+    bool load() override
+    {
+        model.reset(new Model("source/model/nanosuit/nanosuit.obj"));
+        // 各部件的漫反射纹理合成一个数组（玻璃 128x128 缩放到 1024x1024），整个模型只绑定一次
+        use_texture_array = model->buildTextureArray("texture_diffuse");
+        shader.reset(new Shader("source/shader/class11/class11_vertexshader", use_texture_array ? "source/shader/class11/class11_array_fragmentshader"
+                                                                                                 : "source/shader/class11/class11_fragmentshader"));
+        return !model->meshes.empty();
+    }
+
+    void render(Camera &camera, float time) override
+    {
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        shader->use();
+        shader->setMat4("V", camera.view);
+        shader->setMat4("P", camera.projection);
+        shader->setVec3("CameraPosition_worldspace", camera.get_pos());
+        shader->setVec3("pointlight.position", glm::vec3(4.0f * std::cos(time), 10.0f, 4.0f * std::sin(time)));
+        shader->setFloat("pointlight.constant", 1.0f);
+        shader->setFloat("pointlight.linear", 0.045f);
+        shader->setFloat("pointlight.quadratic", 0.0075f);
+        shader->setVec3("pointlight.ambient", glm::vec3(0.2f));
+        shader->setVec3("pointlight.diffuse", glm::vec3(0.8f));
+        shader->setVec3("pointlight.specular", glm::vec3(1.0f));
+        // class11 着色器的模型矩阵叫 M
+        if (use_texture_array)
+            model->DrawTextureArray(*shader, glm::mat4(1.0f), "M");
+        else
+            model->Draw(*shader, glm::mat4(1.0f), "M");
+    }
+
+    void build_default_path(CameraPath &path) const override
+    {
+        // 绕模型一周，中途靠近头盔
+        path.add_key(0.0f, glm::vec3(0.0f, 8.0f, 20.0f), glm::vec3(0.0f, 8.0f, 0.0f));
+        path.add_key(3.0f, glm::vec3(14.0f, 10.0f, 14.0f), glm::vec3(0.0f, 8.0f, 0.0f));
+        path.add_key(6.0f, glm::vec3(4.0f, 14.0f, 5.0f), glm::vec3(0.0f, 14.0f, 0.0f));
+        path.add_key(9.0f, glm::vec3(-14.0f, 6.0f, -14.0f), glm::vec3(0.0f, 8.0f, 0.0f));
+        path.add_key(12.0f, glm::vec3(0.0f, 8.0f, 20.0f), glm::vec3(0.0f, 8.0f, 0.0f));
+    }
+
+private:
+    std::unique_ptr<Shader> shader;
+    std::unique_ptr<Model> model;
+    bool use_texture_array = false;
+};
+
+// 每个实例一项：模型矩阵 + (纹理数组层, 是否是太阳)，对应 homework2_1_array 着色器的 3~7 号属性
+struct SphereInstance
+{
+    glm::mat4 model;
+    glm::ivec2 material;
+};
+
+// 实例属性从当前 GL_ARRAY_BUFFER 的第 first_instance 项开始读（GL 3.3 没有 base instance，分段绘制时改偏移）；调用前绑定 VAO 和实例缓冲
+inline void set_sphere_instance_attributes(size_t first_instance)
+{
+    size_t base = first_instance * sizeof(SphereInstance);
+    // mat4 占 3~6 四个位置，材质占 7
+    for (int column = 0; column < 4; column++)
+        glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(SphereInstance), (void *)(base + offsetof(SphereInstance, model) + column * sizeof(glm::vec4)));
+    glVertexAttribIPointer(7, 2, GL_INT, sizeof(SphereInstance), (void *)(base + offsetof(SphereInstance, material)));
+}
+
+// 与 homework_2 相同：按索引展开成位置 / 纹理坐标 / 法线三个 VBO，实例属性指向 instance_vbo
+inline void setup_instanced_sphere(Sphere &sphere, VertexArrayHandle &vao, BufferHandle (&vbos)[3], GLuint instance_vbo, const std::string &label)
+{
+    std::vector<int> indices = sphere.getIndices();
+    std::vector<glm::vec3> vertices = sphere.getVertices();
+    std::vector<glm::vec2> tex_coords = sphere.getTexCoords();
+    std::vector<glm::vec3> normals = sphere.getNormals();
+    std::vector<float> positions, uvs, normal_values;
+    for (int index : indices)
+    {
+        positions.insert(positions.end(), {vertices[index].x, vertices[index].y, vertices[index].z});
+        uvs.insert(uvs.end(), {tex_coords[index].s, tex_coords[index].t});
+        normal_values.insert(normal_values.end(), {normals[index].x, normals[index].y, normals[index].z});
+    }
+
+    vao.reset(GL_CREATE(VERTEX_ARRAY, label));
+    glBindVertexArray(vao.get());
+    const std::vector<float> *streams[3] = {&positions, &uvs, &normal_values};
+    const GLint components[3] = {3, 2, 3};
+    for (GLuint attribute = 0; attribute < 3; attribute++)
+    {
+        vbos[attribute].reset(GL_CREATE(BUFFER, label + " vertices"));
+        glBindBuffer(GL_ARRAY_BUFFER, vbos[attribute].get());
+        glBufferData(GL_ARRAY_BUFFER, streams[attribute]->size() * sizeof(float), streams[attribute]->data(), GL_STATIC_DRAW);
+        GLRegistry::instance().set_bytes(GLObjectType::BUFFER, vbos[attribute].get(), streams[attribute]->size() * sizeof(float));
+        glVertexAttribPointer(attribute, components[attribute], GL_FLOAT, GL_FALSE, 0, 0);
+        glEnableVertexAttribArray(attribute);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, instance_vbo);
+    set_sphere_instance_attributes(0);
+    for (GLuint attribute = 3; attribute <= 7; attribute++)
+    {
+        glEnableVertexAttribArray(attribute);
+        glVertexAttribDivisor(attribute, 1);
+    }
+    glBindVertexArray(0);
+}
+
+// 太阳系：9 个带纹理的星体 + 轨道线，公转由场景时间驱动
+class SolarSystemScene : public BenchScene
+{
+public:
+    SolarSystemScene() : sphere(48) {}
+
+    bool load() override
+    {
+        planet_shader.reset(new Shader("source/shader/homework2/homework2_1_array.vertexshader", "source/shader/homework2/homework2_1_array.fragmentshader"));
+        orbit_shader.reset(new Shader("source/shader/homework2/homework2_2.vertexshader", "source/shader/homework2/homework2_2.fragmentshader"));
+        // 九张纹理合成一个数组（土星的高度不同，在 CPU 上缩放到其它天体的尺寸），材质 ID 即层号
+        TextureArrayBuilder builder;
+        for (int i = 0; i < PLANET_COUNT; i++)
+            builder.add(planets[i].texture_file);
+        textures = builder.build("solar planets");
+        if (!textures.single_array())
+            return false;
+        for (int i = 0; i < PLANET_COUNT; i++)
+        {
+            glm::mat4 body = glm::translate(glm::mat4(1.0f), glm::vec3(planets[i].distance * SCALE, 0.0f, 0.0f));
+            body = glm::scale(body, glm::vec3(planets[i].radius * SCALE));
+            orbit_nodes[i] = transforms.create();
+            body_nodes[i] = transforms.create(orbit_nodes[i], body);
+        }
+        setup_sphere();
+        setup_orbit();
+        return true;
+    }
+
+    void render(Camera &camera, float time) override
+    {
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        for (int i = 1; i < PLANET_COUNT; i++)
+        {
+            float day = std::fmod(time * DAY_LENGTH, planets[i].orbit_period);
+            transforms.set_local(orbit_nodes[i], glm::rotate(glm::mat4(1.0f), glm::radians(day / planets[i].orbit_period * 360.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+        }
+        transforms.update();
+
+        SphereInstance instances[PLANET_COUNT];
+        for (int i = 0; i < PLANET_COUNT; i++)
+            instances[i] = SphereInstance{transforms.get_world(body_nodes[i]), glm::ivec2(textures[i].layer, i == 0)};
+        glBindBuffer(GL_ARRAY_BUFFER, instance_vbo.get());
+        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(instances), instances);
+
+        planet_shader->use();
+        planet_shader->setMat4("V", camera.view);
+        planet_shader->setMat4("P", camera.projection);
+        planet_shader->setVec3("LightPosition_worldspace", glm::vec3(0.0f));
+        planet_shader->setVec3("LightColor", glm::vec3(1.0f));
+        planet_shader->setFloat("LightPower", 1.0f);
+        planet_shader->setFloat("LightSpecularPower", 0.1f);
+        glBindVertexArray(sphere_vao.get());
+        count_vertex_array_bind();
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, textures.arrays[0].get());
+        count_texture_bind();
+        glDrawArraysInstanced(GL_TRIANGLES, 0, sphere.getNumIndices(), PLANET_COUNT);
+        count_draw(GL_TRIANGLES, sphere.getNumIndices(), PLANET_COUNT);
+
+        orbit_shader->use();
+        orbit_shader->setVec3("mycolor", glm::vec3(1.0f));
+        glBindVertexArray(orbit_vao.get());
+        count_vertex_array_bind();
+        for (int i = 0; i < PLANET_COUNT; i++)
+        {
+            float radius = planets[i].distance * SCALE;
+            glm::mat4 model = glm::scale(glm::mat4(1.0f), glm::vec3(radius, 1.0f, radius));
+            orbit_shader->setMat4("MVP", camera.projection * camera.view * model);
+            glDrawArrays(GL_LINE_LOOP, 0, ORBIT_SEGMENTS + 1);
+            count_draw(GL_LINE_LOOP, ORBIT_SEGMENTS + 1);
+        }
+        glBindVertexArray(0);
+    }
+
+    void build_default_path(CameraPath &path) const override
+    {
+        // 从内行星附近拉远到能看到外行星轨道
+        path.add_key(0.0f, glm::vec3(0.0f, 3.0f, 20.0f), glm::vec3(0.0f));
+        path.add_key(4.0f, glm::vec3(10.0f, 8.0f, 10.0f), glm::vec3(0.0f));
+        path.add_key(8.0f, glm::vec3(30.0f, 25.0f, -20.0f), glm::vec3(0.0f));
+        path.add_key(12.0f, glm::vec3(0.0f, 60.0f, 40.0f), glm::vec3(0.0f));
+    }
+
+private:
+    static constexpr int PLANET_COUNT = 9;
+    static constexpr int ORBIT_SEGMENTS = 100;
+    static constexpr float SCALE = 1e-8f;     // 天体缩放比例
+    static constexpr float DAY_LENGTH = 50.0f; // 1 秒对应的天数
+
+    struct Planet
+    {
+        float radius;
+        float distance;
+        float orbit_period;
+        const char *texture_file;
+    };
+    const Planet planets[PLANET_COUNT] = {
+        {69600000.0f, 0.0f, 0.0f, "source/texture/TEXTURE/sun.bmp"},
+        {4879000.0f, 57900000.0f, 88.0f, "source/texture/TEXTURE/mercury.bmp"},
+        {12104000.0f, 108200000.0f, 225.0f, "source/texture/TEXTURE/venus.bmp"},
+        {15945000.0f, 150000000.0f, 365.0f, "source/texture/TEXTURE/earth.bmp"},
+        {8340000.0f, 227900000.0f, 687.0f, "source/texture/TEXTURE/mars.bmp"},
+        {69911000.0f, 778500000.0f, 4333.0f, "source/texture/TEXTURE/jupiter.bmp"},
+        {58232000.0f, 1429000000.0f, 10759.0f, "source/texture/TEXTURE/saturn.bmp"},
+        {25362000.0f, 2871000000.0f, 30685.0f, "source/texture/TEXTURE/uranus.bmp"},
+        {24622000.0f, 4495000000.0f, 60190.0f, "source/texture/TEXTURE/neptune.bmp"}};
+
+    Sphere sphere;
+    std::unique_ptr<Shader> planet_shader;
+    std::unique_ptr<Shader> orbit_shader;
+    TextureArrays textures;
+    TransformSystem transforms;
+    uint32_t orbit_nodes[PLANET_COUNT];
+    uint32_t body_nodes[PLANET_COUNT];
+    VertexArrayHandle sphere_vao, orbit_vao;
+    BufferHandle sphere_vbos[3];
+    BufferHandle instance_vbo;
+    BufferHandle orbit_vbo;
+
+    // 另有一个每帧更新的实例 VBO
+    void setup_sphere()
+    {
+        instance_vbo.reset(GL_CREATE(BUFFER, "solar planet instances"));
+        glBindBuffer(GL_ARRAY_BUFFER, instance_vbo.get());
+        glBufferData(GL_ARRAY_BUFFER, PLANET_COUNT * sizeof(SphereInstance), nullptr, GL_DYNAMIC_DRAW);
+        GLRegistry::instance().set_bytes(GLObjectType::BUFFER, instance_vbo.get(), PLANET_COUNT * sizeof(SphereInstance));
+        setup_instanced_sphere(sphere, sphere_vao, sphere_vbos, instance_vbo.get(), "solar sphere");
+    }
+
+    void setup_orbit()
+    {
+        std::vector<float> vertices;
+        for (int i = 0; i <= ORBIT_SEGMENTS; ++i)
+        {
+            float theta = 2.0f * GLM_PI * float(i) / float(ORBIT_SEGMENTS);
+            vertices.insert(vertices.end(), {std::cos(theta), 0.0f, std::sin(theta)});
+        }
+        orbit_vao.reset(GL_CREATE(VERTEX_ARRAY, "solar orbit"));
+        glBindVertexArray(orbit_vao.get());
+        orbit_vbo.reset(GL_CREATE(BUFFER, "solar orbit vertices"));
+        glBindBuffer(GL_ARRAY_BUFFER, orbit_vbo.get());
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+        GLRegistry::instance().set_bytes(GLObjectType::BUFFER, orbit_vbo.get(), vertices.size() * sizeof(float));
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void *)0);
+        glEnableVertexAttribArray(0);
+        glBindVertexArray(0);
+    }
+};
+
+// 小行星带：GROUP_COUNT 组各自公转的小行星，每帧由 DrawListBuilder 在任务系统上并行完成变换更新、剔除、LOD 选择和排序，
+// GL 线程只消费排好序的命令列表：按 LOD 分段写实例缓冲，每个 LOD 一次实例化绘制
+class AsteroidFieldScene : public BenchScene
+{
+public:
+    AsteroidFieldScene() : builder(jobs)
+    {
+        // 球体半径 1，屏幕高度占比低于 8% / 3% 时换更粗的网格
+        builder.lod_screen_sizes = {0.08f, 0.03f};
+    }
+
+    bool load() override
+    {
+        shader.reset(new Shader("source/shader/homework2/homework2_1_array.vertexshader", "source/shader/homework2/homework2_1_array.fragmentshader"));
+        TextureArrayBuilder texture_builder;
+        for (const char *file : MATERIAL_FILES)
+            texture_builder.add(file);
+        textures = texture_builder.build("asteroid materials");
+        if (!textures.single_array())
+            return false;
+
+        std::mt19937 rng(29);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        for (uint32_t group = 0; group < GROUP_COUNT; group++)
+        {
+            group_nodes[group] = transforms.create();
+            group_speeds[group] = 0.05f + 0.1f * unit(rng);
+            for (uint32_t i = 0; i < ASTEROIDS_PER_GROUP; i++)
+            {
+                float angle = unit(rng) * 2.0f * GLM_PI;
+                float radius = 20.0f + 40.0f * unit(rng);
+                glm::vec3 position(radius * std::cos(angle), (unit(rng) - 0.5f) * 4.0f, radius * std::sin(angle));
+                glm::mat4 local = glm::translate(glm::mat4(1.0f), position);
+                local = glm::rotate(local, unit(rng) * 2.0f * GLM_PI, glm::normalize(glm::vec3(unit(rng), unit(rng), unit(rng)) + 0.1f));
+                local = glm::scale(local, glm::vec3(0.1f + 0.4f * unit(rng)));
+                uint32_t material = static_cast<uint32_t>(unit(rng) * MATERIAL_COUNT) % MATERIAL_COUNT;
+                // 所有小行星用同一个着色器和纹理数组，DrawObject::material 为 0，排序只按 LOD 和深度分组；纹理层放进实例数据
+                objects.push_back(DrawObject{transforms.create(group_nodes[group], local), AABB(glm::vec3(-1.0f), glm::vec3(1.0f)), 0, LOD_COUNT});
+                layers.push_back(textures[material].layer);
+            }
+        }
+
+        instance_vbo.reset(GL_CREATE(BUFFER, "asteroid instances"));
+        glBindBuffer(GL_ARRAY_BUFFER, instance_vbo.get());
+        glBufferData(GL_ARRAY_BUFFER, objects.size() * sizeof(SphereInstance), nullptr, GL_STREAM_DRAW);
+        GLRegistry::instance().set_bytes(GLObjectType::BUFFER, instance_vbo.get(), objects.size() * sizeof(SphereInstance));
+        for (uint32_t lod = 0; lod < LOD_COUNT; lod++)
+            setup_instanced_sphere(lod_spheres[lod], lod_vaos[lod], lod_vbos[lod], instance_vbo.get(), "asteroid lod " + std::to_string(lod));
+        instances.reserve(objects.size());
+        return true;
+    }
+
+    void render(Camera &camera, float time) override
+    {
+        for (uint32_t group = 0; group < GROUP_COUNT; group++)
+            transforms.set_local(group_nodes[group], glm::rotate(glm::mat4(1.0f), time * group_speeds[group], glm::vec3(0.0f, 1.0f, 0.0f)));
+        FrameView view;
+        view.projection = camera.projection;
+        view.view = camera.view;
+        view.camera_pos = camera.get_pos();
+        if (serial_draw_list)
+        {
+            // 整个列表一个任务块，在调用线程内完成
+            PROFILE_CPU_SCOPE("draw list build");
+            builder.grain = objects.size();
+            builder.build(transforms, objects, view);
+        }
+        else
+        {
+            PROFILE_CPU_SCOPE("draw list kick");
+            builder.grain = PARALLEL_GRAIN;
+            builder.kick(transforms, objects, view);
+        }
+
+        // 列表在工作线程上构建，GL 线程同时做不依赖它的工作
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        shader->use();
+        shader->setMat4("V", camera.view);
+        shader->setMat4("P", camera.projection);
+        shader->setVec3("LightPosition_worldspace", glm::vec3(0.0f, 30.0f, 0.0f));
+        shader->setVec3("LightColor", glm::vec3(1.0f));
+        shader->setFloat("LightPower", 1.0f);
+        shader->setFloat("LightSpecularPower", 0.1f);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, textures.arrays[0].get());
+        count_texture_bind();
+
+        const std::vector<DrawCommand> *commands;
+        {
+            PROFILE_CPU_SCOPE("draw list acquire");
+            commands = &builder.acquire();
+        }
+
+        // 命令已按 LOD 排好，同一 LOD 的实例连续存放
+        uint32_t lod_first[LOD_COUNT + 1] = {};
+        {
+            PROFILE_CPU_SCOPE("draw list consume");
+            instances.clear();
+            for (const DrawCommand &command : *commands)
+            {
+                instances.push_back(SphereInstance{transforms.get_world(objects[command.object].transform_node), glm::ivec2(layers[command.object], 0)});
+                lod_first[command.lod + 1]++;
+            }
+            for (uint32_t lod = 0; lod < LOD_COUNT; lod++)
+                lod_first[lod + 1] += lod_first[lod];
+            glBindBuffer(GL_ARRAY_BUFFER, instance_vbo.get());
+            glBufferData(GL_ARRAY_BUFFER, objects.size() * sizeof(SphereInstance), nullptr, GL_STREAM_DRAW); // 丢弃上一帧的内容，不等 GPU
+            glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(SphereInstance), instances.data());
+        }
+
+        for (uint32_t lod = 0; lod < LOD_COUNT; lod++)
+        {
+            GLsizei count = static_cast<GLsizei>(lod_first[lod + 1] - lod_first[lod]);
+            if (count == 0)
+                continue;
+            glBindVertexArray(lod_vaos[lod].get());
+            count_vertex_array_bind();
+            set_sphere_instance_attributes(lod_first[lod]);
+            glDrawArraysInstanced(GL_TRIANGLES, 0, lod_spheres[lod].getNumIndices(), count);
+            count_draw(GL_TRIANGLES, lod_spheres[lod].getNumIndices(), count);
+        }
+        glBindVertexArray(0);
+    }
+
+    void build_default_path(CameraPath &path) const override
+    {
+        // 从带外俯视，穿过带内再拉远
+        path.add_key(0.0f, glm::vec3(0.0f, 40.0f, 90.0f), glm::vec3(0.0f));
+        path.add_key(4.0f, glm::vec3(40.0f, 5.0f, 20.0f), glm::vec3(0.0f, 0.0f, -30.0f));
+        path.add_key(8.0f, glm::vec3(-30.0f, 2.0f, -30.0f), glm::vec3(30.0f, 0.0f, 30.0f));
+        path.add_key(12.0f, glm::vec3(0.0f, 80.0f, 60.0f), glm::vec3(0.0f));
+    }
+
+private:
+    static constexpr uint32_t GROUP_COUNT = 100;
+    static constexpr uint32_t ASTEROIDS_PER_GROUP = 200;
+    static constexpr uint32_t LOD_COUNT = 3;
+    static constexpr size_t PARALLEL_GRAIN = 1024;
+    static constexpr int MATERIAL_COUNT = 4;
+    static constexpr const char *MATERIAL_FILES[MATERIAL_COUNT] = {"source/texture/TEXTURE/mercury.bmp", "source/texture/TEXTURE/mars.bmp",
+                                                                   "source/texture/TEXTURE/venus.bmp", "source/texture/TEXTURE/neptune.bmp"};
+
+    JobSystem jobs;
+    DrawListBuilder builder;
+    TransformSystem transforms;
+    std::vector<DrawObject> objects;
+    std::vector<int> layers; // 每个物体的纹理数组层
+    uint32_t group_nodes[GROUP_COUNT];
+    float group_speeds[GROUP_COUNT];
+    std::vector<SphereInstance> instances;
+
+    std::unique_ptr<Shader> shader;
+    TextureArrays textures;
+    Sphere lod_spheres[LOD_COUNT] = {Sphere(16), Sphere(8), Sphere(4)};
+    VertexArrayHandle lod_vaos[LOD_COUNT];
+    BufferHandle lod_vbos[LOD_COUNT][3];
+    BufferHandle instance_vbo;
+};
+
+inline std::unique_ptr<BenchScene> create_bench_scene(const std::string &name)
+{
+    if (name == "spheres")
+        return std::unique_ptr<BenchScene>(new SphereGridScene());
+    if (name == "nanosuit")
+        return std::unique_ptr<BenchScene>(new NanosuitScene());
+    if (name == "solar")
+        return std::unique_ptr<BenchScene>(new SolarSystemScene());
+    if (name == "asteroids")
+        return std::unique_ptr<BenchScene>(new AsteroidFieldScene());
+    return nullptr;
+}
+
+#endif // BENCH_SCENES_HPP
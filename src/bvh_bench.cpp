@@ -0,0 +1,129 @@
+// BVH 构建与遍历基准：1k / 10k / 100k 个随机包围盒，对比线性遍历
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#include "bvh.hpp"
+
+using bench_clock = std::chrono::high_resolution_clock;
+
+static double elapsed_ms(bench_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(bench_clock::now() - start).count();
+}
+
+static std::vector<AABB> random_boxes(size_t count, float world_size, std::mt19937 &rng)
+{
+    std::uniform_real_distribution<float> position(-world_size, world_size);
+    std::uniform_real_distribution<float> size(0.2f, 2.0f);
+    std::vector<AABB> boxes(count);
+    for (auto &box : boxes)
+    {
+        glm::vec3 center(position(rng), position(rng), position(rng));
+        glm::vec3 half(size(rng), size(rng), size(rng));
+        box = AABB(center - half, center + half);
+    }
+    return boxes;
+}
+
+int main()
+{
+    const size_t object_counts[] = {1000, 10000, 100000};
+    const int num_queries = 200;
+
+    std::printf("%8s %10s %10s %12s %12s %12s %12s\n",
+                "objects", "build ms", "refit ms", "frustum us", "linear us", "ray us", "linear us");
+    for (size_t count : object_counts)
+    {
+        std::mt19937 rng(42);
+        // 保持物体密度不变，世界尺寸随数量增长
+        float world_size = 100.0f * std::cbrt(float(count) / 1000.0f);
+        std::vector<AABB> boxes = random_boxes(count, world_size, rng);
+
+        BVH bvh;
+        auto start = bench_clock::now();
+        bvh.build(boxes);
+        double build_ms = elapsed_ms(start);
+
+        // 所有物体随机抖动后 refit
+        std::uniform_real_distribution<float> jitter(-0.5f, 0.5f);
+        for (auto &box : boxes)
+        {
+            glm::vec3 offset(jitter(rng), jitter(rng), jitter(rng));
+            box = AABB(box.min + offset, box.max + offset);
+        }
+        start = bench_clock::now();
+        bvh.refit(boxes);
+        double refit_ms = elapsed_ms(start);
+
+        // 视锥查询：相机放在世界中心，朝不同方向看
+        glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.5f, world_size);
+        std::vector<Frustum> frustums;
+        std::vector<Ray> rays;
+        std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+        for (int i = 0; i < num_queries; i++)
+        {
+            float yaw = angle(rng), pitch = angle(rng) * 0.25f - 0.785f;
+            glm::vec3 direction(std::cos(pitch) * std::sin(yaw), std::sin(pitch), std::cos(pitch) * std::cos(yaw));
+            frustums.emplace_back(projection * glm::lookAt(glm::vec3(0.0f), direction, glm::vec3(0.0f, 1.0f, 0.0f)));
+            rays.emplace_back(glm::vec3(0.0f), direction);
+        }
+
+        std::vector<uint32_t> visible;
+        visible.reserve(count);
+        size_t bvh_visible = 0, linear_visible = 0;
+        start = bench_clock::now();
+        for (const Frustum &frustum : frustums)
+        {
+            visible.clear();
+            bvh.query_frustum(frustum, visible);
+            bvh_visible += visible.size();
+        }
+        double frustum_us = elapsed_ms(start) * 1000.0 / num_queries;
+
+        start = bench_clock::now();
+        for (const Frustum &frustum : frustums)
+        {
+            visible.clear();
+            for (uint32_t i = 0; i < boxes.size(); i++)
+                if (frustum.intersects(boxes[i]))
+                    visible.push_back(i);
+            linear_visible += visible.size();
+        }
+        double frustum_linear_us = elapsed_ms(start) * 1000.0 / num_queries;
+
+        int bvh_hits = 0, linear_hits = 0;
+        start = bench_clock::now();
+        for (const Ray &ray : rays)
+        {
+            float t;
+            bvh_hits += bvh.raycast(ray, t) >= 0;
+        }
+        double ray_us = elapsed_ms(start) * 1000.0 / num_queries;
+
+        start = bench_clock::now();
+        for (const Ray &ray : rays)
+        {
+            float t_best = FLT_MAX, t;
+            int best = -1;
+            for (uint32_t i = 0; i < boxes.size(); i++)
+                if (ray.intersects(boxes[i], t_best, t) && t < t_best)
+                {
+                    t_best = t;
+                    best = int(i);
+                }
+            linear_hits += best >= 0;
+        }
+        double ray_linear_us = elapsed_ms(start) * 1000.0 / num_queries;
+
+        std::printf("%8zu %10.2f %10.3f %12.1f %12.1f %12.2f %12.1f\n",
+                    count, build_ms, refit_ms, frustum_us, frustum_linear_us, ray_us, ray_linear_us);
+        if (bvh_visible != linear_visible || bvh_hits != linear_hits)
+            std::printf("  mismatch: visible %zu vs %zu, hits %d vs %d\n", bvh_visible, linear_visible, bvh_hits, linear_hits);
+    }
+    return 0;
+}
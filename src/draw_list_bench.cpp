@@ -0,0 +1,88 @@
+// 绘制列表构建基准：比较单线程与任务系统多线程下 变换更新 + 剔除 + LOD + 排序 的每帧 CPU 时间
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#include "draw_list.hpp"
+
+using bench_clock = std::chrono::high_resolution_clock;
+
+struct BenchScene
+{
+    TransformSystem transforms;
+    std::vector<uint32_t> roots;
+    std::vector<DrawObject> objects;
+};
+
+// group_count 个会转动的根节点，每个根下 objects_per_group 个物体
+static void build_scene(BenchScene &scene, size_t group_count, size_t objects_per_group)
+{
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> position(-200.0f, 200.0f);
+    std::uniform_real_distribution<float> local(-20.0f, 20.0f);
+    std::uniform_int_distribution<uint32_t> material(0, 31);
+    for (size_t g = 0; g < group_count; g++)
+    {
+        uint32_t root = scene.transforms.create(TransformSystem::INVALID_NODE,
+                                                glm::translate(glm::mat4(1.0f), glm::vec3(position(rng), position(rng) * 0.1f, position(rng))));
+        scene.roots.push_back(root);
+        for (size_t i = 0; i < objects_per_group; i++)
+        {
+            uint32_t node = scene.transforms.create(root, glm::translate(glm::mat4(1.0f), glm::vec3(local(rng), local(rng), local(rng))));
+            scene.objects.push_back(DrawObject{node, AABB(glm::vec3(-0.5f), glm::vec3(0.5f)), material(rng), 4});
+        }
+    }
+}
+
+static double run_frames(DrawListBuilder &builder, BenchScene &scene, int frames, size_t &visible)
+{
+    FrameView view;
+    view.projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.5f, 300.0f);
+    view.camera_pos = glm::vec3(0.0f, 20.0f, 0.0f);
+    view.far_plane = 300.0f;
+
+    auto start = bench_clock::now();
+    for (int frame = 0; frame < frames; frame++)
+    {
+        // 每帧转动所有根节点，迫使整棵树重算
+        for (size_t g = 0; g < scene.roots.size(); g++)
+        {
+            glm::mat4 local = scene.transforms.get_local(scene.roots[g]);
+            scene.transforms.set_local(scene.roots[g], glm::rotate(local, 0.01f, glm::vec3(0.0f, 1.0f, 0.0f)));
+        }
+        float yaw = frame * 0.05f;
+        view.view = glm::lookAt(view.camera_pos, view.camera_pos + glm::vec3(std::sin(yaw), -0.2f, std::cos(yaw)), glm::vec3(0.0f, 1.0f, 0.0f));
+        visible = builder.build(scene.transforms, scene.objects, view).size();
+    }
+    return std::chrono::duration<double, std::milli>(bench_clock::now() - start).count() / frames;
+}
+
+int main()
+{
+    const size_t object_counts[] = {10000, 100000};
+    const int frames = 30;
+    JobSystem jobs;
+
+    std::printf("threads: %u\n", jobs.get_thread_count());
+    std::printf("%8s %14s %14s %8s %10s\n", "objects", "1 thread ms", "N threads ms", "speedup", "visible");
+    for (size_t count : object_counts)
+    {
+        BenchScene scene;
+        build_scene(scene, count / 100, 100);
+
+        size_t visible_single = 0, visible_parallel = 0;
+        DrawListBuilder single(jobs);
+        single.grain = scene.objects.size(); // 所有工作都在调用线程内完成
+        double single_ms = run_frames(single, scene, frames, visible_single);
+
+        DrawListBuilder parallel(jobs);
+        double parallel_ms = run_frames(parallel, scene, frames, visible_parallel);
+
+        std::printf("%8zu %14.3f %14.3f %8.2f %10zu\n", count, single_ms, parallel_ms, single_ms / parallel_ms, visible_parallel);
+    }
+    return 0;
+}
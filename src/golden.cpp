@@ -0,0 +1,286 @@
+// 图像回归测试：无窗口渲染每个演示场景，在默认相机路径上均匀取几个时刻截图，
+// 与参考图（golden）逐像素比较。性能相关的重构（实例化、合批、量化……）前后跑一次，确认画面没有变化。
+//
+// golden [--scenes=spheres,nanosuit,solar,asteroids] [--dir=source/golden] [--output=golden_diff] [--shots=3]
+//        [--size=320x240] [--delta-e=3.0] [--max-fraction=0.002] [--update] [--archive=<资源包>] [--depth-prepass]
+//
+// 比较在 CIELAB 空间进行：两像素的色差 ΔE76 超过 --delta-e 记为不同（ΔE≈2.3 为人眼刚可察觉的差异），
+// 不同像素占比超过 --max-fraction 判定失败，并在 --output 目录写出差异热图。
+// --update 用当前结果覆盖参考图。--depth-prepass 打开场景的深度预通道，画面应与参考图完全相同。
+//
+// source/golden 下提交的参考图是默认参数（320x240、每个场景 3 张）在无窗口 EGL + Mesa llvmpipe（LLVM 15）上渲染的。
+// 软件光栅化的结果与 GPU 无关、可以逐位复现；换成硬件驱动后光栅化和插值精度不同，边缘和高光会超出容差，
+// 这时先在当前驱动上用 --update 生成一份本地参考图（--dir 指向别处），再对重构前后做比较。
+// 返回值：0 通过，1 运行错误，2 图像不一致，3 其余都通过但退出时有 GL 对象泄漏。
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <stb_image.h>
+#include <stb_image_write.h>
+
+#include "asset_archive.hpp"
+#include "bench_scenes.hpp"
+#include "frame_capture.hpp"
+#include "render_context.hpp"
+
+struct GoldenOptions
+{
+    std::vector<std::string> scenes = {"spheres", "nanosuit", "solar", "asteroids"};
+    std::string directory = "source/golden";
+    std::string output = "golden_diff";
+    int shots = 3;
+    float delta_e = 3.0f;
+    float max_fraction = 0.002f;
+    bool update = false;
+    bool depth_prepass = false;
+};
+
+struct ImageDifference
+{
+    float max_delta_e = 0.0f;
+    double mean_delta_e = 0.0;
+    size_t different_pixels = 0;
+    std::vector<unsigned char> heatmap; // RGBA8，差异越大越红
+};
+
+static void parse_options(int argc, char **argv, GoldenOptions &options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        if (std::strncmp(arg, "--scenes=", 9) == 0)
+        {
+            options.scenes.clear();
+            std::stringstream list(arg + 9);
+            std::string name;
+            while (std::getline(list, name, ','))
+                if (!name.empty())
+                    options.scenes.push_back(name);
+        }
+        else if (std::strncmp(arg, "--dir=", 6) == 0)
+            options.directory = arg + 6;
+        else if (std::strncmp(arg, "--output=", 9) == 0)
+            options.output = arg + 9;
+        else if (std::strncmp(arg, "--shots=", 8) == 0)
+            options.shots = std::max(1, std::atoi(arg + 8));
+        else if (std::strncmp(arg, "--delta-e=", 10) == 0)
+            options.delta_e = static_cast<float>(std::atof(arg + 10));
+        else if (std::strncmp(arg, "--max-fraction=", 15) == 0)
+            options.max_fraction = static_cast<float>(std::atof(arg + 15));
+        else if (std::strcmp(arg, "--update") == 0)
+            options.update = true;
+        else if (std::strcmp(arg, "--depth-prepass") == 0)
+            options.depth_prepass = true;
+    }
+}
+
+// sRGB (0~255) -> CIELAB，D65 白点
+static glm::vec3 srgb_to_lab(const unsigned char *rgb)
+{
+    auto linear = [](unsigned char value)
+    {
+        float c = value / 255.0f;
+        return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+    };
+    float r = linear(rgb[0]), g = linear(rgb[1]), b = linear(rgb[2]);
+    glm::vec3 xyz(0.4124f * r + 0.3576f * g + 0.1805f * b,
+                  0.2126f * r + 0.7152f * g + 0.0722f * b,
+                  0.0193f * r + 0.1192f * g + 0.9505f * b);
+    xyz /= glm::vec3(0.95047f, 1.0f, 1.08883f);
+    auto f = [](float t)
+    { return t > 0.008856f ? std::cbrt(t) : 7.787f * t + 16.0f / 116.0f; };
+    glm::vec3 v(f(xyz.x), f(xyz.y), f(xyz.z));
+    return glm::vec3(116.0f * v.y - 16.0f, 500.0f * (v.x - v.y), 200.0f * (v.y - v.z));
+}
+
+// 两幅同尺寸 RGBA8 图像的逐像素色差，忽略 alpha
+static ImageDifference compare_images(const unsigned char *expected, const unsigned char *actual, int width, int height, float delta_e)
+{
+    ImageDifference difference;
+    size_t pixel_count = size_t(width) * height;
+    difference.heatmap.resize(pixel_count * 4);
+    double sum = 0.0;
+    for (size_t i = 0; i < pixel_count; i++)
+    {
+        const unsigned char *a = expected + i * 4;
+        const unsigned char *b = actual + i * 4;
+        float distance = (a[0] == b[0] && a[1] == b[1] && a[2] == b[2]) ? 0.0f : glm::length(srgb_to_lab(a) - srgb_to_lab(b));
+        sum += distance;
+        difference.max_delta_e = std::max(difference.max_delta_e, distance);
+        if (distance > delta_e)
+            difference.different_pixels++;
+
+        // 热图：底图取参考图的灰度（暗化），超出阈值的像素按差异大小涂红
+        unsigned char gray = static_cast<unsigned char>((a[0] * 77 + a[1] * 150 + a[2] * 29) >> 10);
+        unsigned char *out = &difference.heatmap[i * 4];
+        if (distance > delta_e)
+        {
+            out[0] = static_cast<unsigned char>(std::min(255.0f, 128.0f + distance * 4.0f));
+            out[1] = out[2] = 0;
+        }
+        else
+            out[0] = out[1] = out[2] = gray;
+        out[3] = 255;
+    }
+    difference.mean_delta_e = pixel_count ? sum / pixel_count : 0.0;
+    return difference;
+}
+
+static bool make_directory(const std::string &path)
+{
+#ifdef _WIN32
+    std::string command = "mkdir \"" + path + "\" 2> nul";
+#else
+    std::string command = "mkdir -p \"" + path + "\"";
+#endif
+    return std::system(command.c_str()) == 0;
+}
+
+struct Shot
+{
+    std::string name;
+    CapturedImage image;
+};
+
+static int run(int argc, char **argv)
+{
+    GoldenOptions options;
+    parse_options(argc, argv, options);
+
+    // 默认用较小的分辨率，软件光栅化下也能很快跑完
+    // --archive=<资源包>：资源先从 asset_pack 打出的包里读
+    AssetArchive::instance().parse_command_line(argc, argv);
+
+    RenderContextDesc desc;
+    desc.title = "golden";
+    desc.width = 320;
+    desc.height = 240;
+    desc.headless = true;
+    desc.parse_command_line(argc, argv);
+    std::unique_ptr<RenderContext> context = RenderContext::create(desc);
+    if (!context)
+        return 1;
+
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LEQUAL);
+
+    // 读回在后续帧里异步完成，编码 / 比较交给工作线程
+    JobSystem jobs(1);
+    FrameCapture capture(jobs, 3);
+    std::vector<Shot> shots;
+    shots.reserve(options.scenes.size() * options.shots);
+    for (const std::string &scene_name : options.scenes)
+    {
+        std::unique_ptr<BenchScene> scene = create_bench_scene(scene_name);
+        if (!scene)
+        {
+            printf("ERROR::GOLDEN:: unknown scene %s (spheres, nanosuit, solar, asteroids)\n", scene_name.c_str());
+            return 1;
+        }
+        scene->set_depth_prepass(options.depth_prepass);
+        if (!scene->load())
+        {
+            printf("ERROR::GOLDEN:: failed to load scene %s\n", scene_name.c_str());
+            return 1;
+        }
+        CameraPath path;
+        scene->build_default_path(path);
+
+        Camera camera(45.0f, glm::vec3(0.0f));
+        for (int i = 0; i < options.shots; i++)
+        {
+            // 在路径上均匀取时刻，场景时间与相机时间一致
+            float time = path.get_duration() * i / options.shots;
+            glm::vec3 position, target;
+            path.evaluate(time, position, target);
+
+            context->begin_frame();
+            camera.look_at(position, target, context->get_width(), context->get_height());
+            scene->render(camera, time);
+
+            shots.push_back(Shot{scene_name + "_" + std::to_string(i), CapturedImage()});
+            Shot *shot = &shots.back();
+            capture.capture(context->get_framebuffer(), context->get_width(), context->get_height(), CapturedImage::Format::LDR,
+                            [shot](CapturedImage &image)
+                            { shot->image = std::move(image); });
+            context->end_frame();
+            capture.poll();
+        }
+        // 场景的 GL 资源在析构时释放，先把引用它们的读回处理完
+        capture.flush();
+    }
+    capture.flush();
+
+    if (options.update)
+    {
+        make_directory(options.directory);
+        bool written = true;
+        for (const Shot &shot : shots)
+        {
+            std::string path = options.directory + "/" + shot.name + ".png";
+            written = shot.image.write(path) && written;
+            printf("updated %s\n", path.c_str());
+        }
+        return written ? 0 : 1;
+    }
+
+    // load_texture 打开了全局的上下翻转，参考图按文件顺序（自上而下）读取
+    stbi_set_flip_vertically_on_load(false);
+    bool passed = true;
+    bool output_ready = false;
+    printf("%-16s %10s %10s %12s  %s\n", "shot", "max dE", "mean dE", "diff pixels", "result");
+    for (const Shot &shot : shots)
+    {
+        std::string path = options.directory + "/" + shot.name + ".png";
+        int width = 0, height = 0, channels = 0;
+        unsigned char *expected = stbi_load(path.c_str(), &width, &height, &channels, 4);
+        if (!expected)
+        {
+            printf("ERROR::GOLDEN:: missing golden image %s (run with --update to create it)\n", path.c_str());
+            return 1;
+        }
+        if (width != shot.image.width || height != shot.image.height)
+        {
+            printf("%-16s %10s %10s %12s  FAILED (golden is %dx%d, rendered %dx%d)\n", shot.name.c_str(), "-", "-", "-",
+                   width, height, shot.image.width, shot.image.height);
+            stbi_image_free(expected);
+            passed = false;
+            continue;
+        }
+
+        ImageDifference difference = compare_images(expected, shot.image.ldr.data(), width, height, options.delta_e);
+        stbi_image_free(expected);
+        double fraction = double(difference.different_pixels) / (size_t(width) * height);
+        bool matched = fraction <= options.max_fraction;
+        printf("%-16s %10.2f %10.3f %11.3f%%  %s\n", shot.name.c_str(), difference.max_delta_e, difference.mean_delta_e,
+               fraction * 100.0, matched ? "ok" : "FAILED");
+        if (!matched)
+        {
+            passed = false;
+            if (!output_ready)
+            {
+                make_directory(options.output);
+                output_ready = true;
+            }
+            std::string diff_path = options.output + "/" + shot.name + "_diff.png";
+            stbi_write_png(diff_path.c_str(), width, height, 4, difference.heatmap.data(), width * 4);
+            shot.image.write(options.output + "/" + shot.name + ".png");
+        }
+    }
+    return passed ? 0 : 2;
+}
+
+int main(int argc, char **argv)
+{
+    // run 返回时场景和上下文都已析构，上下文析构时记下了泄漏的 GL 对象数
+    int result = run(argc, argv);
+    if (result == 0 && RenderContext::get_leak_count() > 0)
+        return 3;
+    return result;
+}
@@ -2,6 +2,8 @@
 #include <iostream>
 #include <fstream>
 #include <cmath>
+#include <cstddef>
+#include <cstdio>
 #include <vector>
 
 #include "glad/glad.h"
@@ -15,12 +17,16 @@
 #include "load_texture.hpp"
 #include "sphere.hpp"
 #include "camera_control.hpp"
+#include "transform_system.hpp"
+#include "profiler.hpp"
+#include "texture_array.hpp"
+#include "gl_handle.hpp"
 
 #define numPlanets 9 // 太阳系 0：太阳 1：水星 2：金星 3：地球 4：火星 5：木星 6：土星 7：天王星 8：海王星
 
 int WINDOW_WIDTH = 1080 * 2;
 int WINDOW_HEIGHT = 720 * 2;
-const int NUM_VBO = 3;
+const int NUM_VBO = 4;
 const float scale = 1e-8f;    // 天体缩放比例
 const int day_length = 50;    // 1秒钟对应的天数
 const int num_segments = 100; // 圆的细分数量
@@ -28,6 +34,21 @@ const int num_segments = 100; // 圆的细分数量
 Sphere sphere(48);
 Camera camera;
 
+// 天体层级：公转节点（绕太阳旋转）-> 星体节点（平移到轨道半径并缩放）
+TransformSystem planet_transforms;
+uint32_t orbit_nodes[numPlanets];
+uint32_t body_nodes[numPlanets];
+
+// 所有天体的纹理合成一个 GL_TEXTURE_2D_ARRAY，材质 ID 即层号
+TextureArrays planet_textures;
+
+// 每个天体一个实例：模型矩阵 + (纹理数组层, 是否是太阳)
+struct PlanetInstance
+{
+    glm::mat4 model;
+    glm::ivec2 material;
+};
+
 glm::vec3 LightPosition_worldspace = glm::vec3(0.0f, 0.0f, 0.0f); // 光源位置
 glm::vec3 LightColor = glm::vec3(1, 1, 1);                        // 光源颜色
 float LightPower = 1.0f;                                          // 光源强度
@@ -54,13 +75,25 @@ const Planet planets[numPlanets] = {
     {24622000.0f, 4495000000.0f, 60190.0f, "source/texture/TEXTURE/neptune.bmp"} // 海王星
 };
 
-void init(GLFWwindow *window, GLuint *programID, GLuint *texture)
+void init(GLFWwindow *window, GLuint *programID)
 {
-    programID[0] = load_shaders("source/shader/homework_2/homework2_1.vertexshader", "source/shader/homework_2/homework2_1.fragmentshader");
-    programID[1] = load_shaders("source/shader/homework_2/homework2_2.vertexshader", "source/shader/homework_2/homework2_2.fragmentshader");
+    programID[0] = load_shaders("source/shader/homework2/homework2_1_array.vertexshader", "source/shader/homework2/homework2_1_array.fragmentshader");
+    programID[1] = load_shaders("source/shader/homework2/homework2_2.vertexshader", "source/shader/homework2/homework2_2.fragmentshader");
     camera = Camera(window, 45.0f, glm::vec3(0, 3, 20));
+    // 加载每个天体的纹理并合成数组，尺寸不同的（土星）在 CPU 上缩放
+    TextureArrayBuilder builder;
+    for (int i = 0; i < numPlanets; i++)
+        builder.add(planets[i].textureFile);
+    planet_textures = builder.build("solar planets");
+
+    // 轨道半径和星体大小不变，只在这里设置一次
     for (int i = 0; i < numPlanets; i++)
-        texture[i] = load_texture(planets[i].textureFile); // 加载每个天体的纹理
+    {
+        glm::mat4 body = glm::translate(glm::mat4(1.0f), glm::vec3(planets[i].distance * scale, 0.0f, 0.0f));
+        body = glm::scale(body, glm::vec3(planets[i].radius * scale));
+        orbit_nodes[i] = planet_transforms.create();
+        body_nodes[i] = planet_transforms.create(orbit_nodes[i], body);
+    }
 }
 
 void setup_vertices(GLuint &VAO, GLuint *VBO)
@@ -107,6 +140,19 @@ void setup_vertices(GLuint &VAO, GLuint *VBO)
     glBufferData(GL_ARRAY_BUFFER, nvalues.size() * 4, &nvalues[0], GL_STATIC_DRAW);
     glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 0, 0);
     glEnableVertexAttribArray(2);
+
+    // 第四个是每个天体一项的实例数据，每帧更新：mat4 占 3~6 四个位置，材质占 7
+    glBindBuffer(GL_ARRAY_BUFFER, VBO[3]);
+    glBufferData(GL_ARRAY_BUFFER, numPlanets * sizeof(PlanetInstance), nullptr, GL_DYNAMIC_DRAW);
+    for (int column = 0; column < 4; column++)
+    {
+        glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(PlanetInstance), (void *)(offsetof(PlanetInstance, model) + column * sizeof(glm::vec4)));
+        glEnableVertexAttribArray(3 + column);
+        glVertexAttribDivisor(3 + column, 1);
+    }
+    glVertexAttribIPointer(7, 2, GL_INT, sizeof(PlanetInstance), (void *)offsetof(PlanetInstance, material));
+    glEnableVertexAttribArray(7);
+    glVertexAttribDivisor(7, 1);
     glBindVertexArray(0);
 }
 
@@ -157,8 +203,9 @@ float day(int index)
     return day[index];
 }
 
-void display(GLFWwindow *window, double currentTime, GLuint *programID, GLuint *texture, GLuint *VAO)
+void display(GLFWwindow *window, double currentTime, GLuint *programID, GLuint *VAO, GLuint instanceVBO)
 {
+    PROFILE_CPU_SCOPE("display");
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     camera.compute_matrices_from_inputs(window);
@@ -167,7 +214,6 @@ void display(GLFWwindow *window, double currentTime, GLuint *programID, GLuint *
 
     // 绘制行星
     glUseProgram(programID[0]);
-    GLuint Matrix_M = glGetUniformLocation(programID[0], "M");
     GLuint Matrix_V = glGetUniformLocation(programID[0], "V");
     GLuint Matrix_P = glGetUniformLocation(programID[0], "P");
 
@@ -175,38 +221,39 @@ void display(GLFWwindow *window, double currentTime, GLuint *programID, GLuint *
     GLuint LightColorID = glGetUniformLocation(programID[0], "LightColor");
     GLuint LightPowerID = glGetUniformLocation(programID[0], "LightPower");
     GLuint specularStrengthID = glGetUniformLocation(programID[0], "LightSpecularPower");
-    GLuint isSunID = glGetUniformLocation(programID[0], "isSun");
-    for (int i = 0; i < numPlanets; i++)
-    {
-        glBindVertexArray(VAO[0]);
-
-        glm::mat4 Model = glm::mat4(1.0f);
 
-        if (i == 0)
-            Model = glm::translate(Model, glm::vec3(0.0f, 0.0f, 0.0f));
-        else
-        {
-            Model = glm::rotate(Model, glm::radians(day(i) / planets[i].orbitPeriod * 360.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-            Model = glm::translate(Model, glm::vec3(planets[i].distance * scale, 0.0f, 0.0f));
-        }
-        Model = glm::scale(Model, glm::vec3(planets[i].radius * scale)); // 设置行星的大小
-
-        glUniformMatrix4fv(Matrix_M, 1, GL_FALSE, &Model[0][0]);        // uniform Model
-        glUniformMatrix4fv(Matrix_V, 1, GL_FALSE, &View[0][0]);         // uniform View
-        glUniformMatrix4fv(Matrix_P, 1, GL_FALSE, &Projection[0][0]);   // uniform Projection
-        glUniform3fv(LightPositionID, 1, &LightPosition_worldspace[0]); // 光源位置
-        glUniform3fv(LightColorID, 1, &LightColor[0]);                  // 光源颜色
-        glUniform1f(LightPowerID, LightPower);                          // 光源强度
-        glUniform1f(specularStrengthID, specularStrength);              // 镜面反射强度
-        glUniform1i(isSunID, i == 0);                                   // 是否是太阳
-
-        glActiveTexture(GL_TEXTURE0);             // 激活纹理单元
-        glBindTexture(GL_TEXTURE_2D, texture[i]); // 绑定纹理
-        glDrawArrays(GL_TRIANGLES, 0, sphere.getNumIndices());
+    // 每帧只更新公转角度，星体节点的世界矩阵由层级自动传播
+    {
+        PROFILE_CPU_SCOPE("transforms");
+        for (int i = 1; i < numPlanets; i++)
+            planet_transforms.set_local(orbit_nodes[i], glm::rotate(glm::mat4(1.0f), glm::radians(day(i) / planets[i].orbitPeriod * 360.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+        planet_transforms.update();
     }
+
+    // 模型矩阵和纹理层作为实例属性，所有天体一次绘制
+    PlanetInstance instances[numPlanets];
+    for (int i = 0; i < numPlanets; i++)
+        instances[i] = PlanetInstance{planet_transforms.get_world(body_nodes[i]), glm::ivec2(planet_textures[i].layer, i == 0)};
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(instances), instances);
+
+    Profiler::instance().begin_gpu("planets");
+    glBindVertexArray(VAO[0]);
+    glUniformMatrix4fv(Matrix_V, 1, GL_FALSE, &View[0][0]);         // uniform View
+    glUniformMatrix4fv(Matrix_P, 1, GL_FALSE, &Projection[0][0]);   // uniform Projection
+    glUniform3fv(LightPositionID, 1, &LightPosition_worldspace[0]); // 光源位置
+    glUniform3fv(LightColorID, 1, &LightColor[0]);                  // 光源颜色
+    glUniform1f(LightPowerID, LightPower);                          // 光源强度
+    glUniform1f(specularStrengthID, specularStrength);              // 镜面反射强度
+
+    glActiveTexture(GL_TEXTURE0);                                        // 激活纹理单元
+    glBindTexture(GL_TEXTURE_2D_ARRAY, planet_textures.arrays[0].get()); // 绑定纹理数组
+    glDrawArraysInstanced(GL_TRIANGLES, 0, sphere.getNumIndices(), numPlanets);
     glBindVertexArray(0);
+    Profiler::instance().end_gpu();
 
     // 绘制圆形轨道
+    PROFILE_GPU_SCOPE("orbits");
     glUseProgram(programID[1]);
     GLuint MatrixID = glGetUniformLocation(programID[1], "MVP");
     GLuint ColorID = glGetUniformLocation(programID[1], "mycolor");
@@ -240,12 +287,23 @@ int main(void)
 
     glfwSwapInterval(1); // 垂直同步，参数：在 glfwSwapBuffers 交换缓冲区之前要等待的最小屏幕更新数
     GLuint programID[2];
-    GLuint texture[numPlanets];
     GLuint VAO[2];
     GLuint VBO[NUM_VBO];
     GLuint orbitVBO;
 
-    init(window, programID, texture);
+    init(window, programID);
+    if (!planet_textures.single_array())
+    {
+        // 着色器只绑定一张数组纹理：贴图加载失败（0 张）或像素格式不一致被分成多张时都无法绘制
+        printf("ERROR::HOMEWORK_2:: planet textures must build into a single texture array, got %zu\n", planet_textures.arrays.size());
+        planet_textures = TextureArrays();
+        GLDeletionQueue::instance().flush();
+        glDeleteProgram(programID[0]);
+        glDeleteProgram(programID[1]);
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return -1;
+    }
     setup_vertices(VAO[0], VBO);
     setup_orbit(VAO[1], orbitVBO);
 
@@ -253,28 +311,29 @@ int main(void)
     glDepthFunc(GL_LEQUAL);
 
     static double last_time = glfwGetTime();
-    static int frame_count = 0;
-    static double fps = 0.0;
+    Profiler &profiler = Profiler::instance();
     while (glfwWindowShouldClose(window) == 0 && glfwGetKey(window, GLFW_KEY_ESCAPE) != GLFW_PRESS)
     {
-        display(window, glfwGetTime(), programID, texture, VAO);
+        profiler.begin_frame();
+        display(window, glfwGetTime(), programID, VAO, VBO[3]);
+        profiler.end_frame();
 
         glfwSwapBuffers(window);
+        GLDeletionQueue::instance().end_frame(); // 释放 GPU 已经用完的延迟删除对象
         glfwPollEvents();
 
-        // FPS
+        // 每秒输出一次帧时间和各作用域统计
         double current_time = glfwGetTime();
-        frame_count++;
         if (current_time - last_time >= 1.0)
         {
-            fps = frame_count;
-            frame_count = 0;
             last_time = current_time;
-            std::cout << "FPS: " << fps << std::endl;
+            profiler.print_summary();
         }
     }
     glDeleteVertexArrays(2, VAO);
-    glDeleteBuffers(3, VBO);
+    glDeleteBuffers(NUM_VBO, VBO);
+    planet_textures = TextureArrays();
+    GLDeletionQueue::instance().flush();
     glDeleteProgram(programID[0]);
     glDeleteProgram(programID[1]);
     glfwDestroyWindow(window);
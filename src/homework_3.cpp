@@ -13,26 +13,21 @@
 #include "load_texture.hpp"
 #include "environment_map.hpp"
 #include "draw_base_model.hpp"
+#include "profiler.hpp"
+#include "render_context.hpp"
+#include "asset_archive.hpp"
+#include "camera_path.hpp"
+#include "job_system.hpp"
+#include "texture_upload.hpp"
+#include "texture_streamer.hpp"
+#include "depth_prepass.hpp"
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 
 const unsigned int WINDOW_WIDTH = 1080 * 2;
 const unsigned int WINDOW_HEIGHT = 720 * 2;
 
-GLFWwindow *initialize_glfw_window()
-{
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-    GLFWwindow *window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "scene", NULL, NULL);
-    glfwMakeContextCurrent(window);
-    gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
-    glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
-
-    return window;
-}
-
 // lights
 glm::vec3 lightPositions[] = {
     glm::vec3(-10.0f, 10.0f, 10.0f),
@@ -44,20 +39,49 @@ int nrRows = 7;
 int nrColumns = 7;
 float spacing = 2.5;
 
-int main()
+int main(int argc, char **argv)
 {
-    GLFWwindow *window = initialize_glfw_window();
+    // --trace=<文件> [--trace-frames=<帧数>]：从启动开始捕获时间线；运行中按 F12 捕获接下来的 TRACE_HOTKEY_FRAMES 帧
+    const int TRACE_HOTKEY_FRAMES = 120;
+    Profiler::instance().parse_command_line(argc, argv);
+
+    // --archive=<资源包>：资源先从 asset_pack 打出的包里读
+    AssetArchive::instance().parse_command_line(argc, argv);
+
+    // --headless [--frames=<帧数>] [--size=<宽>x<高>]：无窗口渲染到 FBO
+    RenderContextDesc desc;
+    desc.width = WINDOW_WIDTH;
+    desc.height = WINDOW_HEIGHT;
+    desc.parse_command_line(argc, argv);
+    std::unique_ptr<RenderContext> context = RenderContext::create(desc);
+    if (!context)
+        return -1;
+
+    // --record-camera=<文件>：每 0.5 秒记录一个相机关键帧，退出时保存，供 bench --path 回放
+    std::string camera_record_path;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strncmp(argv[i], "--record-camera=", 16) == 0)
+            camera_record_path = argv[i] + 16;
+    }
+    CameraPath recorded_path;
+    double record_start = 0.0; // 第一个关键帧的时刻；保存的路径从 t = 0 开始，不含启动和加载的时间
 
     glEnable(GL_DEPTH_TEST);
     glDepthFunc(GL_LEQUAL);
 
-    Camera camera(window, 45.0f, glm::vec3(0., 0., 10.));
+    // 深度预通道，默认关闭；--depth-prepass 开启，运行中按 P 切换，两种模式的 GPU 耗时分别记在不同的作用域下
+    DepthPrepass depth_prepass;
+    depth_prepass.parse_command_line(argc, argv);
+
+    Camera camera(45.0f, glm::vec3(0., 0., 10.));
 
     Shader pbrShader("source/shader/homework_3/pbr.vs", "source/shader/homework_3/pbr_texture_IBL.fs");
     Shader backgroundShader("source/shader/homework_3/background.vs", "source/shader/homework_3/background.fs");
 
     unsigned int hdrTexture = load_HDR_texture("source/texture/HDR/kloppenheim_06_puresky_4k.hdr", GL_RGB16F);
     unsigned int envCubemap = convert_equirectangular_to_cubemap(hdrTexture, "source/shader/homework_3/cubemap.vs", "source/shader/homework_3/equirectangular_to_cubemap.fs");
+    GL_DESTROY(TEXTURE, hdrTexture); // 原始 HDR 贴图只用于生成 cubemap
     unsigned int irradianceMap = generate_irradiance_map(envCubemap, "source/shader/homework_3/cubemap.vs", "source/shader/homework_3/irradiance_convolution.fs");
 
     pbrShader.use();
@@ -67,26 +91,56 @@ int main()
     pbrShader.setInt("roughnessMap", 3);
     pbrShader.setInt("aoMap", 4);
     pbrShader.setInt("irradianceMap", 5);
-    unsigned int albedo = load_texture("source/model/metalgrid2-dx/metalgrid2_basecolor.png");
-    unsigned int normal = load_texture("source/model/metalgrid2-dx/metalgrid2_normal-dx.png");
-    unsigned int metallic = load_texture("source/model/metalgrid2-dx/metalgrid2_metallic.png");
-    unsigned int roughness = load_texture("source/model/metalgrid2-dx/metalgrid2_roughness.png");
-    unsigned int ao = load_texture("source/model/metalgrid2-dx/metalgrid2_AO.png");
+    // texcook 烘焙过的纹理交给流送器，只驻留球体在屏幕上用得到的 mip；
+    // 其余原图在工作线程解码，每帧最多上传 8 MB，加载期间球体先显示占位色
+    JobSystem jobs;
+    TextureUploadQueue uploads(jobs);
+    TextureStreamer streamer;
+    auto load_material_texture = [&](const char *path)
+    {
+        GLuint texture = streamer.load(path);
+        return texture ? texture : uploads.load(path);
+    };
+    unsigned int albedo = load_material_texture("source/model/metalgrid2-dx/metalgrid2_basecolor.png");
+    unsigned int normal = load_material_texture("source/model/metalgrid2-dx/metalgrid2_normal-dx.png");
+    // texcook 打包过 ORM 时只绑一张纹理（单元 2），否则退回三张单通道贴图
+    unsigned int orm = streamer.load("source/model/metalgrid2-dx/metalgrid2_orm.ktx2");
+    unsigned int metallic = 0, roughness = 0, ao = 0;
+    if (orm == 0)
+    {
+        metallic = load_material_texture("source/model/metalgrid2-dx/metalgrid2_metallic.png");
+        roughness = load_material_texture("source/model/metalgrid2-dx/metalgrid2_roughness.png");
+        ao = load_material_texture("source/model/metalgrid2-dx/metalgrid2_AO.png");
+    }
+    // 单位球的 UV 覆盖 [0, 1]^2，表面积 4π
+    const float sphere_uv_density = uv_density(4.0f * GLM_PI, 1.0f);
+    pbrShader.setInt("ormMap", 2);
+    pbrShader.setBool("useOrmMap", orm != 0);
+    bool uploads_reported = false;
 
     backgroundShader.use();
     backgroundShader.setInt("environmentMap", 0);
 
-    int scrWidth, scrHeight;
-    glfwGetFramebufferSize(window, &scrWidth, &scrHeight);
-    glViewport(0, 0, scrWidth, scrHeight);
-
     // light manager
     LightManager light_manager;
 
-    while (glfwWindowShouldClose(window) == 0 && glfwGetKey(window, GLFW_KEY_ESCAPE) != GLFW_PRESS)
+    Profiler &profiler = Profiler::instance();
+    double last_report_time = context->get_time();
+    bool trace_key_down = false;
+    while (!context->should_close())
     {
+        profiler.begin_frame();
+        context->begin_frame();
+        uploads.update();
+        if (!uploads_reported && uploads.get_pending() == 0)
+        {
+            uploads_reported = true;
+            TextureLoadStats::instance().print_report();
+            printf("texture uploads: %.2f MB, longest frame %.2f ms\n", uploads.get_stats().total_bytes / 1048576.0,
+                   uploads.get_stats().max_frame_ms);
+        }
         // Update light positions
-        float time = glfwGetTime();
+        float time = context->get_time();
         for (unsigned int i = 0; i < sizeof(lightPositions) / sizeof(lightPositions[0]); ++i)
         {
             lightPositions[i].x = 10.0f * cos(time + i);
@@ -98,16 +152,77 @@ int main()
         light_manager.add_directional_light(glm::vec3(1.0f, 1.0f, 1.0f), glm::vec3(10.0f, 10.0f, 10.0f));
         light_manager.add_spot_light(lightPositions[3], glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(150.0f, 150.0f, 150.0f));
         light_manager.add_area_light(lightPositions[4], glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(150.0f, 150.0f, 150.0f), 2.0f, 2.0f, 16);
-        light_manager.apply_lights(std::make_shared<Shader>(pbrShader));
+        light_manager.apply_lights(pbrShader);
 
-        camera.compute_matrices_from_inputs(window);
+        camera.update(context->get_camera_input());
+        if (!camera_record_path.empty())
+        {
+            if (recorded_path.empty())
+                record_start = context->get_time();
+            double record_time = context->get_time() - record_start;
+            if (recorded_path.empty() || record_time >= recorded_path.get_duration() + 0.5)
+                recorded_path.add_key(float(record_time), camera.get_pos(), camera.get_pos() + camera.get_direction());
+        }
         glm::mat4 view = camera.view;
         glm::mat4 projection = camera.projection;
         glm::vec3 cam_pos = camera.get_pos();
 
+        // 所有小球共用一套材质，按离相机最近的球面估算需要的 mip
+        float nearest = 1e30f;
+        for (int row = 0; row < nrRows; ++row)
+            for (int col = 0; col < nrColumns; ++col)
+            {
+                glm::vec3 center((float)(col - (nrColumns / 2)) * spacing, (float)(row - (nrRows / 2)) * spacing, -2.0f);
+                nearest = std::min(nearest, glm::length(center - cam_pos) - 1.0f);
+            }
+        streamer.set_view(projection, context->get_height());
+        for (GLuint texture : {albedo, normal, orm, metallic, roughness, ao})
+            streamer.request(texture, sphere_uv_density, nearest);
+        streamer.update();
+
         glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+        // 小球和光源都是不透明物体；shader 为深度着色器时不需要 normalMatrix
+        auto draw_spheres = [&](Shader &shader, bool shading)
+        {
+            glm::mat4 model = glm::mat4(1.0f);
+            for (int row = 0; row < nrRows; ++row)
+            {
+                for (int col = 0; col < nrColumns; ++col)
+                {
+                    model = glm::mat4(1.0f);
+                    model = glm::translate(model, glm::vec3((float)(col - (nrColumns / 2)) * spacing, (float)(row - (nrRows / 2)) * spacing, -2.0f));
+                    shader.setMat4("model", model);
+                    if (shading)
+                        shader.setMat3("normalMatrix", glm::transpose(glm::inverse(glm::mat3(model))));
+                    render_sphere();
+                }
+            }
+
+            // 光源
+            for (unsigned int i = 0; i < sizeof(lightPositions) / sizeof(lightPositions[0]); ++i)
+            {
+                glm::vec3 newPos = lightPositions[i];
+
+                model = glm::mat4(1.0f);
+                model = glm::translate(model, newPos);
+                model = glm::scale(model, glm::vec3(0.5f));
+                shader.setMat4("model", model);
+                if (shading)
+                    shader.setMat3("normalMatrix", glm::transpose(glm::inverse(glm::mat3(model))));
+                render_sphere();
+            }
+        };
+
+        if (depth_prepass.is_enabled())
+        {
+            profiler.begin_gpu("depth prepass");
+            draw_spheres(depth_prepass.begin_depth(projection, view), false);
+            profiler.end_gpu();
+        }
+        depth_prepass.begin_shading();
+
         pbrShader.use();
         pbrShader.setMat4("view", view);
         pbrShader.setMat4("projection", projection);
@@ -117,43 +232,31 @@ int main()
         glBindTexture(GL_TEXTURE_2D, albedo);
         glActiveTexture(GL_TEXTURE1);
         glBindTexture(GL_TEXTURE_2D, normal);
-        glActiveTexture(GL_TEXTURE2);
-        glBindTexture(GL_TEXTURE_2D, metallic);
-        glActiveTexture(GL_TEXTURE3);
-        glBindTexture(GL_TEXTURE_2D, roughness);
-        glActiveTexture(GL_TEXTURE4);
-        glBindTexture(GL_TEXTURE_2D, ao);
-        glActiveTexture(GL_TEXTURE5);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
-
-        // 小球
-        glm::mat4 model = glm::mat4(1.0f);
-        for (int row = 0; row < nrRows; ++row)
+        if (orm)
         {
-            for (int col = 0; col < nrColumns; ++col)
-            {
-                model = glm::mat4(1.0f);
-                model = glm::translate(model, glm::vec3((float)(col - (nrColumns / 2)) * spacing, (float)(row - (nrRows / 2)) * spacing, -2.0f));
-                pbrShader.setMat4("model", model);
-                pbrShader.setMat3("normalMatrix", glm::transpose(glm::inverse(glm::mat3(model))));
-                render_sphere();
-            }
+            glActiveTexture(GL_TEXTURE2);
+            glBindTexture(GL_TEXTURE_2D, orm);
         }
-
-        // 光源
-        for (unsigned int i = 0; i < sizeof(lightPositions) / sizeof(lightPositions[0]); ++i)
+        else
         {
-            glm::vec3 newPos = lightPositions[i];
-
-            model = glm::mat4(1.0f);
-            model = glm::translate(model, newPos);
-            model = glm::scale(model, glm::vec3(0.5f));
-            pbrShader.setMat4("model", model);
-            pbrShader.setMat3("normalMatrix", glm::transpose(glm::inverse(glm::mat3(model))));
-            render_sphere();
+            glActiveTexture(GL_TEXTURE2);
+            glBindTexture(GL_TEXTURE_2D, metallic);
+            glActiveTexture(GL_TEXTURE3);
+            glBindTexture(GL_TEXTURE_2D, roughness);
+            glActiveTexture(GL_TEXTURE4);
+            glBindTexture(GL_TEXTURE_2D, ao);
         }
+        glActiveTexture(GL_TEXTURE5);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap);
+
+        // 开启预通道时着色通道只剩 GL_EQUAL 通过的片元，"depth prepass" + "spheres (equal depth)" 与 "spheres" 对比
+        profiler.begin_gpu(depth_prepass.is_enabled() ? "spheres (equal depth)" : "spheres");
+        draw_spheres(pbrShader, true);
+        profiler.end_gpu();
+        depth_prepass.end();
 
         // skybox
+        profiler.begin_gpu("skybox");
         backgroundShader.use();
         backgroundShader.setMat4("view", view);
         backgroundShader.setMat4("projection", projection);
@@ -161,11 +264,39 @@ int main()
         glBindTexture(GL_TEXTURE_CUBE_MAP, envCubemap);
         // glBindTexture(GL_TEXTURE_CUBE_MAP, irradianceMap); // display irradiance map
         render_cube();
+        profiler.end_gpu();
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        profiler.end_frame();
+        context->end_frame();
+
+        bool trace_key = context->is_key_pressed(GLFW_KEY_F12);
+        if (trace_key && !trace_key_down && !profiler.is_capturing())
+            profiler.start_capture("frame_trace.json", TRACE_HOTKEY_FRAMES);
+        trace_key_down = trace_key;
+        depth_prepass.update_toggle(context->is_key_pressed(GLFW_KEY_P));
+
+        if (context->get_time() - last_report_time >= 1.0)
+        {
+            last_report_time = context->get_time();
+            profiler.print_summary();
+            const TextureStreamer::Stats &streaming = streamer.get_stats();
+            if (streaming.textures > 0)
+                printf("texture streaming: %.2f / %.2f MB resident, %d starved\n", streaming.resident_bytes / 1048576.0,
+                       streamer.get_budget() / 1048576.0, streaming.starved);
+        }
     }
 
-    glfwTerminate();
+    profiler.stop_capture();
+    if (!camera_record_path.empty())
+        recorded_path.save(camera_record_path);
+
+    streamer.print_report();
+    for (GLuint texture : {envCubemap, irradianceMap, albedo, normal, orm, metallic, roughness, ao})
+    {
+        streamer.unload(texture);
+        uploads.cancel(texture);
+        GL_DESTROY(TEXTURE, texture);
+    }
+    GLRegistry::instance().print_report();
     return 0;
 }
@@ -0,0 +1,154 @@
+// OBJ 加载基准：parse_obj 单线程 / 任务系统多线程 与 Assimp ReadFile（Model 使用的后处理参数）的耗时和吞吐量
+// 用法：obj_bench [a.obj b.obj ...]，不给参数时测 nanosuit 和一个临时生成的大网格
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
+#include "job_system.hpp"
+#include "mapped_file.hpp"
+#include "obj_parser.hpp"
+
+using bench_clock = std::chrono::high_resolution_clock;
+
+static double elapsed_ms(bench_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(bench_clock::now() - start).count();
+}
+
+// side x side 个顶点的起伏网格，四边形面，带 vt / vn，每 64 行换一个对象和材质
+static bool generate_grid(const std::string &path, int side)
+{
+    FILE *file = std::fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+    for (int y = 0; y < side; y++)
+    {
+        for (int x = 0; x < side; x++)
+        {
+            float h = 0.1f * std::sin(x * 0.07f) * std::cos(y * 0.05f);
+            std::fprintf(file, "v %.6f %.6f %.6f\nvt %.6f %.6f\nvn %.4f %.4f %.4f\n",
+                         x * 0.01f, h, y * 0.01f, x / float(side - 1), y / float(side - 1), 0.0f, 1.0f, 0.0f);
+        }
+    }
+    for (int y = 0; y + 1 < side; y++)
+    {
+        if (y % 64 == 0)
+            std::fprintf(file, "o strip%d\nusemtl material%d\n", y / 64, (y / 64) % 4);
+        for (int x = 0; x + 1 < side; x++)
+        {
+            int a = y * side + x + 1, b = a + 1, c = a + side + 1, d = a + side;
+            std::fprintf(file, "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n", a, a, a, b, b, b, c, c, c, d, d, d);
+        }
+    }
+    std::fclose(file);
+    return true;
+}
+
+struct Result
+{
+    double ms = 0.0;
+    size_t meshes = 0, vertices = 0, indices = 0;
+};
+
+static Result run_parse_obj(const std::string &path, JobSystem *jobs, int runs)
+{
+    Result result;
+    result.ms = 1e30;
+    for (int run = 0; run < runs; run++)
+    {
+        ObjParseOptions options;
+        options.jobs = jobs;
+        ObjScene scene;
+        bench_clock::time_point start = bench_clock::now();
+        if (!parse_obj(path, scene, options))
+            return Result();
+        result.ms = std::min(result.ms, elapsed_ms(start));
+        result.meshes = scene.meshes.size();
+        result.vertices = result.indices = 0;
+        for (const ObjMesh &mesh : scene.meshes)
+        {
+            result.vertices += mesh.vertices.size();
+            result.indices += mesh.indices.size();
+        }
+    }
+    return result;
+}
+
+static Result run_assimp(const std::string &path, int runs)
+{
+    Result result;
+    result.ms = 1e30;
+    for (int run = 0; run < runs; run++)
+    {
+        Assimp::Importer importer;
+        bench_clock::time_point start = bench_clock::now();
+        const aiScene *scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace |
+                                                           aiProcess_JoinIdenticalVertices | aiProcess_ImproveCacheLocality);
+        if (!scene || !scene->mRootNode)
+        {
+            std::printf("ERROR::ASSIMP:: %s\n", importer.GetErrorString());
+            return Result();
+        }
+        result.ms = std::min(result.ms, elapsed_ms(start));
+        result.meshes = scene->mNumMeshes;
+        result.vertices = result.indices = 0;
+        for (unsigned int i = 0; i < scene->mNumMeshes; i++)
+        {
+            result.vertices += scene->mMeshes[i]->mNumVertices;
+            result.indices += scene->mMeshes[i]->mNumFaces * 3;
+        }
+    }
+    return result;
+}
+
+static void print_row(const char *name, const Result &result, double megabytes, double baseline_ms)
+{
+    std::printf("  %-14s %10.2f %10.1f %8.2f %8zu %10zu %10zu\n", name, result.ms, megabytes / (result.ms / 1000.0),
+                baseline_ms / result.ms, result.meshes, result.vertices, result.indices);
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++)
+        paths.push_back(argv[i]);
+    std::string generated;
+    if (paths.empty())
+    {
+        paths.push_back("source/model/nanosuit/nanosuit.obj");
+        generated = "obj_bench_grid.obj";
+        if (generate_grid(generated, 768))
+            paths.push_back(generated);
+    }
+
+    JobSystem jobs;
+    const int runs = 3;
+    std::printf("threads: %u, best of %d runs\n", jobs.get_thread_count(), runs);
+    for (const std::string &path : paths)
+    {
+        MappedFile file;
+        if (!file.open(path))
+        {
+            std::printf("ERROR::OBJ_BENCH:: cannot open %s\n", path.c_str());
+            continue;
+        }
+        double megabytes = file.size() / (1024.0 * 1024.0);
+        std::printf("%s (%.1f MB)\n", path.c_str(), megabytes);
+        std::printf("  %-14s %10s %10s %8s %8s %10s %10s\n", "loader", "ms", "MB/s", "speedup", "meshes", "vertices", "indices");
+
+        Result assimp = run_assimp(path, runs);
+        print_row("assimp", assimp, megabytes, assimp.ms);
+        print_row("parse_obj x1", run_parse_obj(path, nullptr, runs), megabytes, assimp.ms);
+        print_row("parse_obj xN", run_parse_obj(path, &jobs, runs), megabytes, assimp.ms);
+    }
+    if (!generated.empty())
+        std::remove(generated.c_str());
+    return 0;
+}
@@ -0,0 +1,353 @@
+// 纹理离线压缩：把 source/ 下的 png / jpg / bmp / tga 转成同名的 .ktx2（块压缩 + 完整 mip 链），运行时直接上传压缩数据。
+//
+// texcook [paths...] [--filter=kaiser|box] [--color=bc7|bc1] [--min-psnr=dB] [--threads=N] [--force] [--no-orm]
+//
+// 按文件名选择格式：法线贴图（normal / ddn / nrm）-> BC5，粗糙度 / 金属度 / AO / 高度 -> BC4，
+// 其余颜色纹理 -> --color 指定的格式（默认 BC7），带透明度且选了 BC1 时改用 BC3。
+// 同一材质的 AO / 粗糙度 / 金属度另外打包成一张 <材质>_orm.ktx2（R = AO，G = 粗糙度，B = 金属度，格式同 --color），
+// PBR 着色器一次采样取到三个参数；--no-orm 关闭打包。
+// 相对 RGBA8 显存占用：BC1 / BC4 为 1/8，BC3 / BC5 / BC7 为 1/4。
+// 文件之间、同一张图的块行之间都用 JobSystem 并行。第 0 层解压后与原图比较 PSNR，低于格式阈值（或 --min-psnr）判定失败。
+// .ktx2 比源文件新时跳过，--force 强制重新生成。返回值：0 成功，1 读写错误，2 有纹理低于 PSNR 阈值。
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include "block_compression.hpp"
+#include "job_system.hpp"
+#include "ktx2.hpp"
+#include "orm_packing.hpp"
+
+namespace fs = std::filesystem;
+
+struct CookOptions
+{
+    std::vector<std::string> paths;
+    MipFilter filter = MipFilter::KAISER;
+    BlockFormat color_format = BlockFormat::BC7;
+    double min_psnr = 0.0; // 0 表示使用各格式的默认阈值
+    unsigned int threads = 0;
+    bool force = false;
+    bool pack_orm = true;
+};
+
+struct CookResult
+{
+    std::string path;
+    BlockFormat format = BlockFormat::BC1;
+    int width = 0;
+    int height = 0;
+    int levels = 0;
+    size_t raw_bytes = 0; // RGBA8 + mip 链
+    size_t compressed_bytes = 0;
+    double psnr = 0.0;
+    double threshold = 0.0;
+    double milliseconds = 0.0;
+    bool ok = false;
+    bool skipped = false;
+};
+
+static void parse_options(int argc, char **argv, CookOptions &options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        if (std::strncmp(arg, "--filter=", 9) == 0)
+            options.filter = std::strcmp(arg + 9, "box") == 0 ? MipFilter::BOX : MipFilter::KAISER;
+        else if (std::strncmp(arg, "--color=", 8) == 0)
+            options.color_format = std::strcmp(arg + 8, "bc1") == 0 ? BlockFormat::BC1 : BlockFormat::BC7;
+        else if (std::strncmp(arg, "--min-psnr=", 11) == 0)
+            options.min_psnr = std::atof(arg + 11);
+        else if (std::strncmp(arg, "--threads=", 10) == 0)
+            options.threads = static_cast<unsigned int>(std::max(1, std::atoi(arg + 10)) - 1);
+        else if (std::strcmp(arg, "--force") == 0)
+            options.force = true;
+        else if (std::strcmp(arg, "--no-orm") == 0)
+            options.pack_orm = false;
+        else if (arg[0] != '-')
+            options.paths.push_back(arg);
+    }
+    if (options.paths.empty())
+        options.paths.push_back("source");
+}
+
+static std::string lowercase(std::string text)
+{
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c)
+                   { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+static bool is_source_image(const fs::path &path)
+{
+    std::string extension = lowercase(path.extension().string());
+    return extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".jfif" ||
+           extension == ".bmp" || extension == ".tga";
+}
+
+static bool name_contains(const std::string &name, std::initializer_list<const char *> keys)
+{
+    for (const char *key : keys)
+        if (name.find(key) != std::string::npos)
+            return true;
+    return false;
+}
+
+// 各格式的默认 PSNR 阈值：BC1 的 565 端点本身就有 ~1 个灰阶的误差；BC4 / BC5 每块只有 8 级，噪声很大的数据纹理也只有 33~35 dB
+static double default_threshold(BlockFormat format)
+{
+    switch (format)
+    {
+    case BlockFormat::BC1:
+    case BlockFormat::BC3:
+        return 30.0;
+    case BlockFormat::BC7:
+        return 34.0;
+    case BlockFormat::BC4:
+    case BlockFormat::BC5:
+    default:
+        return 32.0;
+    }
+}
+
+// 一个输出文件：普通纹理只有一个源文件；ORM 打包纹理按通道最多三个源文件，缺少的通道为空
+struct CookJob
+{
+    fs::path target;
+    std::vector<fs::path> sources;
+    bool orm = false;
+};
+
+static bool load_source(const fs::path &source, ImageRGBA &image)
+{
+    int channels = 0;
+    // KTX2 默认自上而下存放，与 stb 不翻转时的行顺序相同
+    unsigned char *pixels = stbi_load(source.generic_string().c_str(), &image.width, &image.height, &channels, 4);
+    if (!pixels)
+    {
+        // 扩展名与内容不符的文件（如 AVIF 存成 .jpg）stb 读不了，运行时同样加载不了，只提示不算失败
+        printf("texcook: %s skipped: %s\n", source.generic_string().c_str(), stbi_failure_reason());
+        return false;
+    }
+    image.pixels.assign(pixels, pixels + size_t(image.width) * image.height * 4);
+    stbi_image_free(pixels);
+    return true;
+}
+
+static CookResult cook(const CookJob &job, const CookOptions &options, JobSystem &jobs)
+{
+    auto start = std::chrono::steady_clock::now();
+    CookResult result;
+    result.path = job.orm ? job.target.generic_string() : job.sources[0].generic_string();
+
+    ImageRGBA image;
+    TextureUsage usage = TextureUsage::COLOR;
+    if (job.orm)
+    {
+        ImageRGBA channels[size_t(OrmChannel::COUNT)];
+        const ImageRGBA *present[size_t(OrmChannel::COUNT)] = {};
+        for (size_t c = 0; c < size_t(OrmChannel::COUNT); c++)
+        {
+            if (job.sources[c].empty())
+                continue;
+            if (!load_source(job.sources[c], channels[c]))
+            {
+                result.skipped = true;
+                return result;
+            }
+            present[c] = &channels[c];
+        }
+        image = pack_orm(present);
+        usage = TextureUsage::LINEAR;
+        // 三个通道互相独立，BC7 的 RGB 端点比 BC1 的 565 更适合
+        result.format = options.color_format;
+    }
+    else
+    {
+        if (!load_source(job.sources[0], image))
+        {
+            result.skipped = true;
+            return result;
+        }
+        std::string name = lowercase(job.sources[0].stem().string());
+        if (name_contains(name, {"normal", "ddn", "nrm"}))
+        {
+            usage = TextureUsage::NORMAL;
+            result.format = BlockFormat::BC5;
+        }
+        else if (name_contains(name, {"roughness", "metallic", "metalness", "_ao", "occlusion", "height", "disp"}))
+        {
+            usage = TextureUsage::LINEAR;
+            result.format = BlockFormat::BC4;
+        }
+        else
+        {
+            bool has_alpha = false;
+            for (size_t i = 3; i < image.pixels.size() && !has_alpha; i += 4)
+                has_alpha = image.pixels[i] != 255;
+            result.format = has_alpha && options.color_format == BlockFormat::BC1 ? BlockFormat::BC3 : options.color_format;
+        }
+    }
+
+    result.width = image.width;
+    result.height = image.height;
+    result.threshold = options.min_psnr > 0.0 ? options.min_psnr : default_threshold(result.format);
+
+    std::vector<std::vector<uint8_t>> levels;
+    ImageRGBA level = std::move(image);
+    while (true)
+    {
+        levels.push_back(compress_image(level, result.format, &jobs));
+        result.raw_bytes += level.pixels.size();
+        result.compressed_bytes += levels.back().size();
+        if (levels.size() == 1)
+        {
+            ImageRGBA decoded = decompress_image(levels.back().data(), level.width, level.height, result.format);
+            result.psnr = compute_psnr(level, decoded, result.format);
+        }
+        if (level.width == 1 && level.height == 1)
+            break;
+        level = downsample(level, options.filter, usage);
+    }
+    result.levels = static_cast<int>(levels.size());
+
+    result.ok = write_ktx2(job.target.string(), result.format, result.width, result.height, levels);
+    result.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+static bool is_up_to_date(const CookJob &job)
+{
+    std::error_code error;
+    if (!fs::exists(job.target, error))
+        return false;
+    fs::file_time_type target_time = fs::last_write_time(job.target, error);
+    for (const fs::path &source : job.sources)
+        if (!source.empty() && fs::last_write_time(source, error) > target_time)
+            return false;
+    return !error;
+}
+
+int main(int argc, char **argv)
+{
+    CookOptions options;
+    parse_options(argc, argv, options);
+
+    std::vector<fs::path> sources;
+    bool unreadable = false;
+    for (const std::string &root : options.paths)
+    {
+        std::error_code error;
+        if (fs::is_regular_file(root, error))
+        {
+            sources.push_back(root);
+            continue;
+        }
+        for (fs::recursive_directory_iterator it(root, error), end; !error && it != end; it.increment(error))
+            if (it->is_regular_file() && is_source_image(it->path()))
+                sources.push_back(it->path());
+        if (error)
+        {
+            printf("ERROR::TEXCOOK:: cannot read %s: %s\n", root.c_str(), error.message().c_str());
+            unreadable = true;
+        }
+    }
+    if (unreadable)
+        return 1;
+    std::sort(sources.begin(), sources.end());
+
+    // 同一目录下 a.png 和 a.jpg 会写到同一个 a.ktx2，只处理排在前面的那个
+    std::vector<CookJob> cook_jobs;
+    std::map<std::string, size_t> orm_jobs; // 打包路径 -> cook_jobs 下标
+    for (size_t i = 0; i < sources.size(); i++)
+    {
+        fs::path target = sources[i];
+        target.replace_extension(".ktx2");
+        if (i > 0 && fs::path(sources[i - 1]).replace_extension(".ktx2") == target)
+        {
+            printf("ERROR::TEXCOOK:: %s skipped, %s already produces %s\n", sources[i].generic_string().c_str(),
+                   sources[i - 1].generic_string().c_str(), target.generic_string().c_str());
+            continue;
+        }
+        cook_jobs.push_back({target, {sources[i]}, false});
+
+        // 同一材质的 AO / 粗糙度 / 金属度再额外打包成一张 ORM，单独的 BC4 仍然保留给逐张绑定的着色器
+        OrmChannel channel;
+        std::string packed_path;
+        if (!options.pack_orm || !find_orm_channel(sources[i].generic_string(), channel, packed_path))
+            continue;
+        auto found = orm_jobs.find(packed_path);
+        if (found == orm_jobs.end())
+        {
+            found = orm_jobs.emplace(packed_path, cook_jobs.size()).first;
+            cook_jobs.push_back({packed_path, std::vector<fs::path>(size_t(OrmChannel::COUNT)), true});
+        }
+        cook_jobs[found->second].sources[size_t(channel)] = sources[i];
+    }
+
+    // 产物比所有源文件都新时跳过
+    std::vector<CookJob> pending;
+    size_t up_to_date = 0;
+    for (CookJob &job : cook_jobs)
+    {
+        if (!options.force && is_up_to_date(job))
+            up_to_date++;
+        else
+            pending.push_back(std::move(job));
+    }
+    printf("texcook: %zu textures (%zu up to date), %s mips\n", pending.size(), up_to_date,
+           options.filter == MipFilter::BOX ? "box" : "kaiser");
+    if (pending.empty())
+        return 0;
+
+    JobSystem jobs(options.threads);
+    std::vector<CookResult> results(pending.size());
+    JobCounter counter;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < pending.size(); i++)
+        jobs.submit([&, i]
+                    { results[i] = cook(pending[i], options, jobs); },
+                    &counter);
+    jobs.wait(counter);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("%-60s %-4s %11s %6s %9s %9s %7s %9s\n", "texture", "fmt", "size", "mips", "raw KB", "ktx2 KB", "PSNR", "ms");
+    size_t raw_total = 0, compressed_total = 0;
+    int errors = 0, below_threshold = 0;
+    for (const CookResult &result : results)
+    {
+        if (!result.ok)
+        {
+            errors += result.skipped ? 0 : 1;
+            continue;
+        }
+        char size[32];
+        snprintf(size, sizeof(size), "%dx%d", result.width, result.height);
+        bool passed = result.psnr >= result.threshold;
+        printf("%-60s %-4s %11s %6d %9.1f %9.1f %7.2f %9.1f%s\n", result.path.c_str(), block_format_name(result.format), size,
+               result.levels, result.raw_bytes / 1024.0, result.compressed_bytes / 1024.0, std::min(result.psnr, 99.99),
+               result.milliseconds, passed ? "" : "  < threshold");
+        if (!passed)
+        {
+            printf("ERROR::TEXCOOK:: %s PSNR %.2f dB below %.2f dB\n", result.path.c_str(), result.psnr, result.threshold);
+            below_threshold++;
+        }
+        raw_total += result.raw_bytes;
+        compressed_total += result.compressed_bytes;
+    }
+    printf("total: %.2f MB -> %.2f MB (%.1fx smaller), %.2f s on %u threads\n", raw_total / 1048576.0, compressed_total / 1048576.0,
+           compressed_total ? double(raw_total) / compressed_total : 0.0, seconds, jobs.get_thread_count());
+    if (errors)
+        return 1;
+    return below_threshold ? 2 : 0;
+}
@@ -1,7 +1,7 @@
 #include <cmath>
 #include <vector>
 #include <iostream>
-#include <glm\glm.hpp>
+#include <glm/glm.hpp>
 #include "sphere.hpp"
 using namespace std;
 Sphere::Sphere()